@@ -34,5 +34,9 @@ namespace QuantumEditor.Demo
 
         [DllImport("QuantumEngine.DemoAPI.dll", EntryPoint = "Run_Complete_Scene")]
         public static extern bool RunCompleteScene(IntPtr handle, GraphicAPI graphicAPI);
+
+
+        [DllImport("QuantumEngine.DemoAPI.dll", EntryPoint = "Run_Meshlet_Benchmark")]
+        public static extern bool RunMeshletBenchmark(IntPtr handle);
     }
 }
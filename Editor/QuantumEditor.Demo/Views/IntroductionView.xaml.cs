@@ -8,6 +8,7 @@ using System.Windows.Controls;
 using System.Windows.Data;
 using System.Windows.Documents;
 using System.Windows.Input;
+using System.Windows.Interop;
 using System.Windows.Media;
 using System.Windows.Media.Imaging;
 using System.Windows.Navigation;
@@ -24,5 +25,11 @@ namespace QuantumEditor.Demo.Views
         {
             InitializeComponent();
         }
+
+        private void OnMeshletBenchmark(object sender, RoutedEventArgs e)
+        {
+            WindowInteropHelper interop = new(Window.GetWindow(this));
+            DemoNativeAPI.RunMeshletBenchmark(interop.Handle);
+        }
     }
 }
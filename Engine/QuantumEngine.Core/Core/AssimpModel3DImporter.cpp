@@ -1,31 +1,107 @@
 #include "AssimpModel3DImporter.h"
 #include <vector>
+#include <atomic>
+#include <chrono>
+#include <numeric>
+#include <thread>
 #include "Mesh.h"
+#include "MeshSimplifier.h"
+#include "MeshletBuilder.h"
 #include "assimp/Importer.hpp"
 #include "assimp/postprocess.h"
 #include "assimp/scene.h"   
 #include "Matrix4.h"
 #include "Model3DAsset.h"
+#include "ModelCache.h"
 #include "../StringUtilities.h"
 
-ref<QuantumEngine::Model3DAsset> QuantumEngine::AssimpModel3DImporter::Import(const std::string& fileName, const ModelImportProperties& properties, std::string& error)
+namespace {
+	Float MillisecondsSince(const std::chrono::high_resolution_clock::time_point& start)
+	{
+		return std::chrono::duration<Float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+}
+
+ref<QuantumEngine::Model3DAsset> QuantumEngine::AssimpModel3DImporter::Import(const std::string& fileName, const ModelImportProperties& properties, std::string& error, ModelImportTimings* timings)
 {
+	ModelImportTimings localTimings;
+
+	if (timings == nullptr)
+		timings = &localTimings;
+
+	*timings = ModelImportTimings();
+
+	std::string cachePath = ModelCache::GetCachePath(fileName);
+	UInt64 sourceHash = 0;
+	auto phaseStart = std::chrono::high_resolution_clock::now();
+
+	if (properties.useModelCache) {
+		sourceHash = ModelCache::HashFile(fileName);
+
+		if (sourceHash != 0) {
+			auto cachedAsset = ModelCache::Load(cachePath, sourceHash, properties);
+			timings->cacheLoad = MillisecondsSince(phaseStart);
+
+			if (cachedAsset != nullptr) {
+				timings->loadedFromCache = true;
+				return cachedAsset;
+			}
+		}
+	}
+
+	phaseStart = std::chrono::high_resolution_clock::now();
+
 	Assimp::Importer Importer;
 
 	auto pScene = Importer.ReadFile(fileName.c_str(), aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_FlipWindingOrder);
+	timings->readFile = MillisecondsSince(phaseStart);
 
 	if (pScene == nullptr) {
 		error = "Error Importing 3D Asset File. Error: " + std::string(Importer.GetErrorString());
 		return nullptr;
 	}
 
+	phaseStart = std::chrono::high_resolution_clock::now();
+
+	// the scene is only read from here on, so meshes can be converted independently.
+	// Biggest meshes are handed out first so one large mesh doesn't end up last on a single thread
+	UInt32 meshCount = pScene->mNumMeshes;
+	std::vector<UInt32> order(meshCount);
+	std::iota(order.begin(), order.end(), 0u);
+	std::stable_sort(order.begin(), order.end(), [pScene](UInt32 a, UInt32 b) { return pScene->mMeshes[a]->mNumVertices > pScene->mMeshes[b]->mNumVertices; });
+
+	std::vector<ref<Mesh>> converted(meshCount);
+	std::atomic<UInt32> nextMesh = 0;
+	auto worker = [&]() {
+		for (UInt32 i = nextMesh++; i < meshCount; i = nextMesh++)
+			converted[order[i]] = CreateMesh(pScene->mMeshes[order[i]], properties);
+	};
+
+	UInt32 threadCount = properties.conversionThreadCount > 0 ? properties.conversionThreadCount : std::max(std::thread::hardware_concurrency(), 1u);
+	threadCount = std::min(threadCount, meshCount);
+	std::vector<std::thread> threads;
+
+	for (UInt32 i = 1; i < threadCount; i++)
+		threads.emplace_back(worker);
+
+	worker();
+
+	for (auto& thread : threads)
+		thread.join();
+
 	std::vector<std::pair<std::string, ref<Mesh>>> meshes;
-	meshes.reserve(pScene->mNumMeshes);
+	meshes.reserve(meshCount);
 
-	for (unsigned int i = 0; i < pScene->mNumMeshes; i++) {
-		const aiMesh* paiMesh = pScene->mMeshes[i];
-        auto mesh = CreateMesh(paiMesh, properties);
-		meshes.push_back(std::make_pair(std::string(paiMesh->mName.C_Str()), mesh));
+	for (UInt32 i = 0; i < meshCount; i++)
+		meshes.push_back(std::make_pair(std::string(pScene->mMeshes[i]->mName.C_Str()), converted[i]));
+
+	timings->conversion = MillisecondsSince(phaseStart);
+
+	// a failed cache write only costs the next run another import
+	if (properties.useModelCache && sourceHash != 0) {
+		phaseStart = std::chrono::high_resolution_clock::now();
+		ModelCache::Save(cachePath, sourceHash, properties, meshes);
+		timings->cacheWrite = MillisecondsSince(phaseStart);
 	}
 
 	return std::make_shared<Model3DAsset>(meshes);
@@ -33,32 +109,52 @@ ref<QuantumEngine::Model3DAsset> QuantumEngine::AssimpModel3DImporter::Import(co
 
 ref<QuantumEngine::Mesh> QuantumEngine::AssimpModel3DImporter::CreateMesh(const aiMesh* paiMesh, const ModelImportProperties& properties)
 {
-    std::vector<Vertex> vertices;
-    std::vector<UInt32> indices;
+	UInt32 vertexCount = paiMesh->mNumVertices;
+	std::vector<Vertex> vertices(vertexCount);
+	std::vector<UInt32> indices(3 * (size_t)paiMesh->mNumFaces);
 
-    const aiVector3D Zero3D(0.0f, 0.0f, 0.0f);
-    Matrix4 rotationMatrix = Matrix4::Rotate(properties.axis, properties.angleDeg);
+	Matrix4 rotationMatrix = Matrix4::Rotate(properties.axis, properties.angleDeg);
 	Matrix4 transformMatrix = Matrix4::Translate(properties.position) * Matrix4::Scale(properties.scale) * rotationMatrix;
-    
-    for (UInt32 i = 0; i < paiMesh->mNumVertices; i++) {
-        const aiVector3D* pPos = &(paiMesh->mVertices[i]);
-        const aiVector3D* pNormal = &(paiMesh->mNormals[i]);
-        const aiVector3D* pTexCoord = paiMesh->HasTextureCoords(0) ? &(paiMesh->mTextureCoords[0][i]) : &Zero3D;
-
-        Vertex v(transformMatrix * Vector3(pPos->x, pPos->y, pPos->z),
-            Vector2(pTexCoord->x, pTexCoord->y),
-            rotationMatrix * Vector3(pNormal->x, pNormal->y, pNormal->z));
-
-        vertices.push_back(v);
-    }
-
-    for (unsigned int i = 0; i < paiMesh->mNumFaces; i++) {
-        const aiFace& Face = paiMesh->mFaces[i];
-        assert(Face.mNumIndices == 3);
-        indices.push_back(Face.mIndices[0]);
-        indices.push_back(Face.mIndices[1]);
-        indices.push_back(Face.mIndices[2]);
-    }
-
-	return std::make_shared<Mesh>(vertices, indices);
+
+	if (vertexCount > 0) {
+		transformMatrix.TransformVectors(&paiMesh->mVertices[0].x, sizeof(aiVector3D), &vertices[0].position.x, sizeof(Vertex), vertexCount);
+
+		if (paiMesh->HasNormals())
+			rotationMatrix.TransformVectors(&paiMesh->mNormals[0].x, sizeof(aiVector3D), &vertices[0].normal.x, sizeof(Vertex), vertexCount);
+	}
+
+	if (paiMesh->HasTextureCoords(0)) {
+		const aiVector3D* texCoords = paiMesh->mTextureCoords[0];
+
+		for (UInt32 i = 0; i < vertexCount; i++)
+			vertices[i].uv = Vector2(texCoords[i].x, texCoords[i].y);
+	}
+
+	UInt32* index = indices.data();
+
+	for (unsigned int i = 0; i < paiMesh->mNumFaces; i++) {
+		const aiFace& Face = paiMesh->mFaces[i];
+		assert(Face.mNumIndices == 3);
+		index[0] = Face.mIndices[0];
+		index[1] = Face.mIndices[1];
+		index[2] = Face.mIndices[2];
+		index += 3;
+	}
+
+	auto mesh = std::make_shared<Mesh>(vertices, indices);
+
+	if (properties.lodCount > 0)
+		MeshSimplifier::GenerateLODs(mesh, properties.lodCount, properties.lodReductionRatio);
+
+	if (properties.quantizeVertices)
+		mesh->Quantize();
+
+	if (properties.buildMeshlets) {
+		mesh->SetMeshletData(MeshletBuilder::Build(mesh));
+
+		for (UInt32 i = 0; i < mesh->GetLODCount(); i++)
+			mesh->GetLOD(i)->SetMeshletData(MeshletBuilder::Build(mesh->GetLOD(i)));
+	}
+
+	return mesh;
 }
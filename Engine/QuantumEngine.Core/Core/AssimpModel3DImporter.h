@@ -14,11 +14,30 @@ namespace QuantumEngine {
 		Vector3 axis = Vector3(0.0f, 0.0f, 1.0f);
 		Float angleDeg = 0.0f;
 		Vector3 scale = Vector3(1.0f);
+		bool quantizeVertices = false;
+		UInt32 lodCount = 0;
+		Float lodReductionRatio = 0.5f;
+		bool buildMeshlets = false;
+		// load from and write to the binary model cache next to the source file (<source>.qmcache). Not part of the cache key
+		bool useModelCache = false;
+		// threads converting meshes after the file is read, 0 uses all cores. Not part of the cache key
+		UInt32 conversionThreadCount = 0;
+	};
+
+	/// <summary>
+	/// Wall clock time spent in each import phase, in milliseconds
+	/// </summary>
+	struct ModelImportTimings {
+		Float cacheLoad = 0.0f;
+		Float readFile = 0.0f;
+		Float conversion = 0.0f;
+		Float cacheWrite = 0.0f;
+		bool loadedFromCache = false;
 	};
 
 	class AssimpModel3DImporter {
 	public:
-		static ref<Model3DAsset> Import(const std::string& filePath, const ModelImportProperties& properties, std::string& error);
+		static ref<Model3DAsset> Import(const std::string& filePath, const ModelImportProperties& properties, std::string& error, ModelImportTimings* timings = nullptr);
 	private:
 		static ref<Mesh> CreateMesh(const aiMesh* paiMesh, const ModelImportProperties& properties);
 	};
@@ -0,0 +1,312 @@
+#include "AsyncAssetLoader.h"
+#include <cwctype>
+#include <objbase.h>
+#include "DDSTextureFile.h"
+#include "Mesh.h"
+#include "Model3DAsset.h"
+#include "ModelCache.h"
+#include "Texture2D.h"
+#include "Texture2DImporter.h"
+#include "TextureCache.h"
+#include "WICTexture2DImporter.h"
+#include "../StringUtilities.h"
+#include "../Rendering/GPUAssetManager.h"
+
+namespace {
+	template<typename T>
+	bool IsReady(const std::shared_future<T>& future)
+	{
+		return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+	}
+
+	bool IsDDSPath(const std::wstring& filePath)
+	{
+		if (filePath.size() < 4)
+			return false;
+
+		std::wstring extension = filePath.substr(filePath.size() - 4);
+
+		for (auto& c : extension)
+			c = (wchar_t)std::towlower(c);
+
+		return extension == L".dds";
+	}
+
+	ref<QuantumEngine::Texture2D> DecodeTexture(const std::wstring& filePath, bool sRGB, bool generateMips, const QuantumEngine::MipGenerationProperties& mipProperties, std::string& error)
+	{
+		using namespace QuantumEngine;
+		auto texture = Texture2DImporter::Import(WStringToString(filePath), error);
+
+		// formats the portable decoders don't cover still go through WIC
+		if (texture == nullptr) {
+			error.clear();
+			texture = WICTexture2DImporter::Import(filePath, error);
+		}
+
+		if (texture != nullptr)
+			texture->SetSRGB(sRGB);
+
+		if (generateMips && texture != nullptr) {
+			auto mippedTexture = TextureMipGenerator::GenerateMips(texture, mipProperties);
+
+			if (mippedTexture != nullptr)
+				texture = mippedTexture;
+		}
+
+		return texture;
+	}
+}
+
+QuantumEngine::AsyncAssetLoader::AsyncAssetLoader(const ref<Rendering::GPUAssetManager>& assetManager, UInt32 threadCount)
+	: m_assetManager(assetManager)
+{
+	if (threadCount == 0)
+		threadCount = std::min(std::max(std::thread::hardware_concurrency(), 1u), 4u);
+
+	for (UInt32 i = 0; i < threadCount; i++)
+		m_threads.emplace_back(&AsyncAssetLoader::WorkerLoop, this);
+}
+
+QuantumEngine::AsyncAssetLoader::~AsyncAssetLoader()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+
+	m_jobAvailable.notify_all();
+
+	for (auto& thread : m_threads)
+		thread.join();
+}
+
+QuantumEngine::ModelLoadHandle QuantumEngine::AsyncAssetLoader::LoadModelAsync(const std::string& filePath, const ModelImportProperties& properties, const ModelCallback& onLoaded)
+{
+	std::string key = filePath + "|" + std::to_string(ModelCache::HashProperties(properties));
+	ModelLoadHandle handle;
+	bool isNewLoad = false;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto it = m_modelLoads.find(key);
+
+		if (it != m_modelLoads.end()) {
+			handle = it->second;
+		}
+		else {
+			auto promise = std::make_shared<std::promise<ModelLoadResult>>();
+			handle = promise->get_future().share();
+			m_modelLoads.emplace(key, handle);
+			isNewLoad = true;
+
+			m_pendingCount++;
+			m_jobs.push_back([this, promise, key, filePath, properties]() {
+				ModelLoadResult result;
+				result.asset = AssimpModel3DImporter::Import(filePath, properties, result.error, &result.timings);
+
+				std::lock_guard<std::mutex> lock(m_mutex);
+
+				if (m_assetManager != nullptr && result.asset != nullptr) {
+					auto asset = result.asset;
+					m_uploads.push_back([this, asset]() {
+						std::vector<ref<Mesh>> meshes;
+
+						for (auto& mesh : asset->GetMeshes())
+							meshes.push_back(mesh.second);
+
+						m_assetManager->UploadMeshesToGPU(meshes);
+					});
+				}
+
+				m_modelLoads.erase(key);
+				promise->set_value(std::move(result));
+			});
+		}
+
+		if (onLoaded != nullptr)
+			m_callbacks.push_back({ [handle]() { return IsReady(handle); }, [handle, onLoaded]() { onLoaded(handle.get()); } });
+	}
+
+	if (isNewLoad)
+		m_jobAvailable.notify_one();
+
+	return handle;
+}
+
+QuantumEngine::TextureLoadHandle QuantumEngine::AsyncAssetLoader::LoadTextureAsync(const std::wstring& filePath, const TextureCallback& onLoaded, bool sRGB)
+{
+	TextureLoadHandle handle;
+	bool isNewLoad = false;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		bool generateMips = m_generateTextureMips;
+		MipGenerationProperties mipProperties = m_mipProperties;
+		mipProperties.sRGB = mipProperties.sRGB && sRGB;
+		bool compress = m_compressTextures;
+		TextureCompressionProperties compressionProperties = m_compressionProperties;
+
+		// the same file loaded with other settings is a different texture
+		std::wstring key = filePath + L"|" + std::to_wstring(sRGB) + std::to_wstring(compress) + L"|"
+			+ std::to_wstring(TextureCache::HashProperties(generateMips, mipProperties, compressionProperties));
+		auto it = m_textureLoads.find(key);
+
+		if (it != m_textureLoads.end()) {
+			handle = it->second;
+		}
+		else {
+			auto promise = std::make_shared<std::promise<TextureLoadResult>>();
+			handle = promise->get_future().share();
+			m_textureLoads.emplace(key, handle);
+			isNewLoad = true;
+
+			m_pendingCount++;
+
+			m_jobs.push_back([this, promise, key, filePath, sRGB, generateMips, mipProperties, compress, compressionProperties]() {
+				TextureLoadResult result;
+
+				// DDS files are already GPU ready, they are mapped and uploaded as stored
+				if (IsDDSPath(filePath)) {
+					result.asset = DDSTextureFile::Load(WStringToString(filePath), result.error);
+				}
+				else if (compress == false) {
+					result.asset = DecodeTexture(filePath, sRGB, generateMips, mipProperties, result.error);
+				}
+				else {
+					std::string sourcePath = WStringToString(filePath);
+					std::string cachePath = TextureCache::GetCachePath(sourcePath);
+					UInt64 sourceHash = ModelCache::HashFile(sourcePath);
+					UInt64 propertiesHash = TextureCache::HashProperties(generateMips, mipProperties, compressionProperties);
+
+					if (sourceHash != 0)
+						result.asset = TextureCache::Load(cachePath, sourceHash, propertiesHash);
+
+					if (result.asset == nullptr)
+						result.asset = DecodeTexture(filePath, sRGB, generateMips, mipProperties, result.error);
+
+					// unsupported textures stay uncompressed, a failed cache write only costs the next run another encode
+					if (result.asset != nullptr && IsBlockCompressed(result.asset->GetFormat()) == false) {
+						auto compressedTexture = TextureCompressor::Compress(result.asset, compressionProperties);
+
+						if (compressedTexture != nullptr) {
+							result.asset = compressedTexture;
+
+							if (sourceHash != 0)
+								TextureCache::Save(cachePath, sourceHash, propertiesHash, compressedTexture);
+						}
+					}
+				}
+
+				// stored files don't know what their content is used for
+				if (result.asset != nullptr)
+					result.asset->SetSRGB(sRGB);
+
+				std::lock_guard<std::mutex> lock(m_mutex);
+
+				if (m_assetManager != nullptr && result.asset != nullptr) {
+					auto asset = result.asset;
+					m_uploads.push_back([this, asset]() { m_assetManager->UploadTextureToGPU(asset); });
+				}
+
+				m_textureLoads.erase(key);
+				promise->set_value(std::move(result));
+			});
+		}
+
+		if (onLoaded != nullptr)
+			m_callbacks.push_back({ [handle]() { return IsReady(handle); }, [handle, onLoaded]() { onLoaded(handle.get()); } });
+	}
+
+	if (isNewLoad)
+		m_jobAvailable.notify_one();
+
+	return handle;
+}
+
+void QuantumEngine::AsyncAssetLoader::SetTextureMipGeneration(bool generateMips, const MipGenerationProperties& properties)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_generateTextureMips = generateMips;
+	m_mipProperties = properties;
+}
+
+void QuantumEngine::AsyncAssetLoader::SetTextureCompression(bool compressTextures, const TextureCompressionProperties& properties)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_compressTextures = compressTextures;
+	m_compressionProperties = properties;
+}
+
+UInt32 QuantumEngine::AsyncAssetLoader::ProcessCompletions()
+{
+	std::vector<std::function<void()>> uploads;
+	std::vector<std::function<void()>> callbacks;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		// collect the ready callbacks first: a ready future guarantees its upload is already queued
+		for (UInt32 i = 0; i < m_callbacks.size();) {
+			if (m_callbacks[i].first()) {
+				callbacks.push_back(std::move(m_callbacks[i].second));
+				m_callbacks.erase(m_callbacks.begin() + i);
+			}
+			else {
+				i++;
+			}
+		}
+
+		uploads.swap(m_uploads);
+	}
+
+	for (auto& upload : uploads)
+		upload();
+
+	for (auto& callback : callbacks)
+		callback();
+
+	return (UInt32)(uploads.size() + callbacks.size());
+}
+
+void QuantumEngine::AsyncAssetLoader::WaitAll()
+{
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_idle.wait(lock, [this]() { return m_pendingCount == 0; });
+	}
+
+	ProcessCompletions();
+}
+
+void QuantumEngine::AsyncAssetLoader::WorkerLoop()
+{
+	// WIC decoding needs COM on the calling thread
+	HRESULT comResult = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+
+	while (true) {
+		std::function<void()> job;
+
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_jobAvailable.wait(lock, [this]() { return m_stopping || m_jobs.empty() == false; });
+
+			if (m_jobs.empty())
+				break;
+
+			job = std::move(m_jobs.front());
+			m_jobs.pop_front();
+		}
+
+		job();
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_pendingCount--;
+		}
+
+		m_idle.notify_all();
+	}
+
+	if (SUCCEEDED(comResult))
+		CoUninitialize();
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../BasicTypes.h"
+#include "AssimpModel3DImporter.h"
+#include "TextureCompressor.h"
+#include "TextureMipGenerator.h"
+
+namespace QuantumEngine::Rendering {
+	class GPUAssetManager;
+}
+
+namespace QuantumEngine {
+	class Model3DAsset;
+	class Texture2D;
+
+	template<typename T>
+	struct AssetLoadResult {
+		ref<T> asset;
+		std::string error;
+	};
+
+	struct ModelLoadResult : AssetLoadResult<Model3DAsset> {
+		// time spent in each import phase of this load
+		ModelImportTimings timings;
+	};
+
+	using TextureLoadResult = AssetLoadResult<Texture2D>;
+	using ModelLoadHandle = std::shared_future<ModelLoadResult>;
+	using TextureLoadHandle = std::shared_future<TextureLoadResult>;
+
+	/// <summary>
+	/// Loads models and textures on a bounded pool of I/O threads.
+	/// Concurrent requests for the same asset share one load. Completion callbacks and GPU uploads
+	/// never run on the pool, they run on the thread calling ProcessCompletions or WaitAll
+	/// </summary>
+	class AsyncAssetLoader {
+	public:
+		using ModelCallback = std::function<void(const ModelLoadResult&)>;
+		using TextureCallback = std::function<void(const TextureLoadResult&)>;
+
+		/// <summary>
+		/// assetManager may be null. If set, every successfully loaded texture and model mesh is uploaded with it on completion.
+		/// threadCount 0 picks the core count, capped to 4 since the work is mostly disk bound
+		/// </summary>
+		AsyncAssetLoader(const ref<Rendering::GPUAssetManager>& assetManager = nullptr, UInt32 threadCount = 0);
+		~AsyncAssetLoader();
+		AsyncAssetLoader(const AsyncAssetLoader&) = delete;
+		AsyncAssetLoader& operator=(const AsyncAssetLoader&) = delete;
+
+		ModelLoadHandle LoadModelAsync(const std::string& filePath, const ModelImportProperties& properties, const ModelCallback& onLoaded = nullptr);
+		/// <summary>
+		/// sRGB marks color textures. Data textures (normal, metallic, roughness, masks) pass false so their mips are filtered as stored
+		/// </summary>
+		TextureLoadHandle LoadTextureAsync(const std::wstring& filePath, const TextureCallback& onLoaded = nullptr, bool sRGB = true);
+
+		/// <summary>
+		/// textures requested from now on get a mip chain generated on the loading thread. Disabled by default, textures then
+		/// keep the levels stored in their file
+		/// </summary>
+		void SetTextureMipGeneration(bool generateMips, const MipGenerationProperties& properties = {});
+
+		/// <summary>
+		/// textures requested from now on are block compressed after mip generation. The result is cached next to the source file
+		/// and reused while the file and settings are unchanged. Disabled by default
+		/// </summary>
+		void SetTextureCompression(bool compressTextures, const TextureCompressionProperties& properties = {});
+
+		/// <summary>
+		/// runs callbacks and uploads of the loads finished so far, returns how many were handled
+		/// </summary>
+		UInt32 ProcessCompletions();
+
+		/// <summary>
+		/// blocks until every requested load has finished, then processes the completions
+		/// </summary>
+		void WaitAll();
+	private:
+		void Enqueue(std::function<void()>&& job);
+		void WorkerLoop();
+
+		ref<Rendering::GPUAssetManager> m_assetManager;
+		std::vector<std::thread> m_threads;
+
+		std::mutex m_mutex;
+		std::condition_variable m_jobAvailable;
+		std::condition_variable m_idle;
+		std::deque<std::function<void()>> m_jobs;
+		UInt32 m_pendingCount = 0;
+		bool m_stopping = false;
+		bool m_generateTextureMips = false;
+		MipGenerationProperties m_mipProperties;
+		bool m_compressTextures = false;
+		TextureCompressionProperties m_compressionProperties;
+
+		// loads in flight, keyed by path and the import or processing properties
+		std::map<std::string, ModelLoadHandle> m_modelLoads;
+		std::map<std::wstring, TextureLoadHandle> m_textureLoads;
+
+		// uploads of finished loads, queued before the load's future becomes ready
+		std::vector<std::function<void()>> m_uploads;
+		// requester callbacks, each runs once its future is ready
+		std::vector<std::pair<std::function<bool()>, std::function<void()>>> m_callbacks;
+	};
+}
@@ -1,31 +1,294 @@
 #include "BezierCurve.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#include <xmmintrin.h>
+#define QE_CURVE_SSE
+#endif
 
 QuantumEngine::Core::BezierCurve::BezierCurve(const Vector3& point1, const Vector3& point2, const Vector3& point3)
-	: m_point1(point1), m_point2(point2), m_point3(point3)
+	: BezierCurve(std::vector<Vector3>{ point1, point2, point3 }, CurveType::QuadraticBezier)
 {
 }
 
+QuantumEngine::Core::BezierCurve::BezierCurve(const std::vector<Vector3>& controlPoints, CurveType type)
+	: m_type(type), m_controlPoints(controlPoints)
+{
+	Rebuild();
+}
+
 void QuantumEngine::Core::BezierCurve::Interpolate(Float t, Vector3* position, Vector3* tangent) const
 {
-	*position = powf(1 - t, 2) * m_point1 + 2 * t * (1 - t) * m_point2 + powf(t, 2) * m_point3;
-	*tangent = -2 * (1 - t) * m_point1 + (-4 * t + 2) * m_point2 + 2 * t * m_point3;
+	UInt32 first;
+	Float s;
+	LocateSegment(t, &first, &s);
+
+	auto& p0 = m_bezierPoints[first];
+	auto& p1 = m_bezierPoints[first + 1];
+	auto& p2 = m_bezierPoints[first + 2];
+	auto& p3 = m_bezierPoints[first + 3];
+	Float u = 1.0f - s;
+
+	*position = (u * u * u) * p0 + (3.0f * u * u * s) * p1 + (3.0f * u * s * s) * p2 + (s * s * s) * p3;
+	// derivative by the curve t, every segment covers 1 / segment count of it
+	*tangent = (3.0f * GetSegmentCount()) * ((u * u) * (p1 - p0) + (2.0f * u * s) * (p2 - p1) + (s * s) * (p3 - p2));
+
+	// the derivative vanishes where control points repeat, such as the clamped ends of a B-spline. Same fallback as InterpolateCurve in CurveFunctions.hlsli
+	if (tangent->SquareMagnitude() <= 0.0f)
+		*tangent = (Float)GetSegmentCount() * (p3 - p0);
+}
+
+void QuantumEngine::Core::BezierCurve::InterpolateBatch(const Float* t, UInt32 count, Vector3* positions, Vector3* tangents) const
+{
+	UInt32 i = 0;
+
+#ifdef QE_CURVE_SSE
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 three = _mm_set1_ps(3.0f);
+	const __m128 tangentScale = _mm_set1_ps(3.0f * GetSegmentCount());
+
+	for (; i + 4 <= count; i += 4) {
+		// control points of the four segments in structure of arrays order
+		alignas(16) Float x[4][4], y[4][4], z[4][4], segmentT[4];
+
+		for (UInt32 lane = 0; lane < 4; lane++) {
+			UInt32 first;
+			LocateSegment(t[i + lane], &first, &segmentT[lane]);
+
+			for (UInt32 p = 0; p < 4; p++) {
+				auto& point = m_bezierPoints[first + p];
+				x[p][lane] = point.x;
+				y[p][lane] = point.y;
+				z[p][lane] = point.z;
+			}
+		}
+
+		__m128 s = _mm_load_ps(segmentT);
+		__m128 u = _mm_sub_ps(one, s);
+		__m128 uu = _mm_mul_ps(u, u);
+		__m128 ss = _mm_mul_ps(s, s);
+		__m128 us = _mm_mul_ps(u, s);
+
+		__m128 b0 = _mm_mul_ps(uu, u);
+		__m128 b1 = _mm_mul_ps(three, _mm_mul_ps(uu, s));
+		__m128 b2 = _mm_mul_ps(three, _mm_mul_ps(us, s));
+		__m128 b3 = _mm_mul_ps(ss, s);
+		__m128 d0 = _mm_mul_ps(uu, tangentScale);
+		__m128 d1 = _mm_mul_ps(_mm_add_ps(us, us), tangentScale);
+		__m128 d2 = _mm_mul_ps(ss, tangentScale);
+
+		alignas(16) Float position[3][4], tangent[3][4];
+		Float (*components[3])[4] = { x, y, z };
+
+		for (UInt32 c = 0; c < 3; c++) {
+			__m128 p0 = _mm_load_ps(components[c][0]);
+			__m128 p1 = _mm_load_ps(components[c][1]);
+			__m128 p2 = _mm_load_ps(components[c][2]);
+			__m128 p3 = _mm_load_ps(components[c][3]);
+
+			_mm_store_ps(position[c], _mm_add_ps(_mm_add_ps(_mm_mul_ps(b0, p0), _mm_mul_ps(b1, p1)),
+				_mm_add_ps(_mm_mul_ps(b2, p2), _mm_mul_ps(b3, p3))));
+			_mm_store_ps(tangent[c], _mm_add_ps(_mm_add_ps(_mm_mul_ps(d0, _mm_sub_ps(p1, p0)), _mm_mul_ps(d1, _mm_sub_ps(p2, p1))),
+				_mm_mul_ps(d2, _mm_sub_ps(p3, p2))));
+		}
+
+		for (UInt32 lane = 0; lane < 4; lane++) {
+			positions[i + lane] = Vector3(position[0][lane], position[1][lane], position[2][lane]);
+			tangents[i + lane] = Vector3(tangent[0][lane], tangent[1][lane], tangent[2][lane]);
+
+			if (tangents[i + lane].SquareMagnitude() <= 0.0f)
+				tangents[i + lane] = (Float)GetSegmentCount() * Vector3(x[3][lane] - x[0][lane], y[3][lane] - y[0][lane], z[3][lane] - z[0][lane]);
+		}
+	}
+#endif
+
+	for (; i < count; i++)
+		Interpolate(t[i], &positions[i], &tangents[i]);
+}
+
+void QuantumEngine::Core::BezierCurve::InterpolateUniform(Float u, Vector3* position, Vector3* tangent) const
+{
+	Interpolate(ParameterAtLength(u * GetLength()), position, tangent);
 }
 
 Float QuantumEngine::Core::BezierCurve::InterpolateLength(Float t) const
 {
-	return Integral(t) - Integral(0);
+	UInt32 sampleCount = (UInt32)m_arcLengths.size() - 1;
+	Float scaled = std::clamp(t, 0.0f, 1.0f) * sampleCount;
+	UInt32 sample = std::min((UInt32)scaled, sampleCount - 1);
+	Float fraction = scaled - sample;
+
+	return m_arcLengths[sample] + fraction * (m_arcLengths[sample + 1] - m_arcLengths[sample]);
 }
 
-Float QuantumEngine::Core::BezierCurve::Integral(Float t) const
+Float QuantumEngine::Core::BezierCurve::ParameterAtLength(Float length) const
 {
-	auto qt = 2.0f * m_point1 - 4.0f * m_point2 + 2.0f * m_point3;
-	auto q = -2.0f * m_point1 + 2.0f * m_point2;
-	Float A = Vector3::Dot(qt, qt);
-	Float B = 2.0f * Vector3::Dot(qt, q);
-	Float C = Vector3::Dot(q, q);
-	Float h = B / (2 * A);
-	Float k = C - ((B * B) / (4 * A));
-	Float exp = sqrtf((A * t * t) + (B * t) + C);
-	return (0.5f * (t + h) * exp) +
-		((0.5f * k) / sqrtf(A)) * log((t + h) + exp / sqrtf(A));
+	UInt32 sampleCount = (UInt32)m_arcLengths.size() - 1;
+
+	if (length <= 0.0f)
+		return 0.0f;
+
+	// last sample at or before the length
+	auto it = std::upper_bound(m_arcLengths.begin(), m_arcLengths.end(), length);
+	UInt32 sample = std::min((UInt32)std::max<Int64>(it - m_arcLengths.begin() - 1, 0), sampleCount - 1);
+
+	Float start = m_arcLengths[sample];
+	Float span = m_arcLengths[sample + 1] - start;
+	Float fraction = span > 0.0f ? std::clamp((length - start) / span, 0.0f, 1.0f) : 0.0f;
+
+	return (sample + fraction) / sampleCount;
+}
+
+UInt32 QuantumEngine::Core::BezierCurve::SegmentsForError(Float maxError) const
+{
+	// a chord of length c on an arc of curvature k is at most k * c^2 / 8 away from it
+	if (maxError <= 0.0f || m_maxCurvature <= 0.0f)
+		return 1;
+
+	Float segments = std::ceil(GetLength() * std::sqrt(m_maxCurvature / (8.0f * maxError)));
+	return (UInt32)std::clamp(segments, 1.0f, 65536.0f);
+}
+
+void QuantumEngine::Core::BezierCurve::SetControlPoint(UInt32 index, const Vector3& point)
+{
+	m_controlPoints[index] = point;
+	Rebuild();
+}
+
+void QuantumEngine::Core::BezierCurve::Rebuild()
+{
+	BuildSegments();
+	BuildArcLengths();
+	BuildCurvatureAndBounds();
+}
+
+void QuantumEngine::Core::BezierCurve::BuildSegments()
+{
+	m_bezierPoints.clear();
+	auto& points = m_controlPoints;
+	UInt32 count = (UInt32)points.size();
+
+	switch (m_type) {
+	case CurveType::QuadraticBezier:
+		// degree elevation keeps the quadratic curve exactly
+		for (UInt32 i = 0; i + 2 < count; i += 2)
+			AddSegment(points[i], points[i] + (2.0f / 3.0f) * (points[i + 1] - points[i]),
+				points[i + 2] + (2.0f / 3.0f) * (points[i + 1] - points[i + 2]), points[i + 2]);
+		break;
+	case CurveType::CubicBezier:
+		for (UInt32 i = 0; i + 3 < count; i += 3)
+			AddSegment(points[i], points[i + 1], points[i + 2], points[i + 3]);
+		break;
+	case CurveType::CatmullRom:
+		// the end points are mirrored so the curve reaches the first and last control points
+		for (UInt32 i = 0; i + 1 < count; i++) {
+			Vector3 previous = i > 0 ? points[i - 1] : 2.0f * points[0] - points[1];
+			Vector3 next = i + 2 < count ? points[i + 2] : 2.0f * points[count - 1] - points[count - 2];
+			AddSegment(points[i], points[i] + (1.0f / 6.0f) * (points[i + 1] - previous),
+				points[i + 1] - (1.0f / 6.0f) * (next - points[i]), points[i + 1]);
+		}
+		break;
+	case CurveType::BSpline:
+		// the end points are repeated three times so the curve is clamped to them
+		if (count >= 2) {
+			std::vector<Vector3> clamped;
+			clamped.reserve(count + 4);
+			clamped.insert(clamped.end(), 2, points[0]);
+			clamped.insert(clamped.end(), points.begin(), points.end());
+			clamped.insert(clamped.end(), 2, points[count - 1]);
+
+			for (UInt32 i = 0; i + 3 < clamped.size(); i++) {
+				auto& p0 = clamped[i];
+				auto& p1 = clamped[i + 1];
+				auto& p2 = clamped[i + 2];
+				auto& p3 = clamped[i + 3];
+				AddSegment((1.0f / 6.0f) * (p0 + 4.0f * p1 + p2), (1.0f / 3.0f) * (2.0f * p1 + p2),
+					(1.0f / 3.0f) * (p1 + 2.0f * p2), (1.0f / 6.0f) * (p1 + 4.0f * p2 + p3));
+			}
+		}
+		break;
+	}
+
+	// not enough control points, a single point keeps the curve valid
+	if (m_bezierPoints.empty()) {
+		Vector3 point = count > 0 ? points[0] : Vector3(0.0f);
+		AddSegment(point, point, point, point);
+	}
+}
+
+void QuantumEngine::Core::BezierCurve::BuildArcLengths()
+{
+	UInt32 sampleCount = GetSegmentCount() * ArcLengthSamplesPerSegment;
+	m_arcLengths.resize(sampleCount + 1);
+	m_arcLengths[0] = 0.0f;
+
+	// chord lengths, unlike the closed form integral they stay valid for straight and degenerate segments
+	Vector3 previous, position, tangent;
+	Interpolate(0.0f, &previous, &tangent);
+
+	for (UInt32 i = 1; i <= sampleCount; i++) {
+		Interpolate((Float)i / sampleCount, &position, &tangent);
+		m_arcLengths[i] = m_arcLengths[i - 1] + (position - previous).Magnitude();
+		previous = position;
+	}
+}
+
+void QuantumEngine::Core::BezierCurve::BuildCurvatureAndBounds()
+{
+	m_maxCurvature = 0.0f;
+
+	// curvature |B' x B''| / |B'|^3 at the arc length samples of every segment
+	for (UInt32 first = 0; first + 3 < m_bezierPoints.size(); first += 3) {
+		Vector3 d0 = m_bezierPoints[first + 1] - m_bezierPoints[first];
+		Vector3 d1 = m_bezierPoints[first + 2] - m_bezierPoints[first + 1];
+		Vector3 d2 = m_bezierPoints[first + 3] - m_bezierPoints[first + 2];
+
+		for (UInt32 i = 0; i <= ArcLengthSamplesPerSegment; i++) {
+			Float s = (Float)i / ArcLengthSamplesPerSegment;
+			Float u = 1.0f - s;
+			Vector3 velocity = 3.0f * ((u * u) * d0 + (2.0f * u * s) * d1 + (s * s) * d2);
+			Vector3 acceleration = 6.0f * (u * (d1 - d0) + s * (d2 - d1));
+			Float speed = velocity.Magnitude();
+
+			// cusps of degenerate segments have no curvature, their neighbours still count
+			if (speed < 1e-6f)
+				continue;
+
+			Vector3 cross(velocity.y * acceleration.z - velocity.z * acceleration.y, velocity.z * acceleration.x - velocity.x * acceleration.z,
+				velocity.x * acceleration.y - velocity.y * acceleration.x);
+			m_maxCurvature = std::max(m_maxCurvature, cross.Magnitude() / (speed * speed * speed));
+		}
+	}
+
+	Vector3 boundsMin = m_bezierPoints[0];
+	Vector3 boundsMax = m_bezierPoints[0];
+
+	for (auto& point : m_bezierPoints) {
+		boundsMin = Vector3(std::min(boundsMin.x, point.x), std::min(boundsMin.y, point.y), std::min(boundsMin.z, point.z));
+		boundsMax = Vector3(std::max(boundsMax.x, point.x), std::max(boundsMax.y, point.y), std::max(boundsMax.z, point.z));
+	}
+
+	m_boundsCenter = 0.5f * (boundsMin + boundsMax);
+	m_boundsRadius = 0.5f * (boundsMax - boundsMin).Magnitude();
+}
+
+void QuantumEngine::Core::BezierCurve::AddSegment(const Vector3& point0, const Vector3& point1, const Vector3& point2, const Vector3& point3)
+{
+	if (m_bezierPoints.empty())
+		m_bezierPoints.push_back(point0);
+
+	m_bezierPoints.push_back(point1);
+	m_bezierPoints.push_back(point2);
+	m_bezierPoints.push_back(point3);
+}
+
+void QuantumEngine::Core::BezierCurve::LocateSegment(Float t, UInt32* firstPoint, Float* segmentT) const
+{
+	UInt32 segmentCount = GetSegmentCount();
+	Float scaled = std::clamp(t, 0.0f, 1.0f) * segmentCount;
+	UInt32 segment = std::min((UInt32)scaled, segmentCount - 1);
+
+	*firstPoint = 3 * segment;
+	*segmentT = scaled - segment;
 }
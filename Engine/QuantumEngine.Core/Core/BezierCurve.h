@@ -1,20 +1,49 @@
-#pragma 
+#pragma once
+#include <vector>
 #include "Vector2.h"
 #include "Vector3.h"
 
 namespace QuantumEngine::Core {
-class BezierCurve{
+    enum class CurveType {
+        // segments of 3 points sharing their end points
+        QuadraticBezier,
+        // segments of 4 points sharing their end points
+        CubicBezier,
+        // passes through every control point
+        CatmullRom,
+        // uniform cubic B-spline, starts and ends on the first and last control points
+        BSpline,
+    };
+
+    /// <summary>
+    /// Chain of cubic bezier segments built from the control points of any curve type, with an arc length table for constant speed sampling.
+    /// Spline compute shaders read the same bezier points and arc length table
+    /// </summary>
+    class BezierCurve{
     public:
+        static constexpr UInt32 ArcLengthSamplesPerSegment = 16;
+
         BezierCurve(const Vector3& point1, const Vector3& point2, const Vector3& point3);
-        
+        BezierCurve(const std::vector<Vector3>& controlPoints, CurveType type);
+
         /// <summary>
-		/// fills the position and tangent at t value on the curve
+		/// fills the position and tangent at t value on the curve, t goes from 0 to 1 over all segments
         /// </summary>
         /// <param name="t"></param>
         /// <param name="position"></param>
         /// <param name="tangent"></param>
         void Interpolate(Float t, Vector3* position, Vector3* tangent) const;
 
+        /// <summary>
+        /// fills the positions and tangents of count t values, four at a time
+        /// </summary>
+        void InterpolateBatch(const Float* t, UInt32 count, Vector3* positions, Vector3* tangents) const;
+
+        /// <summary>
+        /// fills the position and tangent at a fraction u of the curve length
+        /// </summary>
+        void InterpolateUniform(Float u, Vector3* position, Vector3* tangent) const;
+
         /// <summary>
 		/// returns the length of the curve from 0 to t value
         /// </summary>
@@ -22,12 +51,61 @@ class BezierCurve{
         /// <returns></returns>
         Float InterpolateLength(Float t) const;
 
+        /// <summary>
+        /// returns the t value where the curve reaches the given length
+        /// </summary>
+        Float ParameterAtLength(Float length) const;
+
+        /// <summary>
+        /// number of line segments of equal length that keep every chord within maxError of the curve
+        /// </summary>
+        UInt32 SegmentsForError(Float maxError) const;
+
+        inline Float GetLength() const { return m_arcLengths.back(); }
+        inline Float GetMaxCurvature() const { return m_maxCurvature; }
+
+        /// <summary>
+        /// sphere around the bezier points, it contains the whole curve
+        /// </summary>
+        inline const Vector3& GetBoundsCenter() const { return m_boundsCenter; }
+        inline Float GetBoundsRadius() const { return m_boundsRadius; }
+        inline CurveType GetType() const { return m_type; }
+
+        inline UInt32 GetControlPointCount() const { return (UInt32)m_controlPoints.size(); }
+        inline const Vector3& GetControlPoint(UInt32 index) const { return m_controlPoints[index]; }
+
+        /// <summary>
+        /// moves a control point and rebuilds the segments and the arc length table
+        /// </summary>
+        void SetControlPoint(UInt32 index, const Vector3& point);
+
+        inline UInt32 GetSegmentCount() const { return ((UInt32)m_bezierPoints.size() - 1) / 3; }
+
+        /// <summary>
+        /// 3 * segment count + 1 points, segment i uses points 3i to 3i + 3
+        /// </summary>
+        inline const std::vector<Vector3>& GetBezierPoints() const { return m_bezierPoints; }
+
+        /// <summary>
+        /// segment count * ArcLengthSamplesPerSegment + 1 lengths from the start to evenly spaced t values
+        /// </summary>
+        inline const std::vector<Float>& GetArcLengths() const { return m_arcLengths; }
+
     private:
-        Float Integral(Float t) const;
+        void Rebuild();
+        void BuildSegments();
+        void BuildArcLengths();
+        void BuildCurvatureAndBounds();
+        void AddSegment(const Vector3& point0, const Vector3& point1, const Vector3& point2, const Vector3& point3);
+        void LocateSegment(Float t, UInt32* firstPoint, Float* segmentT) const;
 
-    public:
-        Vector3 m_point1;
-        Vector3 m_point2;
-        Vector3 m_point3;
+    private:
+        CurveType m_type;
+        std::vector<Vector3> m_controlPoints;
+        std::vector<Vector3> m_bezierPoints;
+        std::vector<Float> m_arcLengths;
+        Float m_maxCurvature;
+        Vector3 m_boundsCenter;
+        Float m_boundsRadius;
     };
-}
\ No newline at end of file
+}
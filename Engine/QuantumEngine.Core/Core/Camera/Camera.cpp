@@ -1,5 +1,7 @@
 #include "Camera.h"
 #include "../Transform.h"
+#include "../Vector3.h"
+#include <algorithm>
 
 QuantumEngine::Camera::Camera(const ref<Transform>& transform)
 	:m_transform(transform)
@@ -10,3 +12,10 @@ QuantumEngine::Matrix4 QuantumEngine::Camera::ViewMatrix()
 {
 	return Matrix4::Rotate(m_transform->RotationAxis(), -m_transform->GetAngle()) * Matrix4::Translate(-m_transform->Position());
 }
+
+Float QuantumEngine::Camera::PixelsPerUnit(const Vector3& worldPosition, Float radius, Float viewportHeight) const
+{
+	// keep a small minimum distance so objects around the camera resolve to the finest level instead of dividing by zero
+	Float distance = std::max((worldPosition - m_transform->Position()).Magnitude() - radius, 0.01f);
+	return 0.5f * viewportHeight * m_projectionMatrix(1, 1) / distance;
+}
\ No newline at end of file
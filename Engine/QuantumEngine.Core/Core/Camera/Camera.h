@@ -12,6 +12,11 @@ namespace QuantumEngine {
 		inline Matrix4 InverseProjectionMatrix() const { return m_inverseProjectionMatrix; }
 		inline ref<Transform> GetTransform() { return m_transform; }
 		Matrix4 ViewMatrix();
+
+		/// <summary>
+		/// Size in pixels of one world unit projected from the closest point of a sphere around worldPosition
+		/// </summary>
+		Float PixelsPerUnit(const Vector3& worldPosition, Float radius, Float viewportHeight) const;
 	private:
 		ref<Transform> m_transform;
 	protected:
@@ -0,0 +1,120 @@
+#include "FrustumCuller.h"
+#include "../Mesh.h"
+#include "../Transform.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#include <xmmintrin.h>
+#define QE_CULL_SSE
+#endif
+
+UInt32 QuantumEngine::FrustumCuller::AddInstance(const ref<Mesh>& mesh, const ref<Transform>& transform)
+{
+	m_meshes.push_back(mesh);
+	m_transforms.push_back(transform);
+
+	UInt32 paddedCount = (GetInstanceCount() + 3) & ~3u;
+	m_centerX.resize(paddedCount, 0.0f);
+	m_centerY.resize(paddedCount, 0.0f);
+	m_centerZ.resize(paddedCount, 0.0f);
+	m_radius.resize(paddedCount, 0.0f);
+	m_visibility.resize(paddedCount, 1);
+
+	return GetInstanceCount() - 1;
+}
+
+void QuantumEngine::FrustumCuller::Cull(const Matrix4& viewProjection)
+{
+	ExtractPlanes(viewProjection, m_planes);
+	UpdateSpheres();
+
+	const UInt32 count = GetInstanceCount();
+	const UInt32 paddedCount = (UInt32)m_radius.size();
+	m_stats = CullingStats{};
+
+#ifdef QE_CULL_SSE
+	for (UInt32 i = 0; i < paddedCount; i += 4) {
+		__m128 x = _mm_loadu_ps(&m_centerX[i]);
+		__m128 y = _mm_loadu_ps(&m_centerY[i]);
+		__m128 z = _mm_loadu_ps(&m_centerZ[i]);
+		__m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&m_radius[i]));
+		__m128 outside = _mm_setzero_ps();
+
+		for (UInt32 p = 0; p < 6; p++) {
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(m_planes[p][0])), _mm_mul_ps(y, _mm_set1_ps(m_planes[p][1]))),
+				_mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(m_planes[p][2])), _mm_set1_ps(m_planes[p][3])));
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, negativeRadius));
+		}
+
+		Int32 outsideMask = _mm_movemask_ps(outside);
+
+		for (UInt32 lane = 0; lane < 4; lane++)
+			m_visibility[i + lane] = (outsideMask & (1 << lane)) == 0;
+	}
+#else
+	for (UInt32 i = 0; i < paddedCount; i++) {
+		bool outside = false;
+
+		for (UInt32 p = 0; p < 6; p++)
+			outside |= m_planes[p][0] * m_centerX[i] + m_planes[p][1] * m_centerY[i] + m_planes[p][2] * m_centerZ[i] + m_planes[p][3] < -m_radius[i];
+
+		m_visibility[i] = outside == false;
+	}
+#endif
+
+	for (UInt32 i = 0; i < count; i++)
+		m_stats.drawnCount += m_visibility[i];
+
+	m_stats.culledCount = count - m_stats.drawnCount;
+}
+
+void QuantumEngine::FrustumCuller::ExtractPlanes(const Matrix4& m, Float (&planes)[6][4])
+{
+	// Gribb-Hartmann on the rows of a column vector matrix, clip depth is in [0, w]
+	for (UInt32 c = 0; c < 4; c++) {
+		planes[0][c] = m(3, c) + m(0, c);
+		planes[1][c] = m(3, c) - m(0, c);
+		planes[2][c] = m(3, c) + m(1, c);
+		planes[3][c] = m(3, c) - m(1, c);
+		planes[4][c] = m(2, c);
+		planes[5][c] = m(3, c) - m(2, c);
+	}
+
+	for (auto& plane : planes) {
+		Float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+
+		if (length <= 0.0f)
+			continue;
+
+		for (UInt32 c = 0; c < 4; c++)
+			plane[c] /= length;
+	}
+}
+
+void QuantumEngine::FrustumCuller::UpdateSpheres()
+{
+	for (UInt32 i = 0; i < GetInstanceCount(); i++) {
+		if (m_meshes[i] == nullptr) {
+			m_centerX[i] = m_centerY[i] = m_centerZ[i] = 0.0f;
+			m_radius[i] = std::numeric_limits<Float>::max();
+			continue;
+		}
+
+		Matrix4 world = m_transforms[i]->Matrix();
+		Vector3 center = 0.5f * (m_meshes[i]->GetBoundsMin() + m_meshes[i]->GetBoundsMax());
+
+		m_centerX[i] = world(0, 0) * center.x + world(0, 1) * center.y + world(0, 2) * center.z + world(0, 3);
+		m_centerY[i] = world(1, 0) * center.x + world(1, 1) * center.y + world(1, 2) * center.z + world(1, 3);
+		m_centerZ[i] = world(2, 0) * center.x + world(2, 1) * center.y + world(2, 2) * center.z + world(2, 3);
+
+		// the longest basis vector bounds the scale in every direction
+		Float maxScaleSquared = 0.0f;
+
+		for (UInt32 c = 0; c < 3; c++)
+			maxScaleSquared = std::max(maxScaleSquared, world(0, c) * world(0, c) + world(1, c) * world(1, c) + world(2, c) * world(2, c));
+
+		m_radius[i] = m_meshes[i]->GetBoundingRadius() * std::sqrt(maxScaleSquared);
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <vector>
+#include "../../BasicTypes.h"
+#include "../Matrix4.h"
+
+namespace QuantumEngine {
+	class Mesh;
+	class Transform;
+
+	struct CullingStats {
+		UInt32 drawnCount = 0;
+		UInt32 culledCount = 0;
+	};
+
+	/// <summary>
+	/// Tests the bounding spheres of mesh instances against the planes of a view projection frustum.
+	/// Spheres are kept in structure of arrays order and tested four at a time
+	/// </summary>
+	class FrustumCuller {
+	public:
+		/// <summary>
+		/// registers an instance, instances without a mesh are never culled
+		/// </summary>
+		/// <returns>index of the instance for IsVisible</returns>
+		UInt32 AddInstance(const ref<Mesh>& mesh, const ref<Transform>& transform);
+
+		/// <summary>
+		/// moves the spheres with their transforms and tests them against the frustum, viewProjection maps world space to clip space
+		/// </summary>
+		void Cull(const Matrix4& viewProjection);
+
+		inline bool IsVisible(UInt32 index) const { return m_visibility[index] != 0; }
+		inline UInt32 GetInstanceCount() const { return static_cast<UInt32>(m_meshes.size()); }
+
+		/// <summary>
+		/// instances drawn and culled by the last Cull
+		/// </summary>
+		inline const CullingStats& GetStats() const { return m_stats; }
+
+		/// <summary>
+		/// normalized (a, b, c, d) planes facing into the frustum of a view projection matrix
+		/// </summary>
+		static void ExtractPlanes(const Matrix4& viewProjection, Float (&planes)[6][4]);
+	private:
+		void UpdateSpheres();
+
+		std::vector<ref<Mesh>> m_meshes;
+		std::vector<ref<Transform>> m_transforms;
+
+		// world space spheres, padded to a multiple of 4
+		std::vector<Float> m_centerX;
+		std::vector<Float> m_centerY;
+		std::vector<Float> m_centerZ;
+		std::vector<Float> m_radius;
+		std::vector<UInt8> m_visibility;
+
+		Float m_planes[6][4];
+		CullingStats m_stats;
+	};
+}
@@ -0,0 +1,365 @@
+#include "DDSTextureFile.h"
+#include <cstring>
+#include <fstream>
+#include "Texture2DImporter.h"
+#include "TextureCompressor.h"
+#include "TextureMipGenerator.h"
+#include "../Platform/MappedFile.h"
+
+namespace {
+	using namespace QuantumEngine;
+
+	constexpr UInt32 DDSMagic = 0x20534444; // "DDS "
+	constexpr UInt32 MaxMipLevelCount = 32;
+
+	constexpr UInt32 FlagCaps = 0x1;
+	constexpr UInt32 FlagHeight = 0x2;
+	constexpr UInt32 FlagWidth = 0x4;
+	constexpr UInt32 FlagPitch = 0x8;
+	constexpr UInt32 FlagPixelFormat = 0x1000;
+	constexpr UInt32 FlagMipMapCount = 0x20000;
+	constexpr UInt32 FlagLinearSize = 0x80000;
+	constexpr UInt32 FlagDepth = 0x800000;
+
+	constexpr UInt32 PixelFormatFourCC = 0x4;
+	constexpr UInt32 PixelFormatRGB = 0x40;
+
+	constexpr UInt32 CapsComplex = 0x8;
+	constexpr UInt32 CapsTexture = 0x1000;
+	constexpr UInt32 CapsMipMap = 0x400000;
+	constexpr UInt32 Caps2Cubemap = 0x200;
+	constexpr UInt32 Caps2Volume = 0x200000;
+
+	constexpr UInt32 ResourceDimensionTexture2D = 3;
+	constexpr UInt32 MiscTextureCube = 0x4;
+
+	constexpr UInt32 MakeFourCC(char a, char b, char c, char d)
+	{
+		return (UInt32)(Byte)a | ((UInt32)(Byte)b << 8) | ((UInt32)(Byte)c << 16) | ((UInt32)(Byte)d << 24);
+	}
+
+	// D3DFMT_A16B16G16R16F
+	constexpr UInt32 FourCCRGBA16Float = 113;
+
+	struct DDSPixelFormat {
+		UInt32 size;
+		UInt32 flags;
+		UInt32 fourCC;
+		UInt32 rgbBitCount;
+		UInt32 rBitMask;
+		UInt32 gBitMask;
+		UInt32 bBitMask;
+		UInt32 aBitMask;
+	};
+
+	struct DDSHeader {
+		UInt32 size;
+		UInt32 flags;
+		UInt32 height;
+		UInt32 width;
+		UInt32 pitchOrLinearSize;
+		UInt32 depth;
+		UInt32 mipMapCount;
+		UInt32 reserved1[11];
+		DDSPixelFormat pixelFormat;
+		UInt32 caps;
+		UInt32 caps2;
+		UInt32 caps3;
+		UInt32 caps4;
+		UInt32 reserved2;
+	};
+
+	struct DDSHeaderDX10 {
+		UInt32 dxgiFormat;
+		UInt32 resourceDimension;
+		UInt32 miscFlag;
+		UInt32 arraySize;
+		UInt32 miscFlags2;
+	};
+
+	static_assert(sizeof(DDSHeader) == 124, "DDS header layout is fixed");
+	static_assert(sizeof(DDSHeaderDX10) == 20, "DX10 header layout is fixed");
+
+	// DXGI_FORMAT values, the engine has no sRGB formats so the sRGB variants load as their UNORM counterpart
+	struct DXGIFormatEntry {
+		UInt32 dxgiFormat;
+		TextureFormat format;
+	};
+
+	constexpr DXGIFormatEntry DXGIFormats[] = {
+		{ 28, TextureFormat::RGBA32 },
+		{ 29, TextureFormat::RGBA32 },
+		{ 87, TextureFormat::BGRA32 },
+		{ 91, TextureFormat::BGRA32 },
+		{ 10, TextureFormat::RGBA64F },
+		{ 71, TextureFormat::BC1 },
+		{ 72, TextureFormat::BC1 },
+		{ 77, TextureFormat::BC3 },
+		{ 78, TextureFormat::BC3 },
+		{ 83, TextureFormat::BC5 },
+		{ 98, TextureFormat::BC7 },
+		{ 99, TextureFormat::BC7 },
+	};
+
+	TextureFormat FromDXGIFormat(UInt32 dxgiFormat)
+	{
+		for (auto& entry : DXGIFormats) {
+			if (entry.dxgiFormat == dxgiFormat)
+				return entry.format;
+		}
+
+		return TextureFormat::Unknown;
+	}
+
+	UInt32 ToDXGIFormat(TextureFormat format)
+	{
+		// the first entry of every format is the UNORM one
+		for (auto& entry : DXGIFormats) {
+			if (entry.format == format)
+				return entry.dxgiFormat;
+		}
+
+		return 0;
+	}
+
+	TextureFormat FromLegacyPixelFormat(const DDSPixelFormat& pixelFormat)
+	{
+		if (pixelFormat.flags & PixelFormatFourCC) {
+			switch (pixelFormat.fourCC) {
+			case MakeFourCC('D', 'X', 'T', '1'):
+				return TextureFormat::BC1;
+			case MakeFourCC('D', 'X', 'T', '4'):
+			case MakeFourCC('D', 'X', 'T', '5'):
+				return TextureFormat::BC3;
+			case MakeFourCC('A', 'T', 'I', '2'):
+			case MakeFourCC('B', 'C', '5', 'U'):
+				return TextureFormat::BC5;
+			case FourCCRGBA16Float:
+				return TextureFormat::RGBA64F;
+			default:
+				return TextureFormat::Unknown;
+			}
+		}
+
+		if ((pixelFormat.flags & PixelFormatRGB) && pixelFormat.rgbBitCount == 32) {
+			if (pixelFormat.rBitMask == 0x000000FF && pixelFormat.gBitMask == 0x0000FF00 && pixelFormat.bBitMask == 0x00FF0000)
+				return TextureFormat::RGBA32;
+
+			if (pixelFormat.rBitMask == 0x00FF0000 && pixelFormat.gBitMask == 0x0000FF00 && pixelFormat.bBitMask == 0x000000FF)
+				return TextureFormat::BGRA32;
+		}
+
+		return TextureFormat::Unknown;
+	}
+
+	UInt32 GetBitsPerPixel(TextureFormat format)
+	{
+		switch (format) {
+		case TextureFormat::RGBA64F:
+			return 64;
+		case TextureFormat::BC1:
+			return 4;
+		case TextureFormat::BC3:
+		case TextureFormat::BC5:
+		case TextureFormat::BC7:
+			return 8;
+		default:
+			return 32;
+		}
+	}
+
+	UInt32 GetChannelCount(TextureFormat format)
+	{
+		if (format == TextureFormat::BC1)
+			return 3;
+
+		return format == TextureFormat::BC5 ? 2 : 4;
+	}
+}
+
+bool QuantumEngine::DDSTextureFile::IsDDS(const Byte* data, UInt64 size)
+{
+	UInt32 magic = 0;
+
+	if (size < sizeof(UInt32) + sizeof(DDSHeader))
+		return false;
+
+	std::memcpy(&magic, data, sizeof(UInt32));
+	return magic == DDSMagic;
+}
+
+ref<QuantumEngine::Texture2D> QuantumEngine::DDSTextureFile::Load(const std::string& filePath, std::string& error)
+{
+	auto file = Platform::MappedFile::Open(filePath);
+
+	if (file == nullptr) {
+		error = "Failed to open " + filePath;
+		return nullptr;
+	}
+
+	const Byte* data = file->GetData();
+	UInt64 fileSize = file->GetSize();
+
+	if (IsDDS(data, fileSize) == false) {
+		error = filePath + " is not a DDS file";
+		return nullptr;
+	}
+
+	DDSHeader header;
+	std::memcpy(&header, data + sizeof(UInt32), sizeof(DDSHeader));
+	UInt64 dataOffset = sizeof(UInt32) + sizeof(DDSHeader);
+	TextureFormat format;
+
+	if ((header.pixelFormat.flags & PixelFormatFourCC) && header.pixelFormat.fourCC == MakeFourCC('D', 'X', '1', '0')) {
+		if (fileSize < dataOffset + sizeof(DDSHeaderDX10)) {
+			error = filePath + " is truncated";
+			return nullptr;
+		}
+
+		DDSHeaderDX10 headerDX10;
+		std::memcpy(&headerDX10, data + dataOffset, sizeof(DDSHeaderDX10));
+		dataOffset += sizeof(DDSHeaderDX10);
+
+		if (headerDX10.resourceDimension != ResourceDimensionTexture2D || headerDX10.arraySize > 1 || (headerDX10.miscFlag & MiscTextureCube)) {
+			error = filePath + " is not a single 2D texture";
+			return nullptr;
+		}
+
+		format = FromDXGIFormat(headerDX10.dxgiFormat);
+	}
+	else {
+		format = FromLegacyPixelFormat(header.pixelFormat);
+	}
+
+	if (format == TextureFormat::Unknown) {
+		error = filePath + " has an unsupported pixel format";
+		return nullptr;
+	}
+
+	if ((header.caps2 & (Caps2Cubemap | Caps2Volume)) || ((header.flags & FlagDepth) && header.depth > 1)) {
+		error = filePath + " is not a single 2D texture";
+		return nullptr;
+	}
+
+	if (header.width == 0 || header.height == 0) {
+		error = filePath + " has an invalid size";
+		return nullptr;
+	}
+
+	UInt32 mipLevelCount = (header.flags & FlagMipMapCount) ? std::max(header.mipMapCount, 1u) : 1;
+	mipLevelCount = std::min(mipLevelCount, std::min(TextureMipGenerator::GetFullMipLevelCount(header.width, header.height), MaxMipLevelCount));
+
+	// levels of a single 2D texture are stored back to back and tightly packed, the same layout Texture2D uses
+	UInt64 dataSize = 0;
+
+	for (UInt32 level = 0; level < mipLevelCount; level++) {
+		UInt64 width = std::max(header.width >> level, 1u);
+		UInt64 height = std::max(header.height >> level, 1u);
+
+		if (IsBlockCompressed(format))
+			dataSize += ((width + 3) / 4) * ((height + 3) / 4) * GetBlockByteSize(format);
+		else
+			dataSize += width * height * GetBitsPerPixel(format) / 8;
+	}
+
+	if (dataSize > fileSize - dataOffset || dataSize > 0xFFFFFFFFull) {
+		error = filePath + " is truncated";
+		return nullptr;
+	}
+
+	TextureProperties properties;
+	properties.data = (Byte*)data + dataOffset;
+	properties.copyPixelData = false;
+	properties.width = header.width;
+	properties.height = header.height;
+	properties.size = (UInt32)dataSize;
+	properties.bpp = GetBitsPerPixel(format);
+	properties.channelCount = GetChannelCount(format);
+	properties.format = format;
+	properties.mipLevelCount = mipLevelCount;
+	properties.generateGPUMips = false;
+	properties.dataOwner = file;
+
+	return std::make_shared<Texture2D>(properties);
+}
+
+bool QuantumEngine::DDSTextureFile::Save(const std::string& filePath, const ref<Texture2D>& texture, std::string& error)
+{
+	UInt32 dxgiFormat = ToDXGIFormat(texture->GetFormat());
+
+	if (dxgiFormat == 0) {
+		error = "Texture format can't be stored as DDS";
+		return false;
+	}
+
+	bool isBlockCompressed = IsBlockCompressed(texture->GetFormat());
+	UInt32 mipLevelCount = texture->GetMipLevelCount();
+
+	DDSHeader header{};
+	header.size = sizeof(DDSHeader);
+	header.flags = FlagCaps | FlagHeight | FlagWidth | FlagPixelFormat | FlagMipMapCount | (isBlockCompressed ? FlagLinearSize : FlagPitch);
+	header.height = texture->GetHeight();
+	header.width = texture->GetWidth();
+	header.pitchOrLinearSize = isBlockCompressed ? texture->GetMipSize(0) : texture->GetMipRowSize(0);
+	header.mipMapCount = mipLevelCount;
+	header.pixelFormat.size = sizeof(DDSPixelFormat);
+	header.pixelFormat.flags = PixelFormatFourCC;
+	header.pixelFormat.fourCC = MakeFourCC('D', 'X', '1', '0');
+	header.caps = CapsTexture | (mipLevelCount > 1 ? CapsComplex | CapsMipMap : 0);
+
+	DDSHeaderDX10 headerDX10{
+		.dxgiFormat = dxgiFormat,
+		.resourceDimension = ResourceDimensionTexture2D,
+		.miscFlag = 0,
+		.arraySize = 1,
+		// alpha mode straight, or opaque for formats without alpha
+		.miscFlags2 = GetChannelCount(texture->GetFormat()) == 4 ? 1u : 3u,
+	};
+
+	std::ofstream stream(filePath, std::ios::binary | std::ios::trunc);
+
+	if (stream.is_open() == false) {
+		error = "Failed to open " + filePath;
+		return false;
+	}
+
+	stream.write((const char*)&DDSMagic, sizeof(UInt32));
+	stream.write((const char*)&header, sizeof(DDSHeader));
+	stream.write((const char*)&headerDX10, sizeof(DDSHeaderDX10));
+	stream.write((const char*)texture->GetData(), texture->GetTotalSize());
+
+	if (stream.good() == false) {
+		error = "Failed to write " + filePath;
+		return false;
+	}
+
+	return true;
+}
+
+bool QuantumEngine::DDSTextureFile::Convert(const std::string& sourcePath, const std::string& destPath, TextureFormat format, std::string& error)
+{
+	auto texture = Texture2DImporter::Import(sourcePath, error);
+
+	if (texture == nullptr)
+		return false;
+
+	auto mippedTexture = TextureMipGenerator::GenerateMips(texture);
+
+	if (mippedTexture != nullptr)
+		texture = mippedTexture;
+
+	if (format != TextureFormat::Unknown && format != texture->GetFormat()) {
+		TextureCompressionProperties compressionProperties;
+		compressionProperties.format = format;
+		auto compressedTexture = TextureCompressor::Compress(texture, compressionProperties);
+
+		if (compressedTexture == nullptr) {
+			error = "Can't convert " + sourcePath + " to the requested format";
+			return false;
+		}
+
+		texture = compressedTexture;
+	}
+
+	return Save(destPath, texture, error);
+}
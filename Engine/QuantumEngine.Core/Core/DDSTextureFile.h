@@ -0,0 +1,28 @@
+#pragma once
+#include "Texture2D.h"
+#include "../BasicTypes.h"
+#include <string>
+
+namespace QuantumEngine {
+	/// <summary>
+	/// DDS container for GPU ready 2D textures with their mip chain, block compressed or not.
+	/// Files are written with the DX10 header, loading also accepts the legacy DXT1/DXT5/ATI2 and 32-bit RGBA layouts
+	/// </summary>
+	class DDSTextureFile {
+	public:
+		static bool IsDDS(const Byte* data, UInt64 size);
+
+		/// <summary>
+		/// maps the file and returns a texture whose data points into the mapping, nothing is decoded or copied.
+		/// The mapping stays open for the lifetime of the texture and its data is read only
+		/// </summary>
+		static ref<Texture2D> Load(const std::string& filePath, std::string& error);
+		static bool Save(const std::string& filePath, const ref<Texture2D>& texture, std::string& error);
+
+		/// <summary>
+		/// imports an image with Texture2DImporter, generates its mip chain and writes it as DDS.
+		/// format Unknown keeps the decoded format, a block compressed format compresses the levels with the default properties
+		/// </summary>
+		static bool Convert(const std::string& sourcePath, const std::string& destPath, TextureFormat format, std::string& error);
+	};
+}
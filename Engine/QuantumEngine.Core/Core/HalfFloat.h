@@ -0,0 +1,74 @@
+#pragma once
+#include <cstring>
+#include "../BasicTypes.h"
+
+namespace QuantumEngine {
+	/// <summary>
+	/// Converts to IEEE half precision with round to nearest. Values too small for a normal half flush to signed zero
+	/// and values too large clamp to infinity
+	/// </summary>
+	inline UInt16 PackHalf(Float value)
+	{
+		UInt32 bits;
+		std::memcpy(&bits, &value, sizeof(Float));
+
+		UInt32 sign = (bits >> 16) & 0x8000;
+		Int32 exponent = (Int32)((bits >> 23) & 0xFF) - 127 + 15;
+		UInt32 mantissa = bits & 0x007FFFFF;
+
+		if (exponent <= 0)
+			return (UInt16)sign;
+
+		if (exponent >= 31)
+			return (UInt16)(sign | 0x7C00);
+
+		// round to nearest
+		mantissa += 0x00001000;
+
+		if (mantissa & 0x00800000) {
+			mantissa = 0;
+			exponent++;
+
+			if (exponent >= 31)
+				return (UInt16)(sign | 0x7C00);
+		}
+
+		return (UInt16)(sign | (exponent << 10) | (mantissa >> 13));
+	}
+
+	/// <summary>
+	/// Converts IEEE half precision back to float, including denormals, infinity and NaN
+	/// </summary>
+	inline Float UnpackHalf(UInt16 value)
+	{
+		UInt32 sign = (UInt32)(value & 0x8000) << 16;
+		UInt32 exponent = (value >> 10) & 0x1F;
+		UInt32 mantissa = value & 0x03FF;
+		UInt32 bits;
+
+		if (exponent == 0x1F) {
+			bits = sign | 0x7F800000 | (mantissa << 13);
+		}
+		else if (exponent != 0) {
+			bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+		}
+		else if (mantissa != 0) {
+			// denormal, renormalize the mantissa
+			exponent = 127 - 15 + 1;
+
+			while ((mantissa & 0x0400) == 0) {
+				mantissa <<= 1;
+				exponent--;
+			}
+
+			bits = sign | (exponent << 23) | ((mantissa & 0x03FF) << 13);
+		}
+		else {
+			bits = sign;
+		}
+
+		Float result;
+		std::memcpy(&result, &bits, sizeof(Float));
+		return result;
+	}
+}
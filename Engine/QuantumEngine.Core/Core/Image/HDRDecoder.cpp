@@ -0,0 +1,146 @@
+#include "ImageDecoders.h"
+#include "../HalfFloat.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+	// reads one header line, returns false at the end of the data
+	bool ReadLine(const Byte* data, UInt64 size, UInt64& offset, std::string& line)
+	{
+		line.clear();
+
+		if (offset >= size)
+			return false;
+
+		while (offset < size && data[offset] != '\n')
+			line.push_back((char)data[offset++]);
+
+		offset++;
+		return true;
+	}
+
+	// new style run length encoded scanline, each channel is stored separately
+	bool ReadRLEScanline(const Byte* data, UInt64 size, UInt64& offset, UInt32 width, Byte* scanline)
+	{
+		for (UInt32 channel = 0; channel < 4; channel++) {
+			UInt32 x = 0;
+
+			while (x < width) {
+				if (offset >= size)
+					return false;
+
+				UInt32 count = data[offset++];
+
+				if (count > 128) { // run of one value
+					count -= 128;
+
+					if (offset >= size || count > width - x)
+						return false;
+
+					Byte value = data[offset++];
+
+					for (UInt32 i = 0; i < count; i++)
+						scanline[4 * (x++) + channel] = value;
+				}
+				else {
+					if (count == 0 || count > width - x || count > size - offset)
+						return false;
+
+					for (UInt32 i = 0; i < count; i++)
+						scanline[4 * (x++) + channel] = data[offset++];
+				}
+			}
+		}
+
+		return true;
+	}
+}
+
+bool QuantumEngine::Image::IsHDR(const Byte* data, UInt64 size)
+{
+	return (size >= 10 && std::memcmp(data, "#?RADIANCE", 10) == 0) || (size >= 6 && std::memcmp(data, "#?RGBE", 6) == 0);
+}
+
+bool QuantumEngine::Image::DecodeHDR(const Byte* data, UInt64 size, DecodedImage& image, std::string& error)
+{
+	if (IsHDR(data, size) == false) {
+		error = "Not a Radiance HDR file";
+		return false;
+	}
+
+	UInt64 offset = 0;
+	std::string line;
+	bool validFormat = false;
+
+	// header lines until an empty one
+	while (ReadLine(data, size, offset, line) && line.empty() == false) {
+		if (line == "FORMAT=32-bit_rle_rgbe")
+			validFormat = true;
+		else if (line.rfind("FORMAT=", 0) == 0) {
+			error = "Unsupported HDR pixel format " + line.substr(7);
+			return false;
+		}
+	}
+
+	if (validFormat == false) {
+		error = "HDR file has no supported FORMAT line";
+		return false;
+	}
+
+	// only the standard top to bottom, left to right orientation
+	UInt32 width = 0;
+	UInt32 height = 0;
+
+	if (ReadLine(data, size, offset, line) == false || std::sscanf(line.c_str(), "-Y %u +X %u", &height, &width) != 2 || width == 0 || height == 0) {
+		error = "Unsupported HDR resolution line";
+		return false;
+	}
+
+	if ((UInt64)width * height * 8 > 0xFFFFFFFFull) {
+		error = "HDR image is too large";
+		return false;
+	}
+
+	image.Allocate(width, height, TextureFormat::RGBA64F, 64, 4);
+	std::vector<Byte> scanline(4 * (size_t)width);
+	UInt16* dest = (UInt16*)image.pixels.get();
+	const UInt16 one = PackHalf(1.0f);
+
+	for (UInt32 y = 0; y < height; y++) {
+		bool isRLE = width >= 8 && width < 32768 && offset + 4 <= size
+			&& data[offset] == 2 && data[offset + 1] == 2 && (UInt32)((data[offset + 2] << 8) | data[offset + 3]) == width;
+
+		if (isRLE) {
+			offset += 4;
+
+			if (ReadRLEScanline(data, size, offset, width, scanline.data()) == false) {
+				error = "Corrupt HDR scanline";
+				return false;
+			}
+		}
+		else {
+			if (4 * (UInt64)width > size - offset) {
+				error = "Truncated HDR data";
+				return false;
+			}
+
+			std::memcpy(scanline.data(), data + offset, 4 * (size_t)width);
+			offset += 4 * (UInt64)width;
+		}
+
+		for (UInt32 x = 0; x < width; x++) {
+			const Byte* rgbe = scanline.data() + 4 * (size_t)x;
+			Float scale = rgbe[3] != 0 ? std::ldexp(1.0f, (Int32)rgbe[3] - (128 + 8)) : 0.0f;
+
+			dest[0] = PackHalf(rgbe[0] * scale);
+			dest[1] = PackHalf(rgbe[1] * scale);
+			dest[2] = PackHalf(rgbe[2] * scale);
+			dest[3] = one;
+			dest += 4;
+		}
+	}
+
+	return true;
+}
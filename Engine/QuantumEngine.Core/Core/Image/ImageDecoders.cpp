@@ -0,0 +1,42 @@
+#include "ImageDecoders.h"
+
+// MSVC doesn't announce SSSE3, every x64 cpu able to run the DX12 and Vulkan backends has it
+#if defined(_M_X64) || defined(__SSSE3__)
+#include <tmmintrin.h>
+#define QE_IMAGE_SSSE3
+#endif
+
+void QuantumEngine::Image::DecodedImage::Allocate(UInt32 imageWidth, UInt32 imageHeight, TextureFormat imageFormat, UInt32 bitsPerPixel, UInt32 channels)
+{
+	width = imageWidth;
+	height = imageHeight;
+	format = imageFormat;
+	bpp = bitsPerPixel;
+	channelCount = channels;
+	size = width * height * (bpp / 8);
+	pixels = std::make_unique_for_overwrite<Byte[]>(size);
+}
+
+void QuantumEngine::Image::ExpandRGBToRGBA(const Byte* source, Byte* dest, UInt32 pixelCount)
+{
+	UInt32 i = 0;
+
+#ifdef QE_IMAGE_SSSE3
+	// 4 pixels per iteration, the 16 byte load reads 4 bytes past the 12 used so stop early enough
+	const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	const __m128i alpha = _mm_set1_epi32((Int32)0xFF000000);
+
+	for (; i + 6 <= pixelCount; i += 4) {
+		__m128i rgb = _mm_loadu_si128((const __m128i*)(source + 3 * i));
+		__m128i rgba = _mm_or_si128(_mm_shuffle_epi8(rgb, shuffle), alpha);
+		_mm_storeu_si128((__m128i*)(dest + 4 * i), rgba);
+	}
+#endif
+
+	for (; i < pixelCount; i++) {
+		dest[4 * i] = source[3 * i];
+		dest[4 * i + 1] = source[3 * i + 1];
+		dest[4 * i + 2] = source[3 * i + 2];
+		dest[4 * i + 3] = 255;
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <memory>
+#include <string>
+#include "../../BasicTypes.h"
+#include "../Texture2D.h"
+
+namespace QuantumEngine::Image {
+	/// <summary>
+	/// Pixels produced by a decoder, laid out the way Texture2D expects them
+	/// </summary>
+	struct DecodedImage {
+		UInt32 width = 0;
+		UInt32 height = 0;
+		UInt32 bpp = 0;
+		UInt32 channelCount = 0;
+		TextureFormat format = TextureFormat::Unknown;
+		std::unique_ptr<Byte[]> pixels;
+		UInt32 size = 0;
+
+		void Allocate(UInt32 imageWidth, UInt32 imageHeight, TextureFormat imageFormat, UInt32 bitsPerPixel, UInt32 channels);
+	};
+
+	bool IsPNG(const Byte* data, UInt64 size);
+	bool IsJPEG(const Byte* data, UInt64 size);
+	bool IsHDR(const Byte* data, UInt64 size);
+
+	// PNG of any color type and bit depth, decoded to RGBA32
+	bool DecodePNG(const Byte* data, UInt64 size, DecodedImage& image, std::string& error);
+	// baseline and progressive huffman JPEG with 1 or 3 components, decoded to RGBA32
+	bool DecodeJPEG(const Byte* data, UInt64 size, DecodedImage& image, std::string& error);
+	// Radiance RGBE, decoded to RGBA64F
+	bool DecodeHDR(const Byte* data, UInt64 size, DecodedImage& image, std::string& error);
+
+	/// <summary>
+	/// Widens tightly packed 8-bit RGB to RGBA with opaque alpha. Uses SSSE3 shuffles where available
+	/// </summary>
+	void ExpandRGBToRGBA(const Byte* source, Byte* dest, UInt32 pixelCount);
+}
@@ -0,0 +1,361 @@
+#include "Inflate.h"
+#include <cstring>
+
+namespace {
+	constexpr UInt32 FastBits = 10;
+	constexpr UInt32 MaxCodeLength = 15;
+
+	const UInt16 s_lengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	const Byte s_lengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	const UInt16 s_distanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+	const Byte s_distanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+	const Byte s_codeLengthOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+	class BitReader {
+	public:
+		BitReader(const Byte* data, UInt64 size) : m_data(data), m_end(data + size) {}
+
+		inline void Refill()
+		{
+			while (m_count <= 56) {
+				UInt64 byte = m_data < m_end ? *m_data : 0;
+
+				if (m_data < m_end)
+					m_data++;
+				else
+					m_overrun++;
+
+				m_buffer |= byte << m_count;
+				m_count += 8;
+			}
+		}
+
+		inline UInt32 Peek(UInt32 count)
+		{
+			if (m_count < count)
+				Refill();
+
+			return (UInt32)(m_buffer & ((1ull << count) - 1));
+		}
+
+		inline void Consume(UInt32 count)
+		{
+			m_buffer >>= count;
+			m_count -= count;
+		}
+
+		inline UInt32 Read(UInt32 count)
+		{
+			if (count == 0)
+				return 0;
+
+			UInt32 value = Peek(count);
+			Consume(count);
+			return value;
+		}
+
+		void AlignToByte()
+		{
+			Consume(m_count & 7);
+		}
+
+		// zero bytes are fed past the end of the input for look ahead, consuming one of them means the stream is truncated
+		inline bool IsOverrun() const { return m_overrun * 8 > m_count; }
+
+		const Byte* TakeBytes(UInt64 count)
+		{
+			// give back whole bytes still sitting in the bit buffer
+			UInt32 buffered = m_count / 8;
+			UInt32 returned = buffered > m_overrun ? buffered - m_overrun : 0;
+			m_data -= returned;
+			m_overrun = 0;
+			m_buffer = 0;
+			m_count = 0;
+
+			if ((UInt64)(m_end - m_data) < count)
+				return nullptr;
+
+			const Byte* bytes = m_data;
+			m_data += count;
+			return bytes;
+		}
+	private:
+		const Byte* m_data;
+		const Byte* m_end;
+		UInt64 m_buffer = 0;
+		UInt32 m_count = 0;
+		UInt32 m_overrun = 0;
+	};
+
+	// canonical huffman decoder with a direct lookup for short codes
+	class HuffmanTable {
+	public:
+		bool Build(const Byte* lengths, UInt32 count)
+		{
+			std::memset(m_fast, 0, sizeof(m_fast));
+			std::memset(m_counts, 0, sizeof(m_counts));
+
+			for (UInt32 i = 0; i < count; i++)
+				m_counts[lengths[i]]++;
+
+			m_counts[0] = 0;
+			UInt16 offsets[MaxCodeLength + 2];
+			offsets[1] = 0;
+			Int32 left = 1;
+
+			for (UInt32 length = 1; length <= MaxCodeLength; length++) {
+				left = (left << 1) - m_counts[length];
+
+				if (left < 0) // over subscribed
+					return false;
+
+				offsets[length + 1] = offsets[length] + m_counts[length];
+			}
+
+			for (UInt32 i = 0; i < count; i++) {
+				if (lengths[i] != 0)
+					m_symbols[offsets[lengths[i]]++] = (UInt16)i;
+			}
+
+			// fill the fast table with the bit reversed codes
+			UInt32 code = 0;
+			UInt32 symbolIndex = 0;
+
+			for (UInt32 length = 1; length <= FastBits; length++) {
+				for (UInt32 i = 0; i < m_counts[length]; i++) {
+					UInt32 reversed = 0;
+
+					for (UInt32 bit = 0; bit < length; bit++)
+						reversed |= ((code >> bit) & 1) << (length - 1 - bit);
+
+					for (UInt32 fill = reversed; fill < (1u << FastBits); fill += 1u << length)
+						m_fast[fill] = (UInt16)((m_symbols[symbolIndex] << 4) | length);
+
+					code++;
+					symbolIndex++;
+				}
+
+				code <<= 1;
+			}
+
+			return true;
+		}
+
+		inline Int32 Decode(BitReader& reader) const
+		{
+			UInt16 entry = m_fast[reader.Peek(FastBits)];
+
+			if (entry != 0) {
+				reader.Consume(entry & 15);
+				return entry >> 4;
+			}
+
+			// slow path, one bit at a time
+			Int32 code = 0;
+			Int32 first = 0;
+			Int32 index = 0;
+
+			for (UInt32 length = 1; length <= MaxCodeLength; length++) {
+				code |= (Int32)reader.Read(1);
+				Int32 count = m_counts[length];
+
+				if (code - count < first)
+					return m_symbols[index + (code - first)];
+
+				index += count;
+				first += count;
+				first <<= 1;
+				code <<= 1;
+			}
+
+			return -1;
+		}
+	private:
+		UInt16 m_fast[1 << FastBits];
+		UInt16 m_counts[MaxCodeLength + 1];
+		UInt16 m_symbols[288];
+	};
+
+	bool InflateBlock(BitReader& reader, const HuffmanTable& literals, const HuffmanTable& distances, std::vector<Byte>& output)
+	{
+		while (true) {
+			Int32 symbol = literals.Decode(reader);
+
+			if (symbol < 0 || reader.IsOverrun())
+				return false;
+
+			if (symbol < 256) {
+				output.push_back((Byte)symbol);
+				continue;
+			}
+
+			if (symbol == 256)
+				return true;
+
+			symbol -= 257;
+
+			if (symbol >= 29)
+				return false;
+
+			UInt32 length = s_lengthBase[symbol] + reader.Read(s_lengthExtra[symbol]);
+			Int32 distanceSymbol = distances.Decode(reader);
+
+			if (distanceSymbol < 0 || distanceSymbol >= 30)
+				return false;
+
+			UInt32 distance = s_distanceBase[distanceSymbol] + reader.Read(s_distanceExtra[distanceSymbol]);
+
+			if (distance > output.size())
+				return false;
+
+			UInt64 start = output.size();
+			output.resize(start + length);
+			Byte* dest = output.data() + start;
+			const Byte* source = dest - distance;
+
+			if (distance >= length) {
+				std::memcpy(dest, source, length);
+			}
+			else {
+				// overlapping copy repeats the last distance bytes
+				for (UInt32 i = 0; i < length; i++)
+					dest[i] = source[i];
+			}
+		}
+	}
+}
+
+bool QuantumEngine::Image::InflateZlib(const Byte* data, UInt64 size, std::vector<Byte>& output, UInt64 expectedSize, std::string& error)
+{
+	if (size < 2 || (data[0] & 0x0F) != 8 || ((data[0] << 8) | data[1]) % 31 != 0) {
+		error = "Invalid zlib header";
+		return false;
+	}
+
+	if (data[1] & 0x20) {
+		error = "Preset zlib dictionaries are not supported";
+		return false;
+	}
+
+	output.clear();
+	output.reserve(expectedSize);
+
+	BitReader reader(data + 2, size - 2);
+	HuffmanTable literals;
+	HuffmanTable distances;
+	bool lastBlock = false;
+
+	while (lastBlock == false) {
+		lastBlock = reader.Read(1) != 0;
+		UInt32 type = reader.Read(2);
+
+		if (type == 0) {
+			reader.AlignToByte();
+			const Byte* header = reader.TakeBytes(4);
+
+			if (header == nullptr || (UInt16)(header[0] | (header[1] << 8)) != (UInt16)~(header[2] | (header[3] << 8))) {
+				error = "Corrupt stored deflate block";
+				return false;
+			}
+
+			UInt32 length = header[0] | (header[1] << 8);
+			const Byte* bytes = reader.TakeBytes(length);
+
+			if (bytes == nullptr) {
+				error = "Truncated stored deflate block";
+				return false;
+			}
+
+			output.insert(output.end(), bytes, bytes + length);
+			continue;
+		}
+
+		Byte lengths[288 + 32];
+
+		if (type == 1) {
+			std::memset(lengths, 8, 144);
+			std::memset(lengths + 144, 9, 112);
+			std::memset(lengths + 256, 7, 24);
+			std::memset(lengths + 280, 8, 8);
+			literals.Build(lengths, 288);
+			std::memset(lengths, 5, 30);
+			distances.Build(lengths, 30);
+		}
+		else if (type == 2) {
+			UInt32 literalCount = reader.Read(5) + 257;
+			UInt32 distanceCount = reader.Read(5) + 1;
+			UInt32 codeLengthCount = reader.Read(4) + 4;
+
+			Byte codeLengths[19] = {};
+
+			for (UInt32 i = 0; i < codeLengthCount; i++)
+				codeLengths[s_codeLengthOrder[i]] = (Byte)reader.Read(3);
+
+			HuffmanTable codeLengthTable;
+
+			if (codeLengthTable.Build(codeLengths, 19) == false) {
+				error = "Invalid deflate code length table";
+				return false;
+			}
+
+			UInt32 total = literalCount + distanceCount;
+			UInt32 index = 0;
+
+			while (index < total) {
+				Int32 symbol = codeLengthTable.Decode(reader);
+				UInt32 repeat = 0;
+				Byte value = 0;
+
+				if (symbol < 0) {
+					error = "Corrupt deflate code lengths";
+					return false;
+				}
+
+				if (symbol < 16) {
+					lengths[index++] = (Byte)symbol;
+					continue;
+				}
+
+				if (symbol == 16) {
+					if (index == 0) {
+						error = "Corrupt deflate code lengths";
+						return false;
+					}
+
+					value = lengths[index - 1];
+					repeat = 3 + reader.Read(2);
+				}
+				else if (symbol == 17) {
+					repeat = 3 + reader.Read(3);
+				}
+				else {
+					repeat = 11 + reader.Read(7);
+				}
+
+				if (index + repeat > total) {
+					error = "Corrupt deflate code lengths";
+					return false;
+				}
+
+				std::memset(lengths + index, value, repeat);
+				index += repeat;
+			}
+
+			if (literals.Build(lengths, literalCount) == false || distances.Build(lengths + literalCount, distanceCount) == false) {
+				error = "Invalid deflate huffman tables";
+				return false;
+			}
+		}
+		else {
+			error = "Invalid deflate block type";
+			return false;
+		}
+
+		if (InflateBlock(reader, literals, distances, output) == false) {
+			error = "Corrupt deflate data";
+			return false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,12 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "../../BasicTypes.h"
+
+namespace QuantumEngine::Image {
+	/// <summary>
+	/// Decompresses a zlib stream (RFC 1950/1951). expectedSize is only a reservation hint.
+	/// returns false and fills error on malformed input
+	/// </summary>
+	bool InflateZlib(const Byte* data, UInt64 size, std::vector<Byte>& output, UInt64 expectedSize, std::string& error);
+}
@@ -0,0 +1,1080 @@
+#include "ImageDecoders.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define QE_JPEG_SSE2
+#endif
+
+namespace {
+	// natural order index of each zig-zag position, padded so corrupt run lengths stay in bounds
+	const Byte s_zigzag[64 + 16] = {
+		0, 1, 8, 16, 9, 2, 3, 10, 17, 24, 32, 25, 18, 11, 4, 5,
+		12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6, 7, 14, 21, 28,
+		35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+		58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63,
+		63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63,
+	};
+
+	constexpr UInt32 FastBits = 9;
+
+	inline UInt32 ReadBigEndian16(const Byte* data)
+	{
+		return (data[0] << 8) | data[1];
+	}
+
+	// entropy coded segment reader, bits are consumed most significant first
+	class BitReader {
+	public:
+		void Reset(const Byte* data, const Byte* end)
+		{
+			m_data = data;
+			m_end = end;
+			m_buffer = 0;
+			m_count = 0;
+			m_hitMarker = false;
+		}
+
+		inline UInt32 Peek(UInt32 count)
+		{
+			if (m_count < (Int32)count)
+				Fill();
+
+			return (UInt32)(m_buffer >> (64 - count));
+		}
+
+		inline void Consume(UInt32 count)
+		{
+			m_buffer <<= count;
+			m_count -= count;
+		}
+
+		inline UInt32 Read(UInt32 count)
+		{
+			if (count == 0)
+				return 0;
+
+			UInt32 value = Peek(count);
+			Consume(count);
+			return value;
+		}
+
+		inline Int32 ReceiveExtend(UInt32 count)
+		{
+			if (count == 0)
+				return 0;
+
+			Int32 value = (Int32)Read(count);
+			return value < (1 << (count - 1)) ? value - (1 << count) + 1 : value;
+		}
+
+		// skips to the marker ending the current interval and past it if it is a restart marker
+		void Restart()
+		{
+			m_buffer = 0;
+			m_count = 0;
+			m_hitMarker = false;
+
+			while (m_data + 1 < m_end && (m_data[0] != 0xFF || m_data[1] == 0x00 || m_data[1] == 0xFF))
+				m_data++;
+
+			if (m_data + 1 < m_end && m_data[1] >= 0xD0 && m_data[1] <= 0xD7)
+				m_data += 2;
+		}
+
+		// position of the next marker after the scan
+		const Byte* FindMarker()
+		{
+			while (m_data + 1 < m_end && (m_data[0] != 0xFF || m_data[1] == 0x00 || (m_data[1] >= 0xD0 && m_data[1] <= 0xD7)))
+				m_data++;
+
+			return m_data;
+		}
+	private:
+		void Fill()
+		{
+			while (m_count <= 56) {
+				UInt64 byte = 0;
+
+				if (m_hitMarker == false && m_data < m_end) {
+					byte = *m_data;
+
+					if (byte == 0xFF) {
+						Byte next = m_data + 1 < m_end ? m_data[1] : 0xD9;
+
+						if (next == 0x00) {
+							m_data += 2;
+						}
+						else {
+							// leave the marker for Restart and feed zeros
+							m_hitMarker = true;
+							byte = 0;
+						}
+					}
+					else {
+						m_data++;
+					}
+				}
+
+				m_buffer |= byte << (56 - m_count);
+				m_count += 8;
+			}
+		}
+
+		const Byte* m_data = nullptr;
+		const Byte* m_end = nullptr;
+		UInt64 m_buffer = 0;
+		Int32 m_count = 0;
+		bool m_hitMarker = false;
+	};
+
+	class HuffmanTable {
+	public:
+		bool Build(const Byte* counts, const Byte* symbols, UInt32 symbolCount)
+		{
+			std::memcpy(m_symbols, symbols, symbolCount);
+			std::memset(m_fast, 0, sizeof(m_fast));
+
+			UInt32 code = 0;
+			UInt32 index = 0;
+
+			for (UInt32 length = 1; length <= 16; length++) {
+				m_valueOffset[length] = (Int32)index - (Int32)code;
+				UInt32 count = counts[length - 1];
+
+				if (code + count > (1u << length))
+					return false;
+
+				if (count > 0 && length <= FastBits) {
+					for (UInt32 i = 0; i < count; i++) {
+						UInt32 prefix = (code + i) << (FastBits - length);
+
+						for (UInt32 fill = 0; fill < (1u << (FastBits - length)); fill++)
+							m_fast[prefix + fill] = (UInt16)((length << 8) | m_symbols[index + i]);
+					}
+				}
+
+				code += count;
+				index += count;
+				m_maxCode[length] = count > 0 ? (Int32)code - 1 : -1;
+				code <<= 1;
+			}
+
+			BuildFastAC();
+			return index == symbolCount;
+		}
+
+		// value << 8 | run << 4 | total bit count of an AC code and its magnitude bits, 0 if they don't fit the fast lookup
+		inline Int32 FastAC(UInt32 bits) const
+		{
+			return m_fastAC[bits];
+		}
+
+		inline Int32 Decode(BitReader& reader) const
+		{
+			UInt32 bits = reader.Peek(16);
+			UInt16 entry = m_fast[bits >> (16 - FastBits)];
+
+			if (entry != 0) {
+				reader.Consume(entry >> 8);
+				return entry & 0xFF;
+			}
+
+			for (UInt32 length = FastBits + 1; length <= 16; length++) {
+				Int32 code = (Int32)(bits >> (16 - length));
+
+				if (code <= m_maxCode[length]) {
+					reader.Consume(length);
+					return m_symbols[(code + m_valueOffset[length]) & 0xFF];
+				}
+			}
+
+			return -1;
+		}
+	private:
+		void BuildFastAC()
+		{
+			for (UInt32 i = 0; i < (1u << FastBits); i++) {
+				m_fastAC[i] = 0;
+				UInt32 length = m_fast[i] >> 8;
+
+				if (length == 0)
+					continue;
+
+				UInt32 run = (m_fast[i] >> 4) & 15;
+				UInt32 size = m_fast[i] & 15;
+
+				if (size == 0 || length + size > FastBits)
+					continue;
+
+				Int32 value = (Int32)(((i << length) & ((1u << FastBits) - 1)) >> (FastBits - size));
+
+				if (value < (1 << (size - 1)))
+					value += 1 - (1 << size);
+
+				if (value >= -128 && value <= 127)
+					m_fastAC[i] = (Int16)(value * 256 + (Int32)(run * 16 + length + size));
+			}
+		}
+
+		UInt16 m_fast[1 << FastBits];
+		Int16 m_fastAC[1 << FastBits];
+		Int32 m_maxCode[17];
+		Int32 m_valueOffset[17];
+		Byte m_symbols[256];
+	};
+
+	struct Component {
+		UInt32 id;
+		UInt32 h;
+		UInt32 v;
+		UInt32 quantTable;
+		UInt32 width;
+		UInt32 height;
+		UInt32 blocksPerLine;
+		UInt32 blocksPerColumn;
+		UInt32 dcTable;
+		UInt32 acTable;
+		Int32 dcPredictor;
+		std::vector<Int16> coefficients;
+		std::vector<Byte> plane;
+
+		inline Int16* Block(UInt32 x, UInt32 y) { return coefficients.data() + 64 * ((size_t)y * blocksPerLine + x); }
+	};
+
+	struct Decoder {
+		UInt16 quantTables[4][64];
+		HuffmanTable dcTables[4];
+		HuffmanTable acTables[4];
+		std::vector<Component> components;
+		UInt32 width = 0;
+		UInt32 height = 0;
+		UInt32 maxH = 1;
+		UInt32 maxV = 1;
+		UInt32 mcusX = 0;
+		UInt32 mcusY = 0;
+		bool progressive = false;
+		UInt32 restartInterval = 0;
+		Int32 adobeTransform = -1;
+		BitReader reader;
+
+		// scan parameters
+		UInt32 spectralStart = 0;
+		UInt32 spectralEnd = 63;
+		UInt32 approximationHigh = 0;
+		UInt32 approximationLow = 0;
+		UInt32 eobRun = 0;
+		bool corrupt = false;
+
+		void DecodeBlock(Component& component, Int16* block);
+		void DecodeBaseline(Component& component, Int16* block);
+		void DecodeDCFirst(Component& component, Int16* block);
+		void DecodeDCRefine(Int16* block);
+		void DecodeACFirst(Component& component, Int16* block);
+		void DecodeACRefine(Component& component, Int16* block);
+	};
+
+	inline Int32 DecodeSymbol(Decoder& decoder, const HuffmanTable& table)
+	{
+		Int32 symbol = table.Decode(decoder.reader);
+
+		if (symbol < 0) {
+			decoder.corrupt = true;
+			return 0;
+		}
+
+		return symbol;
+	}
+
+	void Decoder::DecodeBaseline(Component& component, Int16* block)
+	{
+		Int32 t = DecodeSymbol(*this, dcTables[component.dcTable]);
+		component.dcPredictor += reader.ReceiveExtend(t & 15);
+		block[0] = (Int16)component.dcPredictor;
+
+		const HuffmanTable& acTable = acTables[component.acTable];
+
+		for (UInt32 k = 1; k < 64;) {
+			Int32 fast = acTable.FastAC(reader.Peek(FastBits));
+
+			if (fast != 0) {
+				k += (fast >> 4) & 15;
+				reader.Consume(fast & 15);
+				block[s_zigzag[k++]] = (Int16)(fast >> 8);
+				continue;
+			}
+
+			Int32 rs = DecodeSymbol(*this, acTable);
+			UInt32 s = rs & 15;
+			UInt32 r = rs >> 4;
+
+			if (s == 0) {
+				if (r != 15)
+					break;
+
+				k += 16;
+				continue;
+			}
+
+			k += r;
+			block[s_zigzag[k]] = (Int16)reader.ReceiveExtend(s);
+			k++;
+		}
+	}
+
+	void Decoder::DecodeDCFirst(Component& component, Int16* block)
+	{
+		Int32 t = DecodeSymbol(*this, dcTables[component.dcTable]);
+		component.dcPredictor += reader.ReceiveExtend(t & 15);
+		block[0] = (Int16)(component.dcPredictor * (1 << approximationLow));
+	}
+
+	void Decoder::DecodeDCRefine(Int16* block)
+	{
+		if (reader.Read(1))
+			block[0] |= (Int16)(1 << approximationLow);
+	}
+
+	void Decoder::DecodeACFirst(Component& component, Int16* block)
+	{
+		if (eobRun > 0) {
+			eobRun--;
+			return;
+		}
+
+		const HuffmanTable& acTable = acTables[component.acTable];
+
+		for (UInt32 k = spectralStart; k <= spectralEnd;) {
+			Int32 rs = DecodeSymbol(*this, acTable);
+			UInt32 s = rs & 15;
+			UInt32 r = rs >> 4;
+
+			if (s == 0) {
+				if (r < 15) {
+					eobRun = (1u << r) - 1;
+
+					if (r > 0)
+						eobRun += reader.Read(r);
+
+					break;
+				}
+
+				k += 16;
+				continue;
+			}
+
+			k += r;
+			block[s_zigzag[k]] = (Int16)(reader.ReceiveExtend(s) * (1 << approximationLow));
+			k++;
+		}
+	}
+
+	void Decoder::DecodeACRefine(Component& component, Int16* block)
+	{
+		Int32 p1 = 1 << approximationLow;
+		Int32 m1 = -1 * (1 << approximationLow);
+		const HuffmanTable& acTable = acTables[component.acTable];
+		UInt32 k = spectralStart;
+
+		auto refine = [this, p1, m1](Int16& coefficient) {
+			if (reader.Read(1) && (coefficient & p1) == 0)
+				coefficient = (Int16)(coefficient + (coefficient >= 0 ? p1 : m1));
+		};
+
+		if (eobRun == 0) {
+			for (; k <= spectralEnd; k++) {
+				Int32 rs = DecodeSymbol(*this, acTable);
+				Int32 s = rs & 15;
+				Int32 r = rs >> 4;
+
+				if (s != 0) {
+					s = reader.Read(1) ? p1 : m1;
+				}
+				else if (r != 15) {
+					eobRun = 1u << r;
+
+					if (r > 0)
+						eobRun += reader.Read(r);
+
+					break;
+				}
+
+				// skip r zero coefficients, refining the non zero ones on the way
+				while (k <= spectralEnd) {
+					Int16& coefficient = block[s_zigzag[k]];
+
+					if (coefficient != 0)
+						refine(coefficient);
+					else if (--r < 0)
+						break;
+
+					k++;
+				}
+
+				if (s != 0 && k <= spectralEnd)
+					block[s_zigzag[k]] = (Int16)s;
+			}
+		}
+
+		if (eobRun > 0) {
+			// the rest of this block is in the end of band run, only refinement bits remain
+			for (; k <= spectralEnd; k++) {
+				Int16& coefficient = block[s_zigzag[k]];
+
+				if (coefficient != 0)
+					refine(coefficient);
+			}
+
+			eobRun--;
+		}
+	}
+
+	void Decoder::DecodeBlock(Component& component, Int16* block)
+	{
+		if (progressive == false)
+			DecodeBaseline(component, block);
+		else if (spectralStart == 0)
+			approximationHigh == 0 ? DecodeDCFirst(component, block) : DecodeDCRefine(block);
+		else
+			approximationHigh == 0 ? DecodeACFirst(component, block) : DecodeACRefine(component, block);
+	}
+
+	bool DecodeScan(Decoder& decoder, const std::vector<Component*>& scanComponents)
+	{
+		UInt32 restartsLeft = decoder.restartInterval;
+		decoder.eobRun = 0;
+
+		for (auto component : scanComponents)
+			component->dcPredictor = 0;
+
+		auto nextMCU = [&](bool lastMCU) {
+			if (decoder.restartInterval == 0 || --restartsLeft > 0 || lastMCU)
+				return;
+
+			decoder.reader.Restart();
+			restartsLeft = decoder.restartInterval;
+			decoder.eobRun = 0;
+
+			for (auto component : scanComponents)
+				component->dcPredictor = 0;
+		};
+
+		if (scanComponents.size() == 1) {
+			// non interleaved, one block per MCU over the real component size
+			Component& component = *scanComponents[0];
+			UInt32 blocksX = (component.width + 7) / 8;
+			UInt32 blocksY = (component.height + 7) / 8;
+
+			for (UInt32 y = 0; y < blocksY; y++) {
+				for (UInt32 x = 0; x < blocksX; x++) {
+					decoder.DecodeBlock(component, component.Block(x, y));
+
+					if (decoder.corrupt)
+						return false;
+
+					nextMCU(y == blocksY - 1 && x == blocksX - 1);
+				}
+			}
+
+			return true;
+		}
+
+		for (UInt32 mcuY = 0; mcuY < decoder.mcusY; mcuY++) {
+			for (UInt32 mcuX = 0; mcuX < decoder.mcusX; mcuX++) {
+				for (auto component : scanComponents) {
+					for (UInt32 v = 0; v < component->v; v++) {
+						for (UInt32 h = 0; h < component->h; h++)
+							decoder.DecodeBlock(*component, component->Block(mcuX * component->h + h, mcuY * component->v + v));
+					}
+				}
+
+				if (decoder.corrupt)
+					return false;
+
+				nextMCU(mcuY == decoder.mcusY - 1 && mcuX == decoder.mcusX - 1);
+			}
+		}
+
+		return true;
+	}
+
+	inline Byte ClampToByte(Int32 value)
+	{
+		return (Byte)std::clamp(value, 0, 255);
+	}
+
+#ifdef QE_JPEG_SSE2
+	// one dimensional AAN IDCT over 4 lanes, v is read and written in natural order
+	inline void InverseDCT1D(__m128* v)
+	{
+		const __m128 sqrt2 = _mm_set1_ps(1.414213562f);
+		const __m128 c1847 = _mm_set1_ps(1.847759065f);
+		const __m128 c1082 = _mm_set1_ps(1.082392200f);
+		const __m128 c2613 = _mm_set1_ps(2.613125930f);
+
+		__m128 tmp10 = _mm_add_ps(v[0], v[4]);
+		__m128 tmp11 = _mm_sub_ps(v[0], v[4]);
+		__m128 tmp13 = _mm_add_ps(v[2], v[6]);
+		__m128 tmp12 = _mm_sub_ps(_mm_mul_ps(_mm_sub_ps(v[2], v[6]), sqrt2), tmp13);
+
+		__m128 tmp0 = _mm_add_ps(tmp10, tmp13);
+		__m128 tmp3 = _mm_sub_ps(tmp10, tmp13);
+		__m128 tmp1 = _mm_add_ps(tmp11, tmp12);
+		__m128 tmp2 = _mm_sub_ps(tmp11, tmp12);
+
+		__m128 z13 = _mm_add_ps(v[5], v[3]);
+		__m128 z10 = _mm_sub_ps(v[5], v[3]);
+		__m128 z11 = _mm_add_ps(v[1], v[7]);
+		__m128 z12 = _mm_sub_ps(v[1], v[7]);
+
+		__m128 tmp7 = _mm_add_ps(z11, z13);
+		tmp11 = _mm_mul_ps(_mm_sub_ps(z11, z13), sqrt2);
+
+		__m128 z5 = _mm_mul_ps(_mm_add_ps(z10, z12), c1847);
+		tmp10 = _mm_sub_ps(_mm_mul_ps(c1082, z12), z5);
+		tmp12 = _mm_sub_ps(z5, _mm_mul_ps(c2613, z10));
+
+		__m128 tmp6 = _mm_sub_ps(tmp12, tmp7);
+		__m128 tmp5 = _mm_sub_ps(tmp11, tmp6);
+		__m128 tmp4 = _mm_add_ps(tmp10, tmp5);
+
+		v[0] = _mm_add_ps(tmp0, tmp7);
+		v[7] = _mm_sub_ps(tmp0, tmp7);
+		v[1] = _mm_add_ps(tmp1, tmp6);
+		v[6] = _mm_sub_ps(tmp1, tmp6);
+		v[2] = _mm_add_ps(tmp2, tmp5);
+		v[5] = _mm_sub_ps(tmp2, tmp5);
+		v[4] = _mm_add_ps(tmp3, tmp4);
+		v[3] = _mm_sub_ps(tmp3, tmp4);
+	}
+
+	// transposes the 8x8 matrix held as rows 0-3 in top and rows 4-7 in bottom, 2 vectors per row, into the same layout
+	inline void Transpose8x8(const __m128* left, const __m128* right, __m128* top, __m128* bottom)
+	{
+		__m128 a0 = left[0], a1 = left[1], a2 = left[2], a3 = left[3];
+		__m128 b0 = right[0], b1 = right[1], b2 = right[2], b3 = right[3];
+		__m128 c0 = left[4], c1 = left[5], c2 = left[6], c3 = left[7];
+		__m128 d0 = right[4], d1 = right[5], d2 = right[6], d3 = right[7];
+
+		_MM_TRANSPOSE4_PS(a0, a1, a2, a3);
+		_MM_TRANSPOSE4_PS(b0, b1, b2, b3);
+		_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+		_MM_TRANSPOSE4_PS(d0, d1, d2, d3);
+
+		top[0] = a0; top[1] = a1; top[2] = a2; top[3] = a3;
+		top[4] = b0; top[5] = b1; top[6] = b2; top[7] = b3;
+		bottom[0] = c0; bottom[1] = c1; bottom[2] = c2; bottom[3] = c3;
+		bottom[4] = d0; bottom[5] = d1; bottom[6] = d2; bottom[7] = d3;
+	}
+
+	// AAN float IDCT on 4 columns (then 4 rows) at a time. The quantization table already contains the AAN scale factors and the final 1/8
+	void InverseDCT(const Int16* block, const Float* quant, Byte* dest, UInt32 stride)
+	{
+		// left holds columns 0-3 and right columns 4-7 of each row
+		__m128 left[8];
+		__m128 right[8];
+
+		for (UInt32 row = 0; row < 8; row++) {
+			__m128i coefficients = _mm_loadu_si128((const __m128i*)(block + 8 * row));
+			__m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(coefficients, coefficients), 16);
+			__m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(coefficients, coefficients), 16);
+
+			left[row] = _mm_mul_ps(_mm_cvtepi32_ps(low), _mm_loadu_ps(quant + 8 * row));
+			right[row] = _mm_mul_ps(_mm_cvtepi32_ps(high), _mm_loadu_ps(quant + 8 * row + 4));
+		}
+
+		InverseDCT1D(left);
+		InverseDCT1D(right);
+
+		// rows become lanes, top holds rows 0-3 and bottom rows 4-7 of each column
+		__m128 top[8];
+		__m128 bottom[8];
+		Transpose8x8(left, right, top, bottom);
+
+		InverseDCT1D(top);
+		InverseDCT1D(bottom);
+
+		Transpose8x8(top, bottom, left, right);
+
+		// + 128.5 level shifts and rounds before truncation, the saturating packs clamp to [0, 255]
+		const __m128 bias = _mm_set1_ps(128.5f);
+
+		for (UInt32 row = 0; row < 8; row++) {
+			__m128i low = _mm_cvttps_epi32(_mm_add_ps(left[row], bias));
+			__m128i high = _mm_cvttps_epi32(_mm_add_ps(right[row], bias));
+			__m128i words = _mm_packs_epi32(low, high);
+			_mm_storel_epi64((__m128i*)(dest + row * stride), _mm_packus_epi16(words, words));
+		}
+	}
+#else
+	// AAN float IDCT. The quantization table already contains the AAN scale factors and the final 1/8
+	void InverseDCT(const Int16* block, const Float* quant, Byte* dest, UInt32 stride)
+	{
+		Float workspace[64];
+
+		for (UInt32 column = 0; column < 8; column++) {
+			const Int16* in = block + column;
+			const Float* q = quant + column;
+			Float* ws = workspace + column;
+
+			if (in[8] == 0 && in[16] == 0 && in[24] == 0 && in[32] == 0 && in[40] == 0 && in[48] == 0 && in[56] == 0) {
+				Float dc = in[0] * q[0];
+
+				for (UInt32 row = 0; row < 8; row++)
+					ws[8 * row] = dc;
+
+				continue;
+			}
+
+			Float tmp0 = in[0] * q[0];
+			Float tmp1 = in[16] * q[16];
+			Float tmp2 = in[32] * q[32];
+			Float tmp3 = in[48] * q[48];
+
+			Float tmp10 = tmp0 + tmp2;
+			Float tmp11 = tmp0 - tmp2;
+			Float tmp13 = tmp1 + tmp3;
+			Float tmp12 = (tmp1 - tmp3) * 1.414213562f - tmp13;
+
+			tmp0 = tmp10 + tmp13;
+			tmp3 = tmp10 - tmp13;
+			tmp1 = tmp11 + tmp12;
+			tmp2 = tmp11 - tmp12;
+
+			Float tmp4 = in[8] * q[8];
+			Float tmp5 = in[24] * q[24];
+			Float tmp6 = in[40] * q[40];
+			Float tmp7 = in[56] * q[56];
+
+			Float z13 = tmp6 + tmp5;
+			Float z10 = tmp6 - tmp5;
+			Float z11 = tmp4 + tmp7;
+			Float z12 = tmp4 - tmp7;
+
+			tmp7 = z11 + z13;
+			tmp11 = (z11 - z13) * 1.414213562f;
+
+			Float z5 = (z10 + z12) * 1.847759065f;
+			tmp10 = 1.082392200f * z12 - z5;
+			tmp12 = -2.613125930f * z10 + z5;
+
+			tmp6 = tmp12 - tmp7;
+			tmp5 = tmp11 - tmp6;
+			tmp4 = tmp10 + tmp5;
+
+			ws[0] = tmp0 + tmp7;
+			ws[56] = tmp0 - tmp7;
+			ws[8] = tmp1 + tmp6;
+			ws[48] = tmp1 - tmp6;
+			ws[16] = tmp2 + tmp5;
+			ws[40] = tmp2 - tmp5;
+			ws[32] = tmp3 + tmp4;
+			ws[24] = tmp3 - tmp4;
+		}
+
+		for (UInt32 row = 0; row < 8; row++) {
+			const Float* ws = workspace + 8 * row;
+			Byte* out = dest + row * stride;
+
+			Float tmp10 = ws[0] + ws[4];
+			Float tmp11 = ws[0] - ws[4];
+			Float tmp13 = ws[2] + ws[6];
+			Float tmp12 = (ws[2] - ws[6]) * 1.414213562f - tmp13;
+
+			Float tmp0 = tmp10 + tmp13;
+			Float tmp3 = tmp10 - tmp13;
+			Float tmp1 = tmp11 + tmp12;
+			Float tmp2 = tmp11 - tmp12;
+
+			Float z13 = ws[5] + ws[3];
+			Float z10 = ws[5] - ws[3];
+			Float z11 = ws[1] + ws[7];
+			Float z12 = ws[1] - ws[7];
+
+			Float tmp7 = z11 + z13;
+			tmp11 = (z11 - z13) * 1.414213562f;
+
+			Float z5 = (z10 + z12) * 1.847759065f;
+			tmp10 = 1.082392200f * z12 - z5;
+			tmp12 = -2.613125930f * z10 + z5;
+
+			Float tmp6 = tmp12 - tmp7;
+			Float tmp5 = tmp11 - tmp6;
+			Float tmp4 = tmp10 + tmp5;
+
+			// + 128.5 level shifts and rounds before truncation
+			out[0] = ClampToByte((Int32)(tmp0 + tmp7 + 128.5f));
+			out[7] = ClampToByte((Int32)(tmp0 - tmp7 + 128.5f));
+			out[1] = ClampToByte((Int32)(tmp1 + tmp6 + 128.5f));
+			out[6] = ClampToByte((Int32)(tmp1 - tmp6 + 128.5f));
+			out[2] = ClampToByte((Int32)(tmp2 + tmp5 + 128.5f));
+			out[5] = ClampToByte((Int32)(tmp2 - tmp5 + 128.5f));
+			out[4] = ClampToByte((Int32)(tmp3 + tmp4 + 128.5f));
+			out[3] = ClampToByte((Int32)(tmp3 - tmp4 + 128.5f));
+		}
+	}
+#endif
+
+	// converts as many pixels of a row as the SIMD path handles and returns their count
+	UInt32 ConvertYCbCrRow(const Byte* luma, const Byte* cb, const Byte* cr, Byte* dest, UInt32 width)
+	{
+		UInt32 x = 0;
+
+#ifdef QE_JPEG_SSE2
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i alpha = _mm_set1_epi8((char)0xFF);
+		const __m128i center = _mm_set1_epi16(128);
+		const __m128 crToR = _mm_set1_ps(1.402f);
+		const __m128 cbToG = _mm_set1_ps(-0.344136f);
+		const __m128 crToG = _mm_set1_ps(-0.714136f);
+		const __m128 cbToB = _mm_set1_ps(1.772f);
+
+		auto convert = [&](__m128i y16, __m128i cb16, __m128i cr16, __m128i& r, __m128i& g, __m128i& b) {
+			__m128 yf = _mm_cvtepi32_ps(y16);
+			__m128 cbf = _mm_cvtepi32_ps(cb16);
+			__m128 crf = _mm_cvtepi32_ps(cr16);
+
+			r = _mm_cvtps_epi32(_mm_add_ps(yf, _mm_mul_ps(crf, crToR)));
+			g = _mm_cvtps_epi32(_mm_add_ps(yf, _mm_add_ps(_mm_mul_ps(cbf, cbToG), _mm_mul_ps(crf, crToG))));
+			b = _mm_cvtps_epi32(_mm_add_ps(yf, _mm_mul_ps(cbf, cbToB)));
+		};
+
+		for (; x + 8 <= width; x += 8, dest += 32) {
+			__m128i y16 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(luma + x)), zero);
+			__m128i cb16 = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(cb + x)), zero), center);
+			__m128i cr16 = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(cr + x)), zero), center);
+
+			__m128i r0, g0, b0, r1, g1, b1;
+			convert(_mm_unpacklo_epi16(y16, zero), _mm_srai_epi32(_mm_unpacklo_epi16(cb16, cb16), 16), _mm_srai_epi32(_mm_unpacklo_epi16(cr16, cr16), 16), r0, g0, b0);
+			convert(_mm_unpackhi_epi16(y16, zero), _mm_srai_epi32(_mm_unpackhi_epi16(cb16, cb16), 16), _mm_srai_epi32(_mm_unpackhi_epi16(cr16, cr16), 16), r1, g1, b1);
+
+			// saturating packs clamp to [0, 255], then interleave to RGBA
+			__m128i r8 = _mm_packus_epi16(_mm_packs_epi32(r0, r1), zero);
+			__m128i g8 = _mm_packus_epi16(_mm_packs_epi32(g0, g1), zero);
+			__m128i b8 = _mm_packus_epi16(_mm_packs_epi32(b0, b1), zero);
+			__m128i rg = _mm_unpacklo_epi8(r8, g8);
+			__m128i ba = _mm_unpacklo_epi8(b8, alpha);
+
+			_mm_storeu_si128((__m128i*)dest, _mm_unpacklo_epi16(rg, ba));
+			_mm_storeu_si128((__m128i*)(dest + 16), _mm_unpackhi_epi16(rg, ba));
+		}
+#endif
+
+		return x;
+	}
+
+	void ReconstructPlane(Decoder& decoder, Component& component)
+	{
+		static const Float aanScale[8] = { 1.0f, 1.387039845f, 1.306562965f, 1.175875602f, 1.0f, 0.785694958f, 0.541196100f, 0.275899379f };
+
+		Float quant[64];
+		const UInt16* table = decoder.quantTables[component.quantTable];
+
+		for (UInt32 row = 0; row < 8; row++) {
+			for (UInt32 column = 0; column < 8; column++)
+				quant[8 * row + column] = table[8 * row + column] * aanScale[row] * aanScale[column] * 0.125f;
+		}
+
+		UInt32 stride = component.blocksPerLine * 8;
+		component.plane.resize((size_t)stride * component.blocksPerColumn * 8);
+
+		for (UInt32 y = 0; y < component.blocksPerColumn; y++) {
+			for (UInt32 x = 0; x < component.blocksPerLine; x++)
+				InverseDCT(component.Block(x, y), quant, component.plane.data() + (size_t)y * 8 * stride + x * 8, stride);
+		}
+	}
+}
+
+bool QuantumEngine::Image::IsJPEG(const Byte* data, UInt64 size)
+{
+	return size >= 3 && data[0] == 0xFF && data[1] == 0xD8 && data[2] == 0xFF;
+}
+
+bool QuantumEngine::Image::DecodeJPEG(const Byte* data, UInt64 size, DecodedImage& image, std::string& error)
+{
+	if (IsJPEG(data, size) == false) {
+		error = "Not a JPEG file";
+		return false;
+	}
+
+	auto decoder = std::make_unique<Decoder>();
+	std::memset(decoder->quantTables, 0, sizeof(decoder->quantTables));
+	const Byte* end = data + size;
+	const Byte* position = data + 2;
+	bool hasFrame = false;
+
+	while (position + 4 <= end) {
+		if (position[0] != 0xFF) {
+			position++;
+			continue;
+		}
+
+		Byte marker = position[1];
+
+		if (marker == 0xFF) { // fill byte
+			position++;
+			continue;
+		}
+
+		if (marker == 0xD9) // EOI
+			break;
+
+		UInt32 length = ReadBigEndian16(position + 2);
+		const Byte* segment = position + 4;
+
+		if (length < 2 || segment + length - 2 > end) {
+			error = "Truncated JPEG segment";
+			return false;
+		}
+
+		const Byte* segmentEnd = segment + length - 2;
+
+		switch (marker) {
+		case 0xDB: // DQT
+			for (const Byte* p = segment; p < segmentEnd;) {
+				UInt32 precision = p[0] >> 4;
+				UInt32 id = p[0] & 3;
+				p++;
+
+				if (p + (precision ? 128 : 64) > segmentEnd) {
+					error = "Corrupt JPEG quantization table";
+					return false;
+				}
+
+				for (UInt32 k = 0; k < 64; k++) {
+					decoder->quantTables[id][s_zigzag[k]] = (UInt16)(precision ? ReadBigEndian16(p) : p[0]);
+					p += precision ? 2 : 1;
+				}
+			}
+			break;
+		case 0xC4: // DHT
+			for (const Byte* p = segment; p + 17 <= segmentEnd;) {
+				UInt32 tableClass = p[0] >> 4;
+				UInt32 id = p[0] & 3;
+				const Byte* counts = p + 1;
+				UInt32 symbolCount = 0;
+
+				for (UInt32 i = 0; i < 16; i++)
+					symbolCount += counts[i];
+
+				p += 17;
+
+				if (symbolCount > 256 || p + symbolCount > segmentEnd) {
+					error = "Corrupt JPEG huffman table";
+					return false;
+				}
+
+				HuffmanTable& table = tableClass == 0 ? decoder->dcTables[id] : decoder->acTables[id];
+
+				if (table.Build(counts, p, symbolCount) == false) {
+					error = "Corrupt JPEG huffman table";
+					return false;
+				}
+
+				p += symbolCount;
+			}
+			break;
+		case 0xDD: // DRI
+			decoder->restartInterval = length >= 4 ? ReadBigEndian16(segment) : 0;
+			break;
+		case 0xEE: // APP14, Adobe color transform
+			if (length >= 14 && std::memcmp(segment, "Adobe", 5) == 0)
+				decoder->adobeTransform = segment[11];
+			break;
+		case 0xC0:
+		case 0xC1:
+		case 0xC2: { // SOF baseline, extended and progressive huffman
+			if (hasFrame || length < 8 || segment[0] != 8) {
+				error = "Unsupported JPEG frame, only 8-bit single frame images are supported";
+				return false;
+			}
+
+			decoder->progressive = marker == 0xC2;
+			decoder->height = ReadBigEndian16(segment + 1);
+			decoder->width = ReadBigEndian16(segment + 3);
+			UInt32 componentCount = segment[5];
+
+			if (decoder->width == 0 || decoder->height == 0 || (componentCount != 1 && componentCount != 3) || length < 8 + 3 * componentCount) {
+				error = "Unsupported JPEG frame, only gray and YCbCr images with a known size are supported";
+				return false;
+			}
+
+			if ((UInt64)decoder->width * decoder->height * 4 > 0xFFFFFFFFull) {
+				error = "JPEG is too large";
+				return false;
+			}
+
+			decoder->components.resize(componentCount);
+
+			for (UInt32 i = 0; i < componentCount; i++) {
+				Component& component = decoder->components[i];
+				const Byte* info = segment + 6 + 3 * i;
+				component.id = info[0];
+				component.h = info[1] >> 4;
+				component.v = info[1] & 15;
+				component.quantTable = info[2] & 3;
+
+				if (component.h == 0 || component.h > 4 || component.v == 0 || component.v > 4) {
+					error = "Invalid JPEG sampling factors";
+					return false;
+				}
+
+				decoder->maxH = std::max(decoder->maxH, component.h);
+				decoder->maxV = std::max(decoder->maxV, component.v);
+			}
+
+			decoder->mcusX = (decoder->width + 8 * decoder->maxH - 1) / (8 * decoder->maxH);
+			decoder->mcusY = (decoder->height + 8 * decoder->maxV - 1) / (8 * decoder->maxV);
+
+			for (auto& component : decoder->components) {
+				component.width = (decoder->width * component.h + decoder->maxH - 1) / decoder->maxH;
+				component.height = (decoder->height * component.v + decoder->maxV - 1) / decoder->maxV;
+				component.blocksPerLine = decoder->mcusX * component.h;
+				component.blocksPerColumn = decoder->mcusY * component.v;
+				component.coefficients.assign(64 * (size_t)component.blocksPerLine * component.blocksPerColumn, 0);
+			}
+
+			hasFrame = true;
+			break;
+		}
+		case 0xC3: case 0xC5: case 0xC6: case 0xC7:
+		case 0xC9: case 0xCA: case 0xCB: case 0xCD: case 0xCE: case 0xCF:
+			error = "Unsupported JPEG coding, only huffman baseline and progressive are supported";
+			return false;
+		case 0xDA: { // SOS
+			if (hasFrame == false) {
+				error = "JPEG scan before frame header";
+				return false;
+			}
+
+			UInt32 scanComponentCount = segment[0];
+
+			if (scanComponentCount == 0 || scanComponentCount > decoder->components.size() || length < 6 + 2 * scanComponentCount) {
+				error = "Corrupt JPEG scan header";
+				return false;
+			}
+
+			std::vector<Component*> scanComponents;
+
+			for (UInt32 i = 0; i < scanComponentCount; i++) {
+				UInt32 id = segment[1 + 2 * i];
+				UInt32 tables = segment[2 + 2 * i];
+				auto it = std::find_if(decoder->components.begin(), decoder->components.end(), [id](const Component& component) { return component.id == id; });
+
+				if (it == decoder->components.end()) {
+					error = "JPEG scan references an unknown component";
+					return false;
+				}
+
+				it->dcTable = (tables >> 4) & 3;
+				it->acTable = tables & 3;
+				scanComponents.push_back(&*it);
+			}
+
+			const Byte* parameters = segment + 1 + 2 * scanComponentCount;
+			decoder->spectralStart = parameters[0];
+			decoder->spectralEnd = std::min<UInt32>(parameters[1], 63);
+			decoder->approximationHigh = parameters[2] >> 4;
+			decoder->approximationLow = parameters[2] & 15;
+
+			decoder->reader.Reset(segmentEnd, end);
+
+			if (DecodeScan(*decoder, scanComponents) == false) {
+				error = "Corrupt JPEG entropy coded data";
+				return false;
+			}
+
+			position = decoder->reader.FindMarker();
+			continue;
+		}
+		default:
+			break;
+		}
+
+		position = segmentEnd;
+	}
+
+	if (hasFrame == false) {
+		error = "JPEG has no frame";
+		return false;
+	}
+
+	for (auto& component : decoder->components)
+		ReconstructPlane(*decoder, component);
+
+	image.Allocate(decoder->width, decoder->height, TextureFormat::RGBA32, 32, 4);
+	Byte* dest = image.pixels.get();
+
+	// nearest sample upsampling into a row buffer, full resolution planes are read in place
+	UInt32 componentCount = (UInt32)decoder->components.size();
+	std::vector<UInt32> columnOffsets[3];
+	std::vector<Byte> upsampledRows[3];
+
+	for (UInt32 c = 0; c < componentCount; c++) {
+		Component& component = decoder->components[c];
+
+		if (component.h == decoder->maxH)
+			continue;
+
+		columnOffsets[c].resize(decoder->width);
+		upsampledRows[c].resize(decoder->width);
+
+		for (UInt32 x = 0; x < decoder->width; x++)
+			columnOffsets[c][x] = x * component.h / decoder->maxH;
+	}
+
+	bool isYCbCr = componentCount == 3 && decoder->adobeTransform != 0;
+
+	for (UInt32 y = 0; y < decoder->height; y++) {
+		const Byte* rows[3];
+
+		for (UInt32 c = 0; c < componentCount; c++) {
+			Component& component = decoder->components[c];
+			const Byte* row = component.plane.data() + (size_t)(y * component.v / decoder->maxV) * component.blocksPerLine * 8;
+
+			if (upsampledRows[c].empty()) {
+				rows[c] = row;
+				continue;
+			}
+
+			for (UInt32 x = 0; x < decoder->width; x++)
+				upsampledRows[c][x] = row[columnOffsets[c][x]];
+
+			rows[c] = upsampledRows[c].data();
+		}
+
+		if (componentCount == 1) {
+			for (UInt32 x = 0; x < decoder->width; x++, dest += 4) {
+				dest[0] = dest[1] = dest[2] = rows[0][x];
+				dest[3] = 255;
+			}
+		}
+		else if (isYCbCr) {
+			UInt32 x = ConvertYCbCrRow(rows[0], rows[1], rows[2], dest, decoder->width);
+			dest += 4 * x;
+
+			for (; x < decoder->width; x++, dest += 4) {
+				Int32 luma = (rows[0][x] << 16) + 32768;
+				Int32 cb = rows[1][x] - 128;
+				Int32 cr = rows[2][x] - 128;
+
+				dest[0] = ClampToByte((luma + 91881 * cr) >> 16);
+				dest[1] = ClampToByte((luma - 22554 * cb - 46802 * cr) >> 16);
+				dest[2] = ClampToByte((luma + 116130 * cb) >> 16);
+				dest[3] = 255;
+			}
+		}
+		else {
+			for (UInt32 x = 0; x < decoder->width; x++, dest += 4) {
+				dest[0] = rows[0][x];
+				dest[1] = rows[1][x];
+				dest[2] = rows[2][x];
+				dest[3] = 255;
+			}
+		}
+	}
+
+	return true;
+}
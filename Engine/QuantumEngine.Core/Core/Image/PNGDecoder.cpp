@@ -0,0 +1,360 @@
+#include "ImageDecoders.h"
+#include "Inflate.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+	const Byte s_signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+	struct PassInfo {
+		UInt32 startX;
+		UInt32 startY;
+		UInt32 stepX;
+		UInt32 stepY;
+	};
+
+	const PassInfo s_adam7Passes[7] = {
+		{ 0, 0, 8, 8 }, { 4, 0, 8, 8 }, { 0, 4, 4, 8 }, { 2, 0, 4, 4 }, { 0, 2, 2, 4 }, { 1, 0, 2, 2 }, { 0, 1, 1, 2 },
+	};
+
+	struct PNGHeader {
+		UInt32 width = 0;
+		UInt32 height = 0;
+		UInt32 bitDepth = 0;
+		UInt32 colorType = 0;
+		UInt32 interlace = 0;
+		UInt32 channels = 0;
+
+		Byte palette[256][4];
+		UInt32 paletteSize = 0;
+		bool hasColorKey = false;
+		UInt16 colorKey[3] = {};
+	};
+
+	inline UInt32 ReadBigEndian32(const Byte* data)
+	{
+		return ((UInt32)data[0] << 24) | ((UInt32)data[1] << 16) | ((UInt32)data[2] << 8) | data[3];
+	}
+
+	inline Byte Paeth(Int32 a, Int32 b, Int32 c)
+	{
+		Int32 p = a + b - c;
+		Int32 pa = std::abs(p - a);
+		Int32 pb = std::abs(p - b);
+		Int32 pc = std::abs(p - c);
+
+		if (pa <= pb && pa <= pc)
+			return (Byte)a;
+
+		return (Byte)(pb <= pc ? b : c);
+	}
+
+	// reverses the per row filters in place, rows are rowBytes + 1 bytes with the filter type first
+	bool Unfilter(Byte* data, UInt32 rowBytes, UInt32 rows, UInt32 filterStride)
+	{
+		const Byte* previous = nullptr;
+
+		for (UInt32 y = 0; y < rows; y++) {
+			Byte filter = data[0];
+			Byte* row = data + 1;
+
+			switch (filter) {
+			case 0:
+				break;
+			case 1:
+				for (UInt32 i = filterStride; i < rowBytes; i++)
+					row[i] += row[i - filterStride];
+				break;
+			case 2:
+				if (previous != nullptr) {
+					for (UInt32 i = 0; i < rowBytes; i++)
+						row[i] += previous[i];
+				}
+				break;
+			case 3:
+				for (UInt32 i = 0; i < rowBytes; i++) {
+					UInt32 left = i >= filterStride ? row[i - filterStride] : 0;
+					UInt32 up = previous != nullptr ? previous[i] : 0;
+					row[i] += (Byte)((left + up) >> 1);
+				}
+				break;
+			case 4:
+				for (UInt32 i = 0; i < rowBytes; i++) {
+					Int32 left = i >= filterStride ? row[i - filterStride] : 0;
+					Int32 up = previous != nullptr ? previous[i] : 0;
+					Int32 upLeft = previous != nullptr && i >= filterStride ? previous[i - filterStride] : 0;
+					row[i] += Paeth(left, up, upLeft);
+				}
+				break;
+			default:
+				return false;
+			}
+
+			previous = row;
+			data += rowBytes + 1;
+		}
+
+		return true;
+	}
+
+	inline UInt32 ReadSample(const Byte* row, UInt32 index, UInt32 bitDepth)
+	{
+		if (bitDepth == 8)
+			return row[index];
+
+		if (bitDepth == 16)
+			return (row[2 * index] << 8) | row[2 * index + 1];
+
+		UInt32 bitOffset = index * bitDepth;
+		UInt32 shift = 8 - bitDepth - (bitOffset & 7);
+		return (row[bitOffset >> 3] >> shift) & ((1u << bitDepth) - 1);
+	}
+
+	// converts one unfiltered row of count pixels to RGBA32
+	void ConvertRow(const PNGHeader& header, const Byte* row, UInt32 count, Byte* dest)
+	{
+		UInt32 depth = header.bitDepth;
+
+		if (depth == 8 && header.colorType == 6) {
+			std::memcpy(dest, row, 4 * (size_t)count);
+			return;
+		}
+
+		if (depth == 8 && header.colorType == 2 && header.hasColorKey == false) {
+			QuantumEngine::Image::ExpandRGBToRGBA(row, dest, count);
+			return;
+		}
+
+		// scale from the sample range to 8 bits
+		UInt32 maxValue = (1u << depth) - 1;
+		auto to8Bit = [depth, maxValue](UInt32 value) -> Byte {
+			if (depth == 16)
+				return (Byte)(value >> 8);
+
+			return (Byte)(value * 255 / maxValue);
+		};
+
+		for (UInt32 x = 0; x < count; x++) {
+			Byte* pixel = dest + 4 * (size_t)x;
+
+			switch (header.colorType) {
+			case 0: {
+				UInt32 gray = ReadSample(row, x, depth);
+				pixel[0] = pixel[1] = pixel[2] = to8Bit(gray);
+				pixel[3] = header.hasColorKey && gray == header.colorKey[0] ? 0 : 255;
+				break;
+			}
+			case 2: {
+				UInt32 r = ReadSample(row, 3 * x, depth);
+				UInt32 g = ReadSample(row, 3 * x + 1, depth);
+				UInt32 b = ReadSample(row, 3 * x + 2, depth);
+				pixel[0] = to8Bit(r);
+				pixel[1] = to8Bit(g);
+				pixel[2] = to8Bit(b);
+				pixel[3] = header.hasColorKey && r == header.colorKey[0] && g == header.colorKey[1] && b == header.colorKey[2] ? 0 : 255;
+				break;
+			}
+			case 3: {
+				UInt32 index = ReadSample(row, x, depth);
+				std::memcpy(pixel, index < header.paletteSize ? header.palette[index] : header.palette[0], 4);
+				break;
+			}
+			case 4:
+				pixel[0] = pixel[1] = pixel[2] = to8Bit(ReadSample(row, 2 * x, depth));
+				pixel[3] = to8Bit(ReadSample(row, 2 * x + 1, depth));
+				break;
+			case 6:
+				pixel[0] = to8Bit(ReadSample(row, 4 * x, depth));
+				pixel[1] = to8Bit(ReadSample(row, 4 * x + 1, depth));
+				pixel[2] = to8Bit(ReadSample(row, 4 * x + 2, depth));
+				pixel[3] = to8Bit(ReadSample(row, 4 * x + 3, depth));
+				break;
+			}
+		}
+	}
+
+	inline UInt64 RowBytes(const PNGHeader& header, UInt32 width)
+	{
+		return ((UInt64)width * header.channels * header.bitDepth + 7) / 8;
+	}
+}
+
+bool QuantumEngine::Image::IsPNG(const Byte* data, UInt64 size)
+{
+	return size >= 8 && std::memcmp(data, s_signature, 8) == 0;
+}
+
+bool QuantumEngine::Image::DecodePNG(const Byte* data, UInt64 size, DecodedImage& image, std::string& error)
+{
+	if (IsPNG(data, size) == false) {
+		error = "Not a PNG file";
+		return false;
+	}
+
+	PNGHeader header;
+	std::memset(header.palette, 0, sizeof(header.palette));
+	std::vector<Byte> compressed;
+	bool hasHeader = false;
+	UInt64 offset = 8;
+
+	while (offset + 12 <= size) {
+		UInt32 length = ReadBigEndian32(data + offset);
+		const Byte* type = data + offset + 4;
+		const Byte* chunk = data + offset + 8;
+
+		if (length > size - offset - 12) {
+			error = "Truncated PNG chunk";
+			return false;
+		}
+
+		if (std::memcmp(type, "IHDR", 4) == 0 && length >= 13) {
+			header.width = ReadBigEndian32(chunk);
+			header.height = ReadBigEndian32(chunk + 4);
+			header.bitDepth = chunk[8];
+			header.colorType = chunk[9];
+			header.interlace = chunk[12];
+			hasHeader = true;
+		}
+		else if (std::memcmp(type, "PLTE", 4) == 0) {
+			header.paletteSize = std::min(length / 3, 256u);
+
+			for (UInt32 i = 0; i < header.paletteSize; i++) {
+				std::memcpy(header.palette[i], chunk + 3 * i, 3);
+				header.palette[i][3] = 255;
+			}
+		}
+		else if (std::memcmp(type, "tRNS", 4) == 0) {
+			if (header.colorType == 3) {
+				for (UInt32 i = 0; i < length && i < 256; i++)
+					header.palette[i][3] = chunk[i];
+			}
+			else if (header.colorType == 0 && length >= 2) {
+				header.hasColorKey = true;
+				header.colorKey[0] = (chunk[0] << 8) | chunk[1];
+			}
+			else if (header.colorType == 2 && length >= 6) {
+				header.hasColorKey = true;
+
+				for (UInt32 i = 0; i < 3; i++)
+					header.colorKey[i] = (chunk[2 * i] << 8) | chunk[2 * i + 1];
+			}
+		}
+		else if (std::memcmp(type, "IDAT", 4) == 0) {
+			compressed.insert(compressed.end(), chunk, chunk + length);
+		}
+		else if (std::memcmp(type, "IEND", 4) == 0) {
+			break;
+		}
+
+		offset += 12 + (UInt64)length;
+	}
+
+	if (hasHeader == false || header.width == 0 || header.height == 0) {
+		error = "PNG has no valid IHDR chunk";
+		return false;
+	}
+
+	switch (header.colorType) {
+	case 0: header.channels = 1; break;
+	case 2: header.channels = 3; break;
+	case 3: header.channels = 1; break;
+	case 4: header.channels = 2; break;
+	case 6: header.channels = 4; break;
+	default:
+		error = "Unknown PNG color type";
+		return false;
+	}
+
+	bool validDepth = header.bitDepth == 8 || header.bitDepth == 16
+		|| ((header.colorType == 0 || header.colorType == 3) && (header.bitDepth == 1 || header.bitDepth == 2 || header.bitDepth == 4));
+
+	if (validDepth == false || (header.colorType == 3 && header.bitDepth == 16)) {
+		error = "Invalid PNG bit depth";
+		return false;
+	}
+
+	if (header.colorType == 3 && header.paletteSize == 0) {
+		error = "PNG palette is missing";
+		return false;
+	}
+
+	if ((UInt64)header.width * header.height * 4 > 0xFFFFFFFFull) {
+		error = "PNG is too large";
+		return false;
+	}
+
+	UInt32 filterStride = std::max(1u, header.channels * header.bitDepth / 8);
+	UInt64 rawSize = 0;
+
+	if (header.interlace == 0) {
+		rawSize = (RowBytes(header, header.width) + 1) * header.height;
+	}
+	else {
+		for (auto& pass : s_adam7Passes) {
+			UInt64 passWidth = (header.width + pass.stepX - 1 - pass.startX) / pass.stepX;
+			UInt64 passHeight = (header.height + pass.stepY - 1 - pass.startY) / pass.stepY;
+
+			if (header.width > pass.startX && header.height > pass.startY)
+				rawSize += (RowBytes(header, (UInt32)passWidth) + 1) * passHeight;
+		}
+	}
+
+	std::vector<Byte> raw;
+
+	if (Image::InflateZlib(compressed.data(), compressed.size(), raw, rawSize, error) == false)
+		return false;
+
+	if (raw.size() < rawSize) {
+		error = "PNG image data is truncated";
+		return false;
+	}
+
+	image.Allocate(header.width, header.height, TextureFormat::RGBA32, 32, 4);
+	UInt32 destStride = 4 * header.width;
+
+	if (header.interlace == 0) {
+		UInt32 rowBytes = (UInt32)RowBytes(header, header.width);
+
+		if (Unfilter(raw.data(), rowBytes, header.height, filterStride) == false) {
+			error = "Invalid PNG filter type";
+			return false;
+		}
+
+		for (UInt32 y = 0; y < header.height; y++)
+			ConvertRow(header, raw.data() + (size_t)y * (rowBytes + 1) + 1, header.width, image.pixels.get() + (size_t)y * destStride);
+
+		return true;
+	}
+
+	// Adam7: every pass is a small image of its own, scattered into the final one
+	Byte* passData = raw.data();
+	std::vector<Byte> passRow(4 * (size_t)header.width);
+
+	for (auto& pass : s_adam7Passes) {
+		if (header.width <= pass.startX || header.height <= pass.startY)
+			continue;
+
+		UInt32 passWidth = (header.width + pass.stepX - 1 - pass.startX) / pass.stepX;
+		UInt32 passHeight = (header.height + pass.stepY - 1 - pass.startY) / pass.stepY;
+		UInt32 rowBytes = (UInt32)RowBytes(header, passWidth);
+
+		if (Unfilter(passData, rowBytes, passHeight, filterStride) == false) {
+			error = "Invalid PNG filter type";
+			return false;
+		}
+
+		for (UInt32 y = 0; y < passHeight; y++) {
+			ConvertRow(header, passData + (size_t)y * (rowBytes + 1) + 1, passWidth, passRow.data());
+			Byte* destRow = image.pixels.get() + (size_t)(pass.startY + y * pass.stepY) * destStride;
+
+			for (UInt32 x = 0; x < passWidth; x++)
+				std::memcpy(destRow + 4 * (size_t)(pass.startX + x * pass.stepX), passRow.data() + 4 * (size_t)x, 4);
+		}
+
+		passData += (size_t)(rowBytes + 1) * passHeight;
+	}
+
+	return true;
+}
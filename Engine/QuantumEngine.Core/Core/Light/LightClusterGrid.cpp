@@ -0,0 +1,377 @@
+#include "LightClusterGrid.h"
+#include "../Matrix4.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// the shaders load the lights with these strides
+static_assert(sizeof(QuantumEngine::DirectionalLight) == 32, "DirectionalLight doesn't match LightStructs.hlsli");
+static_assert(sizeof(QuantumEngine::PointLight) == 48, "PointLight doesn't match LightStructs.hlsli");
+static_assert(sizeof(QuantumEngine::LightBufferHeader) == 128, "LightBufferHeader doesn't match LightStructs.hlsli");
+static_assert(sizeof(QuantumEngine::LightAliasEntry) == 16, "LightAliasEntry doesn't match LightStructs.hlsli");
+
+namespace {
+	constexpr UInt32 SectionAlignment = 16;
+
+	UInt32 AlignSection(UInt32 offset)
+	{
+		return (offset + SectionAlignment - 1) & ~(SectionAlignment - 1);
+	}
+
+	UInt32 ClampedIndex(Float value, UInt32 count)
+	{
+		return (UInt32)std::clamp((Int32)std::floor(value), 0, (Int32)count - 1);
+	}
+
+	Float DistanceToRange(Float value, Float low, Float high)
+	{
+		if (value < low)
+			return low - value;
+
+		if (value > high)
+			return value - high;
+
+		return 0.0f;
+	}
+
+	// has to match PointLightPower in LightStructs.hlsli
+	Float PointLightPower(const QuantumEngine::PointLight& light)
+	{
+		QuantumEngine::Color color = light.color;
+		Float* rgb = color.GetColorArray();
+		return std::max(light.intensity, 0.0f) * std::max(0.2126f * rgb[0] + 0.7152f * rgb[1] + 0.0722f * rgb[2], 0.0f);
+	}
+
+	// Vose's alias method, lights without power are never picked unless no light has any
+	void BuildAliasTable(const QuantumEngine::PointLight* lights, UInt32 count, std::vector<QuantumEngine::LightAliasEntry>& table)
+	{
+		std::vector<Float> scaled(count);
+		std::vector<UInt32> small;
+		std::vector<UInt32> large;
+		Float totalPower = 0.0f;
+
+		for (UInt32 i = 0; i < count; i++) {
+			scaled[i] = PointLightPower(lights[i]);
+			totalPower += scaled[i];
+		}
+
+		if (totalPower <= 0.0f) {
+			std::fill(scaled.begin(), scaled.end(), 1.0f);
+			totalPower = (Float)count;
+		}
+
+		table.resize(count);
+
+		for (UInt32 i = 0; i < count; i++) {
+			table[i].pdf = scaled[i] / totalPower;
+			scaled[i] = table[i].pdf * count;
+			(scaled[i] < 1.0f ? small : large).push_back(i);
+		}
+
+		while (small.empty() == false && large.empty() == false) {
+			UInt32 lower = small.back();
+			UInt32 upper = large.back();
+			small.pop_back();
+			large.pop_back();
+
+			table[lower].threshold = scaled[lower];
+			table[lower].alias = upper;
+			scaled[upper] += scaled[lower] - 1.0f;
+			(scaled[upper] < 1.0f ? small : large).push_back(upper);
+		}
+
+		// leftovers are only below 1 by rounding
+		for (UInt32 i : small) {
+			table[i].threshold = 1.0f;
+			table[i].alias = i;
+		}
+
+		for (UInt32 i : large) {
+			table[i].threshold = 1.0f;
+			table[i].alias = i;
+		}
+
+		for (auto& entry : table)
+			entry.aliasPdf = table[entry.alias].pdf;
+	}
+}
+
+QuantumEngine::LightClusterGrid::LightClusterGrid(const LightClusterProperties& properties)
+	:m_properties(properties), m_header{}
+{
+	m_properties.clusterCountX = std::max(m_properties.clusterCountX, 1u);
+	m_properties.clusterCountY = std::max(m_properties.clusterCountY, 1u);
+	m_properties.clusterCountZ = std::max(m_properties.clusterCountZ, 1u);
+	m_properties.maxLightsPerCluster = std::max(m_properties.maxLightsPerCluster, 1u);
+}
+
+void QuantumEngine::LightClusterGrid::Initialize(const SceneLightData& lights)
+{
+	m_directionalLightCount = (UInt32)lights.directionalLights.size();
+	m_pointLightCount = (UInt32)lights.pointLights.size();
+	m_isBuilt = false;
+}
+
+UInt32 QuantumEngine::LightClusterGrid::GetBufferSize() const
+{
+	LightBufferHeader header;
+	FillLayout(header, SceneLightData{});
+	return header.lightIndexOffset + std::max(GetLightIndexCapacity(), 1u) * sizeof(UInt32);
+}
+
+bool QuantumEngine::LightClusterGrid::Build(const SceneLightData& lights, const Matrix4& viewMatrix, const Matrix4& projectionMatrix)
+{
+	Float view[16];
+	Float projection[16];
+
+	for (UInt32 i = 0; i < 16; i++) {
+		view[i] = viewMatrix(i / 4, i % 4);
+		projection[i] = projectionMatrix(i / 4, i % 4);
+	}
+
+	const UInt32 pointLightCount = GetPointLightCount(lights);
+
+	if (m_isBuilt == false || lights.HasModifiedLights())
+		BuildAliasTable(lights.pointLights.data(), pointLightCount, m_aliasTable);
+
+	if (m_isBuilt && lights.HasModifiedLights() == false &&
+		std::memcmp(view, m_lastView, sizeof(view)) == 0 && std::memcmp(projection, m_lastProjection, sizeof(projection)) == 0)
+		return false;
+
+	std::memcpy(m_lastView, view, sizeof(view));
+	std::memcpy(m_lastProjection, projection, sizeof(projection));
+	m_isBuilt = true;
+
+	const UInt32 countX = m_properties.clusterCountX;
+	const UInt32 countY = m_properties.clusterCountY;
+	const UInt32 countZ = m_properties.clusterCountZ;
+	const UInt32 clusterCount = GetClusterCount();
+
+	FillLayout(m_header, lights);
+	FillAmbient(m_header, lights);
+	m_clusters.assign(2 * clusterCount, 0);
+	m_lightIndices.clear();
+	m_pairs.clear();
+
+	for (UInt32 row = 0; row < 3; row++) {
+		for (UInt32 column = 0; column < 4; column++)
+			m_header.viewRows[4 * row + column] = viewMatrix(row, column);
+	}
+
+	// recover the planes from the z row of Matrix4::PerspectiveProjection
+	Float a = projectionMatrix(2, 2);
+	Float b = projectionMatrix(2, 3);
+	Float nearZ = a != 0.0f ? -b / a : 0.0f;
+	Float farZ = a != 1.0f ? b / (1.0f - a) : 0.0f;
+
+	if (nearZ <= 0.0f || farZ <= nearZ) {
+		// no usable frustum, an empty depth range makes every shaded point fall back to all lights
+		m_header.nearZ = 1.0f;
+		m_header.farZ = 0.0f;
+		return true;
+	}
+
+	Float logRatio = std::log(farZ / nearZ);
+	m_header.nearZ = nearZ;
+	m_header.farZ = farZ;
+	m_header.depthScale = countZ / logRatio;
+	m_header.depthBias = -(Float)countZ * std::log(nearZ) / logRatio;
+	m_header.projectionScaleX = projectionMatrix(0, 0);
+	m_header.projectionScaleY = projectionMatrix(1, 1);
+
+	m_sliceDepths.resize(countZ + 1);
+	for (UInt32 z = 0; z <= countZ; z++)
+		m_sliceDepths[z] = nearZ * std::pow(farZ / nearZ, (Float)z / countZ);
+
+	const Float scaleX = m_header.projectionScaleX;
+	const Float scaleY = m_header.projectionScaleY;
+
+	for (UInt32 lightIndex = 0; lightIndex < pointLightCount; lightIndex++) {
+		const PointLight& light = lights.pointLights[lightIndex];
+		const Float* view = m_header.viewRows;
+		Float cx = view[0] * light.position.x + view[1] * light.position.y + view[2] * light.position.z + view[3];
+		Float cy = view[4] * light.position.x + view[5] * light.position.y + view[6] * light.position.z + view[7];
+		Float cz = view[8] * light.position.x + view[9] * light.position.y + view[10] * light.position.z + view[11];
+		Float radius = light.radius;
+
+		Float zMin = std::max(cz - radius, nearZ);
+		Float zMax = std::min(cz + radius, farZ);
+
+		if (zMin > zMax)
+			continue;
+
+		// x / z is monotonic in z, so the corners of the box around the sphere bound its projection
+		Float lowX = scaleX * std::min((cx - radius) / zMin, (cx - radius) / zMax);
+		Float highX = scaleX * std::max((cx + radius) / zMin, (cx + radius) / zMax);
+		Float lowY = scaleY * std::min((cy - radius) / zMin, (cy - radius) / zMax);
+		Float highY = scaleY * std::max((cy + radius) / zMin, (cy + radius) / zMax);
+
+		if (highX < -1.0f || lowX > 1.0f || highY < -1.0f || lowY > 1.0f)
+			continue;
+
+		UInt32 firstX = ClampedIndex((lowX * 0.5f + 0.5f) * countX, countX);
+		UInt32 lastX = ClampedIndex((highX * 0.5f + 0.5f) * countX, countX);
+		UInt32 firstY = ClampedIndex((lowY * 0.5f + 0.5f) * countY, countY);
+		UInt32 lastY = ClampedIndex((highY * 0.5f + 0.5f) * countY, countY);
+		UInt32 firstZ = ClampedIndex(std::log(zMin) * m_header.depthScale + m_header.depthBias, countZ);
+		UInt32 lastZ = ClampedIndex(std::log(zMax) * m_header.depthScale + m_header.depthBias, countZ);
+		Float radiusSquared = radius * radius;
+
+		// refine the candidate range with a sphere test against the view space bounds of every cluster
+		for (UInt32 z = firstZ; z <= lastZ; z++) {
+			Float z0 = m_sliceDepths[z];
+			Float z1 = m_sliceDepths[z + 1];
+			Float dz = DistanceToRange(cz, z0, z1);
+
+			for (UInt32 y = firstY; y <= lastY; y++) {
+				Float ndcY0 = 2.0f * y / countY - 1.0f;
+				Float ndcY1 = 2.0f * (y + 1) / countY - 1.0f;
+				Float dy = DistanceToRange(cy, std::min(ndcY0 * z0, ndcY0 * z1) / scaleY, std::max(ndcY1 * z0, ndcY1 * z1) / scaleY);
+
+				for (UInt32 x = firstX; x <= lastX; x++) {
+					Float ndcX0 = 2.0f * x / countX - 1.0f;
+					Float ndcX1 = 2.0f * (x + 1) / countX - 1.0f;
+					Float dx = DistanceToRange(cx, std::min(ndcX0 * z0, ndcX0 * z1) / scaleX, std::max(ndcX1 * z0, ndcX1 * z1) / scaleX);
+
+					if (dx * dx + dy * dy + dz * dz <= radiusSquared)
+						m_pairs.emplace_back((z * countY + y) * countX + x, lightIndex);
+				}
+			}
+		}
+	}
+
+	// counting sort by cluster, pairs are in light order so every cluster list stays sorted
+	m_clusterCounts.assign(clusterCount, 0);
+	for (auto& pair : m_pairs)
+		m_clusterCounts[pair.first]++;
+
+	// every cluster fits in its share of GetLightIndexCapacity
+	const UInt32 maxCount = std::min(pointLightCount, m_properties.maxLightsPerCluster);
+	UInt32 offset = 0;
+
+	for (UInt32 cluster = 0; cluster < clusterCount; cluster++) {
+		UInt32 count = std::min(m_clusterCounts[cluster], maxCount);
+		m_clusters[2 * cluster] = offset;
+		m_clusters[2 * cluster + 1] = count;
+		m_clusterCounts[cluster] = 0;
+		offset += count;
+	}
+
+	m_lightIndices.resize(offset);
+
+	for (auto& pair : m_pairs) {
+		UInt32& filled = m_clusterCounts[pair.first];
+
+		if (filled < m_clusters[2 * pair.first + 1]) {
+			m_lightIndices[m_clusters[2 * pair.first] + filled] = pair.second;
+			filled++;
+		}
+	}
+
+	return true;
+}
+
+void QuantumEngine::LightClusterGrid::Write(const SceneLightData& lights, Byte* dest) const
+{
+	LightBufferHeader header = m_header;
+	FillLayout(header, lights);
+	FillAmbient(header, lights);
+
+	std::memcpy(dest + header.directionalLightOffset, lights.directionalLights.data(), header.directionalLightCount * sizeof(DirectionalLight));
+	std::memcpy(dest + header.pointLightOffset, lights.pointLights.data(), header.pointLightCount * sizeof(PointLight));
+
+	// Write may come before the first build
+	std::vector<LightAliasEntry> aliasTable;
+	BuildAliasTable(lights.pointLights.data(), header.pointLightCount, aliasTable);
+	std::memcpy(dest + header.aliasTableOffset, aliasTable.data(), aliasTable.size() * sizeof(LightAliasEntry));
+	WriteClusters(header, dest);
+}
+
+void QuantumEngine::LightClusterGrid::WriteModified(const SceneLightData& lights, Byte* dest, bool clustersChanged) const
+{
+	LightBufferHeader header = m_header;
+	FillLayout(header, lights);
+
+	lights.ForEachModifiedDirectionalLight([&](UInt32 index) {
+		if (index >= header.directionalLightCount)
+			return;
+
+		std::memcpy(dest + header.directionalLightOffset + index * sizeof(DirectionalLight), &lights.directionalLights[index], sizeof(DirectionalLight));
+		});
+
+	lights.ForEachModifiedPointLight([&](UInt32 index) {
+		if (index >= header.pointLightCount)
+			return;
+
+		std::memcpy(dest + header.pointLightOffset + index * sizeof(PointLight), &lights.pointLights[index], sizeof(PointLight));
+		});
+
+	if (lights.HasModifiedLights())
+		std::memcpy(dest + header.aliasTableOffset, m_aliasTable.data(), m_aliasTable.size() * sizeof(LightAliasEntry));
+
+	if (clustersChanged)
+		WriteClusters(header, dest);
+}
+
+UInt32 QuantumEngine::LightClusterGrid::GetClusterCount() const
+{
+	return m_properties.clusterCountX * m_properties.clusterCountY * m_properties.clusterCountZ;
+}
+
+UInt32 QuantumEngine::LightClusterGrid::GetLightIndexCapacity() const
+{
+	return GetClusterCount() * std::min(m_pointLightCount, m_properties.maxLightsPerCluster);
+}
+
+UInt32 QuantumEngine::LightClusterGrid::GetDirectionalLightCount(const SceneLightData& lights) const
+{
+	return std::min((UInt32)lights.directionalLights.size(), m_directionalLightCount);
+}
+
+UInt32 QuantumEngine::LightClusterGrid::GetPointLightCount(const SceneLightData& lights) const
+{
+	return std::min((UInt32)lights.pointLights.size(), m_pointLightCount);
+}
+
+void QuantumEngine::LightClusterGrid::FillLayout(LightBufferHeader& header, const SceneLightData& lights) const
+{
+	// sections are placed for the counts of Initialize, so lights removed later don't move them
+	header.directionalLightCount = GetDirectionalLightCount(lights);
+	header.pointLightCount = GetPointLightCount(lights);
+	header.clusterCountX = m_properties.clusterCountX;
+	header.clusterCountY = m_properties.clusterCountY;
+	header.clusterCountZ = m_properties.clusterCountZ;
+	header.directionalLightOffset = AlignSection(sizeof(LightBufferHeader));
+	header.pointLightOffset = AlignSection(header.directionalLightOffset + m_directionalLightCount * sizeof(DirectionalLight));
+	header.aliasTableOffset = AlignSection(header.pointLightOffset + m_pointLightCount * sizeof(PointLight));
+	header.clusterOffset = AlignSection(header.aliasTableOffset + m_pointLightCount * sizeof(LightAliasEntry));
+	header.lightIndexOffset = AlignSection(header.clusterOffset + 2 * GetClusterCount() * sizeof(UInt32));
+}
+
+void QuantumEngine::LightClusterGrid::WriteClusters(const LightBufferHeader& header, Byte* dest) const
+{
+	std::memcpy(dest, &header, sizeof(LightBufferHeader));
+
+	if (m_clusters.size() == 2 * GetClusterCount())
+		std::memcpy(dest + header.clusterOffset, m_clusters.data(), m_clusters.size() * sizeof(UInt32));
+	else
+		std::memset(dest + header.clusterOffset, 0, 2 * GetClusterCount() * sizeof(UInt32));
+
+	std::memcpy(dest + header.lightIndexOffset, m_lightIndices.data(), m_lightIndices.size() * sizeof(UInt32));
+}
+
+void QuantumEngine::LightClusterGrid::FillAmbient(LightBufferHeader& header, const SceneLightData& lights) const
+{
+	header.pointLightAmbient[0] = 0.0f;
+	header.pointLightAmbient[1] = 0.0f;
+	header.pointLightAmbient[2] = 0.0f;
+	header.padding = 0;
+
+	for (UInt32 lightIndex = 0; lightIndex < GetPointLightCount(lights); lightIndex++) {
+		Color color = lights.pointLights[lightIndex].color;
+		Float* rgb = color.GetColorArray();
+
+		for (UInt32 i = 0; i < 3; i++)
+			header.pointLightAmbient[i] += rgb[i];
+	}
+}
@@ -0,0 +1,123 @@
+#pragma once
+#include <utility>
+#include <vector>
+#include "../../BasicTypes.h"
+#include "Lights.h"
+
+namespace QuantumEngine {
+	struct Matrix4;
+
+	struct LightClusterProperties {
+		UInt32 clusterCountX = 16;
+		UInt32 clusterCountY = 9;
+		// depth slices are spaced exponentially between the near and far planes
+		UInt32 clusterCountZ = 24;
+		// clusters reached by more point lights keep the ones with the lowest indices
+		UInt32 maxLightsPerCluster = 64;
+	};
+
+	/// <summary>
+	/// Header of the light buffer read by LightStructs.hlsli, offsets are in bytes from the start of the buffer
+	/// </summary>
+	struct LightBufferHeader {
+		UInt32 directionalLightCount;
+		UInt32 pointLightCount;
+		UInt32 directionalLightOffset;
+		UInt32 pointLightOffset;
+		UInt32 clusterOffset;
+		UInt32 lightIndexOffset;
+		UInt32 clusterCountX;
+		UInt32 clusterCountY;
+		UInt32 clusterCountZ;
+		Float depthScale;
+		Float depthBias;
+		Float projectionScaleX;
+		Float projectionScaleY;
+		Float nearZ;
+		Float farZ;
+		UInt32 aliasTableOffset;
+		// first three rows of the view matrix the clusters were built with
+		Float viewRows[12];
+		// sum of the point light colors, every point light adds its ambient term whether it reaches a cluster or not
+		Float pointLightAmbient[3];
+		UInt32 padding;
+	};
+
+	/// <summary>
+	/// Entry of the alias table picking point lights proportional to their power, one per point light.
+	/// A uniform slot keeps its own light below the threshold and takes the alias above it
+	/// </summary>
+	struct LightAliasEntry {
+		Float threshold;
+		UInt32 alias;
+		// probabilities of picking the light of the slot and its alias
+		Float pdf;
+		Float aliasPdf;
+	};
+
+	/// <summary>
+	/// Froxel grid over the view frustum holding the point lights touching every cluster.
+	/// Directional lights affect every cluster and are not assigned.
+	/// The buffer holds the header, all lights, the power alias table of the point lights, one (offset, count) pair per cluster
+	/// and the light index list, so shaders only loop over the point lights of the cluster they are shading
+	/// and can sample a bounded number of lights where there are too many
+	/// </summary>
+	class LightClusterGrid {
+	public:
+		LightClusterGrid(const LightClusterProperties& properties = {});
+
+		/// <summary>
+		/// captures the light counts the buffer is sized for. Lights added to the scene later are ignored
+		/// </summary>
+		void Initialize(const SceneLightData& lights);
+
+		/// <summary>
+		/// size of the buffer Write needs for the light counts of Initialize
+		/// </summary>
+		UInt32 GetBufferSize() const;
+
+		/// <summary>
+		/// assigns the point lights to the clusters of the camera frustum. Skipped when neither the matrices
+		/// nor any light changed since the last build. The alias table is rebuilt with the clusters when the lights changed
+		/// </summary>
+		/// <returns>true if the clusters were rebuilt</returns>
+		bool Build(const SceneLightData& lights, const Matrix4& viewMatrix, const Matrix4& projectionMatrix);
+
+		/// <summary>
+		/// writes the lights and the last built clusters, GetBufferSize bytes for the same light counts
+		/// </summary>
+		void Write(const SceneLightData& lights, Byte* dest) const;
+
+		/// <summary>
+		/// updates a buffer filled by Write with the lights modified since their last clear and the alias table built for them,
+		/// and the clusters if clustersChanged
+		/// </summary>
+		void WriteModified(const SceneLightData& lights, Byte* dest, bool clustersChanged) const;
+	private:
+		UInt32 GetClusterCount() const;
+		UInt32 GetLightIndexCapacity() const;
+		UInt32 GetDirectionalLightCount(const SceneLightData& lights) const;
+		UInt32 GetPointLightCount(const SceneLightData& lights) const;
+		void FillLayout(LightBufferHeader& header, const SceneLightData& lights) const;
+		void WriteClusters(const LightBufferHeader& header, Byte* dest) const;
+		void FillAmbient(LightBufferHeader& header, const SceneLightData& lights) const;
+
+		LightClusterProperties m_properties;
+		// light counts the buffer layout is fixed to
+		UInt32 m_directionalLightCount = 0;
+		UInt32 m_pointLightCount = 0;
+		LightBufferHeader m_header;
+		// (offset, count) into m_lightIndices for every cluster
+		std::vector<UInt32> m_clusters;
+		std::vector<UInt32> m_lightIndices;
+		// (cluster, light) pairs of the current build, kept to avoid reallocating every frame
+		std::vector<std::pair<UInt32, UInt32>> m_pairs;
+		std::vector<UInt32> m_clusterCounts;
+		std::vector<Float> m_sliceDepths;
+		std::vector<LightAliasEntry> m_aliasTable;
+		// matrices of the last build
+		Float m_lastView[16];
+		Float m_lastProjection[16];
+		bool m_isBuilt = false;
+	};
+}
@@ -1,4 +1,7 @@
 #pragma once
+#include <algorithm>
+#include <bit>
+#include <vector>
 #include "../Vector3.h"
 #include "../Color.h"
 #include "../Vector2.h"
@@ -24,8 +27,81 @@ namespace QuantumEngine {
 		float radius = 1.0f;
 	};
 
+	/// <summary>
+	/// Lights of a scene. The lists are filled before the scene is prepared, later changes go through the setters
+	/// so renderers only upload the modified lights. The light counts are fixed once the scene is prepared, renderers ignore lights added later
+	/// </summary>
 	struct SceneLightData {
 		std::vector<DirectionalLight> directionalLights;
 		std::vector<PointLight> pointLights;
+
+		inline const DirectionalLight& GetDirectionalLight(UInt32 index) const { return directionalLights[index]; }
+		inline const PointLight& GetPointLight(UInt32 index) const { return pointLights[index]; }
+
+		void SetDirectionalLight(UInt32 index, const DirectionalLight& light) {
+			directionalLights[index] = light;
+			MarkModified(m_modifiedDirectionalLights, index);
+		}
+
+		void SetPointLight(UInt32 index, const PointLight& light) {
+			pointLights[index] = light;
+			MarkModified(m_modifiedPointLights, index);
+		}
+
+		void SetPointLightPosition(UInt32 index, const Vector3& position) {
+			pointLights[index].position = position;
+			MarkModified(m_modifiedPointLights, index);
+		}
+
+		void SetPointLightColor(UInt32 index, const Color& color, Float intensity) {
+			pointLights[index].color = color;
+			pointLights[index].intensity = intensity;
+			MarkModified(m_modifiedPointLights, index);
+		}
+
+		inline bool HasModifiedLights() const { return m_hasModifiedLights; }
+
+		/// <summary>
+		/// calls function(UInt32 index) for every directional light set since the last clear
+		/// </summary>
+		template<typename Function>
+		void ForEachModifiedDirectionalLight(const Function& function) const {
+			ForEachBit(m_modifiedDirectionalLights, function);
+		}
+
+		/// <summary>
+		/// calls function(UInt32 index) for every point light set since the last clear
+		/// </summary>
+		template<typename Function>
+		void ForEachModifiedPointLight(const Function& function) const {
+			ForEachBit(m_modifiedPointLights, function);
+		}
+
+		void ClearModifiedLights() {
+			std::fill(m_modifiedDirectionalLights.begin(), m_modifiedDirectionalLights.end(), 0);
+			std::fill(m_modifiedPointLights.begin(), m_modifiedPointLights.end(), 0);
+			m_hasModifiedLights = false;
+		}
+
+	private:
+		void MarkModified(std::vector<UInt64>& bits, UInt32 index) {
+			if (bits.size() <= index / 64)
+				bits.resize(index / 64 + 1, 0);
+
+			bits[index / 64] |= 1ull << (index % 64);
+			m_hasModifiedLights = true;
+		}
+
+		template<typename Function>
+		static void ForEachBit(const std::vector<UInt64>& bits, const Function& function) {
+			for (UInt32 word = 0; word < bits.size(); word++) {
+				for (UInt64 remaining = bits[word]; remaining != 0; remaining &= remaining - 1)
+					function(word * 64 + (UInt32)std::countr_zero(remaining));
+			}
+		}
+
+		std::vector<UInt64> m_modifiedDirectionalLights;
+		std::vector<UInt64> m_modifiedPointLights;
+		bool m_hasModifiedLights = false;
 	};
 }
\ No newline at end of file
@@ -1,6 +1,11 @@
 #include "Matrix4.h"
 #include "Vector3.h"
 
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#include <xmmintrin.h>
+#define QE_MATRIX_SSE
+#endif
+
 QuantumEngine::Matrix4::Matrix4(const std::initializer_list<Float>& values)
 {
 	std::copy(values.begin(), values.end(), m_values);
@@ -16,7 +21,7 @@ QuantumEngine::Matrix4::Matrix4()
 {
 }
 
-QuantumEngine::Matrix4 QuantumEngine::Matrix4::operator*(const Matrix4& matrixB)
+QuantumEngine::Matrix4 QuantumEngine::Matrix4::operator*(const Matrix4& matrixB) const
 {
 	Float newMat[16];
 
@@ -39,13 +44,47 @@ QuantumEngine::Matrix4 QuantumEngine::Matrix4::operator*(const Matrix4& matrixB)
 	return mat;
 }
 
-QuantumEngine::Vector3 QuantumEngine::Matrix4::operator*(const Vector3& vector)
+QuantumEngine::Vector3 QuantumEngine::Matrix4::operator*(const Vector3& vector) const
 {
 	return Vector3(m_values[0] * vector.x + m_values[1] * vector.y + m_values[2] * vector.z,
 		m_values[4] * vector.x + m_values[5] * vector.y + m_values[6] * vector.z,
 		m_values[8] * vector.x + m_values[9] * vector.y + m_values[10] * vector.z);
 }
 
+void QuantumEngine::Matrix4::TransformVectors(const Float* source, UInt32 sourceStride, Float* dest, UInt32 destStride, UInt32 count) const
+{
+	const Byte* src = (const Byte*)source;
+	Byte* dst = (Byte*)dest;
+
+#ifdef QE_MATRIX_SSE
+	// columns of the upper 3x3, the result is x * c0 + y * c1 + z * c2
+	__m128 c0 = _mm_setr_ps(m_values[0], m_values[4], m_values[8], 0.0f);
+	__m128 c1 = _mm_setr_ps(m_values[1], m_values[5], m_values[9], 0.0f);
+	__m128 c2 = _mm_setr_ps(m_values[2], m_values[6], m_values[10], 0.0f);
+
+	for (UInt32 i = 0; i < count; i++) {
+		const Float* v = (const Float*)(src + (size_t)i * sourceStride);
+		Float* out = (Float*)(dst + (size_t)i * destStride);
+
+		__m128 result = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(v[0])), _mm_mul_ps(c1, _mm_set1_ps(v[1]))), _mm_mul_ps(c2, _mm_set1_ps(v[2])));
+
+		// only three floats may be written, dest is usually a field inside a bigger struct
+		_mm_storel_pi((__m64*)out, result);
+		_mm_store_ss(out + 2, _mm_movehl_ps(result, result));
+	}
+#else
+	for (UInt32 i = 0; i < count; i++) {
+		const Float* v = (const Float*)(src + (size_t)i * sourceStride);
+		Float* out = (Float*)(dst + (size_t)i * destStride);
+		Float x = v[0], y = v[1], z = v[2];
+
+		out[0] = m_values[0] * x + m_values[1] * y + m_values[2] * z;
+		out[1] = m_values[4] * x + m_values[5] * y + m_values[6] * z;
+		out[2] = m_values[8] * x + m_values[9] * y + m_values[10] * z;
+	}
+#endif
+}
+
 QuantumEngine::Matrix4 QuantumEngine::Matrix4::Scale(const Vector3& scale)
 {
 	return Matrix4{
@@ -9,14 +9,20 @@ namespace QuantumEngine {
 	public:
 		Matrix4(const std::initializer_list<Float>& values);
 		Matrix4();
-		Matrix4 operator*(const Matrix4& matrixB);
-		Vector3 operator*(const Vector3& matrixB);
+		Matrix4 operator*(const Matrix4& matrixB) const;
+		Vector3 operator*(const Vector3& matrixB) const;
+
+		/// <summary>
+		/// Batched operator*(Vector3) over strided float3 arrays, translation is ignored the same way.
+		/// Strides are in bytes, source and dest may alias
+		/// </summary>
+		void TransformVectors(const Float* source, UInt32 sourceStride, Float* dest, UInt32 destStride, UInt32 count) const;
 		static Matrix4 Scale(const Vector3& scale);
 		static Matrix4 Translate(const Vector3& translate);
 		static Matrix4 Rotate(const Vector3& axis, Float angleDeg);
 		static Matrix4 PerspectiveProjection(Float near, Float far, Float acpect, Float FOV);
 		static Matrix4 InversePerspectiveProjection(Float near, Float far, Float acpect, Float FOV);
-		Float operator()(UInt8 x, UInt8 y) { return m_values[4 * x + y]; }
+		Float operator()(UInt8 x, UInt8 y) const { return m_values[4 * x + y]; }
 		void SetValue(UInt8 x, UInt8 y, Float value) { m_values[4 * x + y] = value; }
 	private:
 		Float m_values[16];
@@ -1,9 +1,52 @@
 #include "Mesh.h"
+#include "HalfFloat.h"
+#include "Transform.h"
+#include "Camera/Camera.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+	Int16 PackSNorm16(Float value)
+	{
+		value = std::clamp(value, -1.0f, 1.0f);
+		return (Int16)std::lround(value * 32767.0f);
+	}
+
+	void PackOctahedral(const QuantumEngine::Vector3& normal, Int16* dest)
+	{
+		Float l1 = std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
+
+		if (l1 == 0.0f) {
+			dest[0] = 0;
+			dest[1] = 0;
+			return;
+		}
+
+		Float x = normal.x / l1;
+		Float y = normal.y / l1;
+
+		if (normal.z < 0.0f) {
+			Float ox = (1.0f - std::fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+			Float oy = (1.0f - std::fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+			x = ox;
+			y = oy;
+		}
+
+		dest[0] = PackSNorm16(x);
+		dest[1] = PackSNorm16(y);
+	}
+}
 
 QuantumEngine::Mesh::Mesh(const std::vector<Vertex>& vertices, const std::vector<UInt32>& indices)
 	: m_vertices(vertices), m_indices(indices)
 {
+	CalculateBounds();
+}
 
+QuantumEngine::Mesh::Mesh(std::vector<Vertex>&& vertices, std::vector<UInt32>&& indices, const Vector3& boundsMin, const Vector3& boundsMax)
+	: m_vertices(std::move(vertices)), m_indices(std::move(indices)), m_boundsMin(boundsMin), m_boundsMax(boundsMax)
+{
 }
 
 void QuantumEngine::Mesh::CopyIndexData(Byte* dest)
@@ -15,3 +58,118 @@ void QuantumEngine::Mesh::CopyVertexData(Byte* dest)
 {
 	std::memcpy(dest, m_vertices.data(), m_vertices.size() * sizeof(Vertex));
 }
+
+void QuantumEngine::Mesh::Quantize()
+{
+	Quantize(0.5f * (m_boundsMax + m_boundsMin), 0.5f * (m_boundsMax - m_boundsMin));
+}
+
+void QuantumEngine::Mesh::Quantize(const Vector3& center, const Vector3& extent)
+{
+	Vector3 inverseExtent(extent.x > 0.0f ? 1.0f / extent.x : 0.0f,
+		extent.y > 0.0f ? 1.0f / extent.y : 0.0f,
+		extent.z > 0.0f ? 1.0f / extent.z : 0.0f);
+
+	m_quantizedVertices.resize(m_vertices.size());
+
+	for (UInt32 i = 0; i < m_vertices.size(); i++) {
+		const Vertex& vertex = m_vertices[i];
+		QuantizedVertex& packed = m_quantizedVertices[i];
+
+		packed.position[0] = PackSNorm16((vertex.position.x - center.x) * inverseExtent.x);
+		packed.position[1] = PackSNorm16((vertex.position.y - center.y) * inverseExtent.y);
+		packed.position[2] = PackSNorm16((vertex.position.z - center.z) * inverseExtent.z);
+		packed.position[3] = 0;
+		PackOctahedral(vertex.normal, packed.normal);
+		packed.uv[0] = PackHalf(vertex.uv.x);
+		packed.uv[1] = PackHalf(vertex.uv.y);
+	}
+
+	m_vertexLayout = VertexLayout::Quantized;
+	m_quantizationCenter = center;
+	m_quantizationExtent = extent;
+
+	if (m_vertices.size() < 65536) {
+		m_indices16.resize(m_indices.size());
+		std::transform(m_indices.begin(), m_indices.end(), m_indices16.begin(), [](UInt32 index) { return (UInt16)index; });
+		m_indexFormat = IndexFormat::UInt16;
+	}
+
+	for (auto& lod : m_lods)
+		lod->Quantize(center, extent);
+}
+
+QuantumEngine::Matrix4 QuantumEngine::Mesh::GetDequantizationMatrix() const
+{
+	if (m_vertexLayout == VertexLayout::Full)
+		return Matrix4();
+
+	return Matrix4::Translate(m_quantizationCenter) * Matrix4::Scale(m_quantizationExtent);
+}
+
+void QuantumEngine::Mesh::CopyPackedVertexData(Byte* dest)
+{
+	if (m_vertexLayout == VertexLayout::Quantized)
+		std::memcpy(dest, m_quantizedVertices.data(), m_quantizedVertices.size() * sizeof(QuantizedVertex));
+	else
+		CopyVertexData(dest);
+}
+
+void QuantumEngine::Mesh::CopyPackedIndexData(Byte* dest)
+{
+	if (m_indexFormat == IndexFormat::UInt16)
+		std::memcpy(dest, m_indices16.data(), m_indices16.size() * sizeof(UInt16));
+	else
+		CopyIndexData(dest);
+}
+
+void QuantumEngine::Mesh::AddLOD(const ref<Mesh>& lod, Float error)
+{
+	// keep the whole chain on one layout so they can share the entity transforms
+	if (m_vertexLayout == VertexLayout::Quantized)
+		lod->Quantize(m_quantizationCenter, m_quantizationExtent);
+
+	m_lods.push_back(lod);
+	m_lodErrors.push_back(error);
+}
+
+UInt32 QuantumEngine::Mesh::SelectLOD(const Transform& transform, const Camera& camera, Float viewportHeight, Float maxPixelError) const
+{
+	if (m_lods.empty())
+		return 0;
+
+	Vector3 scale = transform.Scale();
+	Float maxScale = std::max(std::fabs(scale.x), std::max(std::fabs(scale.y), std::fabs(scale.z)));
+
+	// Matrix4 * Vector3 ignores translation
+	Vector3 center = transform.Position() + transform.Matrix() * (0.5f * (m_boundsMax + m_boundsMin));
+	Float pixelsPerUnit = maxScale * camera.PixelsPerUnit(center, GetBoundingRadius() * maxScale, viewportHeight);
+
+	UInt32 level = 0;
+
+	for (UInt32 i = 0; i < m_lodErrors.size(); i++) {
+		if (m_lodErrors[i] * pixelsPerUnit > maxPixelError)
+			break;
+
+		level = i + 1;
+	}
+
+	return level;
+}
+
+void QuantumEngine::Mesh::CalculateBounds()
+{
+	if (m_vertices.empty()) {
+		m_boundsMin = Vector3(0.0f);
+		m_boundsMax = Vector3(0.0f);
+		return;
+	}
+
+	m_boundsMin = m_vertices[0].position;
+	m_boundsMax = m_vertices[0].position;
+
+	for (auto& vertex : m_vertices) {
+		m_boundsMin = Vector3(std::min(m_boundsMin.x, vertex.position.x), std::min(m_boundsMin.y, vertex.position.y), std::min(m_boundsMin.z, vertex.position.z));
+		m_boundsMax = Vector3(std::max(m_boundsMax.x, vertex.position.x), std::max(m_boundsMax.y, vertex.position.y), std::max(m_boundsMax.z, vertex.position.z));
+	}
+}
@@ -1,12 +1,19 @@
 #pragma once
 #include "Vector2.h"
 #include "Vector3.h"
+#include "Matrix4.h"
 #include <vector>
 
 namespace QuantumEngine::Rendering {
 	class GPUMeshController;
 }
 
+namespace QuantumEngine {
+	class Transform;
+	class Camera;
+	struct MeshletData;
+}
+
 namespace QuantumEngine {
 	struct Vertex {
 		Vector3 position;
@@ -23,6 +30,26 @@ namespace QuantumEngine {
 		}
 	};
 
+	/// <summary>
+	/// 16 byte compact vertex. position is 16-bit normalized relative to the mesh bounds,
+	/// normal is octahedral encoded in two 16-bit normalized values and uv is stored as half floats
+	/// </summary>
+	struct QuantizedVertex {
+		Int16 position[4];
+		Int16 normal[2];
+		UInt16 uv[2];
+	};
+
+	enum class VertexLayout {
+		Full,
+		Quantized,
+	};
+
+	enum class IndexFormat {
+		UInt32,
+		UInt16,
+	};
+
 	class Mesh {
 	public:
 		Mesh(const std::vector<Vertex>& vertices, const std::vector<UInt32>& indices);
@@ -31,12 +58,84 @@ namespace QuantumEngine {
 		UInt32 GetTotalSize() const { return m_vertices.size() * sizeof(Vertex) + m_indices.size() * sizeof(UInt32); }
 		void CopyVertexData(Byte* dest);
 		void CopyIndexData(Byte* dest);
+		inline const std::vector<Vertex>& GetVertices() const { return m_vertices; }
+		inline const std::vector<UInt32>& GetIndices() const { return m_indices; }
+		inline Vector3 GetBoundsMin() const { return m_boundsMin; }
+		inline Vector3 GetBoundsMax() const { return m_boundsMax; }
+		inline Float GetBoundingRadius() const { return 0.5f * (m_boundsMax - m_boundsMin).Magnitude(); }
+
+		/// <summary>
+		/// Adds a simplified version of this mesh. error is the geometric deviation from this mesh in object space
+		/// and must not decrease from one level to the next
+		/// </summary>
+		void AddLOD(const ref<Mesh>& lod, Float error);
+		inline UInt32 GetLODCount() const { return m_lods.size(); }
+		inline ref<Mesh> GetLOD(UInt32 index) const { return m_lods[index]; }
+		inline Float GetLODError(UInt32 index) const { return m_lodErrors[index]; }
+
+		/// <summary>
+		/// Picks the coarsest level whose projected error stays under maxPixelError.
+		/// Returns 0 for this mesh and i + 1 for GetLOD(i)
+		/// </summary>
+		UInt32 SelectLOD(const Transform& transform, const Camera& camera, Float viewportHeight, Float maxPixelError = 1.0f) const;
+
+		// optional cluster decomposition, see MeshletBuilder
+		inline ref<MeshletData> GetMeshletData() const { return m_meshletData; }
+		inline void SetMeshletData(const ref<MeshletData>& meshletData) { m_meshletData = meshletData; }
+		inline bool HasMeshlets() const { return m_meshletData != nullptr; }
+
+		/// <summary>
+		/// Builds the quantized vertex stream and, if the vertex count allows it, a 16-bit index buffer.
+		/// The full precision data is kept so CPU side consumers are not affected.
+		/// LODs are quantized against the bounds of this mesh so they share its dequantization matrix
+		/// </summary>
+		void Quantize();
+		inline VertexLayout GetVertexLayout() const { return m_vertexLayout; }
+		inline IndexFormat GetIndexFormat() const { return m_indexFormat; }
+
+		/// <summary>
+		/// Matrix that maps quantized positions in [-1, 1] back to object space. Identity for full layout
+		/// </summary>
+		Matrix4 GetDequantizationMatrix() const;
+
+		// Packed data is the GPU facing representation in the current layout and index format
+		UInt32 GetPackedVertexStride() const { return m_vertexLayout == VertexLayout::Quantized ? sizeof(QuantizedVertex) : sizeof(Vertex); }
+		UInt32 GetPackedIndexStride() const { return m_indexFormat == IndexFormat::UInt16 ? sizeof(UInt16) : sizeof(UInt32); }
+		UInt32 GetPackedVertexSize() const { return GetPackedVertexStride() * GetVertexCount(); }
+		UInt32 GetPackedIndexSize() const { return GetPackedIndexStride() * GetIndexCount(); }
+		UInt32 GetPackedTotalSize() const { return GetPackedVertexSize() + GetPackedIndexSize(); }
+		void CopyPackedVertexData(Byte* dest);
+		void CopyPackedIndexData(Byte* dest);
+
 		ref<Rendering::GPUMeshController> GetGPUHandle() { return m_gpuHandle; }
 		void SetGPUHandle(ref<Rendering::GPUMeshController> gpuHandle) { m_gpuHandle = gpuHandle; }
 		bool IsUploadedToGPU() const { return m_gpuHandle != nullptr; }
 	private:
+		friend class ModelCache;
+
+		// used by ModelCache to restore a mesh without recomputing the bounds
+		Mesh(std::vector<Vertex>&& vertices, std::vector<UInt32>&& indices, const Vector3& boundsMin, const Vector3& boundsMax);
+
+		void CalculateBounds();
+		void Quantize(const Vector3& center, const Vector3& extent);
+
 		std::vector<Vertex> m_vertices;
 		std::vector<UInt32> m_indices;
+		Vector3 m_boundsMin;
+		Vector3 m_boundsMax;
+
+		VertexLayout m_vertexLayout = VertexLayout::Full;
+		Vector3 m_quantizationCenter;
+		Vector3 m_quantizationExtent;
+		IndexFormat m_indexFormat = IndexFormat::UInt32;
+		std::vector<QuantizedVertex> m_quantizedVertices;
+		std::vector<UInt16> m_indices16;
+
+		std::vector<ref<Mesh>> m_lods;
+		std::vector<Float> m_lodErrors;
+
+		ref<MeshletData> m_meshletData;
+
 		ref<Rendering::GPUMeshController> m_gpuHandle;
 	};
-}
\ No newline at end of file
+}
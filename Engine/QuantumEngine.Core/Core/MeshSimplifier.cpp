@@ -0,0 +1,344 @@
+#include "MeshSimplifier.h"
+#include "Mesh.h"
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+	// symmetric 4x4 matrix stored as its upper triangle
+	struct Quadric {
+		double a[10] = {};
+		double area = 0.0;
+
+		void AddPlane(double x, double y, double z, double d, double weight) {
+			a[0] += weight * x * x; a[1] += weight * x * y; a[2] += weight * x * z; a[3] += weight * x * d;
+			a[4] += weight * y * y; a[5] += weight * y * z; a[6] += weight * y * d;
+			a[7] += weight * z * z; a[8] += weight * z * d;
+			a[9] += weight * d * d;
+		}
+
+		void Add(const Quadric& q) {
+			for (int i = 0; i < 10; i++)
+				a[i] += q.a[i];
+
+			area += q.area;
+		}
+
+		double Evaluate(const QuantumEngine::Vector3& v) const {
+			double x = v.x, y = v.y, z = v.z;
+			return a[0] * x * x + 2.0 * a[1] * x * y + 2.0 * a[2] * x * z + 2.0 * a[3] * x
+				+ a[4] * y * y + 2.0 * a[5] * y * z + 2.0 * a[6] * y
+				+ a[7] * z * z + 2.0 * a[8] * z
+				+ a[9];
+		}
+	};
+
+	struct Collapse {
+		double cost;
+		double distance;
+		UInt32 from;
+		UInt32 to;
+		UInt32 fromVersion;
+		UInt32 toVersion;
+
+		bool operator>(const Collapse& other) const { return cost > other.cost; }
+	};
+
+	void Cross(const QuantumEngine::Vector3& a, const QuantumEngine::Vector3& b, double* out)
+	{
+		out[0] = (double)a.y * b.z - (double)a.z * b.y;
+		out[1] = (double)a.z * b.x - (double)a.x * b.z;
+		out[2] = (double)a.x * b.y - (double)a.y * b.x;
+	}
+
+	class Simplifier {
+	public:
+		Simplifier(const std::vector<QuantumEngine::Vertex>& vertices, const std::vector<UInt32>& indices)
+			: m_vertices(vertices), m_indices(indices),
+			m_quadrics(vertices.size()), m_versions(vertices.size(), 0), m_removedVertex(vertices.size(), false),
+			m_removedTriangle(indices.size() / 3, false), m_vertexTriangles(vertices.size())
+		{
+			m_liveTriangles = (UInt32)(indices.size() / 3);
+
+			for (UInt32 t = 0; t < m_liveTriangles; t++) {
+				for (UInt32 c = 0; c < 3; c++)
+					m_vertexTriangles[m_indices[3 * t + c]].push_back(t);
+			}
+
+			BuildQuadrics();
+
+			for (UInt32 t = 0; t < m_liveTriangles; t++) {
+				for (UInt32 c = 0; c < 3; c++) {
+					UInt32 a = m_indices[3 * t + c];
+					UInt32 b = m_indices[3 * t + (c + 1) % 3];
+					PushCollapse(a, b);
+					PushCollapse(b, a);
+				}
+			}
+		}
+
+		Float Run(UInt32 targetTriangles)
+		{
+			double maxDistance = 0.0;
+
+			while (m_liveTriangles > targetTriangles && m_heap.empty() == false) {
+				Collapse collapse = m_heap.top();
+				m_heap.pop();
+
+				if (m_removedVertex[collapse.from] || m_removedVertex[collapse.to])
+					continue;
+
+				if (m_versions[collapse.from] != collapse.fromVersion || m_versions[collapse.to] != collapse.toVersion)
+					continue;
+
+				if (FlipsTriangle(collapse.from, collapse.to))
+					continue;
+
+				maxDistance = std::max(maxDistance, collapse.distance);
+				ApplyCollapse(collapse.from, collapse.to);
+			}
+
+			return (Float)maxDistance;
+		}
+
+		ref<QuantumEngine::Mesh> BuildMesh() const
+		{
+			std::vector<UInt32> remap(m_vertices.size(), UINT32_MAX);
+			std::vector<QuantumEngine::Vertex> vertices;
+			std::vector<UInt32> indices;
+			vertices.reserve(m_vertices.size());
+			indices.reserve(3 * m_liveTriangles);
+
+			for (UInt32 t = 0; t < m_removedTriangle.size(); t++) {
+				if (m_removedTriangle[t])
+					continue;
+
+				for (UInt32 c = 0; c < 3; c++) {
+					UInt32 index = m_indices[3 * t + c];
+
+					if (remap[index] == UINT32_MAX) {
+						remap[index] = (UInt32)vertices.size();
+						vertices.push_back(m_vertices[index]);
+					}
+
+					indices.push_back(remap[index]);
+				}
+			}
+
+			return std::make_shared<QuantumEngine::Mesh>(vertices, indices);
+		}
+
+	private:
+		void BuildQuadrics()
+		{
+			for (UInt32 t = 0; t < m_liveTriangles; t++) {
+				const QuantumEngine::Vector3& p0 = m_vertices[m_indices[3 * t]].position;
+				const QuantumEngine::Vector3& p1 = m_vertices[m_indices[3 * t + 1]].position;
+				const QuantumEngine::Vector3& p2 = m_vertices[m_indices[3 * t + 2]].position;
+
+				double n[3];
+				Cross(p1 - p0, p2 - p0, n);
+				double length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+				if (length <= 0.0)
+					continue;
+
+				// area weighted plane quadric
+				double area = 0.5 * length;
+				n[0] /= length; n[1] /= length; n[2] /= length;
+				double d = -(n[0] * p0.x + n[1] * p0.y + n[2] * p0.z);
+
+				Quadric q;
+				q.AddPlane(n[0], n[1], n[2], d, area);
+				q.area = area;
+
+				for (UInt32 c = 0; c < 3; c++)
+					m_quadrics[m_indices[3 * t + c]].Add(q);
+
+				// border edges (including uv/normal seams) get a perpendicular constraint plane so they don't shrink
+				for (UInt32 c = 0; c < 3; c++) {
+					UInt32 a = m_indices[3 * t + c];
+					UInt32 b = m_indices[3 * t + (c + 1) % 3];
+
+					if (IsBorderEdge(a, b) == false)
+						continue;
+
+					QuantumEngine::Vector3 edge = m_vertices[b].position - m_vertices[a].position;
+					double e[3] = { edge.x, edge.y, edge.z };
+					double p[3] = { e[1] * n[2] - e[2] * n[1], e[2] * n[0] - e[0] * n[2], e[0] * n[1] - e[1] * n[0] };
+					double pLength = std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+
+					if (pLength <= 0.0)
+						continue;
+
+					p[0] /= pLength; p[1] /= pLength; p[2] /= pLength;
+					double pd = -(p[0] * m_vertices[a].position.x + p[1] * m_vertices[a].position.y + p[2] * m_vertices[a].position.z);
+
+					Quadric borderQuadric;
+					borderQuadric.AddPlane(p[0], p[1], p[2], pd, s_borderWeight * (e[0] * e[0] + e[1] * e[1] + e[2] * e[2]));
+					m_quadrics[a].Add(borderQuadric);
+					m_quadrics[b].Add(borderQuadric);
+				}
+			}
+		}
+
+		bool IsBorderEdge(UInt32 a, UInt32 b) const
+		{
+			UInt32 shared = 0;
+
+			for (UInt32 t : m_vertexTriangles[a]) {
+				if (m_removedTriangle[t])
+					continue;
+
+				if (m_indices[3 * t] == b || m_indices[3 * t + 1] == b || m_indices[3 * t + 2] == b)
+					shared++;
+			}
+
+			return shared == 1;
+		}
+
+		void PushCollapse(UInt32 from, UInt32 to)
+		{
+			Quadric q = m_quadrics[from];
+			q.Add(m_quadrics[to]);
+			double cost = std::max(q.Evaluate(m_vertices[to].position), 0.0);
+
+			m_heap.push(Collapse{
+				.cost = cost,
+				// area weighted squared distance back to an average distance to the original planes
+				.distance = q.area > 0.0 ? std::sqrt(cost / q.area) : 0.0,
+				.from = from,
+				.to = to,
+				.fromVersion = m_versions[from],
+				.toVersion = m_versions[to],
+				});
+		}
+
+		bool FlipsTriangle(UInt32 from, UInt32 to) const
+		{
+			const QuantumEngine::Vector3& target = m_vertices[to].position;
+
+			for (UInt32 t : m_vertexTriangles[from]) {
+				if (m_removedTriangle[t])
+					continue;
+
+				UInt32 i0 = m_indices[3 * t], i1 = m_indices[3 * t + 1], i2 = m_indices[3 * t + 2];
+
+				// triangles on the collapsing edge disappear
+				if (i0 == to || i1 == to || i2 == to)
+					continue;
+
+				const QuantumEngine::Vector3& p0 = m_vertices[i0].position;
+				const QuantumEngine::Vector3& p1 = m_vertices[i1].position;
+				const QuantumEngine::Vector3& p2 = m_vertices[i2].position;
+
+				double before[3];
+				Cross(p1 - p0, p2 - p0, before);
+
+				const QuantumEngine::Vector3& q0 = i0 == from ? target : p0;
+				const QuantumEngine::Vector3& q1 = i1 == from ? target : p1;
+				const QuantumEngine::Vector3& q2 = i2 == from ? target : p2;
+
+				double after[3];
+				Cross(q1 - q0, q2 - q0, after);
+
+				if (before[0] * after[0] + before[1] * after[1] + before[2] * after[2] <= 0.0)
+					return true;
+			}
+
+			return false;
+		}
+
+		void ApplyCollapse(UInt32 from, UInt32 to)
+		{
+			for (UInt32 t : m_vertexTriangles[from]) {
+				if (m_removedTriangle[t])
+					continue;
+
+				UInt32* triangle = &m_indices[3 * t];
+
+				if (triangle[0] == to || triangle[1] == to || triangle[2] == to) {
+					m_removedTriangle[t] = true;
+					m_liveTriangles--;
+					continue;
+				}
+
+				for (UInt32 c = 0; c < 3; c++) {
+					if (triangle[c] == from)
+						triangle[c] = to;
+				}
+
+				m_vertexTriangles[to].push_back(t);
+			}
+
+			m_removedVertex[from] = true;
+			m_vertexTriangles[from].clear();
+			m_quadrics[to].Add(m_quadrics[from]);
+			m_versions[to]++;
+
+			// drop dead triangles so the adjacency doesn't grow without bound
+			auto& toTriangles = m_vertexTriangles[to];
+			toTriangles.erase(std::remove_if(toTriangles.begin(), toTriangles.end(), [this](UInt32 t) { return m_removedTriangle[t]; }), toTriangles.end());
+
+			for (UInt32 t : toTriangles) {
+				for (UInt32 c = 0; c < 3; c++) {
+					UInt32 neighbour = m_indices[3 * t + c];
+
+					if (neighbour == to)
+						continue;
+
+					PushCollapse(to, neighbour);
+					PushCollapse(neighbour, to);
+				}
+			}
+		}
+
+		static constexpr double s_borderWeight = 100.0;
+
+		const std::vector<QuantumEngine::Vertex>& m_vertices;
+		std::vector<UInt32> m_indices;
+		std::vector<Quadric> m_quadrics;
+		std::vector<UInt32> m_versions;
+		std::vector<bool> m_removedVertex;
+		std::vector<bool> m_removedTriangle;
+		std::vector<std::vector<UInt32>> m_vertexTriangles;
+		std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> m_heap;
+		UInt32 m_liveTriangles;
+	};
+}
+
+ref<QuantumEngine::Mesh> QuantumEngine::MeshSimplifier::Simplify(const ref<Mesh>& mesh, UInt32 targetIndexCount, Float* error)
+{
+	Simplifier simplifier(mesh->GetVertices(), mesh->GetIndices());
+	Float maxError = simplifier.Run(targetIndexCount / 3);
+
+	if (error != nullptr)
+		*error = maxError;
+
+	return simplifier.BuildMesh();
+}
+
+void QuantumEngine::MeshSimplifier::GenerateLODs(const ref<Mesh>& mesh, UInt32 lodCount, Float reductionRatio)
+{
+	UInt32 previousIndexCount = mesh->GetIndexCount();
+	Float previousError = 0.0f;
+	Float targetIndexCount = (Float)previousIndexCount;
+
+	for (UInt32 i = 0; i < lodCount; i++) {
+		targetIndexCount *= reductionRatio;
+
+		// every level starts from the base mesh so the reported error is measured against the original surface
+		Float error;
+		auto lod = Simplify(mesh, (UInt32)targetIndexCount, &error);
+
+		// the remaining collapses would all flip triangles or the mesh is already tiny
+		if (lod->GetIndexCount() == 0 || lod->GetIndexCount() >= previousIndexCount * 0.95f)
+			break;
+
+		// LOD selection expects the error to grow with the level
+		previousError = std::max(error, previousError);
+		mesh->AddLOD(lod, previousError);
+		previousIndexCount = lod->GetIndexCount();
+	}
+}
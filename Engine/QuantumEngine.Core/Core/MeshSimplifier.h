@@ -0,0 +1,27 @@
+#pragma once
+#include "../BasicTypes.h"
+
+namespace QuantumEngine
+{
+	class Mesh;
+
+	/// <summary>
+	/// Quadric error metric mesh simplification based on half edge collapses.
+	/// Collapsed vertices snap to one of the edge ends so uv and normal stay valid without interpolation
+	/// </summary>
+	class MeshSimplifier
+	{
+	public:
+		/// <summary>
+		/// returns a simplified copy of the mesh with at most targetIndexCount indices (if reachable).
+		/// error receives the largest geometric error introduced, in object space units
+		/// </summary>
+		static ref<Mesh> Simplify(const ref<Mesh>& mesh, UInt32 targetIndexCount, Float* error);
+
+		/// <summary>
+		/// generates up to lodCount LOD levels, each reductionRatio times the triangle count of the previous one,
+		/// and stores them in the mesh. Stops early once a level cannot be reduced any further
+		/// </summary>
+		static void GenerateLODs(const ref<Mesh>& mesh, UInt32 lodCount, Float reductionRatio);
+	};
+}
@@ -0,0 +1,298 @@
+#include "MeshletBuilder.h"
+#include "Mesh.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+	// triangles per independently clustered chunk, large enough that the seams between chunks don't matter
+	constexpr UInt32 s_chunkTriangles = 16384;
+
+	struct ChunkResult {
+		std::vector<QuantumEngine::Meshlet> meshlets;
+		std::vector<UInt32> vertices;
+		std::vector<Byte> triangles;
+	};
+
+	QuantumEngine::Vector3 Cross(const QuantumEngine::Vector3& a, const QuantumEngine::Vector3& b)
+	{
+		return QuantumEngine::Vector3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+	}
+
+	void ComputeBounds(const std::vector<QuantumEngine::Vertex>& vertices, ChunkResult& chunk, QuantumEngine::Meshlet& meshlet)
+	{
+		const UInt32* meshletVertices = &chunk.vertices[meshlet.vertexOffset];
+		const Byte* meshletTriangles = &chunk.triangles[3 * meshlet.triangleOffset];
+
+		QuantumEngine::Vector3 minPos = vertices[meshletVertices[0]].position;
+		QuantumEngine::Vector3 maxPos = minPos;
+
+		for (UInt32 i = 1; i < meshlet.vertexCount; i++) {
+			const QuantumEngine::Vector3& p = vertices[meshletVertices[i]].position;
+			minPos = QuantumEngine::Vector3(std::min(minPos.x, p.x), std::min(minPos.y, p.y), std::min(minPos.z, p.z));
+			maxPos = QuantumEngine::Vector3(std::max(maxPos.x, p.x), std::max(maxPos.y, p.y), std::max(maxPos.z, p.z));
+		}
+
+		meshlet.center = 0.5f * (minPos + maxPos);
+		meshlet.radius = 0.0f;
+
+		for (UInt32 i = 0; i < meshlet.vertexCount; i++)
+			meshlet.radius = std::max(meshlet.radius, (vertices[meshletVertices[i]].position - meshlet.center).Magnitude());
+
+		std::vector<QuantumEngine::Vector3> normals;
+		normals.reserve(meshlet.triangleCount);
+		QuantumEngine::Vector3 axis(0.0f);
+
+		for (UInt32 t = 0; t < meshlet.triangleCount; t++) {
+			const QuantumEngine::Vector3& p0 = vertices[meshletVertices[meshletTriangles[3 * t]]].position;
+			const QuantumEngine::Vector3& p1 = vertices[meshletVertices[meshletTriangles[3 * t + 1]]].position;
+			const QuantumEngine::Vector3& p2 = vertices[meshletVertices[meshletTriangles[3 * t + 2]]].position;
+			QuantumEngine::Vector3 normal = Cross(p1 - p0, p2 - p0);
+			Float length = normal.Magnitude();
+
+			if (length <= 0.0f)
+				continue;
+
+			normals.push_back(normal * (1.0f / length));
+			axis += normals.back();
+		}
+
+		Float axisLength = axis.Magnitude();
+		meshlet.coneAxis = axisLength > 0.0f ? axis * (1.0f / axisLength) : QuantumEngine::Vector3(0.0f, 0.0f, 1.0f);
+
+		Float minDot = axisLength > 0.0f ? 1.0f : -1.0f;
+
+		for (auto& normal : normals)
+			minDot = std::min(minDot, QuantumEngine::Vector3::Dot(meshlet.coneAxis, normal));
+
+		// wider than ~85 degrees, the cone would almost never cull anything
+		meshlet.coneCutoff = minDot <= 0.1f ? 1.0f : std::sqrt(1.0f - minDot * minDot);
+	}
+
+	void BuildChunk(const std::vector<QuantumEngine::Vertex>& vertices, const std::vector<UInt32>& indices,
+		UInt32 firstTriangle, UInt32 triangleCount, UInt32 maxVertices, UInt32 maxTriangles, ChunkResult& result)
+	{
+		// chunk local vertex ids and a vertex -> triangle adjacency in CSR form
+		std::unordered_map<UInt32, UInt32> localIds;
+		std::vector<UInt32> globalIds;
+		std::vector<UInt32> cornerVertices(3 * triangleCount);
+
+		for (UInt32 i = 0; i < 3 * triangleCount; i++) {
+			UInt32 global = indices[3 * firstTriangle + i];
+			auto it = localIds.emplace(global, (UInt32)globalIds.size());
+
+			if (it.second)
+				globalIds.push_back(global);
+
+			cornerVertices[i] = it.first->second;
+		}
+
+		UInt32 vertexCount = (UInt32)globalIds.size();
+		std::vector<UInt32> adjacencyOffsets(vertexCount + 1, 0);
+
+		for (UInt32 v : cornerVertices)
+			adjacencyOffsets[v + 1]++;
+
+		for (UInt32 v = 0; v < vertexCount; v++)
+			adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+
+		std::vector<UInt32> adjacency(3 * triangleCount);
+		std::vector<UInt32> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+
+		for (UInt32 i = 0; i < 3 * triangleCount; i++)
+			adjacency[fill[cornerVertices[i]]++] = i / 3;
+
+		std::vector<bool> emitted(triangleCount, false);
+		std::vector<Int32> meshletLocal(vertexCount, -1);
+		std::vector<UInt32> meshletVertices;
+		meshletVertices.reserve(maxVertices);
+		UInt32 meshletTriangleCount = 0;
+
+		// unemitted triangles touching the current meshlet, candidateOwner avoids listing one twice
+		std::vector<UInt32> candidates;
+		std::vector<UInt32> candidateOwner(triangleCount, UINT32_MAX);
+		UInt32 meshletIndex = 0;
+		Float meshletCentroidSum[3] = { 0.0f, 0.0f, 0.0f };
+		UInt32 seed = 0;
+
+		std::vector<Float> centroids(3 * triangleCount);
+
+		for (UInt32 t = 0; t < triangleCount; t++) {
+			const QuantumEngine::Vector3& p0 = vertices[globalIds[cornerVertices[3 * t]]].position;
+			const QuantumEngine::Vector3& p1 = vertices[globalIds[cornerVertices[3 * t + 1]]].position;
+			const QuantumEngine::Vector3& p2 = vertices[globalIds[cornerVertices[3 * t + 2]]].position;
+			centroids[3 * t] = (p0.x + p1.x + p2.x) / 3.0f;
+			centroids[3 * t + 1] = (p0.y + p1.y + p2.y) / 3.0f;
+			centroids[3 * t + 2] = (p0.z + p1.z + p2.z) / 3.0f;
+		}
+
+		auto finishMeshlet = [&]() {
+			if (meshletTriangleCount == 0)
+				return;
+
+			QuantumEngine::Meshlet meshlet{
+				.vertexOffset = (UInt32)result.vertices.size(),
+				.triangleOffset = (UInt32)(result.triangles.size() / 3) - meshletTriangleCount,
+				.vertexCount = (UInt32)meshletVertices.size(),
+				.triangleCount = meshletTriangleCount,
+				// bounds and cone are filled by ComputeBounds
+				.center = QuantumEngine::Vector3(0.0f),
+				.radius = 0.0f,
+				.coneAxis = QuantumEngine::Vector3(0.0f),
+				.coneCutoff = 1.0f,
+			};
+
+			for (UInt32 v : meshletVertices) {
+				result.vertices.push_back(globalIds[v]);
+				meshletLocal[v] = -1;
+			}
+
+			ComputeBounds(vertices, result, meshlet);
+			result.meshlets.push_back(meshlet);
+			meshletVertices.clear();
+			meshletTriangleCount = 0;
+			meshletCentroidSum[0] = meshletCentroidSum[1] = meshletCentroidSum[2] = 0.0f;
+			candidates.clear();
+			meshletIndex++;
+		};
+
+		auto newVertexCount = [&](UInt32 triangle) {
+			UInt32 count = 0;
+
+			for (UInt32 c = 0; c < 3; c++)
+				count += meshletLocal[cornerVertices[3 * triangle + c]] < 0 ? 1 : 0;
+
+			return count;
+		};
+
+		auto emitTriangle = [&](UInt32 triangle) {
+			for (UInt32 c = 0; c < 3; c++) {
+				UInt32 v = cornerVertices[3 * triangle + c];
+
+				if (meshletLocal[v] < 0) {
+					meshletLocal[v] = (Int32)meshletVertices.size();
+					meshletVertices.push_back(v);
+
+					for (UInt32 a = adjacencyOffsets[v]; a < adjacencyOffsets[v + 1]; a++) {
+						UInt32 neighbour = adjacency[a];
+
+						if (emitted[neighbour] == false && candidateOwner[neighbour] != meshletIndex) {
+							candidateOwner[neighbour] = meshletIndex;
+							candidates.push_back(neighbour);
+						}
+					}
+				}
+
+				result.triangles.push_back((Byte)meshletLocal[v]);
+			}
+
+			emitted[triangle] = true;
+			meshletTriangleCount++;
+			for (UInt32 i = 0; i < 3; i++)
+				meshletCentroidSum[i] += centroids[3 * triangle + i];
+		};
+
+		for (UInt32 emittedCount = 0; emittedCount < triangleCount; emittedCount++) {
+			// grow through the triangle that adds the fewest vertices, then the one closest to the meshlet to keep it round.
+			// remaining ties go to the lowest index to stay deterministic
+			UInt32 best = UINT32_MAX;
+			UInt32 bestCost = 4;
+			Float bestDistance = 0.0f;
+			Float inverseCount = meshletTriangleCount > 0 ? 1.0f / meshletTriangleCount : 0.0f;
+			Float cx = meshletCentroidSum[0] * inverseCount, cy = meshletCentroidSum[1] * inverseCount, cz = meshletCentroidSum[2] * inverseCount;
+
+			candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [&emitted](UInt32 triangle) { return emitted[triangle]; }), candidates.end());
+
+			for (UInt32 triangle : candidates) {
+				UInt32 cost = newVertexCount(triangle);
+
+				if (cost > bestCost)
+					continue;
+
+				Float dx = centroids[3 * triangle] - cx, dy = centroids[3 * triangle + 1] - cy, dz = centroids[3 * triangle + 2] - cz;
+				Float distance = dx * dx + dy * dy + dz * dz;
+
+				if (cost < bestCost || distance < bestDistance || (distance == bestDistance && triangle < best)) {
+					best = triangle;
+					bestCost = cost;
+					bestDistance = distance;
+				}
+			}
+
+			if (best == UINT32_MAX) {
+				while (emitted[seed])
+					seed++;
+
+				best = seed;
+				bestCost = newVertexCount(best);
+			}
+
+			if (meshletVertices.size() + bestCost > maxVertices || meshletTriangleCount >= maxTriangles) {
+				finishMeshlet();
+				bestCost = 3;
+			}
+
+			emitTriangle(best);
+		}
+
+		finishMeshlet();
+	}
+}
+
+bool QuantumEngine::Meshlet::IsBackFacing(const Vector3& viewPosition) const
+{
+	Vector3 direction = center - viewPosition;
+	return Vector3::Dot(direction, coneAxis) >= coneCutoff * direction.Magnitude() + radius;
+}
+
+ref<QuantumEngine::MeshletData> QuantumEngine::MeshletBuilder::Build(const ref<Mesh>& mesh, UInt32 maxVertices, UInt32 maxTriangles)
+{
+	// local indices are stored in a byte
+	maxVertices = std::clamp(maxVertices, 3u, 256u);
+	maxTriangles = std::max(maxTriangles, 1u);
+
+	auto& vertices = mesh->GetVertices();
+	auto& indices = mesh->GetIndices();
+	UInt32 triangleCount = (UInt32)(indices.size() / 3);
+	UInt32 chunkCount = (triangleCount + s_chunkTriangles - 1) / s_chunkTriangles;
+	std::vector<ChunkResult> chunks(chunkCount);
+
+	std::atomic<UInt32> nextChunk = 0;
+	auto worker = [&]() {
+		for (UInt32 chunk = nextChunk++; chunk < chunkCount; chunk = nextChunk++) {
+			UInt32 first = chunk * s_chunkTriangles;
+			BuildChunk(vertices, indices, first, std::min(s_chunkTriangles, triangleCount - first), maxVertices, maxTriangles, chunks[chunk]);
+		}
+	};
+
+	UInt32 threadCount = std::min(std::max(std::thread::hardware_concurrency(), 1u), chunkCount);
+	std::vector<std::thread> threads;
+
+	for (UInt32 i = 1; i < threadCount; i++)
+		threads.emplace_back(worker);
+
+	worker();
+
+	for (auto& thread : threads)
+		thread.join();
+
+	auto data = std::make_shared<MeshletData>();
+
+	for (auto& chunk : chunks) {
+		UInt32 vertexBase = (UInt32)data->vertices.size();
+		UInt32 triangleBase = (UInt32)(data->triangles.size() / 3);
+
+		for (auto& meshlet : chunk.meshlets) {
+			data->meshlets.push_back(meshlet);
+			data->meshlets.back().vertexOffset += vertexBase;
+			data->meshlets.back().triangleOffset += triangleBase;
+		}
+
+		data->vertices.insert(data->vertices.end(), chunk.vertices.begin(), chunk.vertices.end());
+		data->triangles.insert(data->triangles.end(), chunk.triangles.begin(), chunk.triangles.end());
+	}
+
+	return data;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "../BasicTypes.h"
+#include "Vector3.h"
+#include <vector>
+
+namespace QuantumEngine
+{
+	class Mesh;
+
+	/// <summary>
+	/// Small cluster of triangles. Triangles index into the meshlet's own vertex list,
+	/// which in turn indexes the vertices of the mesh
+	/// </summary>
+	struct Meshlet {
+		UInt32 vertexOffset;
+		UInt32 triangleOffset;
+		UInt32 vertexCount;
+		UInt32 triangleCount;
+
+		// object space bounding sphere
+		Vector3 center;
+		Float radius;
+
+		// normal cone, coneCutoff is the sine of the cone spread (1 means the cone can't be used for culling)
+		Vector3 coneAxis;
+		Float coneCutoff;
+
+		/// <summary>
+		/// true if every triangle of the meshlet faces away from the object space position
+		/// </summary>
+		bool IsBackFacing(const Vector3& viewPosition) const;
+	};
+
+	struct MeshletData {
+		std::vector<Meshlet> meshlets;
+		// mesh vertex indices referenced by the meshlets
+		std::vector<UInt32> vertices;
+		// three local vertex indices per triangle
+		std::vector<Byte> triangles;
+	};
+
+	class MeshletBuilder
+	{
+	public:
+		static constexpr UInt32 DefaultMaxVertices = 64;
+		static constexpr UInt32 DefaultMaxTriangles = 124;
+
+		/// <summary>
+		/// Splits the mesh into meshlets. The index buffer is cut into fixed chunks that are clustered on separate threads
+		/// and merged in chunk order, so the result doesn't depend on the thread count
+		/// </summary>
+		static ref<MeshletData> Build(const ref<Mesh>& mesh, UInt32 maxVertices = DefaultMaxVertices, UInt32 maxTriangles = DefaultMaxTriangles);
+	};
+}
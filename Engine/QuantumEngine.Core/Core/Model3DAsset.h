@@ -18,6 +18,7 @@ namespace QuantumEngine {
 			}
 			return nullptr;
 		}
+		inline const std::map<std::string, ref<Mesh>>& GetMeshes() const { return m_meshes; }
 	private:
 		std::map<std::string, ref<Mesh>> m_meshes;
 	};
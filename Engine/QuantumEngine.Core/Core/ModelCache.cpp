@@ -0,0 +1,404 @@
+#include "ModelCache.h"
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include "AssimpModel3DImporter.h"
+#include "Mesh.h"
+#include "MeshletBuilder.h"
+#include "Model3DAsset.h"
+#include "../Platform/MappedFile.h"
+
+namespace {
+	constexpr UInt64 BlobAlignment = 16;
+	constexpr UInt64 FnvOffsetBasis = 0xCBF29CE484222325ull;
+	constexpr UInt64 FnvPrime = 0x100000001B3ull;
+
+	struct CacheBlob {
+		UInt64 offset;
+		UInt64 size;
+	};
+
+	struct CacheHeader {
+		UInt32 magic;
+		UInt32 version;
+		// strides of the stored structs, a mismatch means the blobs can't be used as they are
+		UInt32 vertexStride;
+		UInt32 quantizedVertexStride;
+		UInt32 meshletStride;
+		UInt32 meshCount;
+		UInt32 recordCount;
+		UInt32 reserved;
+		UInt64 sourceHash;
+		UInt64 propertiesHash;
+		UInt64 fileSize;
+		UInt64 recordsOffset;
+	};
+
+	// one record per mesh, each top level mesh is directly followed by the records of its LODs
+	struct CacheMeshRecord {
+		CacheBlob name;
+		UInt32 lodCount;
+		Float lodError;
+		UInt32 vertexCount;
+		UInt32 indexCount;
+		UInt32 vertexLayout;
+		UInt32 indexFormat;
+		Float boundsMin[3];
+		Float boundsMax[3];
+		Float quantizationCenter[3];
+		Float quantizationExtent[3];
+		CacheBlob vertices;
+		CacheBlob indices;
+		CacheBlob quantizedVertices;
+		CacheBlob indices16;
+		UInt32 meshletCount;
+		UInt32 reserved;
+		CacheBlob meshlets;
+		CacheBlob meshletVertices;
+		CacheBlob meshletTriangles;
+	};
+
+	static_assert(sizeof(CacheHeader) % BlobAlignment == 0, "records must start aligned");
+	static_assert(sizeof(CacheMeshRecord) % BlobAlignment == 0, "records must stay aligned");
+
+	UInt64 Fnv1a(UInt64 hash, const void* data, UInt64 size)
+	{
+		const Byte* bytes = (const Byte*)data;
+
+		for (UInt64 i = 0; i < size; i++) {
+			hash ^= bytes[i];
+			hash *= FnvPrime;
+		}
+
+		return hash;
+	}
+
+	template<typename T>
+	UInt64 HashValue(UInt64 hash, const T& value)
+	{
+		return Fnv1a(hash, &value, sizeof(T));
+	}
+
+	UInt64 HashVector(UInt64 hash, const QuantumEngine::Vector3& value)
+	{
+		hash = HashValue(hash, value.x);
+		hash = HashValue(hash, value.y);
+		return HashValue(hash, value.z);
+	}
+
+	CacheBlob AppendBlob(std::vector<Byte>& buffer, const void* data, UInt64 size)
+	{
+		UInt64 offset = (buffer.size() + BlobAlignment - 1) & ~(BlobAlignment - 1);
+		buffer.resize(offset + size);
+
+		if (size > 0)
+			std::memcpy(buffer.data() + offset, data, size);
+
+		return CacheBlob{ .offset = offset, .size = size };
+	}
+
+	void StoreVector(Float* dest, const QuantumEngine::Vector3& value)
+	{
+		dest[0] = value.x;
+		dest[1] = value.y;
+		dest[2] = value.z;
+	}
+
+	bool IsBlobValid(const CacheBlob& blob, UInt64 fileSize, UInt64 expectedSize)
+	{
+		return blob.size == expectedSize && blob.offset % BlobAlignment == 0 && blob.offset <= fileSize && blob.size <= fileSize - blob.offset;
+	}
+
+	template<typename T>
+	bool AreIndicesValid(const std::vector<T>& indices, UInt32 vertexCount)
+	{
+		for (T index : indices) {
+			if (index >= vertexCount)
+				return false;
+		}
+
+		return true;
+	}
+
+	// every range of the meshlets has to lie in the stored arrays and reference existing vertices
+	bool AreMeshletsValid(const QuantumEngine::MeshletData& meshletData, UInt32 vertexCount)
+	{
+		UInt64 triangleCount = meshletData.triangles.size() / 3;
+
+		for (auto& meshlet : meshletData.meshlets) {
+			if ((UInt64)meshlet.vertexOffset + meshlet.vertexCount > meshletData.vertices.size()
+				|| (UInt64)meshlet.triangleOffset + meshlet.triangleCount > triangleCount)
+				return false;
+
+			for (UInt32 i = 0; i < 3 * meshlet.triangleCount; i++) {
+				if (meshletData.triangles[3 * (UInt64)meshlet.triangleOffset + i] >= meshlet.vertexCount)
+					return false;
+			}
+		}
+
+		return AreIndicesValid(meshletData.vertices, vertexCount);
+	}
+
+	template<typename T>
+	std::vector<T> ReadBlob(const Byte* data, const CacheBlob& blob)
+	{
+		const T* begin = reinterpret_cast<const T*>(data + blob.offset);
+		return std::vector<T>(begin, begin + blob.size / sizeof(T));
+	}
+}
+
+std::string QuantumEngine::ModelCache::GetCachePath(const std::string& sourcePath)
+{
+	return sourcePath + ".qmcache";
+}
+
+UInt64 QuantumEngine::ModelCache::HashFile(const std::string& filePath)
+{
+	std::error_code error;
+	std::filesystem::path path(filePath);
+	UInt64 size = std::filesystem::file_size(path, error);
+
+	if (error)
+		return 0;
+
+	auto writeTime = std::filesystem::last_write_time(path, error);
+
+	if (error)
+		return 0;
+
+	UInt64 hash = HashValue(FnvOffsetBasis, size);
+	return HashValue(hash, writeTime.time_since_epoch().count());
+}
+
+UInt64 QuantumEngine::ModelCache::HashProperties(const ModelImportProperties& properties)
+{
+	UInt64 hash = FnvOffsetBasis;
+	hash = HashVector(hash, properties.position);
+	hash = HashVector(hash, properties.axis);
+	hash = HashValue(hash, properties.angleDeg);
+	hash = HashVector(hash, properties.scale);
+	hash = HashValue(hash, properties.quantizeVertices);
+	hash = HashValue(hash, properties.lodCount);
+	hash = HashValue(hash, properties.lodReductionRatio);
+	hash = HashValue(hash, properties.buildMeshlets);
+
+	// meshlet limits are not part of the properties but change the stored clusters
+	hash = HashValue(hash, MeshletBuilder::DefaultMaxVertices);
+	hash = HashValue(hash, MeshletBuilder::DefaultMaxTriangles);
+	return hash;
+}
+
+ref<QuantumEngine::Model3DAsset> QuantumEngine::ModelCache::Load(const std::string& cachePath, UInt64 sourceHash, const ModelImportProperties& properties)
+{
+	auto file = Platform::MappedFile::Open(cachePath);
+
+	if (file == nullptr || file->GetSize() < sizeof(CacheHeader))
+		return nullptr;
+
+	const Byte* data = file->GetData();
+	UInt64 fileSize = file->GetSize();
+	CacheHeader header;
+	std::memcpy(&header, data, sizeof(CacheHeader));
+
+	if (header.magic != Magic || header.version != Version || header.fileSize != fileSize)
+		return nullptr;
+
+	if (header.vertexStride != sizeof(Vertex) || header.quantizedVertexStride != sizeof(QuantizedVertex) || header.meshletStride != sizeof(Meshlet))
+		return nullptr;
+
+	if (header.sourceHash != sourceHash || header.propertiesHash != HashProperties(properties))
+		return nullptr;
+
+	if (header.recordsOffset > fileSize || header.recordCount > (fileSize - header.recordsOffset) / sizeof(CacheMeshRecord))
+		return nullptr;
+
+	std::vector<std::pair<std::string, ref<Mesh>>> meshes;
+	meshes.reserve(header.meshCount);
+	UInt32 recordIndex = 0;
+
+	for (UInt32 i = 0; i < header.meshCount; i++) {
+		if (recordIndex >= header.recordCount)
+			return nullptr;
+
+		UInt64 recordOffset = header.recordsOffset + recordIndex * sizeof(CacheMeshRecord);
+		CacheMeshRecord record;
+		std::memcpy(&record, data + recordOffset, sizeof(CacheMeshRecord));
+
+		if (IsBlobValid(record.name, fileSize, record.name.size) == false || record.lodCount > header.recordCount - recordIndex - 1)
+			return nullptr;
+
+		auto mesh = ReadMesh(data, fileSize, recordOffset);
+
+		if (mesh == nullptr)
+			return nullptr;
+
+		recordIndex++;
+
+		for (UInt32 lod = 0; lod < record.lodCount; lod++) {
+			UInt64 lodOffset = header.recordsOffset + recordIndex * sizeof(CacheMeshRecord);
+			CacheMeshRecord lodRecord;
+			std::memcpy(&lodRecord, data + lodOffset, sizeof(CacheMeshRecord));
+			auto lodMesh = ReadMesh(data, fileSize, lodOffset);
+
+			if (lodMesh == nullptr)
+				return nullptr;
+
+			// stored LODs are already in the layout of the base mesh, AddLOD would quantize them again
+			mesh->m_lods.push_back(lodMesh);
+			mesh->m_lodErrors.push_back(lodRecord.lodError);
+			recordIndex++;
+		}
+
+		meshes.push_back(std::make_pair(std::string((const char*)data + record.name.offset, record.name.size), mesh));
+	}
+
+	return std::make_shared<Model3DAsset>(meshes);
+}
+
+bool QuantumEngine::ModelCache::Save(const std::string& cachePath, UInt64 sourceHash, const ModelImportProperties& properties, const std::vector<std::pair<std::string, ref<Mesh>>>& meshes)
+{
+	UInt32 recordCount = 0;
+
+	for (auto& mesh : meshes)
+		recordCount += 1 + mesh.second->GetLODCount();
+
+	std::vector<Byte> buffer(sizeof(CacheHeader) + recordCount * sizeof(CacheMeshRecord), 0);
+	UInt64 recordOffset = sizeof(CacheHeader);
+
+	for (auto& mesh : meshes) {
+		UInt32 lodCount = mesh.second->GetLODCount();
+		WriteMesh(buffer, recordOffset, mesh.second, lodCount, 0.0f);
+
+		// the name is only stored on the top level record
+		CacheBlob name = AppendBlob(buffer, mesh.first.data(), mesh.first.size());
+		std::memcpy(buffer.data() + recordOffset + offsetof(CacheMeshRecord, name), &name, sizeof(CacheBlob));
+		recordOffset += sizeof(CacheMeshRecord);
+
+		for (UInt32 i = 0; i < lodCount; i++) {
+			WriteMesh(buffer, recordOffset, mesh.second->GetLOD(i), 0, mesh.second->GetLODError(i));
+			recordOffset += sizeof(CacheMeshRecord);
+		}
+	}
+
+	buffer.resize((buffer.size() + BlobAlignment - 1) & ~(BlobAlignment - 1), 0);
+
+	CacheHeader header{
+		.magic = Magic,
+		.version = Version,
+		.vertexStride = sizeof(Vertex),
+		.quantizedVertexStride = sizeof(QuantizedVertex),
+		.meshletStride = sizeof(Meshlet),
+		.meshCount = (UInt32)meshes.size(),
+		.recordCount = recordCount,
+		.reserved = 0,
+		.sourceHash = sourceHash,
+		.propertiesHash = HashProperties(properties),
+		.fileSize = buffer.size(),
+		.recordsOffset = sizeof(CacheHeader),
+	};
+	std::memcpy(buffer.data(), &header, sizeof(CacheHeader));
+
+	// write next to the target and swap it in, so a failed write never leaves a half written cache behind
+	std::string tempPath = cachePath + ".tmp";
+	{
+		std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+
+		if (stream.is_open() == false)
+			return false;
+
+		stream.write((const char*)buffer.data(), buffer.size());
+
+		if (stream.good() == false)
+			return false;
+	}
+
+	return MoveFileExA(tempPath.c_str(), cachePath.c_str(), MOVEFILE_REPLACE_EXISTING) != FALSE;
+}
+
+void QuantumEngine::ModelCache::WriteMesh(std::vector<Byte>& buffer, UInt64 recordOffset, const ref<Mesh>& mesh, UInt32 lodCount, Float lodError)
+{
+	CacheMeshRecord record{};
+	record.lodCount = lodCount;
+	record.lodError = lodError;
+	record.vertexCount = mesh->GetVertexCount();
+	record.indexCount = mesh->GetIndexCount();
+	record.vertexLayout = (UInt32)mesh->m_vertexLayout;
+	record.indexFormat = (UInt32)mesh->m_indexFormat;
+	StoreVector(record.boundsMin, mesh->m_boundsMin);
+	StoreVector(record.boundsMax, mesh->m_boundsMax);
+	StoreVector(record.quantizationCenter, mesh->m_quantizationCenter);
+	StoreVector(record.quantizationExtent, mesh->m_quantizationExtent);
+
+	record.vertices = AppendBlob(buffer, mesh->m_vertices.data(), mesh->m_vertices.size() * sizeof(Vertex));
+	record.indices = AppendBlob(buffer, mesh->m_indices.data(), mesh->m_indices.size() * sizeof(UInt32));
+	record.quantizedVertices = AppendBlob(buffer, mesh->m_quantizedVertices.data(), mesh->m_quantizedVertices.size() * sizeof(QuantizedVertex));
+	record.indices16 = AppendBlob(buffer, mesh->m_indices16.data(), mesh->m_indices16.size() * sizeof(UInt16));
+
+	if (mesh->m_meshletData != nullptr) {
+		auto& meshletData = *mesh->m_meshletData;
+		record.meshletCount = meshletData.meshlets.size();
+		record.meshlets = AppendBlob(buffer, meshletData.meshlets.data(), meshletData.meshlets.size() * sizeof(Meshlet));
+		record.meshletVertices = AppendBlob(buffer, meshletData.vertices.data(), meshletData.vertices.size() * sizeof(UInt32));
+		record.meshletTriangles = AppendBlob(buffer, meshletData.triangles.data(), meshletData.triangles.size());
+	}
+
+	std::memcpy(buffer.data() + recordOffset, &record, sizeof(CacheMeshRecord));
+}
+
+ref<QuantumEngine::Mesh> QuantumEngine::ModelCache::ReadMesh(const Byte* data, UInt64 size, UInt64 recordOffset)
+{
+	CacheMeshRecord record;
+	std::memcpy(&record, data + recordOffset, sizeof(CacheMeshRecord));
+
+	bool quantized = record.vertexLayout == (UInt32)VertexLayout::Quantized;
+	bool indices16 = record.indexFormat == (UInt32)IndexFormat::UInt16;
+
+	if ((quantized == false && record.vertexLayout != (UInt32)VertexLayout::Full)
+		|| (indices16 == false && record.indexFormat != (UInt32)IndexFormat::UInt32)
+		|| record.indexCount % 3 != 0)
+		return nullptr;
+
+	if (IsBlobValid(record.vertices, size, (UInt64)record.vertexCount * sizeof(Vertex)) == false
+		|| IsBlobValid(record.indices, size, (UInt64)record.indexCount * sizeof(UInt32)) == false
+		|| IsBlobValid(record.quantizedVertices, size, quantized ? (UInt64)record.vertexCount * sizeof(QuantizedVertex) : 0) == false
+		|| IsBlobValid(record.indices16, size, indices16 ? (UInt64)record.indexCount * sizeof(UInt16) : 0) == false)
+		return nullptr;
+
+	// the GPU reads the indices as they are, out of range values must not reach a vertex buffer
+	auto indices = ReadBlob<UInt32>(data, record.indices);
+	auto indexData16 = ReadBlob<UInt16>(data, record.indices16);
+
+	if (AreIndicesValid(indices, record.vertexCount) == false || AreIndicesValid(indexData16, record.vertexCount) == false)
+		return nullptr;
+
+	Vector3 boundsMin(record.boundsMin[0], record.boundsMin[1], record.boundsMin[2]);
+	Vector3 boundsMax(record.boundsMax[0], record.boundsMax[1], record.boundsMax[2]);
+	ref<Mesh> mesh(new Mesh(ReadBlob<Vertex>(data, record.vertices), std::move(indices), boundsMin, boundsMax));
+
+	mesh->m_vertexLayout = quantized ? VertexLayout::Quantized : VertexLayout::Full;
+	mesh->m_indexFormat = indices16 ? IndexFormat::UInt16 : IndexFormat::UInt32;
+	mesh->m_quantizationCenter = Vector3(record.quantizationCenter[0], record.quantizationCenter[1], record.quantizationCenter[2]);
+	mesh->m_quantizationExtent = Vector3(record.quantizationExtent[0], record.quantizationExtent[1], record.quantizationExtent[2]);
+	mesh->m_quantizedVertices = ReadBlob<QuantizedVertex>(data, record.quantizedVertices);
+	mesh->m_indices16 = std::move(indexData16);
+
+	if (record.meshletCount > 0) {
+		if (IsBlobValid(record.meshlets, size, (UInt64)record.meshletCount * sizeof(Meshlet)) == false
+			|| IsBlobValid(record.meshletVertices, size, record.meshletVertices.size - record.meshletVertices.size % sizeof(UInt32)) == false
+			|| IsBlobValid(record.meshletTriangles, size, record.meshletTriangles.size) == false)
+			return nullptr;
+
+		auto meshletData = std::make_shared<MeshletData>();
+		meshletData->meshlets = ReadBlob<Meshlet>(data, record.meshlets);
+		meshletData->vertices = ReadBlob<UInt32>(data, record.meshletVertices);
+		meshletData->triangles = ReadBlob<Byte>(data, record.meshletTriangles);
+
+		if (AreMeshletsValid(*meshletData, record.vertexCount) == false)
+			return nullptr;
+
+		mesh->m_meshletData = meshletData;
+	}
+
+	return mesh;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "../BasicTypes.h"
+
+namespace QuantumEngine {
+	class Model3DAsset;
+	class Mesh;
+	struct ModelImportProperties;
+
+	/// <summary>
+	/// Engine native binary model format. Stores the imported meshes in their final layout
+	/// (packed vertex/index streams, LODs and meshlets) as 16 byte aligned blobs, so loading skips the importer and
+	/// only validates and copies each blob into its mesh. A cache entry is only valid for the source file version and import properties it was built from
+	/// </summary>
+	class ModelCache {
+	public:
+		static constexpr UInt32 Magic = 0x4D434D51; // "QMCM"
+		static constexpr UInt32 Version = 1;
+
+		/// <summary>
+		/// path of the cache file belonging to a source model file
+		/// </summary>
+		static std::string GetCachePath(const std::string& sourcePath);
+
+		/// <summary>
+		/// hash of the file size and last write time, 0 if the file doesn't exist.
+		/// Cheap enough for every load, a touched but unchanged source only costs one rebuild of the cache
+		/// </summary>
+		static UInt64 HashFile(const std::string& filePath);
+		static UInt64 HashProperties(const ModelImportProperties& properties);
+
+		/// <summary>
+		/// returns nullptr if the cache file is missing, corrupt, from another version or built from different input
+		/// </summary>
+		static ref<Model3DAsset> Load(const std::string& cachePath, UInt64 sourceHash, const ModelImportProperties& properties);
+		static bool Save(const std::string& cachePath, UInt64 sourceHash, const ModelImportProperties& properties, const std::vector<std::pair<std::string, ref<Mesh>>>& meshes);
+	private:
+		static void WriteMesh(std::vector<Byte>& buffer, UInt64 recordOffset, const ref<Mesh>& mesh, UInt32 lodCount, Float lodError);
+		static ref<Mesh> ReadMesh(const Byte* data, UInt64 size, UInt64 recordOffset);
+	};
+}
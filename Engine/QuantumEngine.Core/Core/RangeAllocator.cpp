@@ -0,0 +1,67 @@
+#include "RangeAllocator.h"
+#include <algorithm>
+
+QuantumEngine::RangeAllocator::RangeAllocator(UInt32 capacity)
+{
+	Reset(capacity);
+}
+
+void QuantumEngine::RangeAllocator::Reset(UInt32 capacity)
+{
+	m_capacity = capacity;
+	m_freeSize = capacity;
+	m_freeRanges.clear();
+
+	if (capacity > 0)
+		m_freeRanges.push_back(AllocatedRange{ .offset = 0, .size = capacity });
+}
+
+bool QuantumEngine::RangeAllocator::Allocate(UInt32 size, UInt32* offset)
+{
+	auto it = std::find_if(m_freeRanges.begin(), m_freeRanges.end(), [size](const AllocatedRange& range) {
+		return range.size >= size;
+		});
+
+	if (it == m_freeRanges.end())
+		return false;
+
+	*offset = it->offset;
+	it->offset += size;
+	it->size -= size;
+	m_freeSize -= size;
+
+	if (it->size == 0)
+		m_freeRanges.erase(it);
+
+	return true;
+}
+
+void QuantumEngine::RangeAllocator::Free(UInt32 offset, UInt32 size)
+{
+	if (size == 0)
+		return;
+
+	m_freeSize += size;
+
+	auto next = std::lower_bound(m_freeRanges.begin(), m_freeRanges.end(), offset, [](const AllocatedRange& range, UInt32 offset) {
+		return range.offset < offset;
+		});
+
+	bool mergePrevious = next != m_freeRanges.begin() && (next - 1)->offset + (next - 1)->size == offset;
+	bool mergeNext = next != m_freeRanges.end() && offset + size == next->offset;
+
+	if (mergePrevious && mergeNext) {
+		(next - 1)->size += size + next->size;
+		m_freeRanges.erase(next);
+	}
+	else if (mergePrevious) {
+		(next - 1)->size += size;
+	}
+	else if (mergeNext) {
+		next->offset = offset;
+		next->size += size;
+	}
+	else {
+		m_freeRanges.insert(next, AllocatedRange{ .offset = offset, .size = size });
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <vector>
+#include "../BasicTypes.h"
+
+namespace QuantumEngine {
+	struct AllocatedRange {
+		UInt32 offset;
+		UInt32 size;
+	};
+
+	/// <summary>
+	/// First fit allocator of variable length ranges inside a fixed capacity, used to sub allocate pooled GPU buffers.
+	/// Freed ranges are merged with their free neighbours
+	/// </summary>
+	class RangeAllocator {
+	public:
+		RangeAllocator(UInt32 capacity = 0);
+
+		/// <summary>
+		/// frees every range
+		/// </summary>
+		void Reset(UInt32 capacity);
+
+		/// <summary>
+		/// finds the first free range that fits size
+		/// </summary>
+		/// <returns>false if no free range is large enough, fragmented pools can fail with enough total space</returns>
+		bool Allocate(UInt32 size, UInt32* offset);
+		void Free(UInt32 offset, UInt32 size);
+
+		inline UInt32 GetCapacity() const { return m_capacity; }
+		inline UInt32 GetFreeSize() const { return m_freeSize; }
+	private:
+		UInt32 m_capacity;
+		UInt32 m_freeSize;
+		// sorted by offset, never adjacent
+		std::vector<AllocatedRange> m_freeRanges;
+	};
+}
@@ -16,7 +16,7 @@ namespace QuantumEngine {
 	class Scene {
 	public:
 		ref<Camera> mainCamera;
-		SceneLightData lightData;
+		ref<SceneLightData> lightData;
 		std::vector<ref<GameEntity>> entities;
 		ref<Rendering::Material> rtGlobalMaterial;
 		std::vector<ref<Behaviour>> behaviours;
@@ -0,0 +1,597 @@
+#include "SceneBVH.h"
+#include "GameEntity.h"
+#include "Matrix4.h"
+#include "Mesh.h"
+#include "Transform.h"
+#include "Camera/FrustumCuller.h"
+#include "../Rendering/Renderer.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <thread>
+
+namespace {
+	constexpr UInt32 BinCount = 16;
+
+	using AABB = QuantumEngine::AABB;
+
+	AABB EmptyBounds()
+	{
+		constexpr Float max = std::numeric_limits<Float>::max();
+		return AABB{ QuantumEngine::Vector3(max, max, max), QuantumEngine::Vector3(-max, -max, -max) };
+	}
+
+	void Grow(AABB& bounds, const AABB& other)
+	{
+		bounds.min.x = std::min(bounds.min.x, other.min.x);
+		bounds.min.y = std::min(bounds.min.y, other.min.y);
+		bounds.min.z = std::min(bounds.min.z, other.min.z);
+		bounds.max.x = std::max(bounds.max.x, other.max.x);
+		bounds.max.y = std::max(bounds.max.y, other.max.y);
+		bounds.max.z = std::max(bounds.max.z, other.max.z);
+	}
+
+	AABB Union(const AABB& a, const AABB& b)
+	{
+		AABB bounds = a;
+		Grow(bounds, b);
+		return bounds;
+	}
+
+	Float SurfaceArea(const AABB& bounds)
+	{
+		Float x = bounds.max.x - bounds.min.x;
+		Float y = bounds.max.y - bounds.min.y;
+		Float z = bounds.max.z - bounds.min.z;
+		return x < 0.0f ? 0.0f : 2.0f * (x * y + y * z + z * x);
+	}
+
+	bool Contains(const AABB& outer, const AABB& inner)
+	{
+		return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y && outer.min.z <= inner.min.z &&
+			outer.max.x >= inner.max.x && outer.max.y >= inner.max.y && outer.max.z >= inner.max.z;
+	}
+
+	bool Overlaps(const AABB& a, const AABB& b)
+	{
+		return a.min.x <= b.max.x && a.max.x >= b.min.x && a.min.y <= b.max.y && a.max.y >= b.min.y &&
+			a.min.z <= b.max.z && a.max.z >= b.min.z;
+	}
+
+	Float Component(const QuantumEngine::Vector3& vector, UInt32 axis)
+	{
+		return axis == 0 ? vector.x : (axis == 1 ? vector.y : vector.z);
+	}
+
+	bool IsInsideFrustum(const AABB& bounds, const Float (&planes)[6][4])
+	{
+		for (auto& plane : planes) {
+			// corner furthest along the plane normal
+			Float x = plane[0] >= 0.0f ? bounds.max.x : bounds.min.x;
+			Float y = plane[1] >= 0.0f ? bounds.max.y : bounds.min.y;
+			Float z = plane[2] >= 0.0f ? bounds.max.z : bounds.min.z;
+
+			if (plane[0] * x + plane[1] * y + plane[2] * z + plane[3] < 0.0f)
+				return false;
+		}
+
+		return true;
+	}
+
+	Float SquareDistanceToBounds(const AABB& bounds, const QuantumEngine::Vector3& point)
+	{
+		Float x = std::max(std::max(bounds.min.x - point.x, point.x - bounds.max.x), 0.0f);
+		Float y = std::max(std::max(bounds.min.y - point.y, point.y - bounds.max.y), 0.0f);
+		Float z = std::max(std::max(bounds.min.z - point.z, point.z - bounds.max.z), 0.0f);
+		return x * x + y * y + z * z;
+	}
+
+	// distance along the ray to where it enters the bounds, infinity if it misses them within maxDistance
+	Float IntersectRay(const AABB& bounds, const Float (&origin)[3], const Float (&inverseDirection)[3], Float maxDistance)
+	{
+		Float enter = 0.0f;
+		Float exit = maxDistance;
+		const Float boundsMin[3] = { bounds.min.x, bounds.min.y, bounds.min.z };
+		const Float boundsMax[3] = { bounds.max.x, bounds.max.y, bounds.max.z };
+
+		for (UInt32 axis = 0; axis < 3; axis++) {
+			Float t1 = (boundsMin[axis] - origin[axis]) * inverseDirection[axis];
+			Float t2 = (boundsMax[axis] - origin[axis]) * inverseDirection[axis];
+			enter = std::max(enter, std::min(t1, t2));
+			exit = std::min(exit, std::max(t1, t2));
+		}
+
+		return enter <= exit ? enter : std::numeric_limits<Float>::infinity();
+	}
+}
+
+QuantumEngine::SceneBVH::SceneBVH(const SceneBVHProperties& properties)
+	:m_properties(properties), m_buildNodeCount(0)
+{
+	m_properties.parallelBuildThreshold = std::max(m_properties.parallelBuildThreshold, 2u);
+}
+
+void QuantumEngine::SceneBVH::Build(const std::vector<ref<GameEntity>>& entities)
+{
+	const UInt32 count = (UInt32)entities.size();
+	m_entities = entities;
+	m_entityBounds.resize(count);
+	m_entityLeaves.assign(count, NullNode);
+	m_nodes.assign(count > 0 ? 2 * count - 1 : 0, Node{});
+	m_freeNodes.clear();
+	m_root = NullNode;
+
+	if (count == 0)
+		return;
+
+	m_buildOrder.resize(count);
+	m_buildCentroids.resize(count);
+	std::iota(m_buildOrder.begin(), m_buildOrder.end(), 0u);
+
+	for (UInt32 i = 0; i < count; i++) {
+		ComputeEntityBounds(i);
+		m_buildCentroids[i] = 0.5f * (m_entityBounds[i].min + m_entityBounds[i].max);
+	}
+
+	UInt32 threadCount = m_properties.threadCount > 0 ? m_properties.threadCount : std::max(std::thread::hardware_concurrency(), 1u);
+
+	m_root = 0;
+	m_buildNodeCount = 1;
+	BuildRange(m_root, NullNode, 0, count, threadCount);
+
+	m_buildOrder.clear();
+	m_buildCentroids.clear();
+}
+
+UInt32 QuantumEngine::SceneBVH::Update()
+{
+	UInt32 reinsertedCount = 0;
+
+	for (UInt32 i = 0; i < GetEntityCount(); i++)
+		reinsertedCount += UpdateEntity(i);
+
+	return reinsertedCount;
+}
+
+bool QuantumEngine::SceneBVH::UpdateEntity(UInt32 entityIndex)
+{
+	ComputeEntityBounds(entityIndex);
+	Int32 leaf = m_entityLeaves[entityIndex];
+
+	if (Contains(m_nodes[leaf].bounds, m_entityBounds[entityIndex]))
+		return false;
+
+	RemoveLeaf(leaf);
+	m_nodes[leaf].bounds = GetLeafBounds(entityIndex);
+	InsertLeaf(leaf);
+	return true;
+}
+
+void QuantumEngine::SceneBVH::QueryFrustum(const Matrix4& viewProjection, std::vector<UInt32>& result) const
+{
+	if (m_root == NullNode)
+		return;
+
+	Float planes[6][4];
+	FrustumCuller::ExtractPlanes(viewProjection, planes);
+
+	std::vector<Int32> stack{ m_root };
+
+	while (stack.empty() == false) {
+		const Node& node = m_nodes[stack.back()];
+		stack.pop_back();
+
+		if (IsInsideFrustum(node.bounds, planes) == false)
+			continue;
+
+		if (node.entityIndex != NullNode) {
+			if (IsInsideFrustum(m_entityBounds[node.entityIndex], planes))
+				result.push_back(node.entityIndex);
+
+			continue;
+		}
+
+		stack.push_back(node.children[0]);
+		stack.push_back(node.children[1]);
+	}
+}
+
+void QuantumEngine::SceneBVH::QueryAABB(const AABB& bounds, std::vector<UInt32>& result) const
+{
+	if (m_root == NullNode)
+		return;
+
+	std::vector<Int32> stack{ m_root };
+
+	while (stack.empty() == false) {
+		const Node& node = m_nodes[stack.back()];
+		stack.pop_back();
+
+		if (Overlaps(node.bounds, bounds) == false)
+			continue;
+
+		if (node.entityIndex != NullNode) {
+			if (Overlaps(m_entityBounds[node.entityIndex], bounds))
+				result.push_back(node.entityIndex);
+
+			continue;
+		}
+
+		stack.push_back(node.children[0]);
+		stack.push_back(node.children[1]);
+	}
+}
+
+void QuantumEngine::SceneBVH::QuerySphere(const Vector3& center, Float radius, std::vector<UInt32>& result) const
+{
+	if (m_root == NullNode)
+		return;
+
+	const Float squareRadius = radius * radius;
+	std::vector<Int32> stack{ m_root };
+
+	while (stack.empty() == false) {
+		const Node& node = m_nodes[stack.back()];
+		stack.pop_back();
+
+		if (SquareDistanceToBounds(node.bounds, center) > squareRadius)
+			continue;
+
+		if (node.entityIndex != NullNode) {
+			if (SquareDistanceToBounds(m_entityBounds[node.entityIndex], center) <= squareRadius)
+				result.push_back(node.entityIndex);
+
+			continue;
+		}
+
+		stack.push_back(node.children[0]);
+		stack.push_back(node.children[1]);
+	}
+}
+
+bool QuantumEngine::SceneBVH::Raycast(const Vector3& origin, const Vector3& direction, Float maxDistance, SceneRayHit& hit) const
+{
+	if (m_root == NullNode)
+		return false;
+
+	const Float rayOrigin[3] = { origin.x, origin.y, origin.z };
+	const Float inverseDirection[3] = { 1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z };
+	Float closest = maxDistance;
+	Int32 closestEntity = NullNode;
+
+	// nodes are pushed with their entry distance so farther ones are dropped once something closer is hit
+	std::vector<std::pair<Int32, Float>> stack;
+	stack.reserve(64);
+
+	Float rootDistance = IntersectRay(m_nodes[m_root].bounds, rayOrigin, inverseDirection, closest);
+	if (rootDistance <= closest)
+		stack.push_back({ m_root, rootDistance });
+
+	while (stack.empty() == false) {
+		auto [nodeIndex, distance] = stack.back();
+		stack.pop_back();
+
+		if (distance > closest)
+			continue;
+
+		const Node& node = m_nodes[nodeIndex];
+
+		if (node.entityIndex != NullNode) {
+			Float entityDistance = IntersectRay(m_entityBounds[node.entityIndex], rayOrigin, inverseDirection, closest);
+
+			if (entityDistance <= closest) {
+				closest = entityDistance;
+				closestEntity = node.entityIndex;
+			}
+
+			continue;
+		}
+
+		Float distance0 = IntersectRay(m_nodes[node.children[0]].bounds, rayOrigin, inverseDirection, closest);
+		Float distance1 = IntersectRay(m_nodes[node.children[1]].bounds, rayOrigin, inverseDirection, closest);
+
+		// the nearer child goes on top
+		if (distance0 > distance1) {
+			if (distance0 <= closest)
+				stack.push_back({ node.children[0], distance0 });
+
+			if (distance1 <= closest)
+				stack.push_back({ node.children[1], distance1 });
+		}
+		else {
+			if (distance1 <= closest)
+				stack.push_back({ node.children[1], distance1 });
+
+			if (distance0 <= closest)
+				stack.push_back({ node.children[0], distance0 });
+		}
+	}
+
+	if (closestEntity == NullNode)
+		return false;
+
+	hit.entityIndex = closestEntity;
+	hit.distance = closest;
+	return true;
+}
+
+Float QuantumEngine::SceneBVH::GetCost() const
+{
+	if (m_root == NullNode)
+		return 0.0f;
+
+	Float rootArea = SurfaceArea(m_nodes[m_root].bounds);
+	Float area = 0.0f;
+	std::vector<Int32> stack{ m_root };
+
+	while (stack.empty() == false) {
+		const Node& node = m_nodes[stack.back()];
+		stack.pop_back();
+
+		if (node.entityIndex != NullNode)
+			continue;
+
+		area += SurfaceArea(node.bounds);
+		stack.push_back(node.children[0]);
+		stack.push_back(node.children[1]);
+	}
+
+	return rootArea > 0.0f ? area / rootArea : 0.0f;
+}
+
+void QuantumEngine::SceneBVH::ComputeEntityBounds(UInt32 entityIndex)
+{
+	auto& entity = m_entities[entityIndex];
+	auto transform = entity->GetTransform();
+	auto renderer = entity->GetRenderer();
+	ref<Mesh> mesh = renderer != nullptr ? renderer->GetMesh() : nullptr;
+
+	if (mesh == nullptr) {
+		// entities without geometry are points at their position
+		m_entityBounds[entityIndex] = AABB{ transform->Position(), transform->Position() };
+		return;
+	}
+
+	Matrix4 world = transform->Matrix();
+	Vector3 boundsMin = mesh->GetBoundsMin();
+	Vector3 boundsMax = mesh->GetBoundsMax();
+	const Float center[3] = { 0.5f * (boundsMin.x + boundsMax.x), 0.5f * (boundsMin.y + boundsMax.y), 0.5f * (boundsMin.z + boundsMax.z) };
+	const Float extent[3] = { 0.5f * (boundsMax.x - boundsMin.x), 0.5f * (boundsMax.y - boundsMin.y), 0.5f * (boundsMax.z - boundsMin.z) };
+	Float worldCenter[3];
+	Float worldExtent[3];
+
+	// the extent of a transformed box is the absolute matrix applied to its half size
+	for (UInt32 row = 0; row < 3; row++) {
+		worldCenter[row] = world(row, 3);
+		worldExtent[row] = 0.0f;
+
+		for (UInt32 column = 0; column < 3; column++) {
+			worldCenter[row] += world(row, column) * center[column];
+			worldExtent[row] += std::fabs(world(row, column)) * extent[column];
+		}
+	}
+
+	m_entityBounds[entityIndex] = AABB{
+		Vector3(worldCenter[0] - worldExtent[0], worldCenter[1] - worldExtent[1], worldCenter[2] - worldExtent[2]),
+		Vector3(worldCenter[0] + worldExtent[0], worldCenter[1] + worldExtent[1], worldCenter[2] + worldExtent[2]),
+	};
+}
+
+AABB QuantumEngine::SceneBVH::GetLeafBounds(UInt32 entityIndex) const
+{
+	const AABB& bounds = m_entityBounds[entityIndex];
+	Float margin = m_properties.boundsMargin;
+	Vector3 grow((bounds.max.x - bounds.min.x) * margin, (bounds.max.y - bounds.min.y) * margin, (bounds.max.z - bounds.min.z) * margin);
+	return AABB{ bounds.min - grow, bounds.max + grow };
+}
+
+void QuantumEngine::SceneBVH::BuildRange(Int32 nodeIndex, Int32 parent, UInt32 begin, UInt32 end, UInt32 threadBudget)
+{
+	if (end - begin == 1) {
+		MakeLeaf(nodeIndex, parent, m_buildOrder[begin]);
+		return;
+	}
+
+	AABB centroidBounds = EmptyBounds();
+
+	for (UInt32 i = begin; i < end; i++) {
+		const Vector3& centroid = m_buildCentroids[m_buildOrder[i]];
+		Grow(centroidBounds, AABB{ centroid, centroid });
+	}
+
+	Vector3 centroidExtent = centroidBounds.max - centroidBounds.min;
+	UInt32 axis = centroidExtent.x >= centroidExtent.y && centroidExtent.x >= centroidExtent.z ? 0 : (centroidExtent.y >= centroidExtent.z ? 1 : 2);
+	Float axisMin = Component(centroidBounds.min, axis);
+	Float axisExtent = Component(centroidExtent, axis);
+	UInt32 middle = begin + (end - begin) / 2;
+
+	if (axisExtent > 0.0f) {
+		AABB binBounds[BinCount];
+		UInt32 binCounts[BinCount] = {};
+		Float binScale = BinCount / axisExtent;
+
+		for (auto& bounds : binBounds)
+			bounds = EmptyBounds();
+
+		auto binOf = [&](UInt32 entityIndex) {
+			return std::min((UInt32)((Component(m_buildCentroids[entityIndex], axis) - axisMin) * binScale), BinCount - 1);
+			};
+
+		for (UInt32 i = begin; i < end; i++) {
+			UInt32 bin = binOf(m_buildOrder[i]);
+			Grow(binBounds[bin], m_entityBounds[m_buildOrder[i]]);
+			binCounts[bin]++;
+		}
+
+		// SAH cost of splitting after every bin, right side swept first
+		Float rightCosts[BinCount];
+		AABB sweepBounds = EmptyBounds();
+		UInt32 sweepCount = 0;
+
+		for (UInt32 bin = BinCount - 1; bin > 0; bin--) {
+			Grow(sweepBounds, binBounds[bin]);
+			sweepCount += binCounts[bin];
+			rightCosts[bin - 1] = SurfaceArea(sweepBounds) * sweepCount;
+		}
+
+		sweepBounds = EmptyBounds();
+		sweepCount = 0;
+		Float bestCost = std::numeric_limits<Float>::max();
+		UInt32 bestSplit = 0;
+
+		for (UInt32 bin = 0; bin < BinCount - 1; bin++) {
+			Grow(sweepBounds, binBounds[bin]);
+			sweepCount += binCounts[bin];
+			Float cost = SurfaceArea(sweepBounds) * sweepCount + rightCosts[bin];
+
+			if (sweepCount > 0 && sweepCount < end - begin && cost < bestCost) {
+				bestCost = cost;
+				bestSplit = bin;
+			}
+		}
+
+		middle = (UInt32)(std::partition(m_buildOrder.begin() + begin, m_buildOrder.begin() + end,
+			[&](UInt32 entityIndex) { return binOf(entityIndex) <= bestSplit; }) - m_buildOrder.begin());
+
+		if (middle == begin || middle == end)
+			middle = begin + (end - begin) / 2;
+	}
+
+	Int32 firstChild = m_buildNodeCount.fetch_add(2);
+	Node& node = m_nodes[nodeIndex];
+	node.parent = parent;
+	node.children[0] = firstChild;
+	node.children[1] = firstChild + 1;
+	node.entityIndex = NullNode;
+
+	if (threadBudget > 1 && end - begin > m_properties.parallelBuildThreshold) {
+		std::thread leftThread(&SceneBVH::BuildRange, this, firstChild, nodeIndex, begin, middle, threadBudget / 2);
+		BuildRange(firstChild + 1, nodeIndex, middle, end, threadBudget - threadBudget / 2);
+		leftThread.join();
+	}
+	else {
+		BuildRange(firstChild, nodeIndex, begin, middle, 1);
+		BuildRange(firstChild + 1, nodeIndex, middle, end, 1);
+	}
+
+	node.bounds = Union(m_nodes[firstChild].bounds, m_nodes[firstChild + 1].bounds);
+}
+
+void QuantumEngine::SceneBVH::MakeLeaf(Int32 nodeIndex, Int32 parent, UInt32 entityIndex)
+{
+	Node& node = m_nodes[nodeIndex];
+	node.bounds = GetLeafBounds(entityIndex);
+	node.parent = parent;
+	node.children[0] = NullNode;
+	node.children[1] = NullNode;
+	node.entityIndex = (Int32)entityIndex;
+	m_entityLeaves[entityIndex] = nodeIndex;
+}
+
+Int32 QuantumEngine::SceneBVH::AllocateNode()
+{
+	if (m_freeNodes.empty() == false) {
+		Int32 nodeIndex = m_freeNodes.back();
+		m_freeNodes.pop_back();
+		return nodeIndex;
+	}
+
+	m_nodes.push_back(Node{});
+	return (Int32)m_nodes.size() - 1;
+}
+
+void QuantumEngine::SceneBVH::FreeNode(Int32 nodeIndex)
+{
+	m_freeNodes.push_back(nodeIndex);
+}
+
+void QuantumEngine::SceneBVH::InsertLeaf(Int32 leaf)
+{
+	if (m_root == NullNode) {
+		m_root = leaf;
+		m_nodes[leaf].parent = NullNode;
+		return;
+	}
+
+	const AABB leafBounds = m_nodes[leaf].bounds;
+	Int32 index = m_root;
+
+	// descend towards the sibling that grows the tree the least
+	while (m_nodes[index].entityIndex == NullNode) {
+		const Node& node = m_nodes[index];
+		Float area = SurfaceArea(node.bounds);
+		Float combinedArea = SurfaceArea(Union(node.bounds, leafBounds));
+
+		// pairing with this node, and the growth every child option forces on it
+		Float cost = 2.0f * combinedArea;
+		Float inheritanceCost = 2.0f * (combinedArea - area);
+		Float childCosts[2];
+
+		for (UInt32 c = 0; c < 2; c++) {
+			const Node& child = m_nodes[node.children[c]];
+			Float childCombinedArea = SurfaceArea(Union(child.bounds, leafBounds));
+			childCosts[c] = inheritanceCost + (child.entityIndex != NullNode ? childCombinedArea : childCombinedArea - SurfaceArea(child.bounds));
+		}
+
+		if (cost < childCosts[0] && cost < childCosts[1])
+			break;
+
+		index = childCosts[0] <= childCosts[1] ? node.children[0] : node.children[1];
+	}
+
+	Int32 sibling = index;
+	Int32 oldParent = m_nodes[sibling].parent;
+	Int32 newParent = AllocateNode();
+
+	m_nodes[newParent] = Node{
+		.bounds = Union(leafBounds, m_nodes[sibling].bounds),
+		.parent = oldParent,
+		.children = { sibling, leaf },
+		.entityIndex = NullNode,
+	};
+	m_nodes[sibling].parent = newParent;
+	m_nodes[leaf].parent = newParent;
+
+	if (oldParent == NullNode) {
+		m_root = newParent;
+		return;
+	}
+
+	Node& parentNode = m_nodes[oldParent];
+	parentNode.children[parentNode.children[0] == sibling ? 0 : 1] = newParent;
+	RefitFrom(oldParent);
+}
+
+void QuantumEngine::SceneBVH::RemoveLeaf(Int32 leaf)
+{
+	if (leaf == m_root) {
+		m_root = NullNode;
+		return;
+	}
+
+	Int32 parent = m_nodes[leaf].parent;
+	Int32 grandParent = m_nodes[parent].parent;
+	Int32 sibling = m_nodes[parent].children[0] == leaf ? m_nodes[parent].children[1] : m_nodes[parent].children[0];
+	FreeNode(parent);
+
+	if (grandParent == NullNode) {
+		m_root = sibling;
+		m_nodes[sibling].parent = NullNode;
+		return;
+	}
+
+	Node& grandParentNode = m_nodes[grandParent];
+	grandParentNode.children[grandParentNode.children[0] == parent ? 0 : 1] = sibling;
+	m_nodes[sibling].parent = grandParent;
+	RefitFrom(grandParent);
+}
+
+void QuantumEngine::SceneBVH::RefitFrom(Int32 nodeIndex)
+{
+	while (nodeIndex != NullNode) {
+		Node& node = m_nodes[nodeIndex];
+		node.bounds = Union(m_nodes[node.children[0]].bounds, m_nodes[node.children[1]].bounds);
+		nodeIndex = node.parent;
+	}
+}
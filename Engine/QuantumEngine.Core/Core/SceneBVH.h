@@ -0,0 +1,107 @@
+#pragma once
+#include <atomic>
+#include <vector>
+#include "../BasicTypes.h"
+#include "Vector3.h"
+
+namespace QuantumEngine {
+	class GameEntity;
+	struct Matrix4;
+
+	struct AABB {
+		Vector3 min;
+		Vector3 max;
+	};
+
+	struct SceneBVHProperties {
+		// leaf bounds are grown by this fraction of their size so small moves don't touch the tree
+		Float boundsMargin = 0.1f;
+		// ranges with more entities than this are built on another thread
+		UInt32 parallelBuildThreshold = 4096;
+		// 0 picks the core count
+		UInt32 threadCount = 0;
+	};
+
+	struct SceneRayHit {
+		UInt32 entityIndex;
+		// along the ray to the entry point of the entity bounds
+		Float distance;
+	};
+
+	/// <summary>
+	/// Dynamic bounding volume hierarchy over the world bounds of scene entities, one entity per leaf.
+	/// The tree is bulk built top-down with a binned SAH, entities that leave their grown leaf bounds are removed
+	/// and reinserted at the cheapest sibling, refitting the path to the root.
+	/// Queries return indices into the entity list the tree was built with
+	/// </summary>
+	class SceneBVH {
+	public:
+		SceneBVH(const SceneBVHProperties& properties = {});
+
+		void Build(const std::vector<ref<GameEntity>>& entities);
+
+		/// <summary>
+		/// recomputes the bounds of every entity and reinserts the ones that moved out of their leaf
+		/// </summary>
+		/// <returns>number of reinserted entities</returns>
+		UInt32 Update();
+
+		/// <summary>
+		/// same as Update for a single entity whose transform changed
+		/// </summary>
+		/// <returns>true if the entity was reinserted</returns>
+		bool UpdateEntity(UInt32 entityIndex);
+
+		void QueryFrustum(const Matrix4& viewProjection, std::vector<UInt32>& result) const;
+		void QueryAABB(const AABB& bounds, std::vector<UInt32>& result) const;
+		void QuerySphere(const Vector3& center, Float radius, std::vector<UInt32>& result) const;
+
+		/// <summary>
+		/// finds the closest entity whose bounds the ray enters, direction doesn't need to be normalized
+		/// </summary>
+		bool Raycast(const Vector3& origin, const Vector3& direction, Float maxDistance, SceneRayHit& hit) const;
+
+		inline UInt32 GetEntityCount() const { return static_cast<UInt32>(m_entities.size()); }
+		inline const ref<GameEntity>& GetEntity(UInt32 entityIndex) const { return m_entities[entityIndex]; }
+		inline const AABB& GetEntityBounds(UInt32 entityIndex) const { return m_entityBounds[entityIndex]; }
+
+		/// <summary>
+		/// sum of the node surface areas over the root area, grows as reinsertion degrades the tree
+		/// </summary>
+		Float GetCost() const;
+	private:
+		static constexpr Int32 NullNode = -1;
+
+		struct Node {
+			AABB bounds;
+			Int32 parent;
+			Int32 children[2];
+			// NullNode for inner nodes
+			Int32 entityIndex;
+		};
+
+		void ComputeEntityBounds(UInt32 entityIndex);
+		AABB GetLeafBounds(UInt32 entityIndex) const;
+		void BuildRange(Int32 nodeIndex, Int32 parent, UInt32 begin, UInt32 end, UInt32 threadBudget);
+		void MakeLeaf(Int32 nodeIndex, Int32 parent, UInt32 entityIndex);
+		Int32 AllocateNode();
+		void FreeNode(Int32 nodeIndex);
+		void InsertLeaf(Int32 leaf);
+		void RemoveLeaf(Int32 leaf);
+		void RefitFrom(Int32 nodeIndex);
+
+		SceneBVHProperties m_properties;
+		std::vector<ref<GameEntity>> m_entities;
+		std::vector<AABB> m_entityBounds;
+		std::vector<Int32> m_entityLeaves;
+
+		std::vector<Node> m_nodes;
+		std::vector<Int32> m_freeNodes;
+		Int32 m_root = NullNode;
+
+		// build state, entity order and centroids shared by the build threads
+		std::vector<UInt32> m_buildOrder;
+		std::vector<Vector3> m_buildCentroids;
+		std::atomic<Int32> m_buildNodeCount;
+	};
+}
@@ -1,15 +1,25 @@
 #include "Texture2D.h"
 
 QuantumEngine::Texture2D::Texture2D(const TextureProperties& properties)
-	:m_width(properties.width), m_height(properties.height), m_bpp(properties.bpp),
-	m_size(properties.size), m_format(properties.format), 
-	m_data(properties.copyPixelData ? new Byte[m_size] : properties.data)
+	:m_data(properties.copyPixelData && properties.dataOwner == nullptr ? new Byte[properties.size] : properties.data),
+	m_width(properties.width), m_height(properties.height), m_size(properties.size), m_bpp(properties.bpp),
+	m_channelCount(properties.channelCount), m_format(properties.format),
+	m_mipLevelCount(std::max(properties.mipLevelCount, 1u)), m_generateGPUMips(properties.generateGPUMips), m_sRGB(properties.sRGB), m_dataOwner(properties.dataOwner)
 {
-	if(properties.copyPixelData)
+	if(properties.copyPixelData && m_dataOwner == nullptr)
 		std::memcpy(m_data, properties.data, m_size);
+
+	m_mipOffsets.resize(m_mipLevelCount);
+	UInt32 offset = 0;
+
+	for (UInt32 level = 0; level < m_mipLevelCount; level++) {
+		m_mipOffsets[level] = offset;
+		offset += GetMipSize(level);
+	}
 }
 
 QuantumEngine::Texture2D::~Texture2D()
 {
-	delete[] m_data;
+	if (m_dataOwner == nullptr)
+		delete[] m_data;
 }
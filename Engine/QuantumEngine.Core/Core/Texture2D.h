@@ -1,6 +1,8 @@
 #pragma once
 
 #include "../BasicTypes.h"
+#include <algorithm>
+#include <vector>
 
 namespace QuantumEngine::Rendering {
 	class GPUTexture2DController;
@@ -11,8 +13,29 @@ namespace QuantumEngine {
 		Unknown,
 		RGBA32,
 		BGRA32,
+		RGBA64F, // 16-bit float per channel
+		BC1, // RGB in 4x4 blocks of 8 bytes
+		BC3, // RGBA in 4x4 blocks of 16 bytes, alpha stored as BC4
+		BC5, // two channel (RG) in 4x4 blocks of 16 bytes
+		BC7, // RGBA in 4x4 blocks of 16 bytes
 	};
 
+	inline bool IsBlockCompressed(TextureFormat format)
+	{
+		return format == TextureFormat::BC1 || format == TextureFormat::BC3 || format == TextureFormat::BC5 || format == TextureFormat::BC7;
+	}
+
+	/// <summary>
+	/// bytes of one 4x4 block, 0 for formats that aren't block compressed
+	/// </summary>
+	inline UInt32 GetBlockByteSize(TextureFormat format)
+	{
+		if (format == TextureFormat::BC1)
+			return 8;
+
+		return IsBlockCompressed(format) ? 16 : 0;
+	}
+
 	struct TextureProperties {
 		Byte* data;
 		bool copyPixelData;
@@ -22,6 +45,14 @@ namespace QuantumEngine {
 		UInt32 bpp;
 		UInt32 channelCount;
 		TextureFormat format;
+		// levels are stored back to back from the largest, size covers all of them
+		UInt32 mipLevelCount = 1;
+		// blit the mip chain from level 0 on the GPU at upload time instead of uploading CPU levels (if the backend can)
+		bool generateGPUMips = false;
+		// 8-bit color channels hold sRGB encoded color. Data such as normal, metallic, roughness or mask maps is linear and stored as is
+		bool sRGB = true;
+		// if set, data points into memory owned by this object (e.g. a mapped file). It is kept alive with the texture and data is never copied or freed
+		ref<void> dataOwner = nullptr;
 	};
 
 	class Texture2D {
@@ -32,8 +63,24 @@ namespace QuantumEngine {
 		inline UInt32 GetHeight() const { return m_height; }
 		inline UInt32 GetTotalSize() const { return m_size; }
 		inline TextureFormat GetFormat() const { return m_format; }
+		inline UInt32 GetBitsPerPixel() const { return m_bpp; }
+		// meaningless for block compressed formats, use the mip row helpers instead
 		inline UInt32 GetBytePerPixel() const { return (m_bpp + 7) / 8; }
+		inline UInt32 GetChannelCount() const { return m_channelCount; }
+		inline UInt32 GetMipLevelCount() const { return m_mipLevelCount; }
+		inline UInt32 GetMipWidth(UInt32 level) const { return std::max(m_width >> level, 1u); }
+		inline UInt32 GetMipHeight(UInt32 level) const { return std::max(m_height >> level, 1u); }
+		inline UInt32 GetMipOffset(UInt32 level) const { return m_mipOffsets[level]; }
+		// rows of pixels, or rows of 4x4 blocks for block compressed formats
+		inline UInt32 GetMipRowCount(UInt32 level) const { return IsBlockCompressed(m_format) ? (GetMipHeight(level) + 3) / 4 : GetMipHeight(level); }
+		inline UInt32 GetMipRowSize(UInt32 level) const { return IsBlockCompressed(m_format) ? (GetMipWidth(level) + 3) / 4 * GetBlockByteSize(m_format) : GetMipWidth(level) * GetBytePerPixel(); }
+		inline UInt32 GetMipSize(UInt32 level) const { return GetMipRowCount(level) * GetMipRowSize(level); }
+		inline bool GetGenerateGPUMips() const { return m_generateGPUMips; }
+		inline void SetGenerateGPUMips(bool generate) { m_generateGPUMips = generate; }
+		inline bool IsSRGB() const { return m_sRGB; }
+		inline void SetSRGB(bool sRGB) { m_sRGB = sRGB; }
 		Byte* GetData() { return m_data; }
+		Byte* GetMipData(UInt32 level) { return m_data + m_mipOffsets[level]; }
 		ref<Rendering::GPUTexture2DController> GetGPUHandle() { return m_gpuHandle; }
 		void SetGPUHandle(ref<Rendering::GPUTexture2DController> handle) { m_gpuHandle = handle; }
 	private:
@@ -42,7 +89,13 @@ namespace QuantumEngine {
 		UInt32 m_height;
 		UInt32 m_size;
 		UInt32 m_bpp;
+		UInt32 m_channelCount;
 		TextureFormat m_format;
+		UInt32 m_mipLevelCount;
+		std::vector<UInt32> m_mipOffsets;
+		bool m_generateGPUMips;
+		bool m_sRGB;
+		ref<void> m_dataOwner;
 		ref<Rendering::GPUTexture2DController> m_gpuHandle;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include "Texture2DImporter.h"
+#include "Image/ImageDecoders.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <thread>
+
+ref<QuantumEngine::Texture2D> QuantumEngine::Texture2DImporter::Import(const std::string& filePath, std::string& error)
+{
+	std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+
+	if (file.is_open() == false) {
+		error = "Failed to open " + filePath;
+		return nullptr;
+	}
+
+	std::streamsize size = file.tellg();
+	file.seekg(0, std::ios::beg);
+
+	std::vector<Byte> data((size_t)std::max<std::streamsize>(size, 0));
+
+	if (size <= 0 || !file.read((char*)data.data(), size)) {
+		error = "Failed to read " + filePath;
+		return nullptr;
+	}
+
+	return Decode(data.data(), data.size(), error);
+}
+
+ref<QuantumEngine::Texture2D> QuantumEngine::Texture2DImporter::Decode(const Byte* data, UInt64 size, std::string& error)
+{
+	Image::DecodedImage image;
+	bool decoded;
+
+	if (Image::IsPNG(data, size))
+		decoded = Image::DecodePNG(data, size, image, error);
+	else if (Image::IsJPEG(data, size))
+		decoded = Image::DecodeJPEG(data, size, image, error);
+	else if (Image::IsHDR(data, size))
+		decoded = Image::DecodeHDR(data, size, image, error);
+	else {
+		error = "Unsupported image format";
+		return nullptr;
+	}
+
+	if (decoded == false)
+		return nullptr;
+
+	TextureProperties texProperties;
+	texProperties.width = image.width;
+	texProperties.height = image.height;
+	texProperties.size = image.size;
+	texProperties.bpp = image.bpp;
+	texProperties.channelCount = image.channelCount;
+	texProperties.format = image.format;
+	texProperties.copyPixelData = false;
+	texProperties.data = image.pixels.release();
+
+	return std::make_shared<Texture2D>(texProperties);
+}
+
+std::vector<ref<QuantumEngine::Texture2D>> QuantumEngine::Texture2DImporter::ImportAll(const std::vector<std::string>& filePaths, std::vector<std::string>& errors, UInt32 threadCount)
+{
+	UInt32 fileCount = (UInt32)filePaths.size();
+	std::vector<ref<Texture2D>> textures(fileCount);
+	errors.assign(fileCount, std::string());
+
+	std::atomic<UInt32> nextFile = 0;
+
+	auto worker = [&]() {
+		for (UInt32 file = nextFile++; file < fileCount; file = nextFile++)
+			textures[file] = Import(filePaths[file], errors[file]);
+	};
+
+	if (threadCount == 0)
+		threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+	threadCount = std::min(threadCount, std::max(fileCount, 1u));
+
+	std::vector<std::thread> threads;
+
+	for (UInt32 i = 1; i < threadCount; i++)
+		threads.emplace_back(worker);
+
+	worker();
+
+	for (auto& thread : threads)
+		thread.join();
+
+	return textures;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include "Texture2D.h"
+#include "../BasicTypes.h"
+#include <string>
+#include <vector>
+
+namespace QuantumEngine {
+	/// <summary>
+	/// Platform independent PNG, JPEG and Radiance HDR importer. LDR images are decoded to RGBA32 and HDR images to RGBA64F
+	/// </summary>
+	class Texture2DImporter {
+	public:
+		static ref<Texture2D> Import(const std::string& filePath, std::string& error);
+		static ref<Texture2D> Decode(const Byte* data, UInt64 size, std::string& error);
+
+		/// <summary>
+		/// decodes the files on separate threads. The result and errors line up with filePaths, failed entries are nullptr
+		/// </summary>
+		static std::vector<ref<Texture2D>> ImportAll(const std::vector<std::string>& filePaths, std::vector<std::string>& errors, UInt32 threadCount = 0);
+	};
+}
@@ -0,0 +1,145 @@
+#include "TextureCache.h"
+#include <cstring>
+#include <fstream>
+#include "Texture2D.h"
+#include "TextureCompressor.h"
+#include "TextureMipGenerator.h"
+#include "../Platform/MappedFile.h"
+
+namespace {
+	constexpr UInt64 FnvOffsetBasis = 0xCBF29CE484222325ull;
+	constexpr UInt64 FnvPrime = 0x100000001B3ull;
+
+	struct CacheHeader {
+		UInt32 magic;
+		UInt32 version;
+		UInt32 format;
+		UInt32 width;
+		UInt32 height;
+		UInt32 mipLevelCount;
+		UInt32 bpp;
+		UInt32 channelCount;
+		UInt64 sourceHash;
+		UInt64 propertiesHash;
+		UInt64 fileSize;
+		UInt64 dataSize;
+	};
+
+	static_assert(sizeof(CacheHeader) % 16 == 0, "texture data must start aligned");
+
+	template<typename T>
+	UInt64 HashValue(UInt64 hash, const T& value)
+	{
+		const Byte* bytes = (const Byte*)&value;
+
+		for (UInt64 i = 0; i < sizeof(T); i++) {
+			hash ^= bytes[i];
+			hash *= FnvPrime;
+		}
+
+		return hash;
+	}
+}
+
+std::string QuantumEngine::TextureCache::GetCachePath(const std::string& sourcePath)
+{
+	return sourcePath + ".qtcache";
+}
+
+UInt64 QuantumEngine::TextureCache::HashProperties(bool generateMips, const MipGenerationProperties& mipProperties, const TextureCompressionProperties& compressionProperties)
+{
+	// thread counts don't change the output
+	UInt64 hash = FnvOffsetBasis;
+	hash = HashValue(hash, generateMips);
+
+	if (generateMips) {
+		hash = HashValue(hash, (UInt32)mipProperties.filter);
+		hash = HashValue(hash, mipProperties.sRGB);
+		hash = HashValue(hash, mipProperties.maxLevelCount);
+	}
+
+	hash = HashValue(hash, (UInt32)compressionProperties.format);
+	hash = HashValue(hash, compressionProperties.refinementCount);
+	return hash;
+}
+
+ref<QuantumEngine::Texture2D> QuantumEngine::TextureCache::Load(const std::string& cachePath, UInt64 sourceHash, UInt64 propertiesHash)
+{
+	auto file = Platform::MappedFile::Open(cachePath);
+
+	if (file == nullptr || file->GetSize() < sizeof(CacheHeader))
+		return nullptr;
+
+	const Byte* data = file->GetData();
+	UInt64 fileSize = file->GetSize();
+	CacheHeader header;
+	std::memcpy(&header, data, sizeof(CacheHeader));
+
+	if (header.magic != Magic || header.version != Version || header.fileSize != fileSize)
+		return nullptr;
+
+	if (header.sourceHash != sourceHash || header.propertiesHash != propertiesHash)
+		return nullptr;
+
+	if (header.dataSize != fileSize - sizeof(CacheHeader) || header.mipLevelCount == 0 || header.mipLevelCount > 32)
+		return nullptr;
+
+	TextureProperties properties;
+	// the texture reads straight from the mapping, it stays open as long as the texture lives
+	properties.data = (Byte*)data + sizeof(CacheHeader);
+	properties.copyPixelData = false;
+	properties.width = header.width;
+	properties.height = header.height;
+	properties.size = (UInt32)header.dataSize;
+	properties.bpp = header.bpp;
+	properties.channelCount = header.channelCount;
+	properties.format = (TextureFormat)header.format;
+	properties.mipLevelCount = header.mipLevelCount;
+	properties.generateGPUMips = false;
+	properties.dataOwner = file;
+
+	auto texture = std::make_shared<Texture2D>(properties);
+
+	// the level layout follows from the header, it has to add up to the stored data
+	UInt32 lastLevel = texture->GetMipLevelCount() - 1;
+
+	if ((UInt64)texture->GetMipOffset(lastLevel) + texture->GetMipSize(lastLevel) != header.dataSize)
+		return nullptr;
+
+	return texture;
+}
+
+bool QuantumEngine::TextureCache::Save(const std::string& cachePath, UInt64 sourceHash, UInt64 propertiesHash, const ref<Texture2D>& texture)
+{
+	CacheHeader header{
+		.magic = Magic,
+		.version = Version,
+		.format = (UInt32)texture->GetFormat(),
+		.width = texture->GetWidth(),
+		.height = texture->GetHeight(),
+		.mipLevelCount = texture->GetMipLevelCount(),
+		.bpp = texture->GetBitsPerPixel(),
+		.channelCount = texture->GetChannelCount(),
+		.sourceHash = sourceHash,
+		.propertiesHash = propertiesHash,
+		.fileSize = sizeof(CacheHeader) + (UInt64)texture->GetTotalSize(),
+		.dataSize = texture->GetTotalSize(),
+	};
+
+	// write next to the target and swap it in, so a failed write never leaves a half written cache behind
+	std::string tempPath = cachePath + ".tmp";
+	{
+		std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+
+		if (stream.is_open() == false)
+			return false;
+
+		stream.write((const char*)&header, sizeof(CacheHeader));
+		stream.write((const char*)texture->GetData(), texture->GetTotalSize());
+
+		if (stream.good() == false)
+			return false;
+	}
+
+	return MoveFileExA(tempPath.c_str(), cachePath.c_str(), MOVEFILE_REPLACE_EXISTING) != FALSE;
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <string>
+#include "../BasicTypes.h"
+
+namespace QuantumEngine {
+	class Texture2D;
+	struct MipGenerationProperties;
+	struct TextureCompressionProperties;
+
+	/// <summary>
+	/// Stores processed (mipped and block compressed) textures next to their source file, so the encoding cost is only paid once.
+	/// A cache entry is only valid for the source file version and processing properties it was built from
+	/// </summary>
+	class TextureCache {
+	public:
+		static constexpr UInt32 Magic = 0x4D435451; // "QTCM"
+		static constexpr UInt32 Version = 1;
+
+		/// <summary>
+		/// path of the cache file belonging to a source texture file
+		/// </summary>
+		static std::string GetCachePath(const std::string& sourcePath);
+		static UInt64 HashProperties(bool generateMips, const MipGenerationProperties& mipProperties, const TextureCompressionProperties& compressionProperties);
+
+		/// <summary>
+		/// returns nullptr if the cache file is missing, corrupt, from another version or built from different input
+		/// </summary>
+		static ref<Texture2D> Load(const std::string& cachePath, UInt64 sourceHash, UInt64 propertiesHash);
+		static bool Save(const std::string& cachePath, UInt64 sourceHash, UInt64 propertiesHash, const ref<Texture2D>& texture);
+	};
+}
@@ -0,0 +1,594 @@
+#include "TextureCompressor.h"
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define QE_BC_SSE2
+#endif
+
+namespace {
+	using namespace QuantumEngine;
+
+	constexpr UInt32 PowerIterationCount = 8;
+	// BC7 interpolation weights of 4-bit indices, out of 64
+	constexpr UInt32 BC7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+	// BC1 palette order of the colors from the first to the second endpoint
+	constexpr UInt32 BC1Codes[4] = { 0, 2, 3, 1 };
+
+	// one 4x4 block, one plane per channel in RGBA order
+	struct BlockPixels {
+		alignas(16) Float channels[4][16];
+	};
+
+	struct Endpoints {
+		Float start[4];
+		Float end[4];
+	};
+
+	struct BlockBitWriter {
+		UInt64 bits[2] = { 0, 0 };
+		UInt32 position = 0;
+
+		inline void Write(UInt32 value, UInt32 count)
+		{
+			UInt32 word = position >> 6;
+			UInt32 shift = position & 63;
+			bits[word] |= (UInt64)value << shift;
+
+			if (shift + count > 64)
+				bits[word + 1] |= (UInt64)value >> (64 - shift);
+
+			position += count;
+		}
+	};
+
+	void LoadBlock(const Byte* levelData, UInt32 width, UInt32 height, UInt32 blockX, UInt32 blockY, bool isBGRA, BlockPixels& block)
+	{
+		// levels smaller than a block repeat their last row and column
+		for (UInt32 y = 0; y < 4; y++) {
+			UInt32 sourceY = std::min(blockY * 4 + y, height - 1);
+
+			for (UInt32 x = 0; x < 4; x++) {
+				UInt32 sourceX = std::min(blockX * 4 + x, width - 1);
+				const Byte* pixel = levelData + ((size_t)sourceY * width + sourceX) * 4;
+				UInt32 i = y * 4 + x;
+				block.channels[0][i] = pixel[isBGRA ? 2 : 0];
+				block.channels[1][i] = pixel[1];
+				block.channels[2][i] = pixel[isBGRA ? 0 : 2];
+				block.channels[3][i] = pixel[3];
+			}
+		}
+	}
+
+	/// <summary>
+	/// end points of the block's principal axis in the given channels
+	/// </summary>
+	void FitPrincipalAxis(const BlockPixels& block, UInt32 channelCount, Endpoints& endpoints)
+	{
+		Float mean[4] = {};
+		Float axis[4] = {};
+
+		for (UInt32 c = 0; c < channelCount; c++) {
+			Float minimum = 255.0f;
+			Float maximum = 0.0f;
+
+			for (UInt32 i = 0; i < 16; i++) {
+				mean[c] += block.channels[c][i];
+				minimum = std::min(minimum, block.channels[c][i]);
+				maximum = std::max(maximum, block.channels[c][i]);
+			}
+
+			mean[c] /= 16.0f;
+			axis[c] = maximum - minimum;
+		}
+
+		Float covariance[4][4] = {};
+
+		for (UInt32 i = 0; i < 16; i++) {
+			for (UInt32 a = 0; a < channelCount; a++) {
+				for (UInt32 b = a; b < channelCount; b++)
+					covariance[a][b] += (block.channels[a][i] - mean[a]) * (block.channels[b][i] - mean[b]);
+			}
+		}
+
+		for (UInt32 a = 0; a < channelCount; a++) {
+			for (UInt32 b = 0; b < a; b++)
+				covariance[a][b] = covariance[b][a];
+		}
+
+		for (UInt32 iteration = 0; iteration < PowerIterationCount; iteration++) {
+			Float next[4] = {};
+			Float largest = 0.0f;
+
+			for (UInt32 a = 0; a < channelCount; a++) {
+				for (UInt32 b = 0; b < channelCount; b++)
+					next[a] += covariance[a][b] * axis[b];
+
+				largest = std::max(largest, std::fabs(next[a]));
+			}
+
+			if (largest < 1e-6f)
+				break;
+
+			for (UInt32 c = 0; c < channelCount; c++)
+				axis[c] = next[c] / largest;
+		}
+
+		Float lengthSquared = 0.0f;
+
+		for (UInt32 c = 0; c < channelCount; c++)
+			lengthSquared += axis[c] * axis[c];
+
+		Float minT = 0.0f;
+		Float maxT = 0.0f;
+
+		if (lengthSquared > 1e-12f) {
+			Float inverseLength = 1.0f / std::sqrt(lengthSquared);
+
+			for (UInt32 c = 0; c < channelCount; c++)
+				axis[c] *= inverseLength;
+
+			minT = FLT_MAX;
+			maxT = -FLT_MAX;
+
+			for (UInt32 i = 0; i < 16; i++) {
+				Float t = 0.0f;
+
+				for (UInt32 c = 0; c < channelCount; c++)
+					t += (block.channels[c][i] - mean[c]) * axis[c];
+
+				minT = std::min(minT, t);
+				maxT = std::max(maxT, t);
+			}
+		}
+
+		for (UInt32 c = 0; c < channelCount; c++) {
+			endpoints.start[c] = std::clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f);
+			endpoints.end[c] = std::clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f);
+		}
+	}
+
+	/// <summary>
+	/// picks the nearest of indexCount evenly spaced points from start to end for every pixel by projecting it on the endpoint line.
+	/// Only channels [firstChannel, firstChannel + channelCount) are used
+	/// </summary>
+	void FitIndices(const BlockPixels& block, UInt32 firstChannel, UInt32 channelCount, const Endpoints& endpoints, UInt32 indexCount, Byte* indices)
+	{
+		UInt32 lastChannel = firstChannel + channelCount;
+		Float axis[4] = {};
+		Float lengthSquared = 0.0f;
+
+		for (UInt32 c = firstChannel; c < lastChannel; c++) {
+			axis[c] = endpoints.end[c] - endpoints.start[c];
+			lengthSquared += axis[c] * axis[c];
+		}
+
+		if (lengthSquared < 1e-6f) {
+			std::memset(indices, 0, 16);
+			return;
+		}
+
+		Float scale = (indexCount - 1) / lengthSquared;
+
+		for (UInt32 c = firstChannel; c < lastChannel; c++)
+			axis[c] *= scale;
+
+#ifdef QE_BC_SSE2
+		__m128 maxIndex = _mm_set1_ps((Float)(indexCount - 1));
+
+		for (UInt32 i = 0; i < 16; i += 4) {
+			__m128 t = _mm_setzero_ps();
+
+			for (UInt32 c = firstChannel; c < lastChannel; c++) {
+				__m128 offset = _mm_sub_ps(_mm_load_ps(block.channels[c] + i), _mm_set1_ps(endpoints.start[c]));
+				t = _mm_add_ps(t, _mm_mul_ps(offset, _mm_set1_ps(axis[c])));
+			}
+
+			t = _mm_min_ps(_mm_max_ps(t, _mm_setzero_ps()), maxIndex);
+			__m128i rounded = _mm_cvtps_epi32(t);
+			rounded = _mm_packs_epi32(rounded, rounded);
+			rounded = _mm_packus_epi16(rounded, rounded);
+			UInt32 packed = (UInt32)_mm_cvtsi128_si32(rounded);
+			std::memcpy(indices + i, &packed, 4);
+		}
+#else
+		for (UInt32 i = 0; i < 16; i++) {
+			Float t = 0.0f;
+
+			for (UInt32 c = firstChannel; c < lastChannel; c++)
+				t += (block.channels[c][i] - endpoints.start[c]) * axis[c];
+
+			indices[i] = (Byte)std::lround(std::clamp(t, 0.0f, (Float)(indexCount - 1)));
+		}
+#endif
+	}
+
+	/// <summary>
+	/// squared error of the block against the colors the indices select. weights map an index to its fraction of the way to end
+	/// </summary>
+	Float InterpolationError(const BlockPixels& block, UInt32 firstChannel, UInt32 channelCount, const Endpoints& endpoints, const Float* weights, const Byte* indices)
+	{
+		Float error = 0.0f;
+
+		for (UInt32 c = firstChannel; c < firstChannel + channelCount; c++) {
+			Float start = endpoints.start[c];
+			Float range = endpoints.end[c] - start;
+
+			for (UInt32 i = 0; i < 16; i++) {
+				Float difference = block.channels[c][i] - (start + range * weights[indices[i]]);
+				error += difference * difference;
+			}
+		}
+
+		return error;
+	}
+
+	/// <summary>
+	/// endpoints minimizing the squared error for fixed indices, false if the indices don't determine them
+	/// </summary>
+	bool FitLeastSquares(const BlockPixels& block, UInt32 firstChannel, UInt32 channelCount, const Float* weights, const Byte* indices, Endpoints& endpoints)
+	{
+		Float startWeight = 0.0f;
+		Float endWeight = 0.0f;
+		Float crossWeight = 0.0f;
+		Float startSum[4] = {};
+		Float endSum[4] = {};
+
+		for (UInt32 i = 0; i < 16; i++) {
+			Float w = weights[indices[i]];
+			Float v = 1.0f - w;
+			startWeight += v * v;
+			endWeight += w * w;
+			crossWeight += v * w;
+
+			for (UInt32 c = firstChannel; c < firstChannel + channelCount; c++) {
+				startSum[c] += v * block.channels[c][i];
+				endSum[c] += w * block.channels[c][i];
+			}
+		}
+
+		Float determinant = startWeight * endWeight - crossWeight * crossWeight;
+
+		if (std::fabs(determinant) < 1e-6f)
+			return false;
+
+		Float inverse = 1.0f / determinant;
+
+		for (UInt32 c = firstChannel; c < firstChannel + channelCount; c++) {
+			endpoints.start[c] = std::clamp((endWeight * startSum[c] - crossWeight * endSum[c]) * inverse, 0.0f, 255.0f);
+			endpoints.end[c] = std::clamp((startWeight * endSum[c] - crossWeight * startSum[c]) * inverse, 0.0f, 255.0f);
+		}
+
+		return true;
+	}
+
+	UInt16 Pack565(const Float* color)
+	{
+		UInt32 r = (UInt32)std::lround(color[0] * (31.0f / 255.0f));
+		UInt32 g = (UInt32)std::lround(color[1] * (63.0f / 255.0f));
+		UInt32 b = (UInt32)std::lround(color[2] * (31.0f / 255.0f));
+
+		return (UInt16)((r << 11) | (g << 5) | b);
+	}
+
+	void Unpack565(UInt16 color, Float* dest)
+	{
+		UInt32 r = color >> 11;
+		UInt32 g = (color >> 5) & 63;
+		UInt32 b = color & 31;
+		dest[0] = (Float)((r << 3) | (r >> 2));
+		dest[1] = (Float)((g << 2) | (g >> 4));
+		dest[2] = (Float)((b << 3) | (b >> 2));
+	}
+
+	// BC1 color block in 4 color mode, also the color half of BC3
+	void EncodeColorBlock(const BlockPixels& block, UInt32 refinementCount, Byte* dest)
+	{
+		static constexpr Float weights[4] = { 0.0f, 1.0f / 3.0f, 2.0f / 3.0f, 1.0f };
+
+		Endpoints endpoints;
+		FitPrincipalAxis(block, 3, endpoints);
+
+		Float bestError = FLT_MAX;
+		UInt16 bestColors[2] = {};
+		Byte bestIndices[16] = {};
+
+		for (UInt32 pass = 0; pass <= refinementCount; pass++) {
+			UInt16 colors[2] = { Pack565(endpoints.start), Pack565(endpoints.end) };
+			Endpoints quantized;
+			Unpack565(colors[0], quantized.start);
+			Unpack565(colors[1], quantized.end);
+
+			Byte indices[16];
+			FitIndices(block, 0, 3, quantized, 4, indices);
+			Float error = InterpolationError(block, 0, 3, quantized, weights, indices);
+
+			if (error < bestError) {
+				bestError = error;
+				bestColors[0] = colors[0];
+				bestColors[1] = colors[1];
+				std::memcpy(bestIndices, indices, 16);
+			}
+
+			if (error == 0.0f || FitLeastSquares(block, 0, 3, weights, indices, endpoints) == false)
+				break;
+		}
+
+		// the first color has to be the larger one, equal colors select 3 color mode where index 0 is still the first color
+		if (bestColors[0] < bestColors[1]) {
+			std::swap(bestColors[0], bestColors[1]);
+
+			for (UInt32 i = 0; i < 16; i++)
+				bestIndices[i] = 3 - bestIndices[i];
+		}
+		else if (bestColors[0] == bestColors[1]) {
+			std::memset(bestIndices, 0, 16);
+		}
+
+		UInt32 indexBits = 0;
+
+		for (UInt32 i = 0; i < 16; i++)
+			indexBits |= BC1Codes[bestIndices[i]] << (i * 2);
+
+		std::memcpy(dest, bestColors, 4);
+		std::memcpy(dest + 4, &indexBits, 4);
+	}
+
+	// BC4 block of one channel, the alpha half of BC3 and both halves of BC5
+	void EncodeChannelBlock(const BlockPixels& block, UInt32 channel, UInt32 refinementCount, Byte* dest)
+	{
+		static constexpr Float weights[8] = { 0.0f, 1.0f / 7.0f, 2.0f / 7.0f, 3.0f / 7.0f, 4.0f / 7.0f, 5.0f / 7.0f, 6.0f / 7.0f, 1.0f };
+
+		// start is the smaller endpoint, stored second so the block uses the 8 value mode
+		Endpoints endpoints;
+		endpoints.start[channel] = 255.0f;
+		endpoints.end[channel] = 0.0f;
+
+		for (UInt32 i = 0; i < 16; i++) {
+			endpoints.start[channel] = std::min(endpoints.start[channel], block.channels[channel][i]);
+			endpoints.end[channel] = std::max(endpoints.end[channel], block.channels[channel][i]);
+		}
+
+		Float bestError = FLT_MAX;
+		UInt32 bestValues[2] = {};
+		Byte bestIndices[16] = {};
+
+		for (UInt32 pass = 0; pass <= refinementCount; pass++) {
+			UInt32 minimum = (UInt32)std::lround(std::min(endpoints.start[channel], endpoints.end[channel]));
+			UInt32 maximum = (UInt32)std::lround(std::max(endpoints.start[channel], endpoints.end[channel]));
+			Endpoints quantized;
+			quantized.start[channel] = (Float)minimum;
+			quantized.end[channel] = (Float)maximum;
+
+			Byte indices[16];
+			FitIndices(block, channel, 1, quantized, 8, indices);
+			Float error = InterpolationError(block, channel, 1, quantized, weights, indices);
+
+			if (error < bestError) {
+				bestError = error;
+				bestValues[0] = maximum;
+				bestValues[1] = minimum;
+				std::memcpy(bestIndices, indices, 16);
+			}
+
+			if (error == 0.0f || FitLeastSquares(block, channel, 1, weights, indices, endpoints) == false)
+				break;
+		}
+
+		UInt64 bits = bestValues[0] | (bestValues[1] << 8);
+
+		// value k/7 of the way up from the smaller endpoint is code 0 for the larger endpoint, 1 for the smaller one and 8 - k between
+		if (bestValues[0] > bestValues[1]) {
+			for (UInt32 i = 0; i < 16; i++) {
+				UInt32 k = bestIndices[i];
+				UInt64 code = k == 7 ? 0 : (k == 0 ? 1 : 8 - k);
+				bits |= code << (16 + i * 3);
+			}
+		}
+
+		std::memcpy(dest, &bits, 8);
+	}
+
+	/// <summary>
+	/// nearest 7-bit endpoint with a shared p-bit, the 8-bit value is (q << 1) | p
+	/// </summary>
+	void QuantizeBC7Endpoint(const Float* endpoint, UInt32* quantized, UInt32& pBit, Float* dequantized)
+	{
+		Float bestError = FLT_MAX;
+
+		for (UInt32 p = 0; p < 2; p++) {
+			UInt32 values[4];
+			Float error = 0.0f;
+
+			for (UInt32 c = 0; c < 4; c++) {
+				values[c] = (UInt32)std::clamp(std::lround((endpoint[c] - p) * 0.5f), 0l, 127l);
+				Float difference = (Float)((values[c] << 1) | p) - endpoint[c];
+				error += difference * difference;
+			}
+
+			if (error < bestError) {
+				bestError = error;
+				pBit = p;
+
+				for (UInt32 c = 0; c < 4; c++) {
+					quantized[c] = values[c];
+					dequantized[c] = (Float)((values[c] << 1) | p);
+				}
+			}
+		}
+	}
+
+	// BC7 mode 6: one subset, RGBA 7.7.7.7 endpoints with a p-bit each and 4-bit indices
+	void EncodeBC7Block(const BlockPixels& block, UInt32 refinementCount, Byte* dest)
+	{
+		static constexpr Float weights[16] = {
+			BC7Weights[0] / 64.0f, BC7Weights[1] / 64.0f, BC7Weights[2] / 64.0f, BC7Weights[3] / 64.0f,
+			BC7Weights[4] / 64.0f, BC7Weights[5] / 64.0f, BC7Weights[6] / 64.0f, BC7Weights[7] / 64.0f,
+			BC7Weights[8] / 64.0f, BC7Weights[9] / 64.0f, BC7Weights[10] / 64.0f, BC7Weights[11] / 64.0f,
+			BC7Weights[12] / 64.0f, BC7Weights[13] / 64.0f, BC7Weights[14] / 64.0f, BC7Weights[15] / 64.0f,
+		};
+
+		Endpoints endpoints;
+		FitPrincipalAxis(block, 4, endpoints);
+
+		Float bestError = FLT_MAX;
+		UInt32 bestEndpoints[2][4] = {};
+		UInt32 bestPBits[2] = {};
+		Byte bestIndices[16] = {};
+
+		for (UInt32 pass = 0; pass <= refinementCount; pass++) {
+			UInt32 values[2][4];
+			UInt32 pBits[2];
+			Endpoints quantized;
+			QuantizeBC7Endpoint(endpoints.start, values[0], pBits[0], quantized.start);
+			QuantizeBC7Endpoint(endpoints.end, values[1], pBits[1], quantized.end);
+
+			Byte indices[16];
+			FitIndices(block, 0, 4, quantized, 16, indices);
+			Float error = InterpolationError(block, 0, 4, quantized, weights, indices);
+
+			if (error < bestError) {
+				bestError = error;
+				std::memcpy(bestEndpoints, values, sizeof(values));
+				std::memcpy(bestPBits, pBits, sizeof(pBits));
+				std::memcpy(bestIndices, indices, 16);
+			}
+
+			if (error == 0.0f || FitLeastSquares(block, 0, 4, weights, indices, endpoints) == false)
+				break;
+		}
+
+		// the anchor index drops its top bit, so the first pixel has to sit in the lower half
+		if (bestIndices[0] >= 8) {
+			for (UInt32 c = 0; c < 4; c++)
+				std::swap(bestEndpoints[0][c], bestEndpoints[1][c]);
+
+			std::swap(bestPBits[0], bestPBits[1]);
+
+			for (UInt32 i = 0; i < 16; i++)
+				bestIndices[i] = 15 - bestIndices[i];
+		}
+
+		BlockBitWriter writer;
+		writer.Write(1 << 6, 7);
+
+		for (UInt32 c = 0; c < 4; c++) {
+			writer.Write(bestEndpoints[0][c], 7);
+			writer.Write(bestEndpoints[1][c], 7);
+		}
+
+		writer.Write(bestPBits[0], 1);
+		writer.Write(bestPBits[1], 1);
+		writer.Write(bestIndices[0], 3);
+
+		for (UInt32 i = 1; i < 16; i++)
+			writer.Write(bestIndices[i], 4);
+
+		std::memcpy(dest, writer.bits, 16);
+	}
+
+	void EncodeBlock(const BlockPixels& block, TextureFormat format, UInt32 refinementCount, Byte* dest)
+	{
+		switch (format) {
+		case TextureFormat::BC1:
+			EncodeColorBlock(block, refinementCount, dest);
+			break;
+		case TextureFormat::BC3:
+			EncodeChannelBlock(block, 3, refinementCount, dest);
+			EncodeColorBlock(block, refinementCount, dest + 8);
+			break;
+		case TextureFormat::BC5:
+			EncodeChannelBlock(block, 0, refinementCount, dest);
+			EncodeChannelBlock(block, 1, refinementCount, dest + 8);
+			break;
+		default:
+			EncodeBC7Block(block, refinementCount, dest);
+			break;
+		}
+	}
+}
+
+ref<QuantumEngine::Texture2D> QuantumEngine::TextureCompressor::Compress(const ref<Texture2D>& texture, const TextureCompressionProperties& properties)
+{
+	TextureFormat sourceFormat = texture->GetFormat();
+	TextureFormat format = properties.format;
+
+	if ((sourceFormat != TextureFormat::RGBA32 && sourceFormat != TextureFormat::BGRA32) || IsBlockCompressed(format) == false)
+		return nullptr;
+
+	if (texture->GetWidth() % 4 != 0 || texture->GetHeight() % 4 != 0)
+		return nullptr;
+
+	UInt32 levelCount = texture->GetMipLevelCount();
+	UInt32 blockSize = GetBlockByteSize(format);
+	UInt32 totalSize = 0;
+	// first job of every level, one job compresses one row of blocks
+	std::vector<UInt32> levelJobs(levelCount + 1, 0);
+
+	for (UInt32 level = 0; level < levelCount; level++) {
+		UInt32 blockColumns = (texture->GetMipWidth(level) + 3) / 4;
+		UInt32 blockRows = (texture->GetMipHeight(level) + 3) / 4;
+		totalSize += blockColumns * blockRows * blockSize;
+		levelJobs[level + 1] = levelJobs[level] + blockRows;
+	}
+
+	TextureProperties texProperties;
+	texProperties.data = new Byte[totalSize];
+	texProperties.copyPixelData = false;
+	texProperties.width = texture->GetWidth();
+	texProperties.height = texture->GetHeight();
+	texProperties.size = totalSize;
+	texProperties.bpp = format == TextureFormat::BC1 ? 4 : 8;
+	texProperties.channelCount = format == TextureFormat::BC1 ? 3 : (format == TextureFormat::BC5 ? 2 : 4);
+	texProperties.format = format;
+	texProperties.mipLevelCount = levelCount;
+	texProperties.generateGPUMips = false;
+	texProperties.sRGB = texture->IsSRGB();
+
+	auto compressed = std::make_shared<Texture2D>(texProperties);
+	bool isBGRA = sourceFormat == TextureFormat::BGRA32;
+	UInt32 jobCount = levelJobs[levelCount];
+	std::atomic<UInt32> nextJob = 0;
+
+	auto worker = [&]() {
+		BlockPixels block;
+
+		for (UInt32 job = nextJob++; job < jobCount; job = nextJob++) {
+			UInt32 level = 0;
+
+			while (job >= levelJobs[level + 1])
+				level++;
+
+			UInt32 blockY = job - levelJobs[level];
+			UInt32 width = texture->GetMipWidth(level);
+			UInt32 height = texture->GetMipHeight(level);
+			const Byte* source = texture->GetMipData(level);
+			Byte* dest = compressed->GetMipData(level) + (size_t)blockY * compressed->GetMipRowSize(level);
+
+			for (UInt32 blockX = 0; blockX < (width + 3) / 4; blockX++) {
+				LoadBlock(source, width, height, blockX, blockY, isBGRA, block);
+				EncodeBlock(block, format, properties.refinementCount, dest + blockX * blockSize);
+			}
+		}
+	};
+
+	UInt32 threadCount = properties.threadCount > 0 ? properties.threadCount : std::max(std::thread::hardware_concurrency(), 1u);
+	threadCount = std::min(threadCount, jobCount);
+	std::vector<std::thread> threads;
+
+	for (UInt32 i = 1; i < threadCount; i++)
+		threads.emplace_back(worker);
+
+	worker();
+
+	for (auto& thread : threads)
+		thread.join();
+
+	return compressed;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include "../BasicTypes.h"
+#include "Texture2D.h"
+
+namespace QuantumEngine {
+	struct TextureCompressionProperties {
+		// BC1, BC3, BC5 or BC7
+		TextureFormat format = TextureFormat::BC7;
+		// least squares endpoint refinements after the initial fit, more passes trade speed for quality
+		UInt32 refinementCount = 1;
+		// 0 picks the core count
+		UInt32 threadCount = 0;
+	};
+
+	/// <summary>
+	/// CPU block compressor for RGBA32/BGRA32 textures. Every 4x4 block is fitted on the principal axis of its colors
+	/// and refined with least squares, block rows of all mip levels are split between threads.
+	/// BC1 drops alpha, BC5 keeps red and green, BC7 only uses mode 6 (one RGBA subset with 4-bit indices)
+	/// </summary>
+	class TextureCompressor {
+	public:
+		/// <summary>
+		/// returns the compressed copy of every mip level of the texture, nullptr if the source or target format isn't supported.
+		/// The top level has to be a multiple of 4 in both dimensions, D3D12 can't create block compressed textures otherwise
+		/// </summary>
+		static ref<Texture2D> Compress(const ref<Texture2D>& texture, const TextureCompressionProperties& properties = {});
+	};
+}
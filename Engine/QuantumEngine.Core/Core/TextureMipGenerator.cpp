@@ -0,0 +1,353 @@
+#include "TextureMipGenerator.h"
+#include "Texture2D.h"
+#include "HalfFloat.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#include <xmmintrin.h>
+#define QE_MIP_SSE
+#endif
+
+namespace {
+	using namespace QuantumEngine;
+
+	constexpr UInt32 RowsPerJob = 32;
+	// Kaiser filter half width in destination texels and window shape
+	constexpr Float KaiserWidth = 3.0f;
+	constexpr Float KaiserAlpha = 4.0f;
+	constexpr UInt32 LinearToSRGBSteps = 16383;
+
+	// one RGBA texel in linear float
+	struct Texel {
+#ifdef QE_MIP_SSE
+		__m128 value;
+
+		static inline Texel Zero() { return { _mm_setzero_ps() }; }
+		inline void Store(Float* dest) const { _mm_storeu_ps(dest, value); }
+		inline void Accumulate(const Float* source, Float weight) { value = _mm_add_ps(value, _mm_mul_ps(_mm_loadu_ps(source), _mm_set1_ps(weight))); }
+#else
+		Float value[4];
+
+		static inline Texel Zero() { return { { 0.0f, 0.0f, 0.0f, 0.0f } }; }
+		inline void Store(Float* dest) const { std::memcpy(dest, value, sizeof(value)); }
+
+		inline void Accumulate(const Float* source, Float weight)
+		{
+			for (UInt32 c = 0; c < 4; c++)
+				value[c] += source[c] * weight;
+		}
+#endif
+	};
+
+	struct ConversionTables {
+		Float sRGBToLinear[256];
+		Byte linearToSRGB[LinearToSRGBSteps + 1];
+
+		ConversionTables()
+		{
+			for (UInt32 i = 0; i < 256; i++) {
+				Float value = i / 255.0f;
+				sRGBToLinear[i] = value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+			}
+
+			for (UInt32 i = 0; i <= LinearToSRGBSteps; i++) {
+				Float value = (Float)i / LinearToSRGBSteps;
+				Float encoded = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+				linearToSRGB[i] = (Byte)std::lround(encoded * 255.0f);
+			}
+		}
+	};
+
+	const ConversionTables& GetConversionTables()
+	{
+		static const ConversionTables tables;
+		return tables;
+	}
+
+	// separable polyphase kernel, taps of destination texel i are [offsets[i], offsets[i + 1])
+	struct FilterKernel {
+		std::vector<UInt32> offsets;
+		std::vector<UInt32> sources;
+		std::vector<Float> weights;
+	};
+
+	Float BesselI0(Float x)
+	{
+		Float sum = 1.0f;
+		Float term = 1.0f;
+		Float halfX = 0.5f * x;
+
+		for (UInt32 k = 1; k < 32 && term > 1e-8f * sum; k++) {
+			term *= (halfX / k) * (halfX / k);
+			sum += term;
+		}
+
+		return sum;
+	}
+
+	Float KaiserSinc(Float x)
+	{
+		Float t = x / KaiserWidth;
+
+		if (t <= -1.0f || t >= 1.0f)
+			return 0.0f;
+
+		Float sinc = x == 0.0f ? 1.0f : std::sin(PI * x) / (PI * x);
+		return sinc * BesselI0(KaiserAlpha * std::sqrt(1.0f - t * t)) / BesselI0(KaiserAlpha);
+	}
+
+	// source texels outside the image wrap around, matching the repeat samplers the textures are used with
+	FilterKernel BuildKernel(UInt32 sourceSize, UInt32 destSize, MipFilter filter)
+	{
+		FilterKernel kernel;
+		Float scale = (Float)sourceSize / destSize;
+
+		for (UInt32 i = 0; i < destSize; i++) {
+			UInt32 begin = (UInt32)kernel.weights.size();
+			kernel.offsets.push_back(begin);
+
+			if (sourceSize == destSize) {
+				kernel.sources.push_back(i);
+				kernel.weights.push_back(1.0f);
+				continue;
+			}
+
+			if (filter == MipFilter::Box) {
+				Float left = i * scale;
+				Float right = left + scale;
+
+				for (Int32 s = (Int32)std::floor(left); s < (Int32)std::ceil(right); s++) {
+					Float weight = std::min(right, s + 1.0f) - std::max(left, (Float)s);
+
+					if (weight > 0.0f) {
+						kernel.sources.push_back(std::min((UInt32)s, sourceSize - 1));
+						kernel.weights.push_back(weight);
+					}
+				}
+			}
+			else {
+				Float center = (i + 0.5f) * scale;
+				Int32 first = (Int32)std::floor(center - KaiserWidth * scale);
+				Int32 last = (Int32)std::ceil(center + KaiserWidth * scale);
+
+				for (Int32 s = first; s <= last; s++) {
+					Float weight = KaiserSinc((s + 0.5f - center) / scale);
+
+					if (weight != 0.0f) {
+						Int32 wrapped = s % (Int32)sourceSize;
+						kernel.sources.push_back((UInt32)(wrapped < 0 ? wrapped + (Int32)sourceSize : wrapped));
+						kernel.weights.push_back(weight);
+					}
+				}
+			}
+
+			Float total = 0.0f;
+
+			for (UInt32 k = begin; k < kernel.weights.size(); k++)
+				total += kernel.weights[k];
+
+			for (UInt32 k = begin; k < kernel.weights.size(); k++)
+				kernel.weights[k] /= total;
+		}
+
+		kernel.offsets.push_back((UInt32)kernel.weights.size());
+		return kernel;
+	}
+
+	// splits rows into fixed jobs picked up by the threads, function receives [rowBegin, rowEnd)
+	template<typename Function>
+	void ParallelRows(UInt32 rowCount, UInt32 threadCount, const Function& function)
+	{
+		UInt32 jobCount = (rowCount + RowsPerJob - 1) / RowsPerJob;
+		threadCount = std::min(threadCount, jobCount);
+
+		if (threadCount <= 1) {
+			function(0, rowCount);
+			return;
+		}
+
+		std::atomic<UInt32> nextJob = 0;
+
+		auto worker = [&]() {
+			for (UInt32 job = nextJob++; job < jobCount; job = nextJob++)
+				function(job * RowsPerJob, std::min(rowCount, (job + 1) * RowsPerJob));
+		};
+
+		std::vector<std::thread> threads;
+
+		for (UInt32 i = 1; i < threadCount; i++)
+			threads.emplace_back(worker);
+
+		worker();
+
+		for (auto& thread : threads)
+			thread.join();
+	}
+
+	void DecodeRow(const Byte* source, Float* dest, UInt32 width, TextureFormat format, bool sRGB)
+	{
+		if (format == TextureFormat::RGBA64F) {
+			const UInt16* halves = (const UInt16*)source;
+
+			for (UInt32 i = 0; i < width * 4; i++)
+				dest[i] = UnpackHalf(halves[i]);
+
+			return;
+		}
+
+		const ConversionTables& tables = GetConversionTables();
+
+		for (UInt32 x = 0; x < width; x++, source += 4, dest += 4) {
+			for (UInt32 c = 0; c < 3; c++)
+				dest[c] = sRGB ? tables.sRGBToLinear[source[c]] : source[c] * (1.0f / 255.0f);
+
+			dest[3] = source[3] * (1.0f / 255.0f);
+		}
+	}
+
+	void EncodeRow(const Float* source, Byte* dest, UInt32 width, TextureFormat format, bool sRGB)
+	{
+		if (format == TextureFormat::RGBA64F) {
+			UInt16* halves = (UInt16*)dest;
+
+			for (UInt32 i = 0; i < width * 4; i++)
+				halves[i] = PackHalf(source[i]);
+
+			return;
+		}
+
+		const ConversionTables& tables = GetConversionTables();
+
+		// sharper filters ring past [0, 1]
+		for (UInt32 x = 0; x < width; x++, source += 4, dest += 4) {
+			for (UInt32 c = 0; c < 3; c++) {
+				Float value = std::clamp(source[c], 0.0f, 1.0f);
+				dest[c] = sRGB ? tables.linearToSRGB[(UInt32)(value * LinearToSRGBSteps + 0.5f)] : (Byte)(value * 255.0f + 0.5f);
+			}
+
+			dest[3] = (Byte)(std::clamp(source[3], 0.0f, 1.0f) * 255.0f + 0.5f);
+		}
+	}
+}
+
+UInt32 QuantumEngine::TextureMipGenerator::GetFullMipLevelCount(UInt32 width, UInt32 height)
+{
+	UInt32 levelCount = 1;
+
+	for (UInt32 size = std::max(width, height); size > 1; size >>= 1)
+		levelCount++;
+
+	return levelCount;
+}
+
+ref<QuantumEngine::Texture2D> QuantumEngine::TextureMipGenerator::GenerateMips(const ref<Texture2D>& texture, const MipGenerationProperties& properties)
+{
+	TextureFormat format = texture->GetFormat();
+
+	if (format != TextureFormat::RGBA32 && format != TextureFormat::BGRA32 && format != TextureFormat::RGBA64F)
+		return nullptr;
+
+	UInt32 levelCount = GetFullMipLevelCount(texture->GetWidth(), texture->GetHeight());
+
+	if (properties.maxLevelCount > 0)
+		levelCount = std::min(levelCount, properties.maxLevelCount);
+
+	if (texture->GetMipLevelCount() > 1 || levelCount <= 1)
+		return texture;
+
+	UInt32 bytePerPixel = texture->GetBytePerPixel();
+	UInt32 threadCount = properties.threadCount > 0 ? properties.threadCount : std::max(std::thread::hardware_concurrency(), 1u);
+	bool sRGB = properties.sRGB && texture->IsSRGB() && format != TextureFormat::RGBA64F;
+
+	std::vector<UInt32> levelOffsets(levelCount);
+	UInt32 totalSize = 0;
+
+	for (UInt32 level = 0; level < levelCount; level++) {
+		levelOffsets[level] = totalSize;
+		totalSize += texture->GetMipWidth(level) * texture->GetMipHeight(level) * bytePerPixel;
+	}
+
+	Byte* data = new Byte[totalSize];
+	std::memcpy(data, texture->GetData(), texture->GetMipSize(0));
+
+	for (UInt32 level = 1; level < levelCount; level++) {
+		UInt32 width = texture->GetMipWidth(level - 1);
+		UInt32 height = texture->GetMipHeight(level - 1);
+		UInt32 levelWidth = texture->GetMipWidth(level);
+		UInt32 levelHeight = texture->GetMipHeight(level);
+		FilterKernel horizontalKernel = BuildKernel(width, levelWidth, properties.filter);
+		FilterKernel verticalKernel = BuildKernel(height, levelHeight, properties.filter);
+		const Byte* sourceData = data + levelOffsets[level - 1];
+		Byte* levelData = data + levelOffsets[level];
+
+		// each job filters the source rows its output rows need horizontally, then filters those vertically.
+		// Rows shared with a neighbouring job are filtered twice instead of keeping the whole level in float
+		ParallelRows(levelHeight, threadCount, [&](UInt32 rowBegin, UInt32 rowEnd) {
+			std::vector<Int32> slots(height, -1);
+			std::vector<UInt32> sourceRows;
+
+			for (UInt32 k = verticalKernel.offsets[rowBegin]; k < verticalKernel.offsets[rowEnd]; k++) {
+				UInt32 row = verticalKernel.sources[k];
+
+				if (slots[row] < 0) {
+					slots[row] = (Int32)sourceRows.size();
+					sourceRows.push_back(row);
+				}
+			}
+
+			std::vector<Float> decodedRow((size_t)width * 4);
+			std::vector<Float> filteredRows(sourceRows.size() * levelWidth * 4);
+			std::vector<Float> levelRow((size_t)levelWidth * 4);
+
+			for (UInt32 slot = 0; slot < sourceRows.size(); slot++) {
+				DecodeRow(sourceData + (size_t)sourceRows[slot] * width * bytePerPixel, decodedRow.data(), width, format, sRGB);
+				Float* filteredRow = filteredRows.data() + (size_t)slot * levelWidth * 4;
+
+				for (UInt32 x = 0; x < levelWidth; x++) {
+					Texel sum = Texel::Zero();
+
+					for (UInt32 k = horizontalKernel.offsets[x]; k < horizontalKernel.offsets[x + 1]; k++)
+						sum.Accumulate(decodedRow.data() + horizontalKernel.sources[k] * 4, horizontalKernel.weights[k]);
+
+					sum.Store(filteredRow + x * 4);
+				}
+			}
+
+			for (UInt32 y = rowBegin; y < rowEnd; y++) {
+				UInt32 firstTap = verticalKernel.offsets[y];
+				UInt32 lastTap = verticalKernel.offsets[y + 1];
+
+				for (UInt32 x = 0; x < levelWidth; x++) {
+					Texel sum = Texel::Zero();
+
+					for (UInt32 k = firstTap; k < lastTap; k++)
+						sum.Accumulate(filteredRows.data() + ((size_t)slots[verticalKernel.sources[k]] * levelWidth + x) * 4, verticalKernel.weights[k]);
+
+					sum.Store(levelRow.data() + x * 4);
+				}
+
+				EncodeRow(levelRow.data(), levelData + (size_t)y * levelWidth * bytePerPixel, levelWidth, format, sRGB);
+			}
+		});
+	}
+
+	TextureProperties texProperties;
+	texProperties.data = data;
+	texProperties.copyPixelData = false;
+	texProperties.width = texture->GetWidth();
+	texProperties.height = texture->GetHeight();
+	texProperties.size = totalSize;
+	texProperties.bpp = bytePerPixel * 8;
+	texProperties.channelCount = 4;
+	texProperties.format = format;
+	texProperties.mipLevelCount = levelCount;
+	texProperties.generateGPUMips = false;
+	texProperties.sRGB = texture->IsSRGB();
+
+	return std::make_shared<Texture2D>(texProperties);
+}
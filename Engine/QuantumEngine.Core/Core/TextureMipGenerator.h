@@ -0,0 +1,33 @@
+#pragma once
+#include "../BasicTypes.h"
+
+namespace QuantumEngine {
+	class Texture2D;
+
+	enum class MipFilter {
+		Box,	// area average of the covered texels
+		Kaiser,	// Kaiser windowed sinc, keeps more detail in the smaller levels
+	};
+
+	struct MipGenerationProperties {
+		MipFilter filter = MipFilter::Box;
+		// 8-bit color channels of sRGB textures are filtered in linear space. Linear textures and alpha are always filtered as stored
+		bool sRGB = true;
+		// 0 generates the full chain down to 1x1
+		UInt32 maxLevelCount = 0;
+		// 0 picks the core count
+		UInt32 threadCount = 0;
+	};
+
+	class TextureMipGenerator {
+	public:
+		static UInt32 GetFullMipLevelCount(UInt32 width, UInt32 height);
+
+		/// <summary>
+		/// returns a copy of the texture with its mip chain. Every level is filtered in linear float from the previous one
+		/// and its rows are split between threads.
+		/// Textures that already have mips are returned as is, unsupported formats return nullptr
+		/// </summary>
+		static ref<Texture2D> GenerateMips(const ref<Texture2D>& texture, const MipGenerationProperties& properties = {});
+	};
+}
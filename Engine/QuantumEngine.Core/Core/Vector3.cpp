@@ -40,12 +40,12 @@ Float QuantumEngine::Vector3::Dot(const Vector3& vectorA, const Vector3& vectorB
 	return (vectorA.x * vectorB.x) + (vectorA.y * vectorB.y) + (vectorA.z * vectorB.z);
 }
 
-QuantumEngine::Vector3 QuantumEngine::Vector3::operator-()
+QuantumEngine::Vector3 QuantumEngine::Vector3::operator-() const
 {
 	return Vector3(-x, -y, -z);
 }
 
-QuantumEngine::Vector3 QuantumEngine::Vector3::operator+(const Vector3& vectorB)
+QuantumEngine::Vector3 QuantumEngine::Vector3::operator+(const Vector3& vectorB) const
 {
 	return Vector3(x + vectorB.x, y + vectorB.y, z + vectorB.z);
 }
@@ -58,7 +58,7 @@ QuantumEngine::Vector3 QuantumEngine::Vector3::operator+=(const Vector3& vectorB
 	return *this;
 }
 
-QuantumEngine::Vector3 QuantumEngine::Vector3::operator-(const Vector3& vectorB)
+QuantumEngine::Vector3 QuantumEngine::Vector3::operator-(const Vector3& vectorB) const
 {
 	return Vector3(x - vectorB.x, y - vectorB.y, z - vectorB.z);
 }
@@ -71,7 +71,7 @@ QuantumEngine::Vector3 QuantumEngine::Vector3::operator-=(const Vector3& vectorB
 	return *this;
 }
 
-QuantumEngine::Vector3 QuantumEngine::Vector3::operator*(Float fValue)
+QuantumEngine::Vector3 QuantumEngine::Vector3::operator*(Float fValue) const
 {
 	return Vector3(fValue * x, fValue * y, fValue * z);
 }
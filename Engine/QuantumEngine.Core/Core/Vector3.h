@@ -42,12 +42,12 @@ namespace QuantumEngine {
 
 	public: // Operators
 
-		Vector3 operator-();
-		Vector3 operator+(const Vector3& vectorB);
+		Vector3 operator-() const;
+		Vector3 operator+(const Vector3& vectorB) const;
 		Vector3 operator+=(const Vector3& vectorB);
-		Vector3 operator-(const Vector3& vectorB);
+		Vector3 operator-(const Vector3& vectorB) const;
 		Vector3 operator-=(const Vector3& vectorB);
-		Vector3 operator*(Float fValue);
+		Vector3 operator*(Float fValue) const;
 
 	public: // static methods
 
@@ -0,0 +1,41 @@
+#include "MappedFile.h"
+
+QuantumEngine::Platform::MappedFile::~MappedFile()
+{
+	if (m_data != nullptr)
+		UnmapViewOfFile(m_data);
+
+	if (m_mapping != nullptr)
+		CloseHandle(m_mapping);
+
+	if (m_file != INVALID_HANDLE_VALUE)
+		CloseHandle(m_file);
+}
+
+ref<QuantumEngine::Platform::MappedFile> QuantumEngine::Platform::MappedFile::Open(const std::string& filePath)
+{
+	ref<MappedFile> mappedFile(new MappedFile());
+
+	mappedFile->m_file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+	if (mappedFile->m_file == INVALID_HANDLE_VALUE)
+		return nullptr;
+
+	LARGE_INTEGER size;
+
+	if (GetFileSizeEx(mappedFile->m_file, &size) == FALSE || size.QuadPart == 0)
+		return nullptr;
+
+	mappedFile->m_size = (UInt64)size.QuadPart;
+	mappedFile->m_mapping = CreateFileMappingA(mappedFile->m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+	if (mappedFile->m_mapping == nullptr)
+		return nullptr;
+
+	mappedFile->m_data = (const Byte*)MapViewOfFile(mappedFile->m_mapping, FILE_MAP_READ, 0, 0, 0);
+
+	if (mappedFile->m_data == nullptr)
+		return nullptr;
+
+	return mappedFile;
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include "../BasicTypes.h"
+#include "CommonWin.h"
+#include <string>
+
+namespace QuantumEngine::Platform {
+	/// <summary>
+	/// Read only view of a whole file mapped into the address space.
+	/// The view stays valid for the lifetime of the object
+	/// </summary>
+	class MappedFile {
+	public:
+		~MappedFile();
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		/// <summary>
+		/// returns nullptr if the file doesn't exist, is empty or can't be mapped
+		/// </summary>
+		static ref<MappedFile> Open(const std::string& filePath);
+		inline const Byte* GetData() const { return m_data; }
+		inline UInt64 GetSize() const { return m_size; }
+	private:
+		MappedFile() = default;
+
+		HANDLE m_file = INVALID_HANDLE_VALUE;
+		HANDLE m_mapping = nullptr;
+		const Byte* m_data = nullptr;
+		UInt64 m_size = 0;
+	};
+}
@@ -1,7 +1,13 @@
 #pragma once
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstring>
 #include <string>
 #include <map>
+#include <memory>
 #include <set>
+#include <type_traits>
 #include <vector>
 #include "../Core/Color.h"
 #include "../BasicTypes.h"
@@ -18,10 +24,14 @@ namespace QuantumEngine::Rendering {
 		UInt32 fieldIndex;
 		UInt32 size;
 		Byte* data;
+		// position of the field in the material's dirty bits
+		UInt32 slot;
 	};
 	struct MaterialTextureData {
 		UInt32 fieldIndex;
 		ref<Texture2D> texture;
+		// position of the field in the material's dirty bits, backends may reassign fieldIndex but never this
+		UInt32 slot;
 	};
 
 	struct MaterialValueFieldInfo {
@@ -40,6 +50,26 @@ namespace QuantumEngine::Rendering {
 		std::vector<MaterialTextureFieldInfo> textureFields;
 	};
 
+	/// <summary>
+	/// Value field of a material resolved once by name, accessing the field through it needs no lookup.
+	/// Only valid for the material it was found on. An invalid handle is ignored by the setters
+	/// </summary>
+	template<typename T>
+	struct MaterialFieldHandle {
+		MaterialValueData* field = nullptr;
+
+		inline bool IsValid() const { return field != nullptr; }
+	};
+
+	/// <summary>
+	/// Texture field of a material resolved once by name, see MaterialFieldHandle
+	/// </summary>
+	struct MaterialTextureHandle {
+		MaterialTextureData* field = nullptr;
+
+		inline bool IsValid() const { return field != nullptr; }
+	};
+
 	class Material {
 	public:
 		Material(const ref<ShaderProgram>& program) 
@@ -49,40 +79,18 @@ namespace QuantumEngine::Rendering {
 		}
 
 		Material(const ref<ShaderProgram>& program, const MaterialReflection* fields)
-			:m_program(program)
+			:Material(program, std::make_shared<const MaterialReflection>(*fields))
 		{
-			// Allocate Array holding Value Data
-			UInt32 totalValueSize = 0;
-			for (auto& valueField : fields->valueFields) {
-				totalValueSize += valueField.size;
-			}
-			m_valueData = new Byte[totalValueSize]();
-
-			// Initialize Value Array and Map
-			totalValueSize = 0;
-			for(auto& valueField : fields->valueFields) {
-				m_valueFields[valueField.name] = MaterialValueData{
-					.fieldIndex = valueField.fieldIndex,
-					.size = valueField.size,
-					.data = m_valueData + totalValueSize,
-				};
-
-				totalValueSize += valueField.size;
-			}
 
-			UInt32 index = 0;
-			// Initialize Texture Map
-			for (auto& textureField : fields->textureFields) {
-				m_textureFields[textureField.name] = MaterialTextureData{
-					.fieldIndex = index,
-					.texture = nullptr,
-				};
-
-				index++;
-			}
 		}
 		
 		virtual ~Material() {
+			if (m_isQueued)
+				s_modifiedMaterials.erase(std::find(s_modifiedMaterials.begin(), s_modifiedMaterials.end(), this));
+
+			if (m_parent != nullptr)
+				std::erase(m_parent->m_instances, this);
+
 			delete[] m_valueData;
 		}
 
@@ -93,39 +101,100 @@ namespace QuantumEngine::Rendering {
 		ref<ShaderProgram> GetProgram() { return m_program; }
 
 		/// <summary>
-		/// Sets the value of a field in the material. the value type must be a simple type such as int, color, etc.
+		/// Finds a value field for repeated access. The field size has to match the value type,
+		/// debug builds assert on a mismatch and release builds return an invalid handle
 		/// </summary>
 		/// <typeparam name="T">type of value</typeparam>
 		/// <param name="fieldName">name of the field</param>
-		/// <param name="value">value data</param>
+		/// <returns>invalid handle if the field doesn't exist</returns>
 		template<typename T>
-		void SetValue(const std::string& fieldName, const T& value) {
+		MaterialFieldHandle<T> FindField(const std::string& fieldName) {
+			static_assert(std::is_trivially_copyable_v<T>, "material values are copied as raw bytes");
+
 			auto it = m_valueFields.find(fieldName);
-			if (it != m_valueFields.end()) {
-				MaterialValueData& valueData = it->second;
-				if (sizeof(T) == valueData.size) {
-					memcpy(valueData.data, &value, sizeof(T));
-					m_modifiedValues.emplace(&valueData);
-				}
-			}
+			if (it == m_valueFields.end())
+				return MaterialFieldHandle<T>();
+
+			assert(it->second.size == sizeof(T) && "material field size doesn't match the value type");
+
+			if (it->second.size != sizeof(T))
+				return MaterialFieldHandle<T>();
+
+			return MaterialFieldHandle<T>{ .field = &it->second };
+		}
+
+		/// <summary>
+		/// Finds a texture field for repeated access
+		/// </summary>
+		/// <param name="fieldName">name of the field</param>
+		/// <returns>invalid handle if the field doesn't exist</returns>
+		MaterialTextureHandle FindTextureField(const std::string& fieldName) {
+			auto it = m_textureFields.find(fieldName);
+			if (it == m_textureFields.end())
+				return MaterialTextureHandle();
+
+			return MaterialTextureHandle{ .field = &it->second };
+		}
+
+		/// <summary>
+		/// Sets the value of a field found with FindField
+		/// </summary>
+		template<typename T>
+		void SetValue(const MaterialFieldHandle<T>& handle, const std::type_identity_t<T>& value) {
+			if (handle.IsValid() == false)
+				return;
+
+			std::memcpy(handle.field->data, &value, sizeof(T));
+			MarkModified(m_modifiedValueBits, handle.field->slot);
+			OnValueSet(handle.field->slot);
+		}
+
+		/// <summary>
+		/// Gets the value of a field found with FindField, defaultValue if the handle is invalid
+		/// </summary>
+		template<typename T>
+		T GetValue(const MaterialFieldHandle<T>& handle, const std::type_identity_t<T>& defaultValue) const {
+			if (handle.IsValid() == false)
+				return defaultValue;
+
+			T value;
+			std::memcpy(&value, handle.field->data, sizeof(T));
+			return value;
+		}
+
+		/// <summary>
+		/// Sets the texture of a texture field found with FindTextureField
+		/// </summary>
+		void SetTexture2D(const MaterialTextureHandle& handle, const ref<Texture2D>& texture) {
+			if (handle.IsValid() == false)
+				return;
+
+			handle.field->texture = texture;
+			MarkModified(m_modifiedTextureBits, handle.field->slot);
+			OnTextureSet(handle.field->slot);
 		}
 
 		/// <summary>
 		/// Sets the value of a field in the material. the value type must be a simple type such as int, color, etc.
+		/// Looks the field up on every call, use FindField for fields that are set often
 		/// </summary>
 		/// <typeparam name="T">type of value</typeparam>
 		/// <param name="fieldName">name of the field</param>
 		/// <param name="value">value data</param>
 		template<typename T>
-		T GetValue(const std::string& fieldName, const T& defaultValue) {
-			auto it = m_valueFields.find(fieldName);
-			if (it == m_valueFields.end()) {
-				return defaultValue;
-			}
+		void SetValue(const std::string& fieldName, const T& value) {
+			SetValue(FindField<T>(fieldName), value);
+		}
 
-			MaterialValueData& valueData = it->second;
-			T* data = (T*)valueData.data;
-			return *data;
+		/// <summary>
+		/// Gets the value of a field in the material. the value type must be a simple type such as int, color, etc.
+		/// </summary>
+		/// <typeparam name="T">type of value</typeparam>
+		/// <param name="fieldName">name of the field</param>
+		/// <param name="defaultValue">returned if the field doesn't exist</param>
+		template<typename T>
+		T GetValue(const std::string& fieldName, const T& defaultValue) {
+			return GetValue(FindField<T>(fieldName), defaultValue);
 		}
 
 		/// <summary>
@@ -134,12 +203,7 @@ namespace QuantumEngine::Rendering {
 		/// <param name="fieldName">name of the field</param>
 		/// <param name="texture">texture asset</param>
 		void SetTexture2D(const std::string& fieldName, const ref<Texture2D>& texture) {
-			auto it = m_textureFields.find(fieldName);
-			if (it != m_textureFields.end()) {
-				MaterialTextureData& textureData = it->second;
-				textureData.texture = texture;
-				m_modifiedTextures.emplace(&textureData);
-			}
+			SetTexture2D(FindTextureField(fieldName), texture);
 		}
 
 		/// <summary>
@@ -170,29 +234,219 @@ namespace QuantumEngine::Rendering {
 			return static_cast<UInt32>(m_textureFields.size());
 		}
 
-		inline const std::set<MaterialTextureData*>& GetModifiedTextures() const {
-			return m_modifiedTextures;
+		inline UInt32 GetValueFieldCount() const {
+			return static_cast<UInt32>(m_valueFields.size());
+		}
+
+		inline bool HasModifiedTextures() const {
+			return HasBits(m_modifiedTextureBits);
+		}
+
+		inline bool HasModifiedValues() const {
+			return HasBits(m_modifiedValueBits);
 		}
 
-		inline const std::set<MaterialValueData*>& GetModifiedValues() const {
-			return m_modifiedValues;
+		/// <summary>
+		/// calls function(MaterialTextureData&) for every texture field set since the last clear, in field order
+		/// </summary>
+		template<typename Function>
+		void ForEachModifiedTexture(const Function& function) {
+			ForEachBit(m_modifiedTextureBits, [&](UInt32 slot) { function(*m_textureSlots[slot]); });
 		}
 
-		inline void ClearModifiedTextures() {
-			m_modifiedTextures.clear();
-			m_modifiedValues.clear();
+		/// <summary>
+		/// calls function(MaterialValueData&) for every value field set since the last clear, in field order
+		/// </summary>
+		template<typename Function>
+		void ForEachModifiedValue(const Function& function) {
+			ForEachBit(m_modifiedValueBits, [&](UInt32 slot) { function(*m_valueSlots[slot]); });
 		}
 
-		inline void ClearTextures() { m_modifiedTextures.clear(); }
-		inline void ClearModifiedValues() { m_modifiedValues.clear(); }
+		inline void ClearModifiedTextures() { std::fill(m_modifiedTextureBits.begin(), m_modifiedTextureBits.end(), 0); }
+		inline void ClearModifiedValues() { std::fill(m_modifiedValueBits.begin(), m_modifiedValueBits.end(), 0); }
+
+		/// <summary>
+		/// every material with fields set since they were last cleared, so backends can update them in one pass
+		/// instead of checking all of their materials. Materials that were cleared in between may still be listed.
+		/// Only the ray tracing backends write values from it into their mapped shader tables, rasterization pushes
+		/// every material's value block as root/push constants on each draw and leaves the value bits set
+		/// </summary>
+		static inline const std::vector<Material*>& GetModifiedMaterials() { return s_modifiedMaterials; }
+
+		/// <summary>
+		/// drops the materials without modified fields from the modified list, called by backends after their update pass
+		/// </summary>
+		static void RemoveUnmodifiedMaterials() {
+			std::erase_if(s_modifiedMaterials, [](Material* material) {
+				if (material->HasModifiedTextures() || material->HasModifiedValues())
+					return false;
+
+				material->m_isQueued = false;
+				return true;
+			});
+		}
 
 	protected:
+		Material(const ref<ShaderProgram>& program, const ref<const MaterialReflection>& fields)
+			:m_program(program), m_reflection(fields)
+		{
+			if (m_reflection == nullptr) // instance of a material without fields
+				return;
+
+			// Allocate Array holding Value Data
+			UInt32 totalValueSize = 0;
+			for (auto& valueField : m_reflection->valueFields) {
+				totalValueSize += valueField.size;
+			}
+			m_valueData = new Byte[totalValueSize]();
+
+			// Initialize Value Array and Map
+			totalValueSize = 0;
+			for(auto& valueField : m_reflection->valueFields) {
+				MaterialValueData& valueData = m_valueFields[valueField.name];
+				valueData = MaterialValueData{
+					.fieldIndex = valueField.fieldIndex,
+					.size = valueField.size,
+					.data = m_valueData + totalValueSize,
+					.slot = (UInt32)m_valueSlots.size(),
+				};
+				m_valueSlots.push_back(&valueData);
+
+				totalValueSize += valueField.size;
+			}
+
+			UInt32 index = 0;
+			// Initialize Texture Map
+			for (auto& textureField : m_reflection->textureFields) {
+				MaterialTextureData& textureData = m_textureFields[textureField.name];
+				textureData = MaterialTextureData{
+					.fieldIndex = index,
+					.texture = nullptr,
+					.slot = (UInt32)m_textureSlots.size(),
+				};
+				m_textureSlots.push_back(&textureData);
+
+				index++;
+			}
+
+			m_modifiedValueBits.resize((m_valueSlots.size() + 63) / 64, 0);
+			m_modifiedTextureBits.resize((m_textureSlots.size() + 63) / 64, 0);
+		}
+
+		/// <summary>
+		/// Creates an instance of the parent. It shares the parent's program and reflection and starts with its values and textures
+		/// </summary>
+		Material(const ref<Material>& parent)
+			:Material(parent->m_program, parent->m_reflection)
+		{
+			m_parent = parent;
+			m_parent->m_instances.push_back(this);
+
+			// every copied field is marked so backends upload the instance like any new material
+			for (UInt32 slot = 0; slot < m_valueSlots.size(); slot++)
+				CopyValueFrom(*m_parent, slot);
+
+			for (UInt32 slot = 0; slot < m_textureSlots.size(); slot++)
+				CopyTextureFrom(*m_parent, slot);
+		}
+
+		/// <summary>
+		/// called after a field of this material is set, the material passes it on to its instances
+		/// </summary>
+		virtual void OnValueSet(UInt32 slot) { PropagateValue(slot); }
+		virtual void OnTextureSet(UInt32 slot) { PropagateTexture(slot); }
+
+		/// <summary>
+		/// fields an instance keeps when its parent changes them
+		/// </summary>
+		virtual bool IsValueOverridden(UInt32 slot) const { return false; }
+		virtual bool IsTextureOverridden(UInt32 slot) const { return false; }
+
+		/// <summary>
+		/// copies a field into the instances that don't override it, and on into their instances
+		/// </summary>
+		void PropagateValue(UInt32 slot) {
+			for (Material* instance : m_instances) {
+				if (instance->IsValueOverridden(slot))
+					continue;
+
+				instance->CopyValueFrom(*this, slot);
+				instance->PropagateValue(slot);
+			}
+		}
+
+		void PropagateTexture(UInt32 slot) {
+			for (Material* instance : m_instances) {
+				if (instance->IsTextureOverridden(slot))
+					continue;
+
+				instance->CopyTextureFrom(*this, slot);
+				instance->PropagateTexture(slot);
+			}
+		}
+
+		/// <summary>
+		/// reads a field from the parent again, used when an instance drops an override
+		/// </summary>
+		void InheritValue(UInt32 slot) {
+			CopyValueFrom(*m_parent, slot);
+			PropagateValue(slot);
+		}
+
+		void InheritTexture(UInt32 slot) {
+			CopyTextureFrom(*m_parent, slot);
+			PropagateTexture(slot);
+		}
+
 		ref<ShaderProgram> m_program;
+		ref<const MaterialReflection> m_reflection; // shared with the instances of the material
+		ref<Material> m_parent; // set for instances only
 	private:
+		void CopyValueFrom(const Material& source, UInt32 slot) {
+			std::memcpy(m_valueSlots[slot]->data, source.m_valueSlots[slot]->data, m_valueSlots[slot]->size);
+			MarkModified(m_modifiedValueBits, slot);
+		}
+
+		void CopyTextureFrom(const Material& source, UInt32 slot) {
+			m_textureSlots[slot]->texture = source.m_textureSlots[slot]->texture;
+
+			// backends resolve every modified texture, a field without one keeps what it had
+			if (m_textureSlots[slot]->texture != nullptr)
+				MarkModified(m_modifiedTextureBits, slot);
+		}
+
+		void MarkModified(std::vector<UInt64>& bits, UInt32 slot) {
+			bits[slot / 64] |= 1ull << (slot % 64);
+
+			if (m_isQueued == false) {
+				m_isQueued = true;
+				s_modifiedMaterials.push_back(this);
+			}
+		}
+
+		static bool HasBits(const std::vector<UInt64>& bits) {
+			return std::any_of(bits.begin(), bits.end(), [](UInt64 word) { return word != 0; });
+		}
+
+		template<typename Function>
+		static void ForEachBit(const std::vector<UInt64>& bits, const Function& function) {
+			for (UInt32 word = 0; word < bits.size(); word++) {
+				for (UInt64 remaining = bits[word]; remaining != 0; remaining &= remaining - 1)
+					function(word * 64 + (UInt32)std::countr_zero(remaining));
+			}
+		}
+
 		Byte* m_valueData = nullptr; // contiguous array holding all value data
 		std::map<std::string, MaterialValueData> m_valueFields;
 		std::map<std::string, MaterialTextureData> m_textureFields;
-		std::set<MaterialTextureData*> m_modifiedTextures;
-		std::set<MaterialValueData*> m_modifiedValues;
+		// fields in reflection order, indexed by their dirty bit
+		std::vector<MaterialValueData*> m_valueSlots;
+		std::vector<MaterialTextureData*> m_textureSlots;
+		std::vector<UInt64> m_modifiedValueBits;
+		std::vector<UInt64> m_modifiedTextureBits;
+		bool m_isQueued = false;
+		std::vector<Material*> m_instances;
+
+		inline static std::vector<Material*> s_modifiedMaterials;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,79 @@
+#pragma once
+#include "Material.h"
+
+namespace QuantumEngine::Rendering {
+	/// <summary>
+	/// Variation of a material. It shares the parent's program and reflection, so backends reuse the parent's pipeline state,
+	/// and starts with the parent's values and textures. Fields set on the instance override the parent,
+	/// every other field follows the parent when the parent changes it
+	/// </summary>
+	class MaterialInstance : public Material {
+	public:
+		MaterialInstance(const ref<Material>& parent)
+			:Material(parent)
+		{
+			m_overriddenValueBits.resize((GetValueFieldCount() + 63) / 64, 0);
+			m_overriddenTextureBits.resize((GetTextureFieldCount() + 63) / 64, 0);
+		}
+
+		inline const ref<Material>& GetParent() const { return m_parent; }
+
+		/// <summary>
+		/// Removes the override of a field found with FindField on this instance, it reads the parent's value again
+		/// </summary>
+		template<typename T>
+		void ResetValue(const MaterialFieldHandle<T>& handle) {
+			if (handle.IsValid() == false)
+				return;
+
+			ClearBit(m_overriddenValueBits, handle.field->slot);
+			InheritValue(handle.field->slot);
+		}
+
+		/// <summary>
+		/// Removes the override of a texture field found with FindTextureField on this instance
+		/// </summary>
+		void ResetTexture2D(const MaterialTextureHandle& handle) {
+			if (handle.IsValid() == false)
+				return;
+
+			ClearBit(m_overriddenTextureBits, handle.field->slot);
+			InheritTexture(handle.field->slot);
+		}
+
+		void ResetValue(const std::string& fieldName) {
+			auto it = GetValueFields()->find(fieldName);
+			if (it == GetValueFields()->end())
+				return;
+
+			ClearBit(m_overriddenValueBits, it->second.slot);
+			InheritValue(it->second.slot);
+		}
+
+		void ResetTexture2D(const std::string& fieldName) {
+			ResetTexture2D(FindTextureField(fieldName));
+		}
+
+		inline bool IsValueOverridden(UInt32 slot) const override { return HasBit(m_overriddenValueBits, slot); }
+		inline bool IsTextureOverridden(UInt32 slot) const override { return HasBit(m_overriddenTextureBits, slot); }
+
+	protected:
+		void OnValueSet(UInt32 slot) override {
+			SetBit(m_overriddenValueBits, slot);
+			PropagateValue(slot);
+		}
+
+		void OnTextureSet(UInt32 slot) override {
+			SetBit(m_overriddenTextureBits, slot);
+			PropagateTexture(slot);
+		}
+
+	private:
+		static void SetBit(std::vector<UInt64>& bits, UInt32 slot) { bits[slot / 64] |= 1ull << (slot % 64); }
+		static void ClearBit(std::vector<UInt64>& bits, UInt32 slot) { bits[slot / 64] &= ~(1ull << (slot % 64)); }
+		static bool HasBit(const std::vector<UInt64>& bits, UInt32 slot) { return (bits[slot / 64] >> (slot % 64)) & 1; }
+
+		std::vector<UInt64> m_overriddenValueBits;
+		std::vector<UInt64> m_overriddenTextureBits;
+	};
+}
@@ -3,6 +3,9 @@
 #include "../BasicTypes.h"
 #include "Renderer.h"
 #include <vector>
+#include <algorithm>
+#include <climits>
+#include <cmath>
 #include "../Core/BezierCurve.h"
 
 namespace QuantumEngine::Rendering {
@@ -10,11 +13,17 @@ namespace QuantumEngine::Rendering {
 
 	class SplineRenderer : public Renderer
 	{
+	public: // Constants
+
+		// upper bound of UpdateSegments for every spline, the authored segment count is only the initial tessellation
+		static constexpr int MaxSegments = 1024;
+
 	public: // Constructors
 
-		SplineRenderer(const ref<Material>& material, const std::vector<Vector3>& points, const float width, const int segments)
-			: Renderer(material), m_curve(points[0], points[1], points[2]),
-			m_width(width), m_segments(segments) { }
+		SplineRenderer(const ref<Material>& material, const std::vector<Vector3>& points, const float width, const int segments,
+			Core::CurveType curveType = Core::CurveType::QuadraticBezier)
+			: Renderer(material), m_width(width), m_segments(std::clamp(segments, 1, MaxSegments)),
+			m_curve(points, curveType) { }
 	
 	public: // Methods
 
@@ -30,6 +39,31 @@ namespace QuantumEngine::Rendering {
 		/// <returns></returns>
 		inline int GetSegments() const { return m_segments; }
 
+		/// <summary>
+		/// picks the fewest segments that keep the spline within maxPixelError pixels of the curve.
+		/// pixelsPerUnit is grouped into power of two distance bands, nothing is recomputed until the curve changes or the band does
+		/// </summary>
+		/// <returns>true if the segment count changed</returns>
+		bool UpdateSegments(Float pixelsPerUnit, Float maxPixelError, bool curveChanged)
+		{
+			int band = (int)std::floor(std::log2(std::max(pixelsPerUnit, 1e-6f)));
+
+			if (curveChanged == false && band == m_distanceBand)
+				return false;
+
+			m_distanceBand = band;
+
+			// the closest distance of the band has the most pixels per unit
+			Float maxError = maxPixelError / std::exp2((Float)(band + 1));
+			int segments = (int)std::clamp(m_curve.SegmentsForError(maxError), 1u, (UInt32)MaxSegments);
+
+			if (segments == m_segments)
+				return false;
+
+			m_segments = segments;
+			return true;
+		}
+
 		/// <summary>
 		/// Gets the bezier curve used by this spline renderer
 		/// </summary>
@@ -48,6 +82,7 @@ namespace QuantumEngine::Rendering {
 	private: // Fields
 		float m_width;
 		int m_segments;
+		int m_distanceBand = INT_MIN;
 		bool m_isDirty = true;
 		Core::BezierCurve m_curve;
 	};
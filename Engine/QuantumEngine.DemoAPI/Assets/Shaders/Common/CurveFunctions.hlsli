@@ -0,0 +1,58 @@
+// Curves are chains of cubic bezier segments written by Core::BezierCurve, the including shader declares
+// StructuredBuffer<float4> CurvePoints with 3 * segmentCount + 1 points per curve, segment i uses points 3i to 3i + 3
+// StructuredBuffer<float> CurveArcLengths with segmentCount * CURVE_ARC_LENGTH_SAMPLES + 1 lengths per curve
+
+// Matches BezierCurve::ArcLengthSamplesPerSegment
+#define CURVE_ARC_LENGTH_SAMPLES 16
+
+void InterpolateCurve(uint pointOffset, uint segmentCount, float t, out float3 position, out float3 tangent)
+{
+    float scaled = saturate(t) * segmentCount;
+    uint segment = min((uint) scaled, segmentCount - 1);
+    float s = scaled - segment;
+    float u = 1.0f - s;
+
+    uint first = pointOffset + segment * 3;
+    float3 p0 = CurvePoints[first].xyz;
+    float3 p1 = CurvePoints[first + 1].xyz;
+    float3 p2 = CurvePoints[first + 2].xyz;
+    float3 p3 = CurvePoints[first + 3].xyz;
+
+    position = u * u * u * p0 + 3.0f * u * u * s * p1 + 3.0f * u * s * s * p2 + s * s * s * p3;
+    tangent = u * u * (p1 - p0) + 2.0f * u * s * (p2 - p1) + s * s * (p3 - p2);
+
+    // degenerate segments have no direction, the chord keeps the frame valid
+    if (dot(tangent, tangent) <= 0.0f)
+        tangent = p3 - p0;
+
+    tangent = dot(tangent, tangent) > 0.0f ? normalize(tangent) : float3(1.0f, 0.0f, 0.0f);
+}
+
+// t value where the curve reaches the given length, same search as BezierCurve::ParameterAtLength
+float CurveParameterAtLength(uint lengthOffset, uint segmentCount, float length)
+{
+    uint sampleCount = segmentCount * CURVE_ARC_LENGTH_SAMPLES;
+
+    if (length <= 0.0f)
+        return 0.0f;
+
+    // last sample at or before the length
+    uint low = 0;
+    uint high = sampleCount - 1;
+
+    while (low < high)
+    {
+        uint mid = (low + high + 1) / 2;
+
+        if (CurveArcLengths[lengthOffset + mid] <= length)
+            low = mid;
+        else
+            high = mid - 1;
+    }
+
+    float start = CurveArcLengths[lengthOffset + low];
+    float span = CurveArcLengths[lengthOffset + low + 1] - start;
+    float fraction = span > 0.0f ? saturate((length - start) / span) : 0.0f;
+
+    return (low + fraction) / sampleCount;
+}
@@ -0,0 +1,63 @@
+#ifndef GBUFFER_FUNCTIONS
+#define GBUFFER_FUNCTIONS
+
+// The Vulkan G-buffer has no position target, positions are rebuilt from the depth buffer.
+// Its only color target is R16G16_UINT, 15 bits per octahedral normal component and the mask in the top bit of both components
+#ifdef _VULKAN
+    #define GBUFFER_COMPACT
+#endif
+
+#define GBUFFER_NORMAL_BITS 15
+#define GBUFFER_NORMAL_MAX ((1u << GBUFFER_NORMAL_BITS) - 1)
+
+float2 OctahedralWrap(float2 v)
+{
+    float2 signs = float2(v.x >= 0.0f ? 1.0f : -1.0f, v.y >= 0.0f ? 1.0f : -1.0f);
+    return (1.0f - abs(v.yx)) * signs;
+}
+
+// unit normal to [0, 1] coordinates on the unfolded octahedron
+float2 EncodeOctahedral(float3 normal)
+{
+    normal /= abs(normal.x) + abs(normal.y) + abs(normal.z);
+    float2 oct = normal.z >= 0.0f ? normal.xy : OctahedralWrap(normal.xy);
+    return oct * 0.5f + 0.5f;
+}
+
+float3 DecodeOctahedral(float2 encoded)
+{
+    float2 oct = encoded * 2.0f - 1.0f;
+    float3 normal = float3(oct, 1.0f - abs(oct.x) - abs(oct.y));
+    float fold = saturate(-normal.z);
+    normal.x += normal.x >= 0.0f ? -fold : fold;
+    normal.y += normal.y >= 0.0f ? -fold : fold;
+    return normalize(normal);
+}
+
+// mask keeps its two low bits, 0 marks pixels without G-buffer geometry
+uint2 PackGBufferNormal(float3 normal, uint mask)
+{
+    uint2 oct = (uint2) round(EncodeOctahedral(normalize(normal)) * GBUFFER_NORMAL_MAX);
+    return oct | ((uint2(mask, mask >> 1) & 1u) << GBUFFER_NORMAL_BITS);
+}
+
+float3 UnpackGBufferNormal(uint2 packed)
+{
+    return DecodeOctahedral(float2(packed & GBUFFER_NORMAL_MAX) / GBUFFER_NORMAL_MAX);
+}
+
+uint UnpackGBufferMask(uint2 packed)
+{
+    return (packed.x >> GBUFFER_NORMAL_BITS) | ((packed.y >> GBUFFER_NORMAL_BITS) << 1);
+}
+
+// uv has its origin at the top left, inverseViewProjection is cameraData.inverseProjectionMatrix which also holds the camera transform
+float3 ReconstructWorldPosition(float2 uv, float depth, float4x4 inverseViewProjection)
+{
+    float2 screenPos = uv * 2.0f - 1.0f;
+    screenPos.y = -screenPos.y;
+    float4 worldPos = mul(float4(screenPos, depth, 1.0f), inverseViewProjection);
+    return worldPos.xyz / worldPos.w;
+}
+
+#endif
@@ -27,14 +27,127 @@ struct PointLight
     float radius;
 };
 
-struct LightData
+#define DIRECTIONAL_LIGHT_SIZE 32
+#define POINT_LIGHT_SIZE 48
+#define LIGHT_CLUSTER_SIZE 8
+#define LIGHT_ALIAS_ENTRY_SIZE 16
+#define ALL_LIGHTS_CLUSTER 0xFFFFFFFF
+
+// Layout written by LightClusterGrid, offsets are in bytes from the start of the light buffer
+struct LightBufferHeader
 {
-    DirectionalLight directionalLights[10];
-    PointLight pointLights[10];
     uint directionalLightCount;
     uint pointLightCount;
+    uint directionalLightOffset;
+    uint pointLightOffset;
+    uint clusterOffset;
+    uint lightIndexOffset;
+    uint clusterCountX;
+    uint clusterCountY;
+    uint clusterCountZ;
+    float depthScale;
+    float depthBias;
+    float projectionScaleX;
+    float projectionScaleY;
+    float nearZ;
+    float farZ;
+    uint aliasTableOffset;
+    float4 viewRow0;
+    float4 viewRow1;
+    float4 viewRow2;
+    // sum of the point light colors, scaled by the ambient factor once instead of per light
+    float3 pointLightAmbient;
+    uint padding;
+};
+
+// Slot of the alias table over the point lights, picks the slot's light below the threshold and the alias above it
+struct LightAliasEntry
+{
+    float threshold;
+    uint alias;
+    float pdf;
+    float aliasPdf;
+};
+
+// Range of the light index list holding the point lights of one cluster
+struct LightCluster
+{
+    uint offset;
+    uint count;
 };
 
+inline LightBufferHeader LoadLightHeader(ByteAddressBuffer lights)
+{
+    return lights.Load<LightBufferHeader>(0);
+}
+
+inline DirectionalLight LoadDirectionalLight(ByteAddressBuffer lights, LightBufferHeader header, uint index)
+{
+    return lights.Load<DirectionalLight>(header.directionalLightOffset + index * DIRECTIONAL_LIGHT_SIZE);
+}
+
+inline PointLight LoadPointLight(ByteAddressBuffer lights, LightBufferHeader header, uint index)
+{
+    return lights.Load<PointLight>(header.pointLightOffset + index * POINT_LIGHT_SIZE);
+}
+
+// Finds the froxel of a world position. Positions outside the camera frustum, such as ray hits behind the camera,
+// get a cluster covering all point lights
+inline LightCluster FindLightCluster(ByteAddressBuffer lights, LightBufferHeader header, float3 position)
+{
+    LightCluster cluster;
+    cluster.offset = ALL_LIGHTS_CLUSTER;
+    cluster.count = header.pointLightCount;
+    
+    float4 worldPos = float4(position, 1.0f);
+    float3 viewPos = float3(dot(header.viewRow0, worldPos), dot(header.viewRow1, worldPos), dot(header.viewRow2, worldPos));
+    
+    if (viewPos.z < header.nearZ || viewPos.z > header.farZ)
+        return cluster;
+    
+    float2 ndc = float2(header.projectionScaleX * viewPos.x, header.projectionScaleY * viewPos.y) / viewPos.z;
+    
+    if (abs(ndc.x) > 1.0f || abs(ndc.y) > 1.0f)
+        return cluster;
+    
+    uint2 tile = min(uint2((ndc * 0.5f + 0.5f) * float2(header.clusterCountX, header.clusterCountY)), uint2(header.clusterCountX - 1, header.clusterCountY - 1));
+    uint slice = min(uint(max(log(viewPos.z) * header.depthScale + header.depthBias, 0.0f)), header.clusterCountZ - 1);
+    uint clusterIndex = (slice * header.clusterCountY + tile.y) * header.clusterCountX + tile.x;
+    
+    return lights.Load<LightCluster>(header.clusterOffset + clusterIndex * LIGHT_CLUSTER_SIZE);
+}
+
+inline uint GetClusterLightIndex(ByteAddressBuffer lights, LightBufferHeader header, LightCluster cluster, uint index)
+{
+    if (cluster.offset == ALL_LIGHTS_CLUSTER)
+        return index;
+    
+    return lights.Load(header.lightIndexOffset + (cluster.offset + index) * 4);
+}
+
+// Weight the alias table is built with, has to match LightClusterGrid
+inline float PointLightPower(PointLight light)
+{
+    return max(light.intensity, 0.0f) * max(dot(light.color.xyz, float3(0.2126f, 0.7152f, 0.0722f)), 0.0f);
+}
+
+// Picks a point light proportional to its power in constant time, u is uniform in [0, 1)
+inline uint SamplePointLight(ByteAddressBuffer lights, LightBufferHeader header, float u, out float pdf)
+{
+    float scaled = u * header.pointLightCount;
+    uint index = min(uint(scaled), header.pointLightCount - 1);
+    LightAliasEntry entry = lights.Load<LightAliasEntry>(header.aliasTableOffset + index * LIGHT_ALIAS_ENTRY_SIZE);
+    
+    if (scaled - index < entry.threshold)
+    {
+        pdf = entry.pdf;
+        return index;
+    }
+    
+    pdf = entry.aliasPdf;
+    return entry.alias;
+}
+
 inline float3 PhongDirectionalLight(DirectionalLight light, float3 camPosition, float3 position, float3 normal, float3 ads)
 {
     float3 norm = normalize(normal);
@@ -57,7 +170,8 @@ inline float3 PhongDirectionalLight(DirectionalLight light, float3 camPosition,
     return (ads.x + light.intensity * (specular + diffuse)) * light.color.xyz;
 }
 
-inline float3 PhongPointLight(PointLight light, float3 camPosition, float3 position, float3 normal, float3 ads)
+// diffuse and specular terms of a point light, without its ambient term
+inline float3 PhongPointLightDirect(PointLight light, float3 camPosition, float3 position, float3 normal, float3 ads)
 {
     float3 norm = normalize(normal);
     float3 lightDir = -position + light.position;
@@ -65,7 +179,7 @@ inline float3 PhongPointLight(PointLight light, float3 camPosition, float3 posit
 
     if (sqrlightMag > pow(light.radius, 2))
     { //light is too far away from pixel
-        return ads.x * light.color.xyz;
+        return float3(0.0f, 0.0f, 0.0f);
     }
 	
     float lightMag = sqrt(sqrlightMag);
@@ -84,27 +198,36 @@ inline float3 PhongPointLight(PointLight light, float3 camPosition, float3 posit
     }
     
     float att = light.attenuation.AttenuationFactor(lightMag);
-    return (ads.x + att * light.intensity * (specular + diffuse)) * light.color.xyz;
+    return att * light.intensity * (specular + diffuse) * light.color.xyz;
 }
 
-inline float3 PhongLight(LightData lightData, float3 camPosition, float3 position, float3 normal, float3 ads)
+inline float3 PhongPointLight(PointLight light, float3 camPosition, float3 position, float3 normal, float3 ads)
+{
+    return ads.x * light.color.xyz + PhongPointLightDirect(light, camPosition, position, normal, ads);
+}
+
+inline float3 PhongLight(ByteAddressBuffer lights, float3 camPosition, float3 position, float3 normal, float3 ads)
 {
     float3 lightFactor = float3(0.0f, 0.0f, 0.0f);
+    LightBufferHeader header = LoadLightHeader(lights);
 
-    for (uint i = 0; i < lightData.directionalLightCount; i++)
-        lightFactor += PhongDirectionalLight(lightData.directionalLights[i], camPosition, position, normal, ads);
-    for (uint i = 0; i < lightData.pointLightCount; i++)
-        lightFactor += PhongPointLight(lightData.pointLights[i], camPosition, position, normal, ads);
+    for (uint i = 0; i < header.directionalLightCount; i++)
+        lightFactor += PhongDirectionalLight(LoadDirectionalLight(lights, header, i), camPosition, position, normal, ads);
+    
+    // every point light adds ambient, only the ones reaching the cluster of the position add the rest
+    lightFactor += ads.x * header.pointLightAmbient;
+    LightCluster cluster = FindLightCluster(lights, header, position);
+    
+    for (uint i = 0; i < cluster.count; i++)
+        lightFactor += PhongPointLightDirect(LoadPointLight(lights, header, GetClusterLightIndex(lights, header, cluster, i)), camPosition, position, normal, ads);
     
     return lightFactor;
 }
 
 #if defined(_VULKAN)
-    #define LIGHT_VAR(x)  cbuffer _LightData{ \
-        LightData lightData; \
-    };
+    #define LIGHT_VAR(x)  ByteAddressBuffer _LightData;
 #else
-    #define LIGHT_VAR(x)  cbuffer _LightData : DX12_REGISTER_SPACE(x) {  \
-        LightData lightData; \
-    };
+    #define LIGHT_VAR(x)  ByteAddressBuffer _LightData : DX12_REGISTER_SPACE(x);
 #endif
+
+#define lightData _LightData
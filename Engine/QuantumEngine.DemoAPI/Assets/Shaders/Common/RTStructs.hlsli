@@ -15,6 +15,28 @@ struct Vertex
     float3 normal;
 };
 
+// PCG hash, seeded per ray with CreateRandomSeed
+inline uint NextRandomState(inout uint state)
+{
+    state = state * 747796405u + 2891336453u;
+    uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+// uniform in [0, 1)
+inline float NextRandom(inout uint state)
+{
+    return (NextRandomState(state) >> 8) * (1.0f / 16777216.0f);
+}
+
+inline uint CreateRandomSeed(uint salt)
+{
+    uint3 launchIndex = DispatchRaysIndex();
+    uint state = launchIndex.y * DispatchRaysDimensions().x + launchIndex.x + salt * 0x9E3779B9u;
+    NextRandomState(state);
+    return state;
+}
+
 inline float3 CalculateScreenPosition(float4x4 inverseProjectMatrix)
 {
     uint3 launchIndex = DispatchRaysIndex();
@@ -87,10 +109,22 @@ inline float3 Refract(float3 rayDirection, float3 normal, float refractionFactor
 #endif
 
 
+#ifdef _VULKAN
+    // bindless table indices of the mesh buffers of each TLAS instance
+    struct RTInstanceResources
+    {
+        uint vertexBuffer;
+        uint indexBuffer;
+    };
+
+    StructuredBuffer<RTInstanceResources> _rtInstanceResources;
+#endif
+
+
 #ifdef _VULKAN
     #define RT_OBJECT_INDEX_BUFFER_VAR(x) \
         StructuredBuffer<uint> _indexBufferArray[]; \
-        static const StructuredBuffer<uint> _indexBuffer = _indexBufferArray[InstanceIndex()];
+        static const StructuredBuffer<uint> _indexBuffer = _indexBufferArray[NonUniformResourceIndex(_rtInstanceResources[InstanceIndex()].indexBuffer)];
 #else
     #define RT_OBJECT_INDEX_BUFFER_VAR(x)  StructuredBuffer<uint> _indexBuffer : DX12_REGISTER_SPACE(x);
 #endif
@@ -99,7 +133,7 @@ inline float3 Refract(float3 rayDirection, float3 normal, float refractionFactor
 #ifdef _VULKAN
     #define RT_OBJECT_VERTEX_BUFFER_VAR(x) \
         StructuredBuffer<Vertex> _vertexBufferArray[]; \
-        static const StructuredBuffer<Vertex> _vertexBuffer = _vertexBufferArray[InstanceIndex()];
+        static const StructuredBuffer<Vertex> _vertexBuffer = _vertexBufferArray[NonUniformResourceIndex(_rtInstanceResources[InstanceIndex()].vertexBuffer)];
 #else
     #define RT_OBJECT_VERTEX_BUFFER_VAR(x)  StructuredBuffer<Vertex> _vertexBuffer : DX12_REGISTER_SPACE(x);
 #endif
@@ -0,0 +1,22 @@
+struct SplineVertex
+{
+    float3 pos;
+    float2 texCoord;
+    float3 norm;
+    float3 tangent;
+};
+
+// Matches SplineParameters in VulkanSplinePipelineModule.h, one per spline of the batch
+struct SplineData
+{
+    float width;
+    float length;
+    // first vertex of the spline in the shared vertex buffer
+    uint vertexOffset;
+    uint vertexCount;
+    uint transformIndex;
+    // first bezier point and arc length of the curve in the shared curve buffers
+    uint pointOffset;
+    uint segmentCount;
+    uint lengthOffset;
+};
@@ -18,9 +18,11 @@
             MaterialConstantProperties propName;   \
         };
     #else
+        // the copy lets TEXTURE read the bindless indices without knowing propName
         #define CONSTANT_VARIABLES_END(propName, x) }; \
         [[vk::push_constant]]    \
-        MaterialConstantProperties propName;
+        MaterialConstantProperties propName; \
+        static MaterialConstantProperties _materialConstants = propName;
     #endif
 #else
     #define CONSTANT_VARIABLES_END(propName, x) }; \
@@ -30,15 +32,35 @@
 #endif
 
 
+// declares the bindless index of a TEXTURE inside CONSTANT_VARIABLES_BEGIN/END, rasterization textures are only found through it
+#if defined(_VULKAN) && !defined(_VK_RAY_TRACING)
+    #define TEXTURE_INDEX(texName) uint texName##BindlessIndex;
+#else
+    #define TEXTURE_INDEX(texName)
+#endif
+
 #ifdef _VULKAN
+    // set of the bindless image array in rasterization pipelines, every other resource stays in set 0
+    #define VK_RASTER_BINDLESS_IMAGE_SET 1
+
     #ifdef _VK_RAY_TRACING_LOCAL
+        // texName##Array is the image array of the bindless table, texName##Indices holds the texture index of every material of the program
         #define TEXTURE(texName, type, x)   Texture2D<type> texName##Array[];  \
-        static Texture2D<type> texName = texName##Array[InstanceID()];
-    #else
+        StructuredBuffer<uint> texName##Indices; \
+        static Texture2D<type> texName = texName##Array[NonUniformResourceIndex(texName##Indices[InstanceID()])];
+    #elif defined(_VK_RAY_TRACING)
         #define TEXTURE(texName, type, x)   Texture2D<type> texName;
+    #else
+        // the index is pushed with the material constants, see TEXTURE_INDEX
+        #define TEXTURE(texName, type, x)   [[vk::binding(0, VK_RASTER_BINDLESS_IMAGE_SET)]] Texture2D<type> texName##Array[];  \
+        static Texture2D<type> texName = texName##Array[_materialConstants.texName##BindlessIndex];
     #endif
+
+    // textures written by the engine (G-buffer targets, ray tracing output) are bound directly
+    #define INTERNAL_TEXTURE(texName, type, x)   Texture2D<type> texName;
 #else
     #define TEXTURE(texName, type, x)   Texture2D<type> texName : DX12_REGISTER_SPACE(x) ;
+    #define INTERNAL_TEXTURE(texName, type, x)   Texture2D<type> texName : DX12_REGISTER_SPACE(x) ;
 #endif
 
 
@@ -0,0 +1,28 @@
+#ifndef VERTEX_STRUCTS
+#define VERTEX_STRUCTS
+
+// Set by the pipeline when the mesh uses the quantized vertex layout.
+// Positions are dequantized through the model matrix, only the normal needs decoding here
+#if defined(_VULKAN)
+    [[vk::constant_id(0)]] const bool _quantizedVertex = false;
+#else
+    static const bool _quantizedVertex = false;
+#endif
+
+float3 DecodeOctahedralNormal(float2 e)
+{
+    float3 n = float3(e.xy, 1.0f - abs(e.x) - abs(e.y));
+    float t = saturate(-n.z);
+    n.xy += float2(n.x >= 0.0f ? -t : t, n.y >= 0.0f ? -t : t);
+    return normalize(n);
+}
+
+float3 DecodeVertexNormal(float3 norm)
+{
+    if (_quantizedVertex)
+        return DecodeOctahedralNormal(norm.xy);
+
+    return norm;
+}
+
+#endif
@@ -0,0 +1,55 @@
+#include "Common/VariableMacros.hlsli"
+#include "Common/SplineStructs.hlsli"
+
+CONSTANT_VARIABLES_BEGIN
+    uint dirtySplineCount;
+    // vertices of all dirty splines, one thread each
+    uint dirtyVertexCount;
+CONSTANT_VARIABLES_END(BatchProps, b0)
+
+StructuredBuffer<SplineData> Splines;
+StructuredBuffer<float4> CurvePoints;
+StructuredBuffer<float> CurveArcLengths;
+// slot of every dirty spline and its first thread, ascending by first thread
+StructuredBuffer<uint2> DirtySplines;
+RWStructuredBuffer<SplineVertex> SplineVertices;
+
+#include "Common/CurveFunctions.hlsli"
+
+[numthreads(64, 1, 1)]
+void cs_main(uint3 DTid : SV_DispatchThreadID)
+{
+    if (DTid.x >= BatchProps.dirtyVertexCount)
+        return;
+
+    // last dirty spline starting at or before this thread
+    uint low = 0;
+    uint high = BatchProps.dirtySplineCount - 1;
+
+    while (low < high)
+    {
+        uint mid = (low + high + 1) / 2;
+
+        if (DirtySplines[mid].y <= DTid.x)
+            low = mid;
+        else
+            high = mid - 1;
+    }
+
+    uint2 dirtySpline = DirtySplines[low];
+    SplineData spline = Splines[dirtySpline.x];
+    uint vertexIndex = DTid.x - dirtySpline.y;
+    // vertices are spaced evenly along the length of the curve
+    float u = (float) vertexIndex / (spline.vertexCount - 1);
+    float t = CurveParameterAtLength(spline.lengthOffset, spline.segmentCount, u * spline.length);
+
+    SplineVertex vertex;
+    InterpolateCurve(spline.pointOffset, spline.segmentCount, t, vertex.pos, vertex.tangent);
+
+    float3 normal = float3(0.0f, 1.0f, 0.0f);
+    float3 bitangent = dot(vertex.tangent, normal) * vertex.tangent;
+    vertex.norm = normalize(normal - bitangent);
+    vertex.texCoord = float2(u, 0.0f);
+
+    SplineVertices[spline.vertexOffset + vertexIndex] = vertex;
+}
@@ -1,5 +1,6 @@
 #include "Common/TransformStructs.hlsli"
 #include "Common/LightStructs.hlsli"
+#include "Common/SplineStructs.hlsli"
 
 struct VS_INPUT
 {
@@ -7,6 +8,21 @@ struct VS_INPUT
     float2 texCoord : TEXCOORD;
     float3 norm : NORMAL;
     float3 tangent : TANGENT;
+#ifdef _VULKAN
+    // the first instance of every draw is the slot of its spline
+    uint instanceID : SV_InstanceID;
+#endif
+};
+
+struct VS_OUTPUT
+{
+    float3 pos : POSITION;
+    float2 texCoord : TEXCOORD;
+    float3 norm : NORMAL;
+    float3 tangent : TANGENT;
+#ifdef _VULKAN
+    nointerpolation uint spline : SPLINE_INDEX;
+#endif
 };
 
 struct GS_OUTPUT
@@ -17,11 +33,17 @@ struct GS_OUTPUT
     float3 worldPos : POSITION;
 };
 
+#ifdef _VULKAN
+// all splines of the material are drawn at once, each one finds its transform through its slot
+StructuredBuffer<TransformData> _ObjectTransformDataArray;
+StructuredBuffer<SplineData> Splines;
+#else
 OBJECT_TRANSFORM_VAR(b0)
+#endif
 
 CAMERA_VAR(b1)
 
-LIGHT_VAR(b2)
+LIGHT_VAR(t0)
 
 CONSTANT_VARIABLES_BEGIN
     float4 color;
@@ -38,32 +60,47 @@ CONSTANT_VARIABLES_END(MaterialProps, b3)
 #define _width MaterialProps._width
 
 
-VS_INPUT vs_main(VS_INPUT vertexIn)
+VS_OUTPUT vs_main(VS_INPUT vertexIn)
 {
-    return vertexIn;
+    VS_OUTPUT vsOut;
+    vsOut.pos = vertexIn.pos;
+    vsOut.texCoord = vertexIn.texCoord;
+    vsOut.norm = vertexIn.norm;
+    vsOut.tangent = vertexIn.tangent;
+#ifdef _VULKAN
+    vsOut.spline = vertexIn.instanceID;
+#endif
+    return vsOut;
 }
 
 [maxvertexcount(4)]
-void gs_main(line VS_INPUT vertexIn[2], inout TriangleStream<GS_OUTPUT> triStream)
+void gs_main(line VS_OUTPUT vertexIn[2], inout TriangleStream<GS_OUTPUT> triStream)
 {
+#ifdef _VULKAN
+    SplineData spline = Splines[vertexIn[0].spline];
+    float4x4 mat = mul(_ObjectTransformDataArray[spline.transformIndex].modelViewMatrix, cameraData.projectionMatrix);
+    float width = spline.width;
+#else
     float4x4 mat = mul(transformData.modelViewMatrix, cameraData.projectionMatrix);
+    float width = _width;
+#endif
     GS_OUTPUT gsOut[4];
     float3 edge1 = cross(vertexIn[0].norm, vertexIn[0].tangent);
-    gsOut[0].worldPos = vertexIn[0].pos + _width * edge1;
+    gsOut[0].worldPos = vertexIn[0].pos + width * edge1;
     gsOut[0].texCoord = float2(vertexIn[0].texCoord.x, 1);
     gsOut[0].norm = vertexIn[0].norm;
     gsOut[0].pos = mul(float4(gsOut[0].worldPos, 1.0f), mat);
-    gsOut[1].worldPos = vertexIn[0].pos - _width * edge1;
+    gsOut[1].worldPos = vertexIn[0].pos - width * edge1;
     gsOut[1].texCoord = float2(vertexIn[0].texCoord.x, 0);
     gsOut[1].norm = vertexIn[0].norm;
     gsOut[1].pos = mul(float4(gsOut[1].worldPos, 1.0f), mat);
     
     float3 edge2 = cross(vertexIn[1].norm, vertexIn[1].tangent);
-    gsOut[2].worldPos = vertexIn[1].pos + _width * edge2;
+    gsOut[2].worldPos = vertexIn[1].pos + width * edge2;
     gsOut[2].texCoord = float2(vertexIn[1].texCoord.x, 1);
     gsOut[2].norm = vertexIn[1].norm;
     gsOut[2].pos = mul(float4(gsOut[2].worldPos, 1.0f), mat);
-    gsOut[3].worldPos = vertexIn[1].pos - _width * edge2;
+    gsOut[3].worldPos = vertexIn[1].pos - width * edge2;
     gsOut[3].texCoord = float2(vertexIn[1].texCoord.x, 0);
     gsOut[3].norm = vertexIn[1].norm;
     gsOut[3].pos = mul(float4(gsOut[3].worldPos, 1.0f), mat);
@@ -0,0 +1,142 @@
+#include "Common/TransformStructs.hlsli"
+
+// Matches GBufferInstanceGPU in VulkanGBufferPipelineModule.h
+struct GBufferInstance
+{
+    float3 boundsCenter;
+    float boundsRadius;
+    uint transformIndex;
+    uint firstIndex;
+    uint indexCount;
+    int vertexOffset;
+    uint pipelineIndex;
+    uint drawOffset;
+    uint2 padding;
+};
+
+// pipelineIndex of instances that are only tested for the visibility of their forward pass
+#define NO_DRAW_PIPELINE 0xFFFFFFFF
+
+// Matches GBufferOcclusionParameters in VulkanGBufferPipelineModule.h
+struct OcclusionParameters
+{
+    // view projection the pyramid was built with
+    float4x4 viewProjection;
+    uint2 pyramidSize;
+    uint mipCount;
+    // 0 until the first pyramid is built
+    uint enabled;
+};
+
+// VkDrawIndexedIndirectCommand
+struct DrawIndexedCommand
+{
+    uint indexCount;
+    uint instanceCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint firstInstance;
+};
+
+CONSTANT_VARIABLES_BEGIN
+    float4 frustumPlanes[6];
+    uint instanceCount;
+CONSTANT_VARIABLES_END(CullProps, b0)
+
+StructuredBuffer<TransformData> _ObjectTransformDataArray;
+StructuredBuffer<GBufferInstance> GBufferInstances;
+StructuredBuffer<OcclusionParameters> Occlusion;
+// Hi-Z pyramid of the previous frame, farthest depth per texel
+Texture2D<float> HiZPyramid;
+RWStructuredBuffer<DrawIndexedCommand> DrawCommands;
+// one count per pipeline
+RWStructuredBuffer<uint> DrawCounts;
+// one flag per entity, predicates the forward draws
+RWStructuredBuffer<uint> Visibility;
+
+// Tests the bounding sphere against last frame's depth, anything that can't be projected safely counts as visible
+bool IsOccluded(float3 center, float radius)
+{
+    OcclusionParameters occlusion = Occlusion[0];
+
+    if (occlusion.enabled == 0)
+        return false;
+
+    float2 minNDC = 1.0f;
+    float2 maxNDC = -1.0f;
+    float nearestDepth = 1.0f;
+
+    [unroll]
+    for (uint i = 0; i < 8; i++)
+    {
+        float3 corner = center + radius * float3((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : -1.0f);
+        float4 clip = mul(float4(corner, 1.0f), occlusion.viewProjection);
+
+        // the bounds cross the camera plane
+        if (clip.w <= 0.0f)
+            return false;
+
+        float3 ndc = clip.xyz / clip.w;
+        minNDC = min(minNDC, ndc.xy);
+        maxNDC = max(maxNDC, ndc.xy);
+        nearestDepth = min(nearestDepth, ndc.z);
+    }
+
+    // the view projection is not Y flipped like the one the pyramid was rendered with, NDC y points up and texel rows go down
+    float2 minUV = saturate(float2(0.5f + 0.5f * minNDC.x, 0.5f - 0.5f * maxNDC.y));
+    float2 maxUV = saturate(float2(0.5f + 0.5f * maxNDC.x, 0.5f - 0.5f * minNDC.y));
+
+    // the level where the rectangle spans at most 2x2 texels
+    float2 extent = (maxUV - minUV) * float2(occlusion.pyramidSize);
+    uint mip = min((uint)ceil(log2(max(max(extent.x, extent.y), 1.0f))), occlusion.mipCount - 1);
+    uint2 mipSize = max(occlusion.pyramidSize >> mip, 1);
+    uint2 minTexel = min(uint2(minUV * mipSize), mipSize - 1);
+    uint2 maxTexel = min(uint2(maxUV * mipSize), mipSize - 1);
+
+    float farthestDepth = max(max(HiZPyramid.Load(int3(minTexel, mip)), HiZPyramid.Load(int3(maxTexel.x, minTexel.y, mip))),
+        max(HiZPyramid.Load(int3(minTexel.x, maxTexel.y, mip)), HiZPyramid.Load(int3(maxTexel, mip))));
+
+    return nearestDepth > farthestDepth;
+}
+
+[numthreads(64, 1, 1)]
+void cs_main(uint3 DTid : SV_DispatchThreadID)
+{
+    if (DTid.x >= CullProps.instanceCount)
+        return;
+
+    GBufferInstance instance = GBufferInstances[DTid.x];
+    float4x4 modelMatrix = _ObjectTransformDataArray[instance.transformIndex].modelMatrix;
+
+    float3 center = mul(float4(instance.boundsCenter, 1.0f), modelMatrix).xyz;
+    float scale = max(length(modelMatrix[0].xyz), max(length(modelMatrix[1].xyz), length(modelMatrix[2].xyz)));
+    float radius = instance.boundsRadius * scale;
+
+    bool visible = true;
+
+    [unroll]
+    for (uint i = 0; i < 6; i++)
+    {
+        if (dot(CullProps.frustumPlanes[i].xyz, center) + CullProps.frustumPlanes[i].w < -radius)
+            visible = false;
+    }
+
+    if (visible && IsOccluded(center, radius))
+        visible = false;
+
+    Visibility[instance.transformIndex] = visible ? 1 : 0;
+
+    if (visible == false || instance.pipelineIndex == NO_DRAW_PIPELINE)
+        return;
+
+    uint slot;
+    InterlockedAdd(DrawCounts[instance.pipelineIndex], 1, slot);
+
+    DrawIndexedCommand command;
+    command.indexCount = instance.indexCount;
+    command.instanceCount = 1;
+    command.firstIndex = instance.firstIndex;
+    command.vertexOffset = instance.vertexOffset;
+    command.firstInstance = instance.transformIndex;
+    DrawCommands[instance.drawOffset + slot] = command;
+}
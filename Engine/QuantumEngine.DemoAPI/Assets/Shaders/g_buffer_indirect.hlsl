@@ -0,0 +1,46 @@
+#include "Common/TransformStructs.hlsli"
+#include "Common/VertexStructs.hlsli"
+#include "Common/GBufferFunctions.hlsli"
+
+struct VS_INPUT
+{
+    float3 pos : POSITION;
+    float2 texCoord : TEXCOORD;
+    float3 norm : NORMAL;
+    uint instanceID : SV_InstanceID;
+};
+
+struct VS_OUTPUT
+{
+    float4 pos : SV_POSITION;
+    float3 normal : NORMAL;
+};
+
+// positions are rebuilt from the depth buffer, see Common/GBufferFunctions.hlsli
+struct PSOutput
+{
+    uint2 normalMask : SV_Target0;
+};
+
+// Transforms of all entities, the culling pass sets the first instance of every draw to the entity index
+StructuredBuffer<TransformData> _ObjectTransformDataArray;
+
+CAMERA_VAR(b1)
+
+VS_OUTPUT vs_main(VS_INPUT vertexIn)
+{
+    TransformData transform = _ObjectTransformDataArray[vertexIn.instanceID];
+
+    VS_OUTPUT vsOut;
+    vsOut.pos = mul(float4(vertexIn.pos, 1.0f), mul(transform.modelViewMatrix, cameraData.projectionMatrix));
+    vsOut.normal = mul(float4(DecodeVertexNormal(vertexIn.norm), 1.0f), transform.rotationMatrix).xyz;
+    return vsOut;
+}
+
+PSOutput ps_main(VS_OUTPUT input)
+{
+    PSOutput psOut;
+    psOut.normalMask = PackGBufferNormal(input.normal, 1);
+
+    return psOut;
+}
@@ -1,4 +1,5 @@
 #include "Common/TransformStructs.hlsli"
+#include "Common/VertexStructs.hlsli"
 
 struct VS_INPUT
 {
@@ -29,7 +30,7 @@ VS_OUTPUT vs_main(VS_INPUT vertexIn)
 {
     VS_OUTPUT vsOut;
     vsOut.pos = mul(float4(vertexIn.pos, 1.0f), mul(transformData.modelViewMatrix, cameraData.projectionMatrix));
-    vsOut.normal = mul(float4(vertexIn.norm, 1.0f), transformData.rotationMatrix).xyz;
+    vsOut.normal = mul(float4(DecodeVertexNormal(vertexIn.norm), 1.0f), transformData.rotationMatrix).xyz;
     vsOut.worldPos = mul(float4(vertexIn.pos, 1.0f), transformData.modelMatrix).xyz;
     return vsOut;
 }
@@ -1,5 +1,6 @@
 #include "Common/TransformStructs.hlsli"
 #include "Common/RTStructs.hlsli"
+#include "Common/GBufferFunctions.hlsli"
 
 CAMERA_VAR(b0)
 
@@ -13,11 +14,17 @@ RT_SCENE_VAR(t0)
 
 RT_OUT_TEXTURE_VAR(u0)
 
-TEXTURE(_MaskTexture, uint, t1)
+#ifdef GBUFFER_COMPACT
+INTERNAL_TEXTURE(_NormalTexture, uint2, t1)
 
-TEXTURE(_PositionTexture, float4, t2)
+INTERNAL_TEXTURE(_DepthTexture, float, t2)
+#else
+INTERNAL_TEXTURE(_MaskTexture, uint, t1)
 
-TEXTURE(_NormalTexture, float4, t3)
+INTERNAL_TEXTURE(_PositionTexture, float4, t2)
+
+INTERNAL_TEXTURE(_NormalTexture, float4, t3)
+#endif
 
 SAMPLER(mainSampler, s0)
 
@@ -27,7 +34,12 @@ void rayGen()
     uint3 launchIndex = DispatchRaysIndex();
     uint3 launchDim = DispatchRaysDimensions();
     float2 uv = float2(launchIndex.xy) / float2(launchDim.xy);
+#ifdef GBUFFER_COMPACT
+    uint2 normalMask = _NormalTexture.Load(int3(launchIndex.xy, 0));
+    uint mask = UnpackGBufferMask(normalMask);
+#else
     uint mask = _MaskTexture.Load(int3(launchIndex.xy, 0));
+#endif
     
     if (mask == 0)
     {
@@ -35,8 +47,14 @@ void rayGen()
         return;
     }
     
+#ifdef GBUFFER_COMPACT
+    float2 pixelCenter = (float2(launchIndex.xy) + 0.5f) / float2(launchDim.xy);
+    float3 pos = ReconstructWorldPosition(pixelCenter, _DepthTexture.Load(int3(launchIndex.xy, 0)), cameraData.inverseProjectionMatrix);
+    float3 norm = UnpackGBufferNormal(normalMask);
+#else
     float3 pos = _PositionTexture.SampleLevel(mainSampler, uv, 0).xyz;
     float3 norm = 2 * _NormalTexture.SampleLevel(mainSampler, uv, 0).xyz - 1;
+#endif
     
     RayDesc ray;
     ray.Origin = pos;
@@ -0,0 +1,171 @@
+#include "Common/VariableMacros.hlsli"
+
+// Matches HIZ_MAX_MIP_COUNT and HIZ_TILE_SIZE in VulkanGBufferPipelineModule.h
+#define HIZ_MAX_MIP_COUNT 13
+#define HIZ_TILE_SIZE 64
+
+CONSTANT_VARIABLES_BEGIN
+    uint2 depthSize;
+    // size of level 0, the largest power of two not above the depth size
+    uint2 pyramidSize;
+    uint mipCount;
+    uint tileCountX;
+    uint tileCount;
+CONSTANT_VARIABLES_END(HiZProps, b0)
+
+Texture2D<float> DepthTexture;
+// unused levels are bound to the last mip
+globallycoherent RWTexture2D<float> HiZMips[HIZ_MAX_MIP_COUNT];
+// finished tiles, cleared before every build
+globallycoherent RWStructuredBuffer<uint> HiZCounter;
+
+groupshared float s_depth[16][16];
+groupshared uint s_isLastGroup;
+
+// Farthest depth under a level 0 texel, the depth buffer is less than twice the pyramid size so a texel covers at most 3x3 pixels
+float LoadDepthFootprint(uint2 texel)
+{
+    uint2 begin = min(texel * HiZProps.depthSize / HiZProps.pyramidSize, HiZProps.depthSize - 1);
+    uint2 end = clamp(((texel + 1) * HiZProps.depthSize + HiZProps.pyramidSize - 1) / HiZProps.pyramidSize, begin + 1, HiZProps.depthSize);
+    float depth = 0.0f;
+
+    [unroll]
+    for (uint y = 0; y < 3; y++)
+    {
+        [unroll]
+        for (uint x = 0; x < 3; x++)
+            depth = max(depth, DepthTexture.Load(int3(min(begin + uint2(x, y), end - 1), 0)));
+    }
+
+    return depth;
+}
+
+uint2 MipSize(uint mip)
+{
+    return max(HiZProps.pyramidSize >> mip, 1);
+}
+
+void StoreMip(uint mip, uint2 texel, float depth)
+{
+    if (mip < HiZProps.mipCount && all(texel < MipSize(mip)))
+        HiZMips[mip][texel] = depth;
+}
+
+float LoadMip(uint mip, uint2 texel)
+{
+    return HiZMips[mip][min(texel, MipSize(mip) - 1)];
+}
+
+// Reduces the 16x16 values in s_depth, which are level firstMip at origin, into the next four levels
+void ReduceGroup(uint2 threadID, uint2 origin, uint firstMip)
+{
+    [unroll]
+    for (uint step = 1; step <= 4; step++)
+    {
+        uint size = 16 >> step;
+        bool active = all(threadID < size);
+        float depth = 0.0f;
+
+        if (active)
+        {
+            uint2 source = threadID * 2;
+            depth = max(max(s_depth[source.y][source.x], s_depth[source.y][source.x + 1]),
+                max(s_depth[source.y + 1][source.x], s_depth[source.y + 1][source.x + 1]));
+            StoreMip(firstMip + step, (origin >> step) + threadID, depth);
+        }
+
+        GroupMemoryBarrierWithGroupSync();
+
+        if (active)
+            s_depth[threadID.y][threadID.x] = depth;
+
+        GroupMemoryBarrierWithGroupSync();
+    }
+}
+
+// Every group builds levels 0 to 6 of one 64x64 tile, the last group to finish reduces level 6 into the remaining levels
+[numthreads(16, 16, 1)]
+void cs_main(uint3 groupID : SV_GroupID, uint3 threadID : SV_GroupThreadID)
+{
+    uint2 tile = uint2(groupID.x % HiZProps.tileCountX, groupID.x / HiZProps.tileCountX);
+    uint2 base = tile * HIZ_TILE_SIZE + threadID.xy * 4;
+    float level2 = 0.0f;
+
+    // every thread covers 4x4 texels of level 0
+    [unroll]
+    for (uint j = 0; j < 2; j++)
+    {
+        [unroll]
+        for (uint i = 0; i < 2; i++)
+        {
+            float level1 = 0.0f;
+
+            [unroll]
+            for (uint y = 0; y < 2; y++)
+            {
+                [unroll]
+                for (uint x = 0; x < 2; x++)
+                {
+                    uint2 texel = base + uint2(i * 2 + x, j * 2 + y);
+                    float depth = LoadDepthFootprint(texel);
+                    StoreMip(0, texel, depth);
+                    level1 = max(level1, depth);
+                }
+            }
+
+            StoreMip(1, (base >> 1) + uint2(i, j), level1);
+            level2 = max(level2, level1);
+        }
+    }
+
+    StoreMip(2, base >> 2, level2);
+    s_depth[threadID.y][threadID.x] = level2;
+    GroupMemoryBarrierWithGroupSync();
+
+    ReduceGroup(threadID.xy, tile * 16, 2);
+
+    if (all(threadID.xy == 0))
+    {
+        // level 6 of the tile has to be visible to the last group before it is counted
+        DeviceMemoryBarrier();
+        uint finishedTiles;
+        InterlockedAdd(HiZCounter[0], 1, finishedTiles);
+        s_isLastGroup = finishedTiles == HiZProps.tileCount - 1 ? 1 : 0;
+    }
+
+    GroupMemoryBarrierWithGroupSync();
+
+    if (s_isLastGroup == 0 || HiZProps.mipCount <= 7)
+        return;
+
+    // level 6 is at most 64x64 texels, reduced the same way as a tile of level 0
+    base = threadID.xy * 4;
+    float level8 = 0.0f;
+
+    [unroll]
+    for (uint j2 = 0; j2 < 2; j2++)
+    {
+        [unroll]
+        for (uint i2 = 0; i2 < 2; i2++)
+        {
+            float level7 = 0.0f;
+
+            [unroll]
+            for (uint y = 0; y < 2; y++)
+            {
+                [unroll]
+                for (uint x = 0; x < 2; x++)
+                    level7 = max(level7, LoadMip(6, base + uint2(i2 * 2 + x, j2 * 2 + y)));
+            }
+
+            StoreMip(7, (base >> 1) + uint2(i2, j2), level7);
+            level8 = max(level8, level7);
+        }
+    }
+
+    StoreMip(8, base >> 2, level8);
+    s_depth[threadID.y][threadID.x] = level8;
+    GroupMemoryBarrierWithGroupSync();
+
+    ReduceGroup(threadID.xy, uint2(0, 0), 8);
+}
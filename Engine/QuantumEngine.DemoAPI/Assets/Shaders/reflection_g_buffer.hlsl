@@ -1,5 +1,6 @@
 #include "Common/TransformStructs.hlsli"
 #include "Common/LightStructs.hlsli"
+#include "Common/GBufferFunctions.hlsli"
 
 struct VS_INPUT
 {
@@ -19,13 +20,14 @@ OBJECT_TRANSFORM_VAR(b0)
 
 CAMERA_VAR(b1)
 
-LIGHT_VAR(b2)
+LIGHT_VAR(t4)
 
 CONSTANT_VARIABLES_BEGIN
     float reflectivity;
     float ambient;
     float diffuse;
     float specular;
+    TEXTURE_INDEX(mainTexture)
 CONSTANT_VARIABLES_END(constantVars, b3)
 
 #define reflectivity constantVars.reflectivity
@@ -33,11 +35,15 @@ CONSTANT_VARIABLES_END(constantVars, b3)
 #define diffuse constantVars.diffuse
 #define specular constantVars.specular
 
-TEXTURE(_OutputTexture, float4, t0)
+INTERNAL_TEXTURE(_OutputTexture, float4, t0)
 
-TEXTURE(_PositionTexture, float4, t1)
+#ifdef GBUFFER_COMPACT
+INTERNAL_TEXTURE(_NormalTexture, uint2, t2)
+#else
+INTERNAL_TEXTURE(_PositionTexture, float4, t1)
 
-TEXTURE(_NormalTexture, float4, t2)
+INTERNAL_TEXTURE(_NormalTexture, float4, t2)
+#endif
 
 TEXTURE(mainTexture, float4, t3)
 
@@ -59,8 +65,16 @@ float4 ps_main(VS_OUTPUT input) : SV_TARGET
     float2 ndc = input.pos.xy / float2(1280, 720);
     
     float2 uv = float2(ndc.x, ndc.y);
+#ifdef GBUFFER_COMPACT
+    // this pass draws the G-buffer surfaces again, so the fragment depth is the G-buffer depth
+    float2 gBufferSize;
+    _NormalTexture.GetDimensions(gBufferSize.x, gBufferSize.y);
+    float3 pos = ReconstructWorldPosition(input.pos.xy / gBufferSize, input.pos.z, cameraData.inverseProjectionMatrix);
+    float3 norm = UnpackGBufferNormal(_NormalTexture.Load(int3(input.pos.xy, 0)));
+#else
     float3 pos = _PositionTexture.SampleLevel(mainSampler, uv, 0).xyz;
     float3 norm = 2 * _NormalTexture.SampleLevel(mainSampler, uv, 0).xyz - 1;
+#endif
     float4 reflectionData = _OutputTexture.Sample(mainSampler, uv, 0);
     
     float3 ads = float3(ambient, diffuse, specular);
@@ -6,7 +6,7 @@ OBJECT_TRANSFORM_VAR(b0)
 
 CAMERA_VAR(b1)
 
-LIGHT_VAR(b2)
+LIGHT_VAR(t4)
 
 CONSTANT_VARIABLES_BEGIN
     uint castShadow;
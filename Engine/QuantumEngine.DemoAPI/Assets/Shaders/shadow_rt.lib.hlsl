@@ -20,7 +20,7 @@ OBJECT_TRANSFORM_VAR(b1)
 
 CAMERA_VAR(b2)
 
-LIGHT_VAR(b3)
+LIGHT_VAR(t4)
 
 RT_SCENE_VAR(t0);
 
@@ -32,6 +32,29 @@ TEXTURE(mainTexture, float4, t3)
 
 SAMPLER(mainSampler, s0)
 
+// shadow rays traced per hit for the point lights, lights past the budget are sampled by power
+#define MAX_SHADOW_LIGHT_SAMPLES 4
+
+// diffuse and specular of a point light if it isn't shadowed, the ambient of all point lights is added once per hit
+inline float3 ShadePointLight(PointLight light, float3 position, float3 normal, float3 ads, inout GeneralPayload innerPayload)
+{
+    float d = distance(light.position, position);
+    if (d > light.radius)
+        return float3(0.0f, 0.0f, 0.0f);
+    
+    RayDesc ray;
+    ray.Origin = position;
+    ray.Direction = normalize(light.position - ray.Origin);
+    ray.TMin = 0.1;
+    ray.TMax = min(light.radius, d);
+    TraceRay(_RTScene, 0 /*rayFlags*/, 0xFF, 0 /* ray index*/, 0, _missIndex, ray, innerPayload);
+
+    if (innerPayload.hit > 0)
+        return float3(0.0f, 0.0f, 0.0f);
+    
+    return PhongPointLightDirect(light, cameraData.position, position, normal, ads);
+}
+
 [shader("closesthit")]
 void chs(inout GeneralPayload payload, in BuiltInTriangleIntersectionAttributes attribs)
 {
@@ -55,9 +78,11 @@ void chs(inout GeneralPayload payload, in BuiltInTriangleIntersectionAttributes
     float3 lightColor = float3(0.0f, 0.0f, 0.0f);
     float3 ads = float3(ambient, diffuse, specular);
     
-    for (uint i = 0; i < lightData.directionalLightCount; i++)
+    LightBufferHeader lightHeader = LoadLightHeader(lightData);
+    
+    for (uint i = 0; i < lightHeader.directionalLightCount; i++)
     {
-        DirectionalLight light = lightData.directionalLights[i];
+        DirectionalLight light = LoadDirectionalLight(lightData, lightHeader, i);
         
         RayDesc ray;
         ray.Origin = position;
@@ -72,28 +97,70 @@ void chs(inout GeneralPayload payload, in BuiltInTriangleIntersectionAttributes
             lightColor += PhongDirectionalLight(light, cameraData.position, position, normal, ads);
     }
     
-    for (uint i = 0; i < lightData.pointLightCount; i++)
+    // every point light adds ambient, shadow rays are only traced for the ones reaching the cluster of the hit
+    lightColor += ambient * lightHeader.pointLightAmbient;
+    LightCluster cluster = FindLightCluster(lightData, lightHeader, position);
+    
+    if (cluster.count <= MAX_SHADOW_LIGHT_SAMPLES)
     {
-        PointLight light = lightData.pointLights[i];
-        
-        float d = distance(light.position, position);
-        if (d > light.radius)
+        for (uint i = 0; i < cluster.count; i++)
         {
-            lightColor += ambient * light.color.xyz;
-            continue;
+            PointLight light = LoadPointLight(lightData, lightHeader, GetClusterLightIndex(lightData, lightHeader, cluster, i));
+            lightColor += ShadePointLight(light, position, normal, ads, innerPayload);
         }
+    }
+    else
+    {
+        // too many lights to trace them all, the direct light is estimated from a bounded number of power weighted samples.
+        // ShadePointLight returns no ambient, so the sample weights never scale the ambient added above
+        uint randomState = CreateRandomSeed(payload.recursionCount);
         
-        RayDesc ray;
-        ray.Origin = position;
-        ray.Direction = normalize(light.position - ray.Origin);
-        ray.TMin = 0.1;
-        ray.TMax = min(lightData.pointLights[i].radius, d);
-        TraceRay(_RTScene, 0 /*rayFlags*/, 0xFF, 0 /* ray index*/, 0, _missIndex, ray, innerPayload);
-
-        if (innerPayload.hit > 0)
-            lightColor += ambient * light.color.xyz;
+        if (cluster.offset == ALL_LIGHTS_CLUSTER)
+        {
+            for (uint s = 0; s < MAX_SHADOW_LIGHT_SAMPLES; s++)
+            {
+                float pdf;
+                uint lightIndex = SamplePointLight(lightData, lightHeader, NextRandom(randomState), pdf);
+                
+                if (pdf > 0.0f)
+                    lightColor += ShadePointLight(LoadPointLight(lightData, lightHeader, lightIndex), position, normal, ads, innerPayload) / (MAX_SHADOW_LIGHT_SAMPLES * pdf);
+            }
+        }
         else
-            lightColor += PhongPointLight(light, cameraData.position, position, normal, ads);
+        {
+            // the alias table covers every light, cluster lists are sampled with one reservoir per sample instead
+            uint selectedLights[MAX_SHADOW_LIGHT_SAMPLES];
+            float selectedPowers[MAX_SHADOW_LIGHT_SAMPLES];
+            float powerSum = 0.0f;
+            
+            for (uint i = 0; i < cluster.count; i++)
+            {
+                uint lightIndex = GetClusterLightIndex(lightData, lightHeader, cluster, i);
+                PointLight light = LoadPointLight(lightData, lightHeader, lightIndex);
+                float power = PointLightPower(light);
+                
+                // no direct light to sample, no ray needed
+                if (power <= 0.0f)
+                    continue;
+                
+                powerSum += power;
+                
+                for (uint s = 0; s < MAX_SHADOW_LIGHT_SAMPLES; s++)
+                {
+                    if (NextRandom(randomState) * powerSum < power)
+                    {
+                        selectedLights[s] = lightIndex;
+                        selectedPowers[s] = power;
+                    }
+                }
+            }
+            
+            for (uint s = 0; s < MAX_SHADOW_LIGHT_SAMPLES && powerSum > 0.0f; s++)
+            {
+                PointLight light = LoadPointLight(lightData, lightHeader, selectedLights[s]);
+                lightColor += ShadePointLight(light, position, normal, ads, innerPayload) * powerSum / (MAX_SHADOW_LIGHT_SAMPLES * selectedPowers[s]);
+            }
+        }
     }
     
     payload.color = lightColor * (texColor.xyz);
@@ -1,4 +1,5 @@
 #include "Common/TransformStructs.hlsli"
+#include "Common/VertexStructs.hlsli"
 #include "Common/LightStructs.hlsli"
 
 struct VS_INPUT
@@ -20,13 +21,14 @@ OBJECT_TRANSFORM_VAR(b0)
 
 CAMERA_VAR(b1) 
 
-LIGHT_VAR(b2)
+LIGHT_VAR(t1)
 
 CONSTANT_VARIABLES_BEGIN
     float ambient;
     float diffuse;
     float specular;
     float textureFactor;
+    TEXTURE_INDEX(mainTexture)
 CONSTANT_VARIABLES_END(constantVars, b3)
 
 #define ambient constantVars.ambient
@@ -42,7 +44,7 @@ VS_OUTPUT vs_main(VS_INPUT vertexIn)
     VS_OUTPUT vsOut;
     vsOut.pos = mul(float4(vertexIn.pos, 1.0f), mul(transformData.modelViewMatrix, cameraData.projectionMatrix));
     vsOut.texCoord = vertexIn.texCoord;
-    vsOut.norm = mul(float4(vertexIn.norm, 1.0f), transformData.rotationMatrix).xyz;
+    vsOut.norm = mul(float4(DecodeVertexNormal(vertexIn.norm), 1.0f), transformData.rotationMatrix).xyz;
     vsOut.worldPos = mul(float4(vertexIn.pos, 1.0f), transformData.modelMatrix).xyz;
     return vsOut;
 }
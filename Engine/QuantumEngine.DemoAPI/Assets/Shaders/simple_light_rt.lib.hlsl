@@ -19,7 +19,7 @@ OBJECT_TRANSFORM_VAR(b1)
 
 CAMERA_VAR(b2)
 
-LIGHT_VAR(b3)
+LIGHT_VAR(t3)
 
 TEXTURE(mainTexture, float4, t0)
 
@@ -2,7 +2,7 @@
 #include "Platform/CommonWin.h"
 
 CurveModifier::CurveModifier(const ref<Rendering::SplineRenderer>& spline, float speed)
-	:m_spline(spline), m_currentPoint(spline->GetCurve().m_point1), m_speedSign(speed)
+	:m_spline(spline), m_currentPoint(spline->GetCurve().GetControlPoint(0)), m_speedSign(speed)
 {
 }
 
@@ -10,13 +10,13 @@ void CurveModifier::Update(Float deltaTime)
 {
 	if (GetKeyState('Q') & 0x80) {
 		m_currentPoint += Vector3(deltaTime * m_speedSign, 0.0f, 0.0f);
-		m_spline->GetCurve().m_point1 = m_currentPoint;
+		m_spline->GetCurve().SetControlPoint(0, m_currentPoint);
 		m_spline->SetDirty();
 	}
 
 	if (GetKeyState('E') & 0x80) {
 		m_currentPoint -= Vector3(deltaTime * m_speedSign, 0.0f, 0.0f);
-		m_spline->GetCurve().m_point1 = m_currentPoint;
+		m_spline->GetCurve().SetControlPoint(0, m_currentPoint);
 		m_spline->SetDirty();
 	}
 }
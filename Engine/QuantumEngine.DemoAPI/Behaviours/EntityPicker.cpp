@@ -0,0 +1,49 @@
+#include "EntityPicker.h"
+#include "Platform/CommonWin.h"
+#include "Core/Transform.h"
+#include <limits>
+#include <string>
+
+EntityPicker::EntityPicker(ref<Camera>& camera, const std::vector<ref<GameEntity>>& entities, const ref<Platform::GraphicWindow>& window)
+	:m_camera(camera), m_window(window), m_wasButtonDown(false)
+{
+	m_bvh.Build(entities);
+}
+
+void EntityPicker::Update(Float deltaTime)
+{
+	// TODO Replace it with event-based input system
+	bool isButtonDown = (GetKeyState(VK_LBUTTON) & 0x80) != 0;
+	bool isClicked = isButtonDown && m_wasButtonDown == false;
+	m_wasButtonDown = isButtonDown;
+
+	if (isClicked == false)
+		return;
+
+	POINT mousePos;
+	GetCursorPos(&mousePos);
+	ScreenToClient(m_window->GetHandle(), &mousePos);
+
+	if (mousePos.x < 0 || mousePos.y < 0 || mousePos.x >= m_window->GetWidth() || mousePos.y >= m_window->GetHeight())
+		return;
+
+	// moved entities are only reinserted once they leave their grown leaf bounds
+	m_bvh.Update();
+
+	// the projection only scales view space x and y, so the ray through the pixel is rebuilt from the camera axes
+	Float ndcX = 2.0f * (mousePos.x + 0.5f) / m_window->GetWidth() - 1.0f;
+	Float ndcY = 1.0f - 2.0f * (mousePos.y + 0.5f) / m_window->GetHeight();
+	Matrix4 projection = m_camera->ProjectionMatrix();
+	auto transform = m_camera->GetTransform();
+	Vector3 direction = transform->Forward() + (ndcX / projection(0, 0)) * transform->Right() + (ndcY / projection(1, 1)) * transform->Up();
+
+	SceneRayHit hit;
+
+	if (m_bvh.Raycast(transform->Position(), direction.Normalize(), std::numeric_limits<Float>::max(), hit) == false) {
+		m_pickedEntity = nullptr;
+		return;
+	}
+
+	m_pickedEntity = m_bvh.GetEntity(hit.entityIndex);
+	OutputDebugStringA(("Picked entity " + std::to_string(hit.entityIndex) + " at " + m_pickedEntity->GetTransform()->Position().ToString() + "\n").c_str());
+}
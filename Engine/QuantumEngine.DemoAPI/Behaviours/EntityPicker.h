@@ -0,0 +1,27 @@
+#pragma once
+#include "Core/Behaviour.h"
+#include <Core/Camera/Camera.h>
+#include <Core/GameEntity.h>
+#include <Core/SceneBVH.h>
+#include <Platform/GraphicWindow.h>
+#include <vector>
+
+using namespace QuantumEngine;
+
+/// <summary>
+/// Picks the entity under the cursor on a left click with a ray query on a SceneBVH of the pickable entities
+/// </summary>
+class EntityPicker : public QuantumEngine::Behaviour
+{
+public:
+	EntityPicker(ref<Camera>& camera, const std::vector<ref<GameEntity>>& entities, const ref<Platform::GraphicWindow>& window);
+	virtual void Update(Float deltaTime) override;
+
+	inline ref<GameEntity> GetPickedEntity() const { return m_pickedEntity; }
+private:
+	ref<Camera> m_camera;
+	ref<Platform::GraphicWindow> m_window;
+	SceneBVH m_bvh;
+	ref<GameEntity> m_pickedEntity;
+	bool m_wasButtonDown;
+};
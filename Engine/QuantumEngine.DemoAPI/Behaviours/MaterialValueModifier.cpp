@@ -2,8 +2,8 @@
 #include "Platform/CommonWin.h"
 
 MaterialValueModifier::MaterialValueModifier(ref<Rendering::Material>& material, const std::string& fieldName, Float speed, Float minValue, Float maxValue)
-	:m_material(material), m_fieldName(fieldName), m_speed(speed), m_minValue(minValue), m_maxValue(maxValue),
-	m_currentValue(material->GetValue(fieldName, 0.0f))
+	:m_material(material), m_field(material->FindField<Float>(fieldName)), m_speed(speed), m_minValue(minValue), m_maxValue(maxValue),
+	m_currentValue(material->GetValue(m_field, 0.0f))
 {
 }
 
@@ -15,7 +15,7 @@ void MaterialValueModifier::Update(Float deltaTime)
 		if (m_currentValue > m_maxValue)
 			m_currentValue = m_maxValue;
 
-		m_material->SetValue(m_fieldName, m_currentValue);
+		m_material->SetValue(m_field, m_currentValue);
 	}
 
 	if (GetKeyState(VK_OEM_MINUS) & 0x80) {
@@ -24,6 +24,6 @@ void MaterialValueModifier::Update(Float deltaTime)
 		if (m_currentValue < m_minValue)
 			m_currentValue = m_minValue;
 
-		m_material->SetValue(m_fieldName, m_currentValue);
+		m_material->SetValue(m_field, m_currentValue);
 	}
 }
@@ -12,7 +12,7 @@ public:
 	virtual void Update(Float deltaTime) override;
 private:
 	ref<Rendering::Material> m_material;
-	std::string m_fieldName;
+	Rendering::MaterialFieldHandle<Float> m_field;
 	Float m_currentValue;
 	Float m_speed;
 	Float m_minValue;
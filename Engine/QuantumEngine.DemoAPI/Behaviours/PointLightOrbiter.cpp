@@ -0,0 +1,15 @@
+#include "PointLightOrbiter.h"
+#include <cmath>
+
+PointLightOrbiter::PointLightOrbiter(ref<SceneLightData>& lights, UInt32 lightIndex, const Vector3& center, Float radius, Float speed)
+	:m_lights(lights), m_lightIndex(lightIndex), m_center(center), m_radius(radius), m_speed(speed), m_currentAngle(0)
+{
+}
+
+void PointLightOrbiter::Update(Float deltaTime)
+{
+	m_currentAngle += m_speed * deltaTime;
+
+	// only the moved light is uploaded to the light buffer next frame
+	m_lights->SetPointLightPosition(m_lightIndex, m_center + Vector3(m_radius * std::cos(m_currentAngle), 0.0f, m_radius * std::sin(m_currentAngle)));
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include "Core/Behaviour.h"
+#include <Core/Light/Lights.h>
+#include <Core/Vector3.h>
+
+using namespace QuantumEngine;
+
+class PointLightOrbiter : public QuantumEngine::Behaviour
+{
+public:
+	PointLightOrbiter(ref<SceneLightData>& lights, UInt32 lightIndex, const Vector3& center, Float radius, Float speed);
+	virtual void Update(Float deltaTime) override;
+private:
+	ref<SceneLightData> m_lights;
+	UInt32 m_lightIndex;
+	Vector3 m_center;
+	Float m_radius;
+	Float m_speed;
+	Float m_currentAngle;
+};
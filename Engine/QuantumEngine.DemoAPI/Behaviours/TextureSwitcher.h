@@ -14,7 +14,7 @@ public:
 	virtual void Update(Float deltaTime) override;
 private:
 	ref<Rendering::Material> m_material;
-	std::string m_fieldName;
+	Rendering::MaterialTextureHandle m_field;
 	std::vector<ref<Texture2D>> m_textures;
 	int m_index = 0;
 	bool m_keyPressed = false;
@@ -6,6 +6,11 @@
 #include <Rendering/GraphicContext.h>
 #include "SceneBuilder.h"
 #include <Core/Scene.h>
+#include <Core/Mesh.h>
+#include <Core/ShapeBuilder.h>
+#include <Core/MeshletBuilder.h>
+#include <chrono>
+#include <sstream>
 
 namespace OS = QuantumEngine::Platform; 
 namespace DX12 = QuantumEngine::Rendering::DX12;
@@ -270,3 +275,36 @@ bool Run_Complete_Scene(HWND parentWindow, Graphics_API graphicApi)
 
 	return true;
 }
+
+bool Run_Meshlet_Benchmark(HWND parentWindow)
+{
+	const UInt32 segmentCounts[] = { 128, 256, 512, 1024 };
+	const UInt32 runCount = 5;
+	std::stringstream report;
+	report << "Meshlet generation (" << QuantumEngine::MeshletBuilder::DefaultMaxVertices << " vertices / "
+		<< QuantumEngine::MeshletBuilder::DefaultMaxTriangles << " triangles)\n\n";
+
+	for (UInt32 segments : segmentCounts) {
+		auto mesh = QuantumEngine::ShapeBuilder::CreateSphere(1.0f, segments, segments);
+		UInt32 triangleCount = mesh->GetIndexCount() / 3;
+		double bestSeconds = 0.0;
+		ref<QuantumEngine::MeshletData> meshletData;
+
+		// best of several runs to hide thread start up and cache warm up
+		for (UInt32 run = 0; run < runCount; run++) {
+			auto start = std::chrono::high_resolution_clock::now();
+			meshletData = QuantumEngine::MeshletBuilder::Build(mesh);
+			double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+			if (run == 0 || seconds < bestSeconds)
+				bestSeconds = seconds;
+		}
+
+		report << triangleCount << " triangles -> " << meshletData->meshlets.size() << " meshlets, "
+			<< (UInt32)(triangleCount / bestSeconds / 1000.0) << "K triangles/s\n";
+	}
+
+	MessageBoxA(parentWindow, report.str().c_str(), "Meshlet Benchmark", 0);
+
+	return true;
+}
\ No newline at end of file
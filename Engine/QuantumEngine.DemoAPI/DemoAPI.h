@@ -21,4 +21,6 @@ DEMO_API bool Run_Shadow_Scene(HWND parentWindow, Graphics_API graphicApi);
 
 DEMO_API bool Run_Refraction_Scene(HWND parentWindow, Graphics_API graphicApi);
 
-DEMO_API bool Run_Complete_Scene(HWND parentWindow, Graphics_API graphicApi);
\ No newline at end of file
+DEMO_API bool Run_Complete_Scene(HWND parentWindow, Graphics_API graphicApi);
+
+DEMO_API bool Run_Meshlet_Benchmark(HWND parentWindow);
\ No newline at end of file
@@ -9,6 +9,7 @@
 #include <Rendering/GPUAssetManager.h>
 #include <Rendering/GraphicContext.h>
 #include <Rendering/MaterialFactory.h>
+#include <Rendering/MaterialInstance.h>
 
 #include <Rendering/MeshRenderer.h>
 #include <Rendering/GBufferRTReflectionRenderer.h>
@@ -18,6 +19,7 @@
 #include <Core/Light/Lights.h>
 #include <Core/WICTexture2DImporter.h>
 #include <Core/AssimpModel3DImporter.h>
+#include <Core/AsyncAssetLoader.h>
 #include <Core/Camera/PerspectiveCamera.h>
 #include <Core/Model3DAsset.h>
 #include <Core/GameEntity.h>
@@ -29,63 +31,90 @@
 #include "Behaviours/CameraController.h"
 #include "Behaviours/FrameRateLogger.h"
 #include "Behaviours/EntityMover.h"
+#include "Behaviours/EntityPicker.h"
 #include "Behaviours/EntityRotator.h"
 #include "Behaviours/EntityPositionController.h"
 #include "Behaviours/CurveModifier.h"
 #include "Behaviours/TextureSwitcher.h"
 #include "Behaviours/MaterialValueModifier.h"
+#include "Behaviours/PointLightOrbiter.h"
 
 using namespace QuantumEngine;
 
-#define IMPORT_RETRO_CAR_MESH(MESH_VAR, ERROR_VAR)   \
+// REQUEST_* starts the load on the asset loader, IMPORT_*_MESH reads the result once the loader is done
+#define REQUEST_RETRO_CAR_MODEL(LOADER_VAR)   \
     auto retroCarModelPath = root + L"\\Assets\\Models\\RetroCar.fbx";  \
-    auto retroCarModel = AssimpModel3DImporter::Import(WCharToString(retroCarModelPath.c_str()), ModelImportProperties{ .axis = Vector3(1.0f, 0.0f, 0.0f), .angleDeg = 90, .scale = Vector3(0.05f) }, ERROR_VAR);    \
+    auto retroCarModelLoad = LOADER_VAR.LoadModelAsync(WCharToString(retroCarModelPath.c_str()), ModelImportProperties{ .axis = Vector3(1.0f, 0.0f, 0.0f), .angleDeg = 90, .scale = Vector3(0.05f) });
+
+#define IMPORT_RETRO_CAR_MESH(MESH_VAR, ERROR_VAR)   \
+    auto retroCarModel = retroCarModelLoad.get().asset;    \
     if (retroCarModel == nullptr) { \
+        ERROR_VAR = retroCarModelLoad.get().error;   \
         error = "Error in Importing Model At: \n" + WStringToString(retroCarModelPath) + "Error: \n" + ERROR_VAR;   \
         return nullptr; \
     }   \
     auto MESH_VAR = retroCarModel->GetMesh("Cube.002");
 
-#define IMPORT_PICKUP_TRUCK_MESH(MESH_VAR, ERROR_VAR)   \
+#define REQUEST_PICKUP_TRUCK_MODEL(LOADER_VAR)   \
     auto pickupTruckModelPath = root + L"\\Assets\\Models\\PickupTruck.fbx";  \
-    auto pickupTruckModel = AssimpModel3DImporter::Import(WCharToString(pickupTruckModelPath.c_str()), ModelImportProperties{ .axis = Vector3(1.0f, 0.0f, 0.0f), .angleDeg = 0, .scale = Vector3(0.01f) }, ERROR_VAR);    \
+    auto pickupTruckModelLoad = LOADER_VAR.LoadModelAsync(WCharToString(pickupTruckModelPath.c_str()), ModelImportProperties{ .axis = Vector3(1.0f, 0.0f, 0.0f), .angleDeg = 0, .scale = Vector3(0.01f) });
+
+#define IMPORT_PICKUP_TRUCK_MESH(MESH_VAR, ERROR_VAR)   \
+    auto pickupTruckModel = pickupTruckModelLoad.get().asset;    \
     if (pickupTruckModel == nullptr) { \
+        ERROR_VAR = pickupTruckModelLoad.get().error;   \
         error = "Error in Importing Model At: \n" + WStringToString(pickupTruckModelPath) + "Error: \n" + ERROR_VAR;   \
         return nullptr; \
     }   \
     auto MESH_VAR = pickupTruckModel->GetMesh("Mesh.006");
 
-#define IMPORT_PEDESTAL_MESH(MESH_VAR, ERROR_VAR)   \
+#define REQUEST_PEDESTAL_MODEL(LOADER_VAR)   \
     auto pedestalModelPath = root + L"\\Assets\\Models\\tech_pedestal.fbx";  \
-    auto pedestalModel = AssimpModel3DImporter::Import(WCharToString(pedestalModelPath.c_str()), ModelImportProperties{ .axis = Vector3(1.0f, 0.0f, 0.0f), .angleDeg = 90, .scale = Vector3(0.1f) }, ERROR_VAR);    \
+    auto pedestalModelLoad = LOADER_VAR.LoadModelAsync(WCharToString(pedestalModelPath.c_str()), ModelImportProperties{ .axis = Vector3(1.0f, 0.0f, 0.0f), .angleDeg = 90, .scale = Vector3(0.1f) });
+
+#define IMPORT_PEDESTAL_MESH(MESH_VAR, ERROR_VAR)   \
+    auto pedestalModel = pedestalModelLoad.get().asset;    \
     if (pedestalModel == nullptr) { \
+        ERROR_VAR = pedestalModelLoad.get().error;   \
         error = "Error in Importing Model At: \n" + WStringToString(pedestalModelPath) + "Error: \n" + ERROR_VAR;   \
         return nullptr; \
     }   \
     auto MESH_VAR = pedestalModel->GetMesh("Circle.001");
 
-#define IMPORT_CONTAINER_MESH(MESH_VAR, ERROR_VAR)   \
+#define REQUEST_CONTAINER_MODEL(LOADER_VAR)   \
     auto containerModelPath = root + L"\\Assets\\Models\\Scifi_Container.fbx";  \
-    auto containerModel = AssimpModel3DImporter::Import(WCharToString(containerModelPath.c_str()), ModelImportProperties{ .axis = Vector3(1.0f, 0.0f, 0.0f), .angleDeg = 90, .scale = Vector3(1.0f) }, ERROR_VAR);    \
+    auto containerModelLoad = LOADER_VAR.LoadModelAsync(WCharToString(containerModelPath.c_str()), ModelImportProperties{ .axis = Vector3(1.0f, 0.0f, 0.0f), .angleDeg = 90, .scale = Vector3(1.0f) });
+
+#define IMPORT_CONTAINER_MESH(MESH_VAR, ERROR_VAR)   \
+    auto containerModel = containerModelLoad.get().asset;    \
     if (containerModel == nullptr) { \
+        ERROR_VAR = containerModelLoad.get().error;   \
         error = "Error in Importing Model At: \n" + WStringToString(containerModelPath) + "Error: \n" + ERROR_VAR;   \
         return nullptr; \
     }   \
     auto MESH_VAR = containerModel->GetMesh("Container Free");
 
-#define IMPORT_LION_STATUE_MESH(MESH_VAR, ERROR_VAR)   \
+#define REQUEST_LION_STATUE_MODEL(LOADER_VAR)   \
     auto lionStatueModelPath = root + L"\\Assets\\Models\\lion-lp.fbx";  \
-    auto lionStatueModel = AssimpModel3DImporter::Import(WCharToString(lionStatueModelPath.c_str()), ModelImportProperties{ .axis = Vector3(1.0f, 0.0f, 0.0f), .angleDeg = 0, .scale = Vector3(1.0f) }, ERROR_VAR);    \
+    auto lionStatueModelLoad = LOADER_VAR.LoadModelAsync(WCharToString(lionStatueModelPath.c_str()), ModelImportProperties{ .axis = Vector3(1.0f, 0.0f, 0.0f), .angleDeg = 0, .scale = Vector3(1.0f) });
+
+#define IMPORT_LION_STATUE_MESH(MESH_VAR, ERROR_VAR)   \
+    auto lionStatueModel = lionStatueModelLoad.get().asset;    \
     if (lionStatueModel == nullptr) { \
+        ERROR_VAR = lionStatueModelLoad.get().error;   \
         error = "Error in Importing Model At: \n" + WStringToString(lionStatueModelPath) + "Error: \n" + ERROR_VAR;   \
         return nullptr; \
     }   \
     auto MESH_VAR = lionStatueModel->GetMesh("Model.004");
 
-#define IMPORT_DRONE_MESH(MESH_VAR, ERROR_VAR)   \
+#define REQUEST_DRONE_MODEL(LOADER_VAR)   \
     auto droneModelPath = root + L"\\Assets\\Models\\304_Drone.fbx";  \
-    auto droneModel = AssimpModel3DImporter::Import(WCharToString(droneModelPath.c_str()), ModelImportProperties{ .axis = Vector3(1.0f, 0.0f, 0.0f), .angleDeg = 90, .scale = Vector3(0.2f) }, ERROR_VAR);    \
+    auto droneModelLoad = LOADER_VAR.LoadModelAsync(WCharToString(droneModelPath.c_str()), ModelImportProperties{ .axis = Vector3(1.0f, 0.0f, 0.0f), .angleDeg = 90, .scale = Vector3(0.2f) });
+
+#define IMPORT_DRONE_MESH(MESH_VAR, ERROR_VAR)   \
+    auto droneModel = droneModelLoad.get().asset;    \
     if (droneModel == nullptr) { \
+        ERROR_VAR = droneModelLoad.get().error;   \
         error = "Error in Importing Model At: \n" + WStringToString(droneModelPath) + "Error: \n" + ERROR_VAR;   \
         return nullptr; \
     }   \
@@ -138,31 +167,43 @@ ref<Scene> SceneBuilder::BuildSimpleLightScene(const ref<Render::GPUAssetManager
     ref<Camera> mainCamera = std::make_shared<PerspectiveCamera>(camtransform, 0.1f, 1000.0f, (float)win->GetWidth() / win->GetHeight(), 45);
     ref<CameraController> cameraController = std::make_shared<CameraController>(mainCamera);
 
-	////// Importing Textures
-
-    auto retroCarTex = QuantumEngine::WICTexture2DImporter::Import(root + L"\\Assets\\Textures\\RetroCarAlbedo.png", errorStr);
-    auto pickupTruckGreenTex = QuantumEngine::WICTexture2DImporter::Import(root + L"\\Assets\\Textures\\truck_color-green.jpg", errorStr);
-    auto pickupTruckRedTex = QuantumEngine::WICTexture2DImporter::Import(root + L"\\Assets\\Textures\\truck_color-red.jpg", errorStr);
-    auto pickupTruckSilverTex = QuantumEngine::WICTexture2DImporter::Import(root + L"\\Assets\\Textures\\truck_color-silver.jpg", errorStr);
-    auto pedestalTex = QuantumEngine::WICTexture2DImporter::Import(root + L"\\Assets\\Textures\\tech_pedestal_COL.png", errorStr);
-    auto containerTex = QuantumEngine::WICTexture2DImporter::Import(root + L"\\Assets\\Textures\\Sci-fi_Container_BaseColor.png", errorStr);
-    auto groundBrickTex1 = QuantumEngine::WICTexture2DImporter::Import(root + L"\\Assets\\Textures\\brickGround.png", errorStr);
-
-
-    auto rabbitStatueTex1 = QuantumEngine::WICTexture2DImporter::Import(root + L"\\Assets\\Textures\\Rabbit_basecolor.jpg", errorStr);
-    auto lionStatueTex1 = QuantumEngine::WICTexture2DImporter::Import(root + L"\\Assets\\Textures\\Lion_statue_raw_texture.jpg", errorStr);
-    
-    assetManager->UploadTextureToGPU(retroCarTex);
-    assetManager->UploadTextureToGPU(pickupTruckGreenTex);
-    assetManager->UploadTextureToGPU(pickupTruckRedTex);
-    assetManager->UploadTextureToGPU(pickupTruckSilverTex);
-    assetManager->UploadTextureToGPU(pedestalTex);
-    assetManager->UploadTextureToGPU(containerTex);
-    assetManager->UploadTextureToGPU(groundBrickTex1);
+	////// Loading Assets
+
+    // loaded textures and meshes are uploaded to the GPU by the loader inside WaitAll
+    AsyncAssetLoader assetLoader(assetManager);
+
+    auto retroCarTexLoad = assetLoader.LoadTextureAsync(root + L"\\Assets\\Textures\\RetroCarAlbedo.png");
+    auto pickupTruckGreenTexLoad = assetLoader.LoadTextureAsync(root + L"\\Assets\\Textures\\truck_color-green.jpg");
+    auto pickupTruckRedTexLoad = assetLoader.LoadTextureAsync(root + L"\\Assets\\Textures\\truck_color-red.jpg");
+    auto pickupTruckSilverTexLoad = assetLoader.LoadTextureAsync(root + L"\\Assets\\Textures\\truck_color-silver.jpg");
+    auto pedestalTexLoad = assetLoader.LoadTextureAsync(root + L"\\Assets\\Textures\\tech_pedestal_COL.png");
+    auto containerTexLoad = assetLoader.LoadTextureAsync(root + L"\\Assets\\Textures\\Sci-fi_Container_BaseColor.png");
+    auto groundBrickTex1Load = assetLoader.LoadTextureAsync(root + L"\\Assets\\Textures\\brickGround.png");
+    auto rabbitStatueTex1Load = assetLoader.LoadTextureAsync(root + L"\\Assets\\Textures\\Rabbit_basecolor.jpg");
+    auto lionStatueTex1Load = assetLoader.LoadTextureAsync(root + L"\\Assets\\Textures\\Lion_statue_raw_texture.jpg");
+
+    REQUEST_RETRO_CAR_MODEL(assetLoader)
+    REQUEST_PICKUP_TRUCK_MODEL(assetLoader)
+    REQUEST_PEDESTAL_MODEL(assetLoader)
+    REQUEST_CONTAINER_MODEL(assetLoader)
+    auto rabbitStatuePath = root + L"\\Assets\\Models\\Scifi_Container.fbx";
+    auto rabbitStatueModel1Load = assetLoader.LoadModelAsync(WCharToString(rabbitStatuePath.c_str()), ModelImportProperties{ .axis = Vector3(1.0f, 0.0f, 0.0f), .angleDeg = 0, .scale = Vector3(20.0f) });
+    auto lionStatuePath = root + L"\\Assets\\Models\\lion-lp.fbx";
+    auto lionStatueModel1Load = assetLoader.LoadModelAsync(WCharToString(lionStatuePath.c_str()), ModelImportProperties{ .axis = Vector3(1.0f, 0.0f, 0.0f), .angleDeg = 0, .scale = Vector3(1.0f) });
+    auto chairPath = root + L"\\Assets\\Models\\leather_chair.fbx";
+    auto chairModel1Load = assetLoader.LoadModelAsync(WCharToString(chairPath.c_str()), ModelImportProperties{.axis = Vector3(1.0f, 0.0f, 0.0f), .angleDeg = 90, .scale = Vector3(1.0f)});
 
+    assetLoader.WaitAll();
 
-	assetManager->UploadTextureToGPU(rabbitStatueTex1);
-    assetManager->UploadTextureToGPU(lionStatueTex1);
+    auto retroCarTex = retroCarTexLoad.get().asset;
+    auto pickupTruckGreenTex = pickupTruckGreenTexLoad.get().asset;
+    auto pickupTruckRedTex = pickupTruckRedTexLoad.get().asset;
+    auto pickupTruckSilverTex = pickupTruckSilverTexLoad.get().asset;
+    auto pedestalTex = pedestalTexLoad.get().asset;
+    auto containerTex = containerTexLoad.get().asset;
+    auto groundBrickTex1 = groundBrickTex1Load.get().asset;
+    auto rabbitStatueTex1 = rabbitStatueTex1Load.get().asset;
+    auto lionStatueTex1 = lionStatueTex1Load.get().asset;
 
 	////// Importing meshes
 
@@ -174,16 +215,16 @@ ref<Scene> SceneBuilder::BuildSimpleLightScene(const ref<Render::GPUAssetManager
 
     IMPORT_CONTAINER_MESH(containerMesh, errorStr)
 
-    auto rabbitStatuePath = root + L"\\Assets\\Models\\Scifi_Container.fbx";
-    auto rabbitStatueModel1 = AssimpModel3DImporter::Import(WCharToString(rabbitStatuePath.c_str()), ModelImportProperties{ .axis = Vector3(1.0f, 0.0f, 0.0f), .angleDeg = 0, .scale = Vector3(20.0f) }, errorStr);
+    auto rabbitStatueModel1 = rabbitStatueModel1Load.get().asset;
+    errorStr = rabbitStatueModel1Load.get().error;
     if (rabbitStatueModel1 == nullptr) {
         error = "Error in Importing Model At: \n" + WStringToString(rabbitStatuePath) + "Error: \n" + errorStr;
         return nullptr;
     }
     auto rabbitStatueMesh1 = rabbitStatueModel1->GetMesh("Rabbit_low_Stereo_textured_mesh");
 
-    auto lionStatuePath = root + L"\\Assets\\Models\\lion-lp.fbx";
-    auto lionStatueModel1 = AssimpModel3DImporter::Import(WCharToString(lionStatuePath.c_str()), ModelImportProperties{ .axis = Vector3(1.0f, 0.0f, 0.0f), .angleDeg = 0, .scale = Vector3(1.0f) }, errorStr);
+    auto lionStatueModel1 = lionStatueModel1Load.get().asset;
+    errorStr = lionStatueModel1Load.get().error;
     
     if (lionStatueModel1 == nullptr) {
         error = "Error in Importing Model At: \n" + WStringToString(lionStatuePath) + "Error: \n" + errorStr;
@@ -192,8 +233,8 @@ ref<Scene> SceneBuilder::BuildSimpleLightScene(const ref<Render::GPUAssetManager
     
     auto lionStatueMesh1 = lionStatueModel1->GetMesh("Model.004");
 
-    auto chairPath = root + L"\\Assets\\Models\\leather_chair.fbx";
-    auto chairModel1 = AssimpModel3DImporter::Import(WCharToString(chairPath.c_str()), ModelImportProperties{.axis = Vector3(1.0f, 0.0f, 0.0f), .angleDeg = 90, .scale = Vector3(1.0f)}, errorStr);
+    auto chairModel1 = chairModel1Load.get().asset;
+    errorStr = chairModel1Load.get().error;
 
     if (chairModel1 == nullptr) {
         error = "Error in Importing Model At: \n" + WStringToString(chairPath) + "Error: \n" + errorStr;
@@ -257,11 +298,14 @@ ref<Scene> SceneBuilder::BuildSimpleLightScene(const ref<Render::GPUAssetManager
     pickupTruckRTMaterial->SetValue("diffuse", 0.5f);
     pickupTruckRTMaterial->SetValue("specular", 2.1f);
 
-    auto rabbitStatueMaterial1 = materialFactory->CreateMaterial(lightRasterProgram);
+    // the statues, containers and ground only differ in texture and specular, they are instances of one material
+    auto statueMaterial = materialFactory->CreateMaterial(lightRasterProgram);
+    statueMaterial->SetValue("ambient", 0.1f);
+    statueMaterial->SetValue("diffuse", 0.8f);
+    statueMaterial->SetValue("specular", 0.1f);
+
+    auto rabbitStatueMaterial1 = std::make_shared<Render::MaterialInstance>(statueMaterial);
     rabbitStatueMaterial1->SetTexture2D("mainTexture", rabbitStatueTex1);
-    rabbitStatueMaterial1->SetValue("ambient", 0.1f);
-    rabbitStatueMaterial1->SetValue("diffuse", 0.8f);
-    rabbitStatueMaterial1->SetValue("specular", 0.1f);
 
 	auto rabbitStatueRTMaterial = materialFactory->CreateMaterial(simpleRTLightProgram);
 	rabbitStatueRTMaterial->SetTexture2D("mainTexture", rabbitStatueTex1);
@@ -269,11 +313,8 @@ ref<Scene> SceneBuilder::BuildSimpleLightScene(const ref<Render::GPUAssetManager
 	rabbitStatueRTMaterial->SetValue("diffuse", 0.8f);
 	rabbitStatueRTMaterial->SetValue("specular", 0.1f);
 
-    auto lionStatueMaterial1 = materialFactory->CreateMaterial(lightRasterProgram);
+    auto lionStatueMaterial1 = std::make_shared<Render::MaterialInstance>(statueMaterial);
     lionStatueMaterial1->SetTexture2D("mainTexture", lionStatueTex1);
-    lionStatueMaterial1->SetValue("ambient", 0.1f);
-    lionStatueMaterial1->SetValue("diffuse", 0.8f);
-    lionStatueMaterial1->SetValue("specular", 0.1f);
 
     auto lionStatueRTMaterial = materialFactory->CreateMaterial(simpleRTLightProgram);
     lionStatueRTMaterial->SetTexture2D("mainTexture", lionStatueTex1);
@@ -281,11 +322,8 @@ ref<Scene> SceneBuilder::BuildSimpleLightScene(const ref<Render::GPUAssetManager
     lionStatueRTMaterial->SetValue("diffuse", 0.8f);
     lionStatueRTMaterial->SetValue("specular", 0.1f);
 
-    auto containerMaterial = materialFactory->CreateMaterial(lightRasterProgram);
+    auto containerMaterial = std::make_shared<Render::MaterialInstance>(statueMaterial);
     containerMaterial->SetTexture2D("mainTexture", containerTex);
-    containerMaterial->SetValue("ambient", 0.1f);
-    containerMaterial->SetValue("diffuse", 0.8f);
-    containerMaterial->SetValue("specular", 0.1f);
 
     auto containerRTMaterial = materialFactory->CreateMaterial(simpleRTLightProgram);
     containerRTMaterial->SetTexture2D("mainTexture", containerTex);
@@ -293,10 +331,8 @@ ref<Scene> SceneBuilder::BuildSimpleLightScene(const ref<Render::GPUAssetManager
     containerRTMaterial->SetValue("diffuse", 0.8f);
     containerRTMaterial->SetValue("specular", 0.3f);
 
-    auto groundMaterial1 = materialFactory->CreateMaterial(lightRasterProgram);
+    auto groundMaterial1 = std::make_shared<Render::MaterialInstance>(statueMaterial);
     groundMaterial1->SetTexture2D("mainTexture", groundBrickTex1);
-    groundMaterial1->SetValue("ambient", 0.1f);
-    groundMaterial1->SetValue("diffuse", 0.8f);
     groundMaterial1->SetValue("specular", 0.4f);
 
     auto groundRTMaterial = materialFactory->CreateMaterial(simpleRTLightProgram);
@@ -396,11 +432,12 @@ ref<Scene> SceneBuilder::BuildSimpleLightScene(const ref<Render::GPUAssetManager
 	auto curveModifier = std::make_shared<CurveModifier>(curveRenderer, 2.0f);
     ref<Scene> scene = std::make_shared<Scene>();
     scene->mainCamera = mainCamera;
-    scene->lightData = lightData;
+    scene->lightData = std::make_shared<SceneLightData>(lightData);
+    auto pointLightOrbiter = std::make_shared<PointLightOrbiter>(scene->lightData, 0, Vector3(0.0f, 4.4f, 0.0f), 3.0f, 0.5f);
     //scene->entities = { retroCarEntity, retroCarEntity1, rabbitStatueEntity1, lionStatueEntity1, grountEntity1, chairEntity1, chairEntity2, curveEntity, curveEntity1};
     scene->entities = { retroCarEntity, retroCarEntity1, pedestalEntity, pickupTruckEntity, containerEntity1, containerEntity2, grountEntity1 };
 
-    scene->behaviours = { cameraController, pickupTruckTextureSwitcher, pickupTruckTextureRTSwitcher, pickupTruckRotator };
+    scene->behaviours = { cameraController, pickupTruckTextureSwitcher, pickupTruckTextureRTSwitcher, pickupTruckRotator, pointLightOrbiter };
 	scene->rtGlobalMaterial = rtGlobalMaterial;
     
     return scene;
@@ -477,24 +514,37 @@ ref<Scene> SceneBuilder::BuildReflectionScene(const ref<Render::GPUAssetManager>
     ref<Camera> mainCamera = std::make_shared<PerspectiveCamera>(camtransform, 0.1f, 1000.0f, (float)win->GetWidth() / win->GetHeight(), 45);
     ref<CameraController> cameraController = std::make_shared<CameraController>(mainCamera);
 
-    ////// Importing Textures
-
-    auto retroCarTex = QuantumEngine::WICTexture2DImporter::Import(root + L"\\Assets\\Textures\\RetroCarAlbedo.png", errorStr);
-    auto rabbitStatueTex1 = QuantumEngine::WICTexture2DImporter::Import(root + L"\\Assets\\Textures\\Rabbit_basecolor.jpg", errorStr);
-    auto lionStatueTex1 = QuantumEngine::WICTexture2DImporter::Import(root + L"\\Assets\\Textures\\Lion_statue_raw_texture.jpg", errorStr);
-    auto chairTex1 = QuantumEngine::WICTexture2DImporter::Import(root + L"\\Assets\\Textures\\leather_chair_BaseColor.png", errorStr);
-    auto groundBrickTex1 = QuantumEngine::WICTexture2DImporter::Import(root + L"\\Assets\\Textures\\brickGround.png", errorStr);
-    auto swampTex1 = QuantumEngine::WICTexture2DImporter::Import(root + L"\\Assets\\Textures\\swampTex.jpg", errorStr);
-    auto wallColorTex = QuantumEngine::WICTexture2DImporter::Import(root + L"\\Assets\\Textures\\CorrugatedGlassFrame_basecolor.png", errorStr);
-    auto wallReflectionMaskTex = QuantumEngine::WICTexture2DImporter::Import(root + L"\\Assets\\Textures\\CorrugatedGlassFrame_metallic.png", errorStr);
-    assetManager->UploadTextureToGPU(retroCarTex);
-    assetManager->UploadTextureToGPU(rabbitStatueTex1);
-    assetManager->UploadTextureToGPU(lionStatueTex1);
-    assetManager->UploadTextureToGPU(groundBrickTex1);
-    assetManager->UploadTextureToGPU(chairTex1);
-    assetManager->UploadTextureToGPU(swampTex1);
-    assetManager->UploadTextureToGPU(wallColorTex);
-    assetManager->UploadTextureToGPU(wallReflectionMaskTex);
+    ////// Loading Assets
+
+    // loaded textures and meshes are uploaded to the GPU by the loader inside WaitAll
+    AsyncAssetLoader assetLoader(assetManager);
+
+    auto retroCarTexLoad = assetLoader.LoadTextureAsync(root + L"\\Assets\\Textures\\RetroCarAlbedo.png");
+    auto rabbitStatueTex1Load = assetLoader.LoadTextureAsync(root + L"\\Assets\\Textures\\Rabbit_basecolor.jpg");
+    auto lionStatueTex1Load = assetLoader.LoadTextureAsync(root + L"\\Assets\\Textures\\Lion_statue_raw_texture.jpg");
+    auto chairTex1Load = assetLoader.LoadTextureAsync(root + L"\\Assets\\Textures\\leather_chair_BaseColor.png");
+    auto groundBrickTex1Load = assetLoader.LoadTextureAsync(root + L"\\Assets\\Textures\\brickGround.png");
+    auto swampTex1Load = assetLoader.LoadTextureAsync(root + L"\\Assets\\Textures\\swampTex.jpg");
+    auto wallColorTexLoad = assetLoader.LoadTextureAsync(root + L"\\Assets\\Textures\\CorrugatedGlassFrame_basecolor.png");
+    auto wallReflectionMaskTexLoad = assetLoader.LoadTextureAsync(root + L"\\Assets\\Textures\\CorrugatedGlassFrame_metallic.png", nullptr, false);
+
+    REQUEST_RETRO_CAR_MODEL(assetLoader)
+    REQUEST_LION_STATUE_MODEL(assetLoader)
+    auto rabbitStatuePath = root + L"\\Assets\\Models\\RabbitStatue.fbx";
+    auto rabbitStatueModel1Load = assetLoader.LoadModelAsync(WCharToString(rabbitStatuePath.c_str()), ModelImportProperties{ .axis = Vector3(1.0f, 0.0f, 0.0f), .angleDeg = 0, .scale = Vector3(20.0f) });
+    auto chairPath = root + L"\\Assets\\Models\\leather_chair.fbx";
+    auto chairModel1Load = assetLoader.LoadModelAsync(WCharToString(chairPath.c_str()), ModelImportProperties{ .axis = Vector3(1.0f, 0.0f, 0.0f), .angleDeg = 90, .scale = Vector3(1.0f) });
+
+    assetLoader.WaitAll();
+
+    auto retroCarTex = retroCarTexLoad.get().asset;
+    auto rabbitStatueTex1 = rabbitStatueTex1Load.get().asset;
+    auto lionStatueTex1 = lionStatueTex1Load.get().asset;
+    auto chairTex1 = chairTex1Load.get().asset;
+    auto groundBrickTex1 = groundBrickTex1Load.get().asset;
+    auto swampTex1 = swampTex1Load.get().asset;
+    auto wallColorTex = wallColorTexLoad.get().asset;
+    auto wallReflectionMaskTex = wallReflectionMaskTexLoad.get().asset;
 
     ////// Importing meshes
 
@@ -502,16 +552,16 @@ ref<Scene> SceneBuilder::BuildReflectionScene(const ref<Render::GPUAssetManager>
 
     IMPORT_LION_STATUE_MESH(lionStatueMesh, errorStr)
 
-    auto rabbitStatuePath = root + L"\\Assets\\Models\\RabbitStatue.fbx";
-    auto rabbitStatueModel1 = AssimpModel3DImporter::Import(WCharToString(rabbitStatuePath.c_str()), ModelImportProperties{ .axis = Vector3(1.0f, 0.0f, 0.0f), .angleDeg = 0, .scale = Vector3(20.0f) }, errorStr);
+    auto rabbitStatueModel1 = rabbitStatueModel1Load.get().asset;
+    errorStr = rabbitStatueModel1Load.get().error;
     if (rabbitStatueModel1 == nullptr) {
         error = "Error in Importing Model At: \n" + WStringToString(rabbitStatuePath) + "Error: \n" + errorStr;
         return nullptr;
     }
     auto rabbitStatueMesh1 = rabbitStatueModel1->GetMesh("Rabbit_low_Stereo_textured_mesh");
 
-    auto chairPath = root + L"\\Assets\\Models\\leather_chair.fbx";
-    auto chairModel1 = AssimpModel3DImporter::Import(WCharToString(chairPath.c_str()), ModelImportProperties{ .axis = Vector3(1.0f, 0.0f, 0.0f), .angleDeg = 90, .scale = Vector3(1.0f) }, errorStr);
+    auto chairModel1 = chairModel1Load.get().asset;
+    errorStr = chairModel1Load.get().error;
 
     if (chairModel1 == nullptr) {
         error = "Error in Importing Model At: \n" + WStringToString(chairPath) + "Error: \n" + errorStr;
@@ -699,7 +749,7 @@ ref<Scene> SceneBuilder::BuildReflectionScene(const ref<Render::GPUAssetManager>
 
     ref<Scene> scene = std::make_shared<Scene>();
     scene->mainCamera = mainCamera;
-    scene->lightData = lightData;
+    scene->lightData = std::make_shared<SceneLightData>(lightData);
     scene->entities = {retroCarEntity, rabbitStatueEntity1, lionStatueEntity, chairEntity1, grountEntity1, sphereEntity, wallEntity };
     scene->behaviours = { cameraController, carRotator, sphereReflectionModifier, sphereGBufferReflectionModifier };
     scene->rtGlobalMaterial = rtGlobalMaterial;
@@ -745,18 +795,32 @@ ref<Scene> SceneBuilder::BuildShadowScene(const ref<Render::GPUAssetManager>& as
     ref<Camera> mainCamera = std::make_shared<PerspectiveCamera>(camtransform, 0.1f, 1000.0f, (float)win->GetWidth() / win->GetHeight(), 45);
     ref<CameraController> cameraController = std::make_shared<CameraController>(mainCamera);
 
-    ////// Importing Textures
+    ////// Loading Assets
+
+    // loaded textures and meshes are uploaded to the GPU by the loader inside WaitAll
+    AsyncAssetLoader assetLoader(assetManager);
+
+    auto retroCarTexLoad = assetLoader.LoadTextureAsync(root + L"\\Assets\\Textures\\RetroCarAlbedo.png");
+    auto pickupTruckTexLoad = assetLoader.LoadTextureAsync(root + L"\\Assets\\Textures\\truck_color-green.jpg");
+    auto lionStatueTexLoad = assetLoader.LoadTextureAsync(root + L"\\Assets\\Textures\\Lion_statue_raw_texture.jpg");
+    auto droneTexLoad = assetLoader.LoadTextureAsync(root + L"\\Assets\\Textures\\304_Drone_M_304_Drone_BaseColor.png");
+    // the ground is BC7 compressed on its first load and read from the texture cache after that
+    assetLoader.SetTextureCompression(true);
+    auto groundBrickTex1Load = assetLoader.LoadTextureAsync(root + L"\\Assets\\Textures\\brickGround.png");
+    assetLoader.SetTextureCompression(false);
 
-    auto retroCarTex = QuantumEngine::WICTexture2DImporter::Import(root + L"\\Assets\\Textures\\RetroCarAlbedo.png", error);
-    auto pickupTruckTex = QuantumEngine::WICTexture2DImporter::Import(root + L"\\Assets\\Textures\\truck_color-green.jpg", error);
-    auto lionStatueTex = QuantumEngine::WICTexture2DImporter::Import(root + L"\\Assets\\Textures\\Lion_statue_raw_texture.jpg", error);
-    auto droneTex = QuantumEngine::WICTexture2DImporter::Import(root + L"\\Assets\\Textures\\304_Drone_M_304_Drone_BaseColor.png", error);
-    auto groundBrickTex1 = QuantumEngine::WICTexture2DImporter::Import(root + L"\\Assets\\Textures\\brickGround.png", error);
-    assetManager->UploadTextureToGPU(retroCarTex);
-    assetManager->UploadTextureToGPU(pickupTruckTex);
-    assetManager->UploadTextureToGPU(lionStatueTex);
-    assetManager->UploadTextureToGPU(groundBrickTex1);
-    assetManager->UploadTextureToGPU(droneTex);
+    REQUEST_RETRO_CAR_MODEL(assetLoader)
+    REQUEST_LION_STATUE_MODEL(assetLoader)
+    REQUEST_PICKUP_TRUCK_MODEL(assetLoader)
+    REQUEST_DRONE_MODEL(assetLoader)
+
+    assetLoader.WaitAll();
+
+    auto retroCarTex = retroCarTexLoad.get().asset;
+    auto pickupTruckTex = pickupTruckTexLoad.get().asset;
+    auto lionStatueTex = lionStatueTexLoad.get().asset;
+    auto droneTex = droneTexLoad.get().asset;
+    auto groundBrickTex1 = groundBrickTex1Load.get().asset;
 
     ////// Importing meshes
 
@@ -894,7 +958,7 @@ ref<Scene> SceneBuilder::BuildShadowScene(const ref<Render::GPUAssetManager>& as
 
     ref<Scene> scene = std::make_shared<Scene>();
     scene->mainCamera = mainCamera;
-    scene->lightData = lightData;
+    scene->lightData = std::make_shared<SceneLightData>(lightData);
     scene->entities = { retroCarEntity, pickupTruckEntity, lionStatueEntity1, droneEntity, groundEntity1 };
     scene->behaviours = { cameraController, droneController };
     scene->rtGlobalMaterial = rtGlobalMaterial;
@@ -949,18 +1013,31 @@ ref<Scene> SceneBuilder::BuildRefractionScene(const ref<Render::GPUAssetManager>
     ref<Camera> mainCamera = std::make_shared<PerspectiveCamera>(camtransform, 0.1f, 1000.0f, (float)win->GetWidth() / win->GetHeight(), 45);
     ref<CameraController> cameraController = std::make_shared<CameraController>(mainCamera);
 
-    ////// Importing Textures
+    ////// Loading Assets
+
+    // loaded textures and meshes are uploaded to the GPU by the loader inside WaitAll
+    AsyncAssetLoader assetLoader(assetManager);
 
-    ref<QuantumEngine::Texture2D> carTex1 = QuantumEngine::WICTexture2DImporter::Import(root + L"\\Assets\\Textures\\RetroCarAlbedo.png", errorStr);
-    ref<QuantumEngine::Texture2D> rabbitStatueTex1 = QuantumEngine::WICTexture2DImporter::Import(root + L"\\Assets\\Textures\\Rabbit_basecolor.jpg", errorStr);
-    ref<QuantumEngine::Texture2D> lionStatueTex1 = QuantumEngine::WICTexture2DImporter::Import(root + L"\\Assets\\Textures\\Lion_statue_raw_texture.jpg", errorStr);
-    ref<QuantumEngine::Texture2D> chairTex1 = QuantumEngine::WICTexture2DImporter::Import(root + L"\\Assets\\Textures\\leather_chair_BaseColor.png", errorStr);
-    ref<QuantumEngine::Texture2D> groundBrickTex1 = QuantumEngine::WICTexture2DImporter::Import(root + L"\\Assets\\Textures\\brickGround.png", errorStr);
-    assetManager->UploadTextureToGPU(carTex1);
-    assetManager->UploadTextureToGPU(rabbitStatueTex1);
-    assetManager->UploadTextureToGPU(lionStatueTex1);
-    assetManager->UploadTextureToGPU(groundBrickTex1);
-    assetManager->UploadTextureToGPU(chairTex1);
+    auto carTex1Load = assetLoader.LoadTextureAsync(root + L"\\Assets\\Textures\\RetroCarAlbedo.png");
+    auto rabbitStatueTex1Load = assetLoader.LoadTextureAsync(root + L"\\Assets\\Textures\\Rabbit_basecolor.jpg");
+    auto lionStatueTex1Load = assetLoader.LoadTextureAsync(root + L"\\Assets\\Textures\\Lion_statue_raw_texture.jpg");
+    auto chairTex1Load = assetLoader.LoadTextureAsync(root + L"\\Assets\\Textures\\leather_chair_BaseColor.png");
+    auto groundBrickTex1Load = assetLoader.LoadTextureAsync(root + L"\\Assets\\Textures\\brickGround.png");
+
+    REQUEST_RETRO_CAR_MODEL(assetLoader)
+    REQUEST_LION_STATUE_MODEL(assetLoader)
+    auto rabbitStatuePath = root + L"\\Assets\\Models\\RabbitStatue.fbx";
+    auto rabbitStatueModel1Load = assetLoader.LoadModelAsync(WCharToString(rabbitStatuePath.c_str()), ModelImportProperties{ .axis = Vector3(1.0f, 0.0f, 0.0f), .angleDeg = 0, .scale = Vector3(20.0f) });
+    auto chairPath = root + L"\\Assets\\Models\\leather_chair.fbx";
+    auto chairModel1Load = assetLoader.LoadModelAsync(WCharToString(chairPath.c_str()), ModelImportProperties{ .axis = Vector3(1.0f, 0.0f, 0.0f), .angleDeg = 90, .scale = Vector3(1.0f) });
+
+    assetLoader.WaitAll();
+
+    auto carTex1 = carTex1Load.get().asset;
+    auto rabbitStatueTex1 = rabbitStatueTex1Load.get().asset;
+    auto lionStatueTex1 = lionStatueTex1Load.get().asset;
+    auto chairTex1 = chairTex1Load.get().asset;
+    auto groundBrickTex1 = groundBrickTex1Load.get().asset;
 
     ////// Importing meshes
 
@@ -968,16 +1045,16 @@ ref<Scene> SceneBuilder::BuildRefractionScene(const ref<Render::GPUAssetManager>
 
     IMPORT_LION_STATUE_MESH(lionStatueMesh, error)
 
-    auto rabbitStatuePath = root + L"\\Assets\\Models\\RabbitStatue.fbx";
-    auto rabbitStatueModel1 = AssimpModel3DImporter::Import(WCharToString(rabbitStatuePath.c_str()), ModelImportProperties{ .axis = Vector3(1.0f, 0.0f, 0.0f), .angleDeg = 0, .scale = Vector3(20.0f) }, errorStr);
+    auto rabbitStatueModel1 = rabbitStatueModel1Load.get().asset;
+    errorStr = rabbitStatueModel1Load.get().error;
     if (rabbitStatueModel1 == nullptr) {
         error = "Error in Importing Model At: \n" + WStringToString(rabbitStatuePath) + "Error: \n" + errorStr;
         return nullptr;
     }
     auto rabbitStatueMesh1 = rabbitStatueModel1->GetMesh("Rabbit_low_Stereo_textured_mesh");
 
-    auto chairPath = root + L"\\Assets\\Models\\leather_chair.fbx";
-    auto chairModel1 = AssimpModel3DImporter::Import(WCharToString(chairPath.c_str()), ModelImportProperties{ .axis = Vector3(1.0f, 0.0f, 0.0f), .angleDeg = 90, .scale = Vector3(1.0f) }, errorStr);
+    auto chairModel1 = chairModel1Load.get().asset;
+    errorStr = chairModel1Load.get().error;
 
     if (chairModel1 == nullptr) {
         error = "Error in Importing Model At: \n" + WStringToString(chairPath) + "Error: \n" + errorStr;
@@ -1113,7 +1190,7 @@ ref<Scene> SceneBuilder::BuildRefractionScene(const ref<Render::GPUAssetManager>
 
     ref<Scene> scene = std::make_shared<Scene>();
     scene->mainCamera = mainCamera;
-    scene->lightData = lightData;
+    scene->lightData = std::make_shared<SceneLightData>(lightData);
     scene->entities = { retroCarEntity, rabbitStatueEntity, lionStatueEntity, chairEntity1, groundEntity, slabEntity, sphereEntity };
     scene->behaviours = { cameraController, sphereReflectionModifier };
     scene->rtGlobalMaterial = rtGlobalMaterial;
@@ -1200,25 +1277,35 @@ ref<Scene> SceneBuilder::BuildComplexScene(const ref<Render::GPUAssetManager>& a
     ref<Camera> mainCamera = std::make_shared<PerspectiveCamera>(camtransform, 0.1f, 1000.0f, (float)win->GetWidth() / win->GetHeight(), 45);
     ref<CameraController> cameraController = std::make_shared<CameraController>(mainCamera);
 
-    ////// Importing Textures
-
-    auto pickupTruckColorTex = QuantumEngine::WICTexture2DImporter::Import(root + L"\\Assets\\Textures\\truck_color.jpg", error);
-    auto pickupTruckReflTex = QuantumEngine::WICTexture2DImporter::Import(root + L"\\Assets\\Textures\\truck_refl.jpg", error);
-    auto pedestalTex = QuantumEngine::WICTexture2DImporter::Import(root + L"\\Assets\\Textures\\tech_pedestal_COL.png", error);
-    auto retroCarTex = QuantumEngine::WICTexture2DImporter::Import(root + L"\\Assets\\Textures\\RetroCarAlbedo.png", error);
-    auto lionStatueTex1 = QuantumEngine::WICTexture2DImporter::Import(root + L"\\Assets\\Textures\\Lion_statue_raw_texture.jpg", error);
-    auto groundBrickTex1 = QuantumEngine::WICTexture2DImporter::Import(root + L"\\Assets\\Textures\\brickGround.png", errorStr);
-    auto waterTex1 = QuantumEngine::WICTexture2DImporter::Import(root + L"\\Assets\\Textures\\water.jpeg", errorStr);
-    auto skyBoxTex = QuantumEngine::WICTexture2DImporter::Import(root + L"\\Assets\\Textures\\skybox.jpg", errorStr);
-
-    assetManager->UploadTextureToGPU(pickupTruckColorTex);
-    assetManager->UploadTextureToGPU(pickupTruckReflTex);
-    assetManager->UploadTextureToGPU(pedestalTex);
-    assetManager->UploadTextureToGPU(retroCarTex);
-    assetManager->UploadTextureToGPU(lionStatueTex1);
-    assetManager->UploadTextureToGPU(groundBrickTex1);
-    assetManager->UploadTextureToGPU(waterTex1);
-    assetManager->UploadTextureToGPU(skyBoxTex);
+    ////// Loading Assets
+
+    // loaded textures and meshes are uploaded to the GPU by the loader inside WaitAll
+    AsyncAssetLoader assetLoader(assetManager);
+
+    auto pickupTruckColorTexLoad = assetLoader.LoadTextureAsync(root + L"\\Assets\\Textures\\truck_color.jpg");
+    auto pickupTruckReflTexLoad = assetLoader.LoadTextureAsync(root + L"\\Assets\\Textures\\truck_refl.jpg", nullptr, false);
+    auto pedestalTexLoad = assetLoader.LoadTextureAsync(root + L"\\Assets\\Textures\\tech_pedestal_COL.png");
+    auto retroCarTexLoad = assetLoader.LoadTextureAsync(root + L"\\Assets\\Textures\\RetroCarAlbedo.png");
+    auto lionStatueTex1Load = assetLoader.LoadTextureAsync(root + L"\\Assets\\Textures\\Lion_statue_raw_texture.jpg");
+    auto groundBrickTex1Load = assetLoader.LoadTextureAsync(root + L"\\Assets\\Textures\\brickGround.png");
+    auto waterTex1Load = assetLoader.LoadTextureAsync(root + L"\\Assets\\Textures\\water.jpeg");
+    auto skyBoxTexLoad = assetLoader.LoadTextureAsync(root + L"\\Assets\\Textures\\skybox.jpg");
+
+    REQUEST_PICKUP_TRUCK_MODEL(assetLoader)
+    REQUEST_RETRO_CAR_MODEL(assetLoader)
+    REQUEST_LION_STATUE_MODEL(assetLoader)
+    REQUEST_PEDESTAL_MODEL(assetLoader)
+
+    assetLoader.WaitAll();
+
+    auto pickupTruckColorTex = pickupTruckColorTexLoad.get().asset;
+    auto pickupTruckReflTex = pickupTruckReflTexLoad.get().asset;
+    auto pedestalTex = pedestalTexLoad.get().asset;
+    auto retroCarTex = retroCarTexLoad.get().asset;
+    auto lionStatueTex1 = lionStatueTex1Load.get().asset;
+    auto groundBrickTex1 = groundBrickTex1Load.get().asset;
+    auto waterTex1 = waterTex1Load.get().asset;
+    auto skyBoxTex = skyBoxTexLoad.get().asset;
 
     ////// Import Meshes
 
@@ -1412,7 +1499,7 @@ ref<Scene> SceneBuilder::BuildComplexScene(const ref<Render::GPUAssetManager>& a
 
     ref<Scene> scene = std::make_shared<Scene>();
     scene->mainCamera = mainCamera;
-    scene->lightData = lightData;
+    scene->lightData = std::make_shared<SceneLightData>(lightData);
     scene->entities = { 
         pickupTruckEntity, 
         retroCarEntity,
@@ -1425,6 +1512,12 @@ ref<Scene> SceneBuilder::BuildComplexScene(const ref<Render::GPUAssetManager>& a
         skyBoxEntity,
         pedestalEntity,
     };
+
+    // the camera is always inside the sky box, it would be the first hit of every ray
+    std::vector<ref<GameEntity>> pickableEntities = scene->entities;
+    std::erase(pickableEntities, skyBoxEntity);
+    auto entityPicker = std::make_shared<EntityPicker>(mainCamera, pickableEntities, win);
+
     scene->behaviours = { 
         cameraController, 
         pickupTruckMover, 
@@ -1432,6 +1525,7 @@ ref<Scene> SceneBuilder::BuildComplexScene(const ref<Render::GPUAssetManager>& a
         lionRotator, 
         sphereMover,
         glassMover,
+        entityPicker,
     };
     scene->rtGlobalMaterial = rtGlobalMaterial;
 
@@ -69,6 +69,7 @@ ComPtr<ID3D12RootSignature> QuantumEngine::Rendering::DX12::HLSLReflection::Crea
         case D3D_SIT_RTACCELERATIONSTRUCTURE:
         case D3D_SIT_TEXTURE:
         case D3D_SIT_STRUCTURED:
+        case D3D_SIT_BYTEADDRESS:
             rangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
             break;
         case D3D_SIT_UAV_RWTYPED:
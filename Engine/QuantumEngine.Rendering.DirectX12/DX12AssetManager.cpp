@@ -4,6 +4,7 @@
 #include "DX12Texture2DController.h"
 #include "DX12CommandExecuter.h"
 #include "Core/Texture2D.h"
+#include "Core/TextureMipGenerator.h"
 #include "Core/Mesh.h"
 #include "DX12Utilities.h"
 
@@ -18,7 +19,17 @@ void QuantumEngine::Rendering::DX12::DX12AssetManager::UploadTextureToGPU(const
 		return;
 	}
 
-	auto texture2DController = std::make_shared<DX12Texture2DController>(texture);
+	// D3D12 has no blit, textures asking for GPU mips get a CPU generated chain instead
+	ref<Texture2D> uploadTexture = texture;
+
+	if (texture->GetGenerateGPUMips() && texture->GetMipLevelCount() == 1) {
+		auto mippedTexture = TextureMipGenerator::GenerateMips(texture);
+
+		if (mippedTexture != nullptr)
+			uploadTexture = mippedTexture;
+	}
+
+	auto texture2DController = std::make_shared<DX12Texture2DController>(uploadTexture);
 
 	if (texture2DController->Initialize(m_device) == false)
 		return;
@@ -148,7 +148,7 @@ bool QuantumEngine::Rendering::DX12::DX12GraphicContext::InitializeCamera(const
 	return true;
 }
 
-bool QuantumEngine::Rendering::DX12::DX12GraphicContext::InitializeLight(const SceneLightData& lights)
+bool QuantumEngine::Rendering::DX12::DX12GraphicContext::InitializeLight(const ref<SceneLightData>& lights)
 {
 	return m_lightManager.Initialize(lights, m_device);
 }
@@ -206,6 +206,8 @@ void QuantumEngine::Rendering::DX12::DX12GraphicContext::UpdateDataHeaps()
 	std::memcpy(camData, &m_camData, sizeof(CameraGPU));
 	m_cameraBuffer->Unmap(0, nullptr);
 
+	m_lightManager.Update(m_camData.viewMatrix, m_camera->ProjectionMatrix());
+
 	for (auto& entity : m_entityGPUData) {
 		m_transformData.modelMatrix = entity.gameEntity->GetTransform()->Matrix();
 		m_transformData.modelViewMatrix = m_camData.viewMatrix * m_transformData.modelMatrix;
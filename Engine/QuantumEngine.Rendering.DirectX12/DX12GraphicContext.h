@@ -69,7 +69,7 @@ namespace QuantumEngine::Rendering::DX12 {
 		bool InitializeCommandObjects(const ComPtr<ID3D12Device10>& device);
 		bool InitializeSwapChain(const ComPtr<IDXGIFactory7>& factory);
 		bool InitializeCamera(const ref<Camera>& camera);
-		bool InitializeLight(const SceneLightData& lights);
+		bool InitializeLight(const ref<SceneLightData>& lights);
 		void InitializeEntityGPUData(const std::vector<ref<GameEntity>>& gameEntities);
 		void UploadTexturesAndMeshes(const ref<Scene>& scene);
 		void UpdateDataHeaps();
@@ -209,8 +209,9 @@ void QuantumEngine::Rendering::DX12::DX12HybridContext::InitializePipelines()
 
 	for (auto& entityGpu : m_entityGPUData) {
 		auto splineRenderer = std::dynamic_pointer_cast<SplineRenderer>(entityGpu.gameEntity->GetRenderer());
+		// vertex buffer, curve points and arc lengths
 		if (splineRenderer != nullptr) {
-			rasterHeapSize += 1;
+			rasterHeapSize += 3;
 		}
 	}
 
@@ -234,10 +235,7 @@ void QuantumEngine::Rendering::DX12::DX12HybridContext::InitializePipelines()
 
 	firstHandle.ptr += incrementSize;
 	gpuHandle.ptr += incrementSize;
-	D3D12_CONSTANT_BUFFER_VIEW_DESC lightViewDesc;
-	lightViewDesc.BufferLocation = m_lightManager.GetResource()->GetGPUVirtualAddress();
-	lightViewDesc.SizeInBytes = m_lightManager.GetResource()->GetDesc().Width;
-	m_device->CreateConstantBufferView(&lightViewDesc, firstHandle);
+	DX12LightManager::CreateShaderView(m_device, m_lightManager.GetResource(), firstHandle);
 	m_lightHandle = gpuHandle;
 
 	// Populate Transform View and Pipelines
@@ -375,8 +373,7 @@ void QuantumEngine::Rendering::DX12::DX12HybridContext::InitializePipelines()
 	}
 
 	for(auto& splinePipeline : m_splinePipelines) {
-		splinePipeline->BindDescriptorToResources(m_rasterHeap, offset);
-		offset += 1;
+		offset += splinePipeline->BindDescriptorToResources(m_rasterHeap, offset);
 	}
 }
 
@@ -3,9 +3,17 @@
 #include <BasicTypes.h>
 #include "DX12Utilities.h"
 
-bool QuantumEngine::Rendering::DX12::DX12LightManager::Initialize(const SceneLightData& lights, const ComPtr<ID3D12Device10>& device)
+QuantumEngine::Rendering::DX12::DX12LightManager::~DX12LightManager()
 {
-	UInt32 lightSize = CONSTANT_BUFFER_ALIGHT(10 * (sizeof(DirectionalLight) + sizeof(PointLight)) + 2 * sizeof(UInt32));
+	if (m_mappedData != nullptr)
+		m_lightBuffer->Unmap(0, nullptr);
+}
+
+bool QuantumEngine::Rendering::DX12::DX12LightManager::Initialize(const ref<SceneLightData>& lights, const ComPtr<ID3D12Device10>& device)
+{
+	m_lights = lights;
+	m_clusterGrid.Initialize(*lights);
+	UInt32 lightSize = m_clusterGrid.GetBufferSize();
 
 	D3D12_RESOURCE_DESC shaderTableBufferDesc
 	{
@@ -36,23 +44,39 @@ bool QuantumEngine::Rendering::DX12::DX12LightManager::Initialize(const SceneLig
 		return false;
 	}
 
-	D3D12_CONSTANT_BUFFER_VIEW_DESC cbDesc1{
-		.BufferLocation = m_lightBuffer->GetGPUVirtualAddress(),
-		.SizeInBytes = lightSize,
-	};
+	CreateShaderView(device, m_lightBuffer, m_lightHeap->GetCPUDescriptorHandleForHeapStart());
 
-	device->CreateConstantBufferView(&cbDesc1, m_lightHeap->GetCPUDescriptorHandleForHeapStart());
-	
-	Byte* pData;
-	m_lightBuffer->Map(0, nullptr, reinterpret_cast<void**>(&pData));
-	std::memcpy(pData, (void*)lights.directionalLights.data(), lights.directionalLights.size() * sizeof(DirectionalLight));
-	pData += 10 * (sizeof(DirectionalLight));
-	std::memcpy(pData, (void*)lights.pointLights.data(), lights.pointLights.size() * sizeof(PointLight));
-	pData += 10 * (sizeof(PointLight));
-	UInt32* data = reinterpret_cast<UInt32*>(pData);
-	*data = lights.directionalLights.size();
-	data++;
-	*data = lights.pointLights.size();
-	m_lightBuffer->Unmap(0, nullptr);
+	// the buffer is rewritten every frame, keep it mapped
+	if (FAILED(m_lightBuffer->Map(0, nullptr, reinterpret_cast<void**>(&m_mappedData))))
+		return false;
+
+	// without a camera every point falls back to all lights until the first update
+	m_clusterGrid.Write(*m_lights, m_mappedData);
+	m_lights->ClearModifiedLights();
 	return true;
 }
+
+void QuantumEngine::Rendering::DX12::DX12LightManager::Update(const Matrix4& viewMatrix, const Matrix4& projectionMatrix)
+{
+	// every frame waits for the GPU before the next one starts, so the buffer can be written in place
+	bool clustersChanged = m_clusterGrid.Build(*m_lights, viewMatrix, projectionMatrix);
+	m_clusterGrid.WriteModified(*m_lights, m_mappedData, clustersChanged);
+	m_lights->ClearModifiedLights();
+}
+
+void QuantumEngine::Rendering::DX12::DX12LightManager::CreateShaderView(const ComPtr<ID3D12Device10>& device, const ComPtr<ID3D12Resource2>& lightBuffer, D3D12_CPU_DESCRIPTOR_HANDLE handle)
+{
+	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc{
+		.Format = DXGI_FORMAT_R32_TYPELESS,
+		.ViewDimension = D3D12_SRV_DIMENSION_BUFFER,
+		.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING,
+		.Buffer = D3D12_BUFFER_SRV{
+			.FirstElement = 0,
+			.NumElements = (UInt32)(lightBuffer->GetDesc().Width / 4),
+			.StructureByteStride = 0,
+			.Flags = D3D12_BUFFER_SRV_FLAG_RAW,
+		},
+	};
+
+	device->CreateShaderResourceView(lightBuffer.Get(), &srvDesc, handle);
+}
@@ -1,18 +1,41 @@
 #pragma once
 #include <vector>
 #include <Core/Light/Lights.h>
+#include <Core/Light/LightClusterGrid.h>
+
+namespace QuantumEngine {
+	struct Matrix4;
+}
 
 namespace QuantumEngine::Rendering::DX12 {
 	using namespace Microsoft::WRL;
 
+	/// <summary>
+	/// Owns the light buffer, a raw buffer holding all scene lights and their per frame cluster assignment
+	/// </summary>
 	class DX12LightManager
 	{
 	public:
-		bool Initialize(const SceneLightData& lights, const ComPtr<ID3D12Device10>& device);
+		~DX12LightManager();
+		bool Initialize(const ref<SceneLightData>& lights, const ComPtr<ID3D12Device10>& device);
+
+		/// <summary>
+		/// reassigns the point lights to the clusters of the camera frustum and uploads the lights modified since the last frame
+		/// </summary>
+		void Update(const Matrix4& viewMatrix, const Matrix4& projectionMatrix);
+
+		/// <summary>
+		/// creates the raw shader resource view the shaders read the lights through
+		/// </summary>
+		static void CreateShaderView(const ComPtr<ID3D12Device10>& device, const ComPtr<ID3D12Resource2>& lightBuffer, D3D12_CPU_DESCRIPTOR_HANDLE handle);
+
 		inline ComPtr<ID3D12DescriptorHeap> GetDescriptor() { return m_lightHeap; }
 		inline ComPtr<ID3D12Resource2> GetResource() { return m_lightBuffer; }
 	private:
 		ComPtr<ID3D12Resource2> m_lightBuffer;
 		ComPtr<ID3D12DescriptorHeap> m_lightHeap;
+		Byte* m_mappedData = nullptr;
+		ref<SceneLightData> m_lights;
+		LightClusterGrid m_clusterGrid;
 	};
-}
\ No newline at end of file
+}
@@ -51,24 +51,26 @@ QuantumEngine::Rendering::DX12::DX12SplineRasterPipelineModule::DX12SplineRaster
 			return binding.name == SPLINE_WIDTH_BUFFER_NAME;
 		});*/
 
-	m_curveRootIndex = rootConstantBuffer.rootParameterIndex;
+	m_curveRootIndex = computeReflection->GetRootConstants().rootParameterIndex;
 
 	auto& resourceVariableList = computeReflection->GetResourceVariables();
-
-	auto vertexIt = std::find_if(
-		resourceVariableList.begin(),
-		resourceVariableList.end(),
-		[](const ResourceVariableData& binding) {
-			return binding.name == "_vertexBuffer";
-		});
-
-	m_vertexRootIndex = (*vertexIt).rootParameterIndex;
-
-	m_splineParams.startPoint = m_splineRenderer->GetCurve().m_point1;
-	m_splineParams.midPoint = m_splineRenderer->GetCurve().m_point2;
-	m_splineParams.endPoint = m_splineRenderer->GetCurve().m_point3;
-	m_splineParams.width = m_splineWidth;
-	m_splineParams.length = m_splineRenderer->GetCurve().InterpolateLength(1.0f);
+	auto findRootIndex = [&resourceVariableList](const std::string& name) {
+		auto it = std::find_if(
+			resourceVariableList.begin(),
+			resourceVariableList.end(),
+			[&name](const ResourceVariableData& binding) {
+				return binding.name == name;
+			});
+
+		return (*it).rootParameterIndex;
+	};
+
+	m_vertexRootIndex = findRootIndex("_vertexBuffer");
+	m_curvePointRootIndex = findRootIndex("CurvePoints");
+	m_arcLengthRootIndex = findRootIndex("CurveArcLengths");
+
+	m_splineParams.segmentCount = m_splineRenderer->GetCurve().GetSegmentCount();
+	m_splineParams.length = m_splineRenderer->GetCurve().GetLength();
 }
 
 bool QuantumEngine::Rendering::DX12::DX12SplineRasterPipelineModule::Initialize(const ComPtr<ID3D12Device10>& device)
@@ -90,6 +92,25 @@ bool QuantumEngine::Rendering::DX12::DX12SplineRasterPipelineModule::Initialize(
 	m_bufferView.SizeInBytes = sizeof(SplineVertex) * (m_splineRenderer->GetSegments() + 1);
 	m_bufferView.StrideInBytes = sizeof(SplineVertex);
 
+	// Curve buffers, rewritten whenever the spline is dirty
+	auto& curve = m_splineRenderer->GetCurve();
+	D3D12_RESOURCE_DESC pointDesc = ResourceUtilities::GetCommonBufferResourceDesc(
+		4 * sizeof(Float) * (UInt32)curve.GetBezierPoints().size(), D3D12_RESOURCE_FLAG_NONE);
+
+	if (FAILED(device->CreateCommittedResource(&DescriptorUtilities::CommonUploadHeapProps, D3D12_HEAP_FLAG_NONE, &pointDesc,
+		D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&m_curvePointBuffer))))
+		return false;
+
+	D3D12_RESOURCE_DESC lengthDesc = ResourceUtilities::GetCommonBufferResourceDesc(
+		sizeof(Float) * (UInt32)curve.GetArcLengths().size(), D3D12_RESOURCE_FLAG_NONE);
+
+	if (FAILED(device->CreateCommittedResource(&DescriptorUtilities::CommonUploadHeapProps, D3D12_HEAP_FLAG_NONE, &lengthDesc,
+		D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&m_arcLengthBuffer))))
+		return false;
+
+	m_curvePointBuffer->SetName(L"Spline Curve Point Buffer");
+	m_arcLengthBuffer->SetName(L"Spline Arc Length Buffer");
+
 	// Compute Pipeline to generate spline vertices
 	D3D12_COMPUTE_PIPELINE_STATE_DESC computePipelineDesc = {};
 	computePipelineDesc.pRootSignature = m_computeProgram->GetRootSignature().Get();
@@ -217,15 +238,14 @@ bool QuantumEngine::Rendering::DX12::DX12SplineRasterPipelineModule::Initialize(
 void QuantumEngine::Rendering::DX12::DX12SplineRasterPipelineModule::Render(ComPtr<ID3D12GraphicsCommandList7>& commandList, D3D12_GPU_DESCRIPTOR_HANDLE camHandle, D3D12_GPU_DESCRIPTOR_HANDLE lightHandle)
 {
 	if (m_splineRenderer->IsDirty()) {
-		m_splineParams.startPoint = m_splineRenderer->GetCurve().m_point1;
-		m_splineParams.midPoint = m_splineRenderer->GetCurve().m_point2;
-		m_splineParams.endPoint = m_splineRenderer->GetCurve().m_point3;
-		m_splineParams.width = m_splineWidth;
-		m_splineParams.length = m_splineRenderer->GetCurve().InterpolateLength(1.0f);
+		m_splineParams.length = m_splineRenderer->GetCurve().GetLength();
+		WriteCurve();
 
 		commandList->SetComputeRootSignature(m_computeProgram->GetRootSignature().Get());
-		commandList->SetComputeRoot32BitConstants(m_curveRootIndex, 12, &m_splineParams, 0);
+		commandList->SetComputeRoot32BitConstants(m_curveRootIndex, sizeof(SplineParameters) / 4, &m_splineParams, 0);
 		commandList->SetComputeRootDescriptorTable(m_vertexRootIndex, m_vertexBufferHandle);
+		commandList->SetComputeRootDescriptorTable(m_curvePointRootIndex, m_curvePointHandle);
+		commandList->SetComputeRootDescriptorTable(m_arcLengthRootIndex, m_arcLengthHandle);
 		commandList->SetPipelineState(m_computePipeline.Get());
 
 		D3D12_RESOURCE_BARRIER uavVertexBarrier
@@ -242,7 +262,8 @@ void QuantumEngine::Rendering::DX12::DX12SplineRasterPipelineModule::Render(ComP
 		};
 		commandList->ResourceBarrier(1, &uavVertexBarrier);
 
-		commandList->Dispatch(m_splineRenderer->GetSegments() + 1, 1, 1);
+		// 32 threads per group in curve_mesh_compute.cs.hlsl
+		commandList->Dispatch((m_splineRenderer->GetSegments() + 32) / 32, 1, 1);
 
 		D3D12_RESOURCE_BARRIER uavVertexEndBarrier = uavVertexBarrier;
 		uavVertexEndBarrier.Transition.StateBefore = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
@@ -287,5 +308,52 @@ UInt32 QuantumEngine::Rendering::DX12::DX12SplineRasterPipelineModule::BindDescr
 	m_device->CreateUnorderedAccessView(m_vertexBuffer.Get(), nullptr, &uavDesc, cpuHandle);
 	m_vertexBufferHandle = gpuHandle;
 
-	return 1;
+	auto& curve = m_splineRenderer->GetCurve();
+	D3D12_SHADER_RESOURCE_VIEW_DESC curveView{
+	.Format = DXGI_FORMAT_UNKNOWN,
+	.ViewDimension = D3D12_SRV_DIMENSION_BUFFER,
+	.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING,
+	.Buffer = D3D12_BUFFER_SRV{
+		.FirstElement = 0,
+		.NumElements = (UInt32)curve.GetBezierPoints().size(),
+		.StructureByteStride = 4 * sizeof(Float),
+		.Flags = D3D12_BUFFER_SRV_FLAG_NONE,
+		},
+	};
+
+	cpuHandle.ptr += incrementSize;
+	gpuHandle.ptr += incrementSize;
+	m_device->CreateShaderResourceView(m_curvePointBuffer.Get(), &curveView, cpuHandle);
+	m_curvePointHandle = gpuHandle;
+
+	curveView.Buffer.NumElements = (UInt32)curve.GetArcLengths().size();
+	curveView.Buffer.StructureByteStride = sizeof(Float);
+	cpuHandle.ptr += incrementSize;
+	gpuHandle.ptr += incrementSize;
+	m_device->CreateShaderResourceView(m_arcLengthBuffer.Get(), &curveView, cpuHandle);
+	m_arcLengthHandle = gpuHandle;
+
+	return 3;
+}
+
+void QuantumEngine::Rendering::DX12::DX12SplineRasterPipelineModule::WriteCurve()
+{
+	auto& curve = m_splineRenderer->GetCurve();
+	Float* pointData;
+	m_curvePointBuffer->Map(0, nullptr, reinterpret_cast<void**>(&pointData));
+
+	for (auto& point : curve.GetBezierPoints()) {
+		pointData[0] = point.x;
+		pointData[1] = point.y;
+		pointData[2] = point.z;
+		pointData[3] = 0.0f;
+		pointData += 4;
+	}
+
+	m_curvePointBuffer->Unmap(0, nullptr);
+
+	void* lengthData;
+	m_arcLengthBuffer->Map(0, nullptr, &lengthData);
+	std::memcpy(lengthData, curve.GetArcLengths().data(), sizeof(Float) * curve.GetArcLengths().size());
+	m_arcLengthBuffer->Unmap(0, nullptr);
 }
@@ -37,13 +37,12 @@ namespace QuantumEngine::Rendering::DX12 {
 		}
 	};
 
+	/// <summary>
+	/// CurveProps of curve_mesh_compute.cs.hlsl
+	/// </summary>
 	struct SplineParameters {
-		Vector3 startPoint;
-		float width;
-		Vector3 midPoint;
+		UInt32 segmentCount;
 		float length;
-		Vector3 endPoint;
-		float padding;
 	};
 
 
@@ -55,6 +54,8 @@ namespace QuantumEngine::Rendering::DX12 {
 		void Render(ComPtr<ID3D12GraphicsCommandList7>& commandList, D3D12_GPU_DESCRIPTOR_HANDLE camHandle, D3D12_GPU_DESCRIPTOR_HANDLE lightHandle);
 		UInt32 BindDescriptorToResources(const ComPtr<ID3D12DescriptorHeap>& descriptorHeap, UInt32 offset);
 	private:
+		void WriteCurve();
+
 		ref<SplineRenderer> m_splineRenderer;
 
 		ComPtr<ID3D12Resource2> m_vertexBuffer;
@@ -80,5 +81,13 @@ namespace QuantumEngine::Rendering::DX12 {
 		UInt32 m_curveRootIndex;
 		UInt32 m_vertexRootIndex;
 		D3D12_GPU_DESCRIPTOR_HANDLE m_vertexBufferHandle;
+
+		// bezier points as float4 and arc length table of the curve, their sizes never change
+		ComPtr<ID3D12Resource2> m_curvePointBuffer;
+		ComPtr<ID3D12Resource2> m_arcLengthBuffer;
+		UInt32 m_curvePointRootIndex;
+		UInt32 m_arcLengthRootIndex;
+		D3D12_GPU_DESCRIPTOR_HANDLE m_curvePointHandle;
+		D3D12_GPU_DESCRIPTOR_HANDLE m_arcLengthHandle;
 	};
 }
@@ -6,6 +6,11 @@ const std::map<QuantumEngine::TextureFormat, DXGI_FORMAT> QuantumEngine::Renderi
 	{QuantumEngine::TextureFormat::Unknown, DXGI_FORMAT_UNKNOWN},
 	{QuantumEngine::TextureFormat::RGBA32, DXGI_FORMAT_R8G8B8A8_UNORM},
 	{QuantumEngine::TextureFormat::BGRA32, DXGI_FORMAT_B8G8R8A8_UNORM},
+	{QuantumEngine::TextureFormat::RGBA64F, DXGI_FORMAT_R16G16B16A16_FLOAT},
+	{QuantumEngine::TextureFormat::BC1, DXGI_FORMAT_BC1_UNORM},
+	{QuantumEngine::TextureFormat::BC3, DXGI_FORMAT_BC3_UNORM},
+	{QuantumEngine::TextureFormat::BC5, DXGI_FORMAT_BC5_UNORM},
+	{QuantumEngine::TextureFormat::BC7, DXGI_FORMAT_BC7_UNORM},
 };
 
 QuantumEngine::Rendering::DX12::DX12Texture2DController::DX12Texture2DController(const ref<Texture2D>& texture)
@@ -16,6 +21,33 @@ QuantumEngine::Rendering::DX12::DX12Texture2DController::DX12Texture2DController
 bool QuantumEngine::Rendering::DX12::DX12Texture2DController::Initialize(const ComPtr<ID3D12Device10>& device) {
 	m_dxFormat = m_texFormatMaps.at(m_texture->GetFormat());
 	
+	D3D12_HEAP_PROPERTIES bufferHeapProps{};
+	bufferHeapProps.Type = D3D12_HEAP_TYPE_DEFAULT;
+	bufferHeapProps.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+	bufferHeapProps.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+	bufferHeapProps.CreationNodeMask = 0;
+	bufferHeapProps.VisibleNodeMask = 0;
+	
+	D3D12_RESOURCE_DESC bufferDesc
+	{
+	bufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D,
+	bufferDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT,
+	bufferDesc.Width = m_texture->GetWidth(),
+	bufferDesc.Height = m_texture->GetHeight(),
+	bufferDesc.DepthOrArraySize = 1,
+	bufferDesc.MipLevels = (UInt16)m_texture->GetMipLevelCount(),
+	bufferDesc.Format = m_dxFormat,
+	bufferDesc.SampleDesc.Count = 1,
+	bufferDesc.SampleDesc.Quality = 0,
+	bufferDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN,
+	bufferDesc.Flags = D3D12_RESOURCE_FLAG_NONE,
+	};
+
+	// rows of each level are padded to the copy pitch alignment in the upload buffer
+	UInt64 uploadSize = 0;
+	m_footprints.resize(m_texture->GetMipLevelCount());
+	device->GetCopyableFootprints(&bufferDesc, 0, (UInt32)m_footprints.size(), 0, m_footprints.data(), nullptr, nullptr, &uploadSize);
+
 	D3D12_HEAP_PROPERTIES uploadHeapProps
 	{
 	.Type = D3D12_HEAP_TYPE_UPLOAD,
@@ -29,7 +61,7 @@ bool QuantumEngine::Rendering::DX12::DX12Texture2DController::Initialize(const C
 	{
 	uploadBufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
 	uploadBufferDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT,
-	uploadBufferDesc.Width = m_texture->GetTotalSize(),
+	uploadBufferDesc.Width = uploadSize,
 	uploadBufferDesc.Height = 1,
 	uploadBufferDesc.DepthOrArraySize = 1,
 	uploadBufferDesc.MipLevels = 1,
@@ -44,28 +76,6 @@ bool QuantumEngine::Rendering::DX12::DX12Texture2DController::Initialize(const C
 		D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(&m_uploadTextureBuffer))))
 		return false;
 
-	D3D12_HEAP_PROPERTIES bufferHeapProps{};
-	bufferHeapProps.Type = D3D12_HEAP_TYPE_DEFAULT;
-	bufferHeapProps.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
-	bufferHeapProps.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
-	bufferHeapProps.CreationNodeMask = 0;
-	bufferHeapProps.VisibleNodeMask = 0;
-	
-	D3D12_RESOURCE_DESC bufferDesc
-	{
-	bufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D,
-	bufferDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT,
-	bufferDesc.Width = m_texture->GetWidth(),
-	bufferDesc.Height = m_texture->GetHeight(),
-	bufferDesc.DepthOrArraySize = 1,
-	bufferDesc.MipLevels = 1,
-	bufferDesc.Format = m_dxFormat,
-	bufferDesc.SampleDesc.Count = 1,
-	bufferDesc.SampleDesc.Quality = 0,
-	bufferDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN,
-	bufferDesc.Flags = D3D12_RESOURCE_FLAG_NONE,
-	};
-
 	if (FAILED(device->CreateCommittedResource(&bufferHeapProps, D3D12_HEAP_FLAG_NONE, &bufferDesc,
 		D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(&m_tectureResource))))
 		return false;
@@ -94,37 +104,31 @@ bool QuantumEngine::Rendering::DX12::DX12Texture2DController::Initialize(const C
 
 void QuantumEngine::Rendering::DX12::DX12Texture2DController::UploadToGPU(ComPtr<ID3D12GraphicsCommandList7>& uploadCommandList)
 {
-	auto meshData = m_texture->GetData();
-	auto size = m_texture->GetTotalSize();
-	void* uploadAddress;
-	D3D12_RANGE range;
-	range.Begin = 0;
-	range.End = size - 1;
-	m_uploadTextureBuffer->Map(0, &range, &uploadAddress);
-	std::memcpy(uploadAddress, meshData, range.End);
-	m_uploadTextureBuffer->Unmap(0, &range);
-	D3D12_BOX srcBox{
-		.left = 0,
-		.top = 0,
-		.front = 0,
-		.right = m_texture->GetWidth(),
-		.bottom = m_texture->GetHeight(),
-		.back = 1,
-	};
+	Byte* uploadAddress;
+	m_uploadTextureBuffer->Map(0, nullptr, (void**)&uploadAddress);
 
-	D3D12_TEXTURE_COPY_LOCATION srcTexLocation{};
-	srcTexLocation.pResource = m_uploadTextureBuffer.Get();
-	srcTexLocation.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
-	srcTexLocation.PlacedFootprint.Offset = 0;
-	srcTexLocation.PlacedFootprint.Footprint.Width = m_texture->GetWidth();
-	srcTexLocation.PlacedFootprint.Footprint.Height = m_texture->GetHeight();
-	srcTexLocation.PlacedFootprint.Footprint.Depth = 1;
-	srcTexLocation.PlacedFootprint.Footprint.RowPitch = m_texture->GetWidth() * m_texture->GetBytePerPixel();
-	srcTexLocation.PlacedFootprint.Footprint.Format = m_dxFormat;
-
-	D3D12_TEXTURE_COPY_LOCATION destTexLocation{};
-	destTexLocation.pResource = m_tectureResource.Get();
-	destTexLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
-	destTexLocation.SubresourceIndex = 0;
-	uploadCommandList->CopyTextureRegion(&destTexLocation, 0, 0, 0, &srcTexLocation, &srcBox);
+	for (UInt32 level = 0; level < m_footprints.size(); level++) {
+		const D3D12_PLACED_SUBRESOURCE_FOOTPRINT& footprint = m_footprints[level];
+		const Byte* levelData = m_texture->GetMipData(level);
+		UInt32 rowSize = m_texture->GetMipRowSize(level);
+
+		// block compressed levels are copied a row of blocks at a time
+		for (UInt32 row = 0; row < m_texture->GetMipRowCount(level); row++)
+			std::memcpy(uploadAddress + footprint.Offset + row * footprint.Footprint.RowPitch, levelData + row * rowSize, rowSize);
+	}
+
+	m_uploadTextureBuffer->Unmap(0, nullptr);
+
+	for (UInt32 level = 0; level < m_footprints.size(); level++) {
+		D3D12_TEXTURE_COPY_LOCATION srcTexLocation{};
+		srcTexLocation.pResource = m_uploadTextureBuffer.Get();
+		srcTexLocation.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+		srcTexLocation.PlacedFootprint = m_footprints[level];
+
+		D3D12_TEXTURE_COPY_LOCATION destTexLocation{};
+		destTexLocation.pResource = m_tectureResource.Get();
+		destTexLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+		destTexLocation.SubresourceIndex = level;
+		uploadCommandList->CopyTextureRegion(&destTexLocation, 0, 0, 0, &srcTexLocation, nullptr);
+	}
 }
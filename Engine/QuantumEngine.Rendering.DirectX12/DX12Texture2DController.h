@@ -1,6 +1,7 @@
 #pragma once
 #include "BasicTypes.h"
 #include <map>
+#include <vector>
 #include "Rendering/GPUTexture2DController.h"
 
 using namespace Microsoft::WRL;
@@ -25,5 +26,7 @@ namespace QuantumEngine::Rendering::DX12 {
 		ComPtr<ID3D12Resource2> m_tectureResource;
 		const static std::map<TextureFormat, DXGI_FORMAT> m_texFormatMaps;
 		ComPtr<ID3D12DescriptorHeap> m_textureHeap;
+		// upload buffer layout of every mip level
+		std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> m_footprints;
 	};
 }
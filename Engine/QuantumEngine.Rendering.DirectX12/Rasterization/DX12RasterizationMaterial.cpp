@@ -89,14 +89,14 @@ void QuantumEngine::Rendering::DX12::Rasterization::DX12RasterizationMaterial::B
 void QuantumEngine::Rendering::DX12::Rasterization::DX12RasterizationMaterial::BindParameters(ComPtr<ID3D12GraphicsCommandList7>& commandList)
 {
 	// Update Modified Textures
-    for(auto& modified : m_material->GetModifiedTextures()) {
-        auto& heapData = m_heapValues[modified->fieldIndex];
+    m_material->ForEachModifiedTexture([&](MaterialTextureData& modified) {
+        auto& heapData = m_heapValues[modified.fieldIndex];
         m_device->CopyDescriptorsSimple(
             1,
             heapData.cpuHandle,
-            std::dynamic_pointer_cast<DX12Texture2DController>(modified->texture->GetGPUHandle())->GetShaderView()->GetCPUDescriptorHandleForHeapStart(),
+            std::dynamic_pointer_cast<DX12Texture2DController>(modified.texture->GetGPUHandle())->GetShaderView()->GetCPUDescriptorHandleForHeapStart(),
 			D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-	}
+	});
 
 	m_material->ClearModifiedTextures();
 
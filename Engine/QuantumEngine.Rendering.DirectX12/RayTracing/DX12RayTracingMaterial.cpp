@@ -264,21 +264,23 @@ void QuantumEngine::Rendering::DX12::RayTracing::DX12RayTracingMaterial::BindPar
 void QuantumEngine::Rendering::DX12::RayTracing::DX12RayTracingMaterial::UpdateModifiedParameters()
 {
 	// Update Modified Textures
-	for (auto& modified : m_material->GetModifiedTextures()) {
-		auto& heapData = m_heapValues[modified->fieldIndex];
+	m_material->ForEachModifiedTexture([&](MaterialTextureData& modified) {
+		auto& heapData = m_heapValues[modified.fieldIndex];
 		m_device->CopyDescriptorsSimple(
 			1,
 			heapData.cpuHandle,
-			std::dynamic_pointer_cast<DX12Texture2DController>(modified->texture->GetGPUHandle())->GetShaderView()->GetCPUDescriptorHandleForHeapStart(),
+			std::dynamic_pointer_cast<DX12Texture2DController>(modified.texture->GetGPUHandle())->GetShaderView()->GetCPUDescriptorHandleForHeapStart(),
 			D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-	}
+	});
 
-	for (auto& modifiedVal : m_material->GetModifiedValues()) {
-		auto& cbData = m_constantRegisterValues[modifiedVal->fieldIndex];
+	// shader records live in the persistently mapped shader table, values are written straight into every record using them
+	m_material->ForEachModifiedValue([&](MaterialValueData& modifiedVal) {
+		auto& cbData = m_constantRegisterValues[modifiedVal.fieldIndex];
 
 		for (auto g : m_linkedLocations)
 			std::memcpy(g + cbData.locationOffset, cbData.dataLocation , cbData.size);
-	}
+	});
 
 	m_material->ClearModifiedTextures();
+	m_material->ClearModifiedValues();
 }
@@ -46,6 +46,7 @@ bool QuantumEngine::Rendering::DX12::RayTracing::DX12RayTracingPipelineModule::I
 		auto rtProgram = std::dynamic_pointer_cast<RayTracing::HLSLRayTracingProgram>(rtMaterial->GetProgram());
 		auto dxMaterial = std::make_shared<DX12::RayTracing::DX12RayTracingMaterial>(rtMaterial, rtProgram);
 		dxMaterialMap.emplace(rtMaterial, dxMaterial);
+		m_modifiedMaterialLookup.emplace(rtMaterial.get(), dxMaterial);
 		rtHeapsize += dxMaterial->GetNonGlobalResourceCounts();
 	}
 
@@ -74,11 +75,7 @@ bool QuantumEngine::Rendering::DX12::RayTracing::DX12RayTracingPipelineModule::I
 	gpuStartHandle.ptr += incSize;
 
 	// Light
-	rDesc = light->GetDesc();
-	D3D12_CONSTANT_BUFFER_VIEW_DESC lightViewDesc;
-	lightViewDesc.BufferLocation = light->GetGPUVirtualAddress();
-	lightViewDesc.SizeInBytes = rDesc.Width;
-	m_device->CreateConstantBufferView(&lightViewDesc, heapStartHandle);
+	DX12LightManager::CreateShaderView(m_device, light, heapStartHandle);
 	auto lightHandle = gpuStartHandle;
 
 	heapStartHandle.ptr += incSize;
@@ -166,8 +163,15 @@ bool QuantumEngine::Rendering::DX12::RayTracing::DX12RayTracingPipelineModule::I
 
 void QuantumEngine::Rendering::DX12::RayTracing::DX12RayTracingPipelineModule::RenderCommand(ComPtr<ID3D12GraphicsCommandList7>& commandList, const ref<Camera>& camera)
 {
-	for (auto& mat : dxMaterialMap)
-		mat.second->UpdateModifiedParameters();
+	// only materials changed since the last frame are visited, all of their fields are written in one pass
+	for (Material* material : Material::GetModifiedMaterials()) {
+		auto it = m_modifiedMaterialLookup.find(material);
+
+		if (it != m_modifiedMaterialLookup.end())
+			it->second->UpdateModifiedParameters();
+	}
+
+	Material::RemoveUnmodifiedMaterials();
 
 	Matrix4 v = camera->ViewMatrix();
 	m_TLASController->UpdateTransforms(commandList, v);
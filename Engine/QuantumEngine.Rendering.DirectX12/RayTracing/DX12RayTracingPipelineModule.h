@@ -56,6 +56,8 @@ namespace QuantumEngine::Rendering::DX12::RayTracing {
 		ref<RayTracing::DX12RayTracingMaterial> m_globalRTMaterial;
 		ComPtr<ID3D12DescriptorHeap> m_rtHeap;
 		std::map<ref<Material>, ref<RayTracing::DX12RayTracingMaterial>> dxMaterialMap;
+		// same materials keyed by the raw pointer, to look up the entries of Material::GetModifiedMaterials
+		std::map<Material*, ref<RayTracing::DX12RayTracingMaterial>> m_modifiedMaterialLookup;
 		D3D12_DISPATCH_RAYS_DESC m_raytraceDesc;
 	};
 }
@@ -1,5 +1,7 @@
 #include "vulkan-pch.h"
 #include "SPIRVReflection.h"
+#include "VulkanBindlessTable.h"
+#include "VulkanUtilities.h"
 #include <algorithm>
 
 void QuantumEngine::Rendering::Vulkan::SPIRVReflection::AddShaderReflection(const SpvReflectShaderModule* shaderReflectionModule, bool isRayTracing)
@@ -141,7 +143,7 @@ UInt32 QuantumEngine::Rendering::Vulkan::SPIRVReflection::GetDynamicDescriptorCo
 	return UInt32(h);
 }
 
-void QuantumEngine::Rendering::Vulkan::SPIRVReflection::CreatePipelineLayout(const VkDevice device, VkShaderStageFlags stageFlags, const VkSampler sampler, VkPipelineLayout* pipelineLayout, VkDescriptorSetLayout* descriptorSetLayout)
+void QuantumEngine::Rendering::Vulkan::SPIRVReflection::CreatePipelineLayout(const VkDevice device, VkShaderStageFlags stageFlags, const VkSampler sampler, VkPipelineLayout* pipelineLayout, VkDescriptorSetLayout* descriptorSetLayout, const VulkanBindlessTable* bindlessTable)
 {
 	std::vector<VkPushConstantRange> pushConstantRanges;
 	pushConstantRanges.reserve(1);
@@ -155,16 +157,18 @@ void QuantumEngine::Rendering::Vulkan::SPIRVReflection::CreatePipelineLayout(con
 	VkDescriptorType desType = VK_DESCRIPTOR_TYPE_MAX_ENUM;
 
 	std::vector<std::vector<VkDescriptorSetLayoutBinding>> descriptorLayoutBindings(GetDescriptorLayoutCount());
-	std::vector<std::vector<VkDescriptorBindingFlags>> bindingFlags(GetDescriptorLayoutCount());
+	std::vector<VkDescriptorSetLayout> bindlessLayouts(GetDescriptorLayoutCount(), VK_NULL_HANDLE);
 
 	for (auto& descriptor : m_descripters) {
-		bindingFlags[descriptor.data.set].push_back(descriptor.isDynamicArray ? VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT |
-			VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT : 0);
+		if (descriptor.isDynamicArray && bindlessTable != nullptr) {
+			bindlessLayouts[descriptor.data.set] = bindlessTable->GetSetLayout(descriptor.descriptorType);
+			continue;
+		}
 
 		descriptorLayoutBindings[descriptor.data.set].push_back(VkDescriptorSetLayoutBinding{
 			.binding = descriptor.data.binding,
 			.descriptorType = descriptor.descriptorType,
-			.descriptorCount = descriptor.isDynamicArray ? 200 : descriptor.data.count, //TODO fix te hard-coded size
+			.descriptorCount = descriptor.data.count,
 			.stageFlags = stageFlags,
 			.pImmutableSamplers = nullptr,
 		});
@@ -188,10 +192,11 @@ void QuantumEngine::Rendering::Vulkan::SPIRVReflection::CreatePipelineLayout(con
 	}
 
 	for (UInt32 i = 0; i < descriptorLayoutBindings.size(); i++) {
-		VkDescriptorSetLayoutBindingFlagsCreateInfo createInfoFlag{};
-		createInfoFlag.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
-		createInfoFlag.bindingCount = (UInt32)bindingFlags[i].size();         
-		createInfoFlag.pBindingFlags = bindingFlags[i].data();
+		// owned by the bindless table
+		if (bindlessLayouts[i] != VK_NULL_HANDLE) {
+			descriptorSetLayout[i] = bindlessLayouts[i];
+			continue;
+		}
 
 		VkDescriptorSetLayoutCreateInfo descriptorCreateInfo{
 		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
@@ -222,7 +227,9 @@ void QuantumEngine::Rendering::Vulkan::SPIRVReflection::CreatePipelineLayout(con
 QuantumEngine::Rendering::MaterialReflection QuantumEngine::Rendering::Vulkan::SPIRVReflection::CreateMaterialReflection()
 {
 	UInt32 fieldIndex = 0;
+	UInt32 textureIndex = 0;
 	MaterialReflection reflectionData;
+	std::string bindlessIndexSuffix = HLSL_RASTER_TEXTURE_INDEX_SUFFIX;
 
 	for (auto& pushConstBlock : m_pushConstant.blocks) {
 		if (pushConstBlock.isDynamic) {// Skip internal root constants
@@ -238,18 +245,35 @@ QuantumEngine::Rendering::MaterialReflection QuantumEngine::Rendering::Vulkan::S
 			};
 			reflectionData.valueFields.push_back(valueFieldInfo);
 			fieldIndex++;
+
+			// rasterization textures are pushed as their bindless index, the index stays a value field so the block is pushed in one piece
+			if (rootVar.name.size() > bindlessIndexSuffix.size()
+				&& rootVar.name.compare(rootVar.name.size() - bindlessIndexSuffix.size(), bindlessIndexSuffix.size(), bindlessIndexSuffix) == 0) {
+				reflectionData.textureFields.push_back(MaterialTextureFieldInfo{
+					.name = rootVar.name.substr(0, rootVar.name.size() - bindlessIndexSuffix.size()),
+					.fieldIndex = textureIndex,
+					});
+				textureIndex++;
+			}
 		}
 	}
 
-	UInt32 textureIndex = 0;
+	std::string indicesSuffix = HLSL_RT_TEXTURE_INDICES_SUFFIX;
+
 	for (auto& descriptor : m_descripters) {
+		if (descriptor.isDynamicArray) // Arrays of the bindless table, textures are found by their indices
+			continue;
+
 		if (descriptor.name[0] == '_') {// Skip internal variables
 			textureIndex++;
 			continue;
 		}
 
+		bool isTextureIndices = descriptor.name.size() > indicesSuffix.size()
+			&& descriptor.name.compare(descriptor.name.size() - indicesSuffix.size(), indicesSuffix.size(), indicesSuffix) == 0;
+
 		MaterialTextureFieldInfo textureFieldInfo{
-			.name = descriptor.isDynamicArray ? descriptor.name.substr(0, descriptor.name.size() - 5) : descriptor.name,
+			.name = isTextureIndices ? descriptor.name.substr(0, descriptor.name.size() - indicesSuffix.size()) : descriptor.name,
 			.fieldIndex = textureIndex,
 		};
 
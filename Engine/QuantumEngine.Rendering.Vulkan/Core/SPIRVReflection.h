@@ -3,6 +3,8 @@
 #include <Rendering/Material.h>
 
 namespace QuantumEngine::Rendering::Vulkan {
+	class VulkanBindlessTable;
+
 	struct PushConstantVariableData {
 		std::string name;
 		SpvReflectBlockVariable variableDesc;
@@ -36,7 +38,10 @@ namespace QuantumEngine::Rendering::Vulkan {
 		void AddShaderReflection(const SpvReflectShaderModule* shaderReflection, bool isRayTracing = false);
 		UInt32 GetDescriptorLayoutCount();
 		UInt32 GetDynamicDescriptorCount();
-		void CreatePipelineLayout(const VkDevice device, VkShaderStageFlags stageFlags, const VkSampler sampler, VkPipelineLayout* pipelineLayout, VkDescriptorSetLayout* m_descriptorSetLayout);
+		/// <summary>
+		/// creates a layout for every set, sets holding unbounded arrays use the layouts of the bindless table instead
+		/// </summary>
+		void CreatePipelineLayout(const VkDevice device, VkShaderStageFlags stageFlags, const VkSampler sampler, VkPipelineLayout* pipelineLayout, VkDescriptorSetLayout* m_descriptorSetLayout, const VulkanBindlessTable* bindlessTable = nullptr);
 		MaterialReflection CreateMaterialReflection();
 		inline PushConstantBufferData& GetPushConstants() { return m_pushConstant; }
 		PushConstantBlockData* GetPushConstantBlockData(const std::string& name);
@@ -6,6 +6,9 @@
 #include "VulkanUtilities.h"
 #include "Core/Texture2D.h"
 #include "VulkanTexture2DController.h"
+#include "VulkanBindlessTable.h"
+#include "VulkanDeviceManager.h"
+#include "VulkanBufferFactory.h"
 
 QuantumEngine::Rendering::Vulkan::VulkanAssetManager::VulkanAssetManager(const VkDevice device, VkPhysicalDevice physicalDevice)
 	: m_device(device), m_physicalDevice(physicalDevice)
@@ -45,6 +48,31 @@ bool QuantumEngine::Rendering::Vulkan::VulkanAssetManager::Initializes(UInt32 fa
 	if(vkAllocateCommandBuffers(m_device, &allocInfo, &m_commandBuffer) != VK_SUCCESS)
 		return false;
 
+	m_bindlessTable = VulkanDeviceManager::Instance()->GetBindlessTable();
+
+	// texture fields point to one white texel until they are assigned, sampling it leaves the material color unchanged
+	Byte whiteTexel[4] = { 255, 255, 255, 255 };
+
+	TextureProperties fallbackProperties;
+	fallbackProperties.width = 1;
+	fallbackProperties.height = 1;
+	fallbackProperties.size = sizeof(whiteTexel);
+	fallbackProperties.bpp = 32;
+	fallbackProperties.channelCount = 4;
+	fallbackProperties.format = TextureFormat::RGBA32;
+	fallbackProperties.copyPixelData = true;
+	fallbackProperties.data = whiteTexel;
+
+	m_fallbackTexture = std::make_shared<Texture2D>(fallbackProperties);
+	UploadTextureToGPU(m_fallbackTexture);
+
+	auto fallbackController = std::dynamic_pointer_cast<VulkanTexture2DController>(m_fallbackTexture->GetGPUHandle());
+
+	if (fallbackController == nullptr)
+		return false;
+
+	m_bindlessTable->SetFallbackImageIndex(fallbackController->GetBindlessIndex());
+
 	return true;
 }
 
@@ -60,6 +88,14 @@ void QuantumEngine::Rendering::Vulkan::VulkanAssetManager::UploadTextureToGPU(co
 	if (gpuTexture->Initialize(m_memoryProperties) == false)
 		return;
 
+	// the texture is not uploaded if shaders can't reach it
+	UInt32 bindlessIndex = m_bindlessTable->AddImage(gpuTexture->GetImageView());
+
+	if (bindlessIndex == UINT32_MAX)
+		return;
+
+	gpuTexture->SetBindlessIndex(m_bindlessTable, bindlessIndex);
+
 	VkBufferCreateInfo stageBufferCreateInfo{
 		.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
 		.pNext = nullptr,
@@ -127,6 +163,9 @@ void QuantumEngine::Rendering::Vulkan::VulkanAssetManager::UploadMeshesToGPU(con
 
 	for(auto& mesh : meshes)
 	{
+		if (mesh->IsUploadedToGPU()) // mesh has already been uploaded
+			continue;
+
 		auto meshPairIt = meshPairs.emplace(mesh, nullptr);
 
 		if(meshPairIt.second == false)
@@ -136,10 +175,13 @@ void QuantumEngine::Rendering::Vulkan::VulkanAssetManager::UploadMeshesToGPU(con
 		if (meshController->Initialize(&m_memoryProperties)) {
 			(*(meshPairIt.first)).second = meshController;
 
-			totalVBSize += mesh->GetTotalSize();
+			totalVBSize += mesh->GetPackedTotalSize();
 		}
 	}
 
+	if (meshPairs.empty())
+		return;
+
 	VkBufferCreateInfo stageBufferCreateInfo{
 		.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
 		.pNext = nullptr,
@@ -188,12 +230,12 @@ void QuantumEngine::Rendering::Vulkan::VulkanAssetManager::UploadMeshesToGPU(con
 
 	for(auto& meshPair : meshPairs)
 	{
-		meshPair.first->CopyVertexData(dataPtr);
-		dataPtr += sizeof(Vertex) * meshPair.first->GetVertexCount();
-		meshPair.first->CopyIndexData(dataPtr);
-		dataPtr += sizeof(UInt32) * meshPair.first->GetIndexCount();
+		meshPair.first->CopyPackedVertexData(dataPtr);
+		dataPtr += meshPair.first->GetPackedVertexSize();
+		meshPair.first->CopyPackedIndexData(dataPtr);
+		dataPtr += meshPair.first->GetPackedIndexSize();
 		meshPair.second->CopyCommand(m_commandBuffer, stageBuffer, offset);
-		offset += meshPair.first->GetTotalSize();
+		offset += meshPair.first->GetPackedTotalSize();
 	}
 
 	vkUnmapMemory(m_device, stageBufferMemory);
@@ -216,3 +258,64 @@ void QuantumEngine::Rendering::Vulkan::VulkanAssetManager::UploadMeshesToGPU(con
 	vkDestroyBuffer(m_device, stageBuffer, nullptr);
 	vkFreeMemory(m_device, stageBufferMemory, nullptr);
 }
+
+bool QuantumEngine::Rendering::Vulkan::VulkanAssetManager::GetMeshStorageIndices(const ref<VulkanMeshController>& meshController, UInt32* vertexBufferIndex, UInt32* indexBufferIndex)
+{
+	if (meshController->GetVertexStorageIndex() == UINT32_MAX) {
+		VkBuffer vertexStorageBuffer;
+		VkBuffer indexStorageBuffer;
+		UInt32 copySize = meshController->GetStorageCopySize();
+
+		if (copySize == 0) {
+			meshController->CreateStorageBuffers(VK_NULL_HANDLE, VK_NULL_HANDLE, nullptr, &vertexStorageBuffer, &indexStorageBuffer);
+		}
+		else {
+			// quantized vertices and 16-bit indices are expanded into device local copies through a stage buffer
+			VkBuffer stageBuffer;
+			VkDeviceMemory stageBufferMemory;
+
+			if (VulkanDeviceManager::Instance()->GetBufferFactory()->CreateBuffer(copySize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &stageBuffer, &stageBufferMemory) == false)
+				return false;
+
+			VkCommandBufferBeginInfo beginInfo{};
+			beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+			vkBeginCommandBuffer(m_commandBuffer, &beginInfo);
+
+			void* data;
+			vkMapMemory(m_device, stageBufferMemory, 0, VK_WHOLE_SIZE, 0, &data);
+			meshController->CreateStorageBuffers(m_commandBuffer, stageBuffer, (Byte*)data, &vertexStorageBuffer, &indexStorageBuffer);
+			vkUnmapMemory(m_device, stageBufferMemory);
+
+			vkEndCommandBuffer(m_commandBuffer);
+
+			VkSubmitInfo submitInfo{};
+			submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			submitInfo.commandBufferCount = 1;
+			submitInfo.pCommandBuffers = &m_commandBuffer;
+
+			vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+			vkQueueWaitIdle(m_graphicsQueue);
+
+			vkDestroyBuffer(m_device, stageBuffer, nullptr);
+			vkFreeMemory(m_device, stageBufferMemory, nullptr);
+		}
+
+		UInt32 vertexIndex = m_bindlessTable->AddBuffer(vertexStorageBuffer);
+		UInt32 indexIndex = m_bindlessTable->AddBuffer(indexStorageBuffer);
+
+		if (vertexIndex == UINT32_MAX || indexIndex == UINT32_MAX) {
+			m_bindlessTable->RemoveBuffer(vertexIndex);
+			m_bindlessTable->RemoveBuffer(indexIndex);
+			return false;
+		}
+
+		meshController->SetStorageIndices(m_bindlessTable, vertexIndex, indexIndex);
+	}
+
+	*vertexBufferIndex = meshController->GetVertexStorageIndex();
+	*indexBufferIndex = meshController->GetIndexStorageIndex();
+	return true;
+}
@@ -3,6 +3,9 @@
 #include "Rendering/GPUAssetManager.h"
 
 namespace QuantumEngine::Rendering::Vulkan {
+	class VulkanBindlessTable;
+	class VulkanMeshController;
+
 	class VulkanAssetManager : public GPUAssetManager 
 	{
 	public:
@@ -12,6 +15,13 @@ namespace QuantumEngine::Rendering::Vulkan {
 		virtual void UploadMeshToGPU(const ref<Mesh>& mesh) override;
 		virtual void UploadTextureToGPU(const ref<Texture2D>& texture) override;
 		virtual void UploadMeshesToGPU(const std::vector<ref<Mesh>>& meshes) override;
+		inline const ref<VulkanBindlessTable>& GetBindlessTable() const { return m_bindlessTable; }
+
+		/// <summary>
+		/// adds the storage buffers read by hit shaders to the bindless table the first time a mesh is asked for
+		/// </summary>
+		/// <returns>false if the table has no room left for the buffers</returns>
+		bool GetMeshStorageIndices(const ref<VulkanMeshController>& meshController, UInt32* vertexBufferIndex, UInt32* indexBufferIndex);
 
 	private:
 		VkDevice m_device;
@@ -20,5 +30,7 @@ namespace QuantumEngine::Rendering::Vulkan {
 		VkCommandBuffer m_commandBuffer;
 		VkQueue m_graphicsQueue;
 		VkPhysicalDeviceMemoryProperties m_memoryProperties;
+		ref<VulkanBindlessTable> m_bindlessTable;
+		ref<Texture2D> m_fallbackTexture;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,285 @@
+#include "vulkan-pch.h"
+#include "VulkanBindlessTable.h"
+#include <algorithm>
+
+QuantumEngine::Rendering::Vulkan::VulkanBindlessTable::VulkanBindlessTable(const VkDevice device, const VkPhysicalDevice physicalDevice)
+	:m_device(device), m_physicalDevice(physicalDevice)
+{
+	m_buffers.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	m_images.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+}
+
+QuantumEngine::Rendering::Vulkan::VulkanBindlessTable::~VulkanBindlessTable()
+{
+	DestroyArray(m_buffers);
+	DestroyArray(m_images);
+}
+
+bool QuantumEngine::Rendering::Vulkan::VulkanBindlessTable::Initialize(UInt32 initialCapacity)
+{
+	VkPhysicalDeviceDescriptorIndexingProperties indexingProperties{};
+	indexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+
+	VkPhysicalDeviceProperties2 properties{};
+	properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	properties.pNext = &indexingProperties;
+
+	vkGetPhysicalDeviceProperties2(m_physicalDevice, &properties);
+
+	// both arrays are visible to every stage, so they share the per stage budget with the descriptors of the pipelines' own sets
+	UInt32 stageBudget = indexingProperties.maxPerStageUpdateAfterBindResources;
+	UInt32 arrayBudget = (stageBudget > ReservedStageResources ? stageBudget - ReservedStageResources : stageBudget / 2) / 2;
+
+	m_buffers.maxCapacity = std::min({ indexingProperties.maxDescriptorSetUpdateAfterBindStorageBuffers,
+		indexingProperties.maxPerStageDescriptorUpdateAfterBindStorageBuffers, arrayBudget, MaxDescriptorCount });
+	m_images.maxCapacity = std::min({ indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages,
+		indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages, arrayBudget, MaxDescriptorCount });
+
+	if (m_buffers.maxCapacity == 0 || m_images.maxCapacity == 0)
+		return false;
+
+	for (auto descriptorArray : { &m_buffers, &m_images }) {
+		if (CreateLayout(*descriptorArray) == false)
+			return false;
+
+		if (AllocateSet(std::min(std::max(initialCapacity, 1u), descriptorArray->maxCapacity), *descriptorArray) == false)
+			return false;
+	}
+
+	return true;
+}
+
+UInt32 QuantumEngine::Rendering::Vulkan::VulkanBindlessTable::AddBuffer(VkBuffer buffer)
+{
+	UInt32 index = Reserve(m_buffers);
+
+	if (index == UINT32_MAX)
+		return index;
+
+	VkDescriptorBufferInfo bufferInfo{
+		.buffer = buffer,
+		.offset = 0,
+		.range = VK_WHOLE_SIZE,
+	};
+
+	VkWriteDescriptorSet write{
+		.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+		.pNext = nullptr,
+		.dstSet = m_buffers.set,
+		.dstBinding = 0,
+		.dstArrayElement = index,
+		.descriptorCount = 1,
+		.descriptorType = m_buffers.descriptorType,
+		.pImageInfo = nullptr,
+		.pBufferInfo = &bufferInfo,
+		.pTexelBufferView = nullptr,
+	};
+
+	vkUpdateDescriptorSets(m_device, 1, &write, 0, nullptr);
+
+	return index;
+}
+
+UInt32 QuantumEngine::Rendering::Vulkan::VulkanBindlessTable::AddImage(VkImageView imageView)
+{
+	UInt32 index = Reserve(m_images);
+
+	if (index == UINT32_MAX)
+		return index;
+
+	VkDescriptorImageInfo imageInfo{
+		.sampler = VK_NULL_HANDLE,
+		.imageView = imageView,
+		.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+	};
+
+	VkWriteDescriptorSet write{
+		.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+		.pNext = nullptr,
+		.dstSet = m_images.set,
+		.dstBinding = 0,
+		.dstArrayElement = index,
+		.descriptorCount = 1,
+		.descriptorType = m_images.descriptorType,
+		.pImageInfo = &imageInfo,
+		.pBufferInfo = nullptr,
+		.pTexelBufferView = nullptr,
+	};
+
+	vkUpdateDescriptorSets(m_device, 1, &write, 0, nullptr);
+
+	return index;
+}
+
+void QuantumEngine::Rendering::Vulkan::VulkanBindlessTable::RemoveBuffer(UInt32 index)
+{
+	Release(m_buffers, index);
+}
+
+void QuantumEngine::Rendering::Vulkan::VulkanBindlessTable::RemoveImage(UInt32 index)
+{
+	Release(m_images, index);
+}
+
+VkDescriptorSetLayout QuantumEngine::Rendering::Vulkan::VulkanBindlessTable::GetSetLayout(VkDescriptorType descriptorType) const
+{
+	if (descriptorType == m_buffers.descriptorType)
+		return m_buffers.layout;
+
+	if (descriptorType == m_images.descriptorType)
+		return m_images.layout;
+
+	return VK_NULL_HANDLE;
+}
+
+VkDescriptorSet QuantumEngine::Rendering::Vulkan::VulkanBindlessTable::GetDescriptorSet(VkDescriptorSetLayout layout) const
+{
+	if (layout == m_buffers.layout)
+		return m_buffers.set;
+
+	if (layout == m_images.layout)
+		return m_images.set;
+
+	return VK_NULL_HANDLE;
+}
+
+bool QuantumEngine::Rendering::Vulkan::VulkanBindlessTable::CreateLayout(DescriptorArray& descriptorArray)
+{
+	VkDescriptorBindingFlags bindingFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT
+		| VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT;
+
+	VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+		.pNext = nullptr,
+		.bindingCount = 1,
+		.pBindingFlags = &bindingFlags,
+	};
+
+	// the layout declares the upper bound, the allocated sets only hold their capacity
+	VkDescriptorSetLayoutBinding binding{
+		.binding = 0,
+		.descriptorType = descriptorArray.descriptorType,
+		.descriptorCount = descriptorArray.maxCapacity,
+		.stageFlags = VK_SHADER_STAGE_ALL,
+		.pImmutableSamplers = nullptr,
+	};
+
+	VkDescriptorSetLayoutCreateInfo layoutInfo{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+		.pNext = &bindingFlagsInfo,
+		.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+		.bindingCount = 1,
+		.pBindings = &binding,
+	};
+
+	return vkCreateDescriptorSetLayout(m_device, &layoutInfo, nullptr, &descriptorArray.layout) == VK_SUCCESS;
+}
+
+bool QuantumEngine::Rendering::Vulkan::VulkanBindlessTable::AllocateSet(UInt32 capacity, DescriptorArray& descriptorArray)
+{
+	VkDescriptorPoolSize poolSize{
+		.type = descriptorArray.descriptorType,
+		.descriptorCount = capacity,
+	};
+
+	VkDescriptorPoolCreateInfo poolInfo{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+		.pNext = nullptr,
+		.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
+		.maxSets = 1,
+		.poolSizeCount = 1,
+		.pPoolSizes = &poolSize,
+	};
+
+	VkDescriptorPool pool;
+
+	if (vkCreateDescriptorPool(m_device, &poolInfo, nullptr, &pool) != VK_SUCCESS)
+		return false;
+
+	VkDescriptorSetVariableDescriptorCountAllocateInfo variableCountInfo{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO,
+		.pNext = nullptr,
+		.descriptorSetCount = 1,
+		.pDescriptorCounts = &capacity,
+	};
+
+	VkDescriptorSetAllocateInfo allocInfo{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+		.pNext = &variableCountInfo,
+		.descriptorPool = pool,
+		.descriptorSetCount = 1,
+		.pSetLayouts = &descriptorArray.layout,
+	};
+
+	VkDescriptorSet set;
+
+	if (vkAllocateDescriptorSets(m_device, &allocInfo, &set) != VK_SUCCESS) {
+		vkDestroyDescriptorPool(m_device, pool, nullptr);
+		return false;
+	}
+
+	// the old set may still be bound by submitted work, growing only happens while loading so the device is drained first
+	if (descriptorArray.pool != VK_NULL_HANDLE) {
+		vkDeviceWaitIdle(m_device);
+
+		if (descriptorArray.count > 0) {
+			VkCopyDescriptorSet copy{
+				.sType = VK_STRUCTURE_TYPE_COPY_DESCRIPTOR_SET,
+				.pNext = nullptr,
+				.srcSet = descriptorArray.set,
+				.srcBinding = 0,
+				.srcArrayElement = 0,
+				.dstSet = set,
+				.dstBinding = 0,
+				.dstArrayElement = 0,
+				.descriptorCount = descriptorArray.count,
+			};
+
+			vkUpdateDescriptorSets(m_device, 0, nullptr, 1, &copy);
+		}
+
+		vkDestroyDescriptorPool(m_device, descriptorArray.pool, nullptr);
+	}
+
+	descriptorArray.pool = pool;
+	descriptorArray.set = set;
+	descriptorArray.capacity = capacity;
+
+	return true;
+}
+
+UInt32 QuantumEngine::Rendering::Vulkan::VulkanBindlessTable::Reserve(DescriptorArray& descriptorArray)
+{
+	if (descriptorArray.freeSlots.empty() == false) {
+		UInt32 index = descriptorArray.freeSlots.back();
+		descriptorArray.freeSlots.pop_back();
+		return index;
+	}
+
+	if (descriptorArray.count == descriptorArray.capacity) {
+		if (descriptorArray.capacity == descriptorArray.maxCapacity)
+			return UINT32_MAX;
+
+		UInt32 capacity = std::min(std::max(descriptorArray.capacity * 2, 1u), descriptorArray.maxCapacity);
+
+		if (AllocateSet(capacity, descriptorArray) == false)
+			return UINT32_MAX;
+	}
+
+	return descriptorArray.count++;
+}
+
+void QuantumEngine::Rendering::Vulkan::VulkanBindlessTable::Release(DescriptorArray& descriptorArray, UInt32 index)
+{
+	if (index < descriptorArray.count)
+		descriptorArray.freeSlots.push_back(index);
+}
+
+void QuantumEngine::Rendering::Vulkan::VulkanBindlessTable::DestroyArray(DescriptorArray& descriptorArray)
+{
+	if (descriptorArray.pool != VK_NULL_HANDLE)
+		vkDestroyDescriptorPool(m_device, descriptorArray.pool, nullptr);
+
+	if (descriptorArray.layout != VK_NULL_HANDLE)
+		vkDestroyDescriptorSetLayout(m_device, descriptorArray.layout, nullptr);
+}
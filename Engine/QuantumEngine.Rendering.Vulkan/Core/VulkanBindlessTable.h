@@ -0,0 +1,80 @@
+#pragma once
+#include "vulkan-pch.h"
+#include <vector>
+
+namespace QuantumEngine::Rendering::Vulkan {
+	/// <summary>
+	/// Device wide descriptor table that pipelines index into. Storage buffers and sampled images each live in their own set
+	/// with one update-after-bind array. Resources keep their index until they are removed, removed slots are handed out again before the
+	/// array grows and a full array is reallocated with twice the capacity
+	/// </summary>
+	class VulkanBindlessTable {
+	public:
+		VulkanBindlessTable(const VkDevice device, const VkPhysicalDevice physicalDevice);
+		~VulkanBindlessTable();
+		bool Initialize(UInt32 initialCapacity);
+
+		/// <summary>
+		/// writes the buffer into the next free slot
+		/// </summary>
+		/// <returns>index of the buffer in the storage buffer array, UINT32_MAX when the device limit is reached</returns>
+		UInt32 AddBuffer(VkBuffer buffer);
+
+		/// <summary>
+		/// writes the image view into the next free slot
+		/// </summary>
+		/// <returns>index of the image in the sampled image array, UINT32_MAX when the device limit is reached</returns>
+		UInt32 AddImage(VkImageView imageView);
+
+		/// <summary>
+		/// frees a slot returned by AddBuffer or AddImage. The descriptor is left in place, shaders must not index the slot anymore
+		/// </summary>
+		void RemoveBuffer(UInt32 index);
+		void RemoveImage(UInt32 index);
+
+		/// <summary>
+		/// image that texture indices point to until a texture is assigned, set by the asset manager once it has uploaded one
+		/// </summary>
+		inline UInt32 GetFallbackImageIndex() const { return m_fallbackImageIndex; }
+		inline void SetFallbackImageIndex(UInt32 index) { m_fallbackImageIndex = index; }
+
+		inline VkDescriptorSetLayout GetBufferSetLayout() const { return m_buffers.layout; }
+		inline VkDescriptorSetLayout GetImageSetLayout() const { return m_images.layout; }
+		VkDescriptorSetLayout GetSetLayout(VkDescriptorType descriptorType) const;
+
+		/// <summary>
+		/// returns the set created with the layout, or VK_NULL_HANDLE if the layout is not owned by the table.
+		/// Sets change when the table grows, so pipelines fetch them every time they bind
+		/// </summary>
+		VkDescriptorSet GetDescriptorSet(VkDescriptorSetLayout layout) const;
+	private:
+		struct DescriptorArray {
+			VkDescriptorType descriptorType;
+			UInt32 count = 0;
+			UInt32 capacity = 0;
+			UInt32 maxCapacity = 0;
+			VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+			VkDescriptorPool pool = VK_NULL_HANDLE;
+			VkDescriptorSet set = VK_NULL_HANDLE;
+			// removed slots below count
+			std::vector<UInt32> freeSlots;
+		};
+
+		bool CreateLayout(DescriptorArray& descriptorArray);
+		bool AllocateSet(UInt32 capacity, DescriptorArray& descriptorArray);
+		UInt32 Reserve(DescriptorArray& descriptorArray);
+		void Release(DescriptorArray& descriptorArray, UInt32 index);
+		void DestroyArray(DescriptorArray& descriptorArray);
+
+		// upper bound of both arrays, drivers may report far more than a scene ever uses
+		static constexpr UInt32 MaxDescriptorCount = 1 << 20;
+		// part of maxPerStageUpdateAfterBindResources left to the other sets of a pipeline
+		static constexpr UInt32 ReservedStageResources = 1024;
+
+		VkDevice m_device;
+		VkPhysicalDevice m_physicalDevice;
+		DescriptorArray m_buffers;
+		DescriptorArray m_images;
+		UInt32 m_fallbackImageIndex = 0;
+	};
+}
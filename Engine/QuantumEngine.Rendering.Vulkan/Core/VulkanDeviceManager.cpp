@@ -8,6 +8,7 @@
 #include "VulkanAssetManager.h"
 #include "VulkanMaterialFactory.h"
 #include "VulkanBufferFactory.h"
+#include "VulkanBindlessTable.h"
 #include <set>
 
 QuantumEngine::Rendering::Vulkan::VulkanDeviceManager* QuantumEngine::Rendering::Vulkan::VulkanDeviceManager::s_instance;
@@ -122,6 +123,8 @@ bool QuantumEngine::Rendering::Vulkan::VulkanDeviceManager::Initialize()
 	requiredDeviceExtensions.push_back(VK_KHR_SPIRV_1_4_EXTENSION_NAME);
 	requiredDeviceExtensions.push_back(VK_KHR_SHADER_FLOAT_CONTROLS_EXTENSION_NAME);
 	requiredDeviceExtensions.push_back(VK_KHR_RAY_QUERY_EXTENSION_NAME);
+	// forward draws skipped by the G-buffer occlusion culling
+	requiredDeviceExtensions.push_back(VK_EXT_CONDITIONAL_RENDERING_EXTENSION_NAME);
 
 	for (auto& devicePtr : devices) {
 		vkGetPhysicalDeviceProperties(devicePtr, &deviceProperties);
@@ -148,8 +151,16 @@ bool QuantumEngine::Rendering::Vulkan::VulkanDeviceManager::Initialize()
 	float queuePriority = 1.0f;
 	Int32 graphicsQueueFamilyIndex = FindQueueFamilies(m_physicalDevice, VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT);
 
+	VkPhysicalDeviceFeatures supportedFeatures;
+	vkGetPhysicalDeviceFeatures(m_physicalDevice, &supportedFeatures);
+
 	VkPhysicalDeviceFeatures deviceFeatures{};
 	deviceFeatures.geometryShader = VK_TRUE;
+	// BC textures are rejected at upload where this isn't supported
+	deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+	// G-buffer indirect draws, firstInstance selects the entity transform
+	deviceFeatures.multiDrawIndirect = VK_TRUE;
+	deviceFeatures.drawIndirectFirstInstance = VK_TRUE;
 
 	std::set<UInt32> uniqueQueueFamilies = { (UInt32)graphicsQueueFamilyIndex, (UInt32)surfaceFamilyIndex };
 
@@ -185,14 +196,27 @@ bool QuantumEngine::Rendering::Vulkan::VulkanDeviceManager::Initialize()
 	rayQueryFeature.pNext = &rtPipelineFeature;
 	rayQueryFeature.rayQuery = VK_TRUE;
 
+	VkPhysicalDeviceConditionalRenderingFeaturesEXT conditionalRenderingFeature{};
+	conditionalRenderingFeature.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_CONDITIONAL_RENDERING_FEATURES_EXT;
+	conditionalRenderingFeature.pNext = &rayQueryFeature;
+	conditionalRenderingFeature.conditionalRendering = VK_TRUE;
+
 	VkPhysicalDeviceVulkan12Features enabled12{};
 	enabled12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
-	enabled12.pNext = &rayQueryFeature;
+	enabled12.pNext = &conditionalRenderingFeature;
 	enabled12.descriptorIndexing = VK_TRUE;
 	enabled12.runtimeDescriptorArray = VK_TRUE;
+	// bindless table
+	enabled12.descriptorBindingPartiallyBound = VK_TRUE;
+	enabled12.descriptorBindingVariableDescriptorCount = VK_TRUE;
+	enabled12.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+	enabled12.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+	enabled12.shaderStorageBufferArrayNonUniformIndexing = VK_TRUE;
+	enabled12.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
 	enabled12.bufferDeviceAddress = VK_TRUE;
 	enabled12.uniformBufferStandardLayout = VK_TRUE;
 	enabled12.scalarBlockLayout = VK_TRUE;
+	enabled12.drawIndirectCount = VK_TRUE;
 
 	// top-level features2
 	VkPhysicalDeviceFeatures2 features2{};
@@ -236,6 +260,11 @@ bool QuantumEngine::Rendering::Vulkan::VulkanDeviceManager::Initialize()
 
 	s_instance = this;
 	m_bufferFactory = std::make_shared<VulkanBufferFactory>(m_graphicDevice, m_physicalDevice);
+	m_bindlessTable = std::make_shared<VulkanBindlessTable>(m_graphicDevice, m_physicalDevice);
+
+	if (m_bindlessTable->Initialize(InitialBindlessCapacity) == false)
+		return false;
+
 	return true;
 }
 
@@ -289,6 +318,7 @@ QuantumEngine::Rendering::Vulkan::VulkanDeviceManager::~VulkanDeviceManager()
 	func(m_instance, m_debugMessenger, nullptr);
 #endif
 
+	m_bindlessTable.reset();
 	vkDestroyDevice(m_graphicDevice, nullptr);
 	vkDestroyInstance(m_instance, nullptr);
 }
@@ -15,6 +15,7 @@ namespace QuantumEngine {
 
 namespace QuantumEngine::Rendering::Vulkan {
 	class VulkanBufferFactory;
+	class VulkanBindlessTable;
 
 	class VulkanDeviceManager : public GPUDeviceManager
 	{
@@ -27,6 +28,7 @@ namespace QuantumEngine::Rendering::Vulkan {
 		virtual ref<MaterialFactory> CreateMaterialFactory() override;
 		~VulkanDeviceManager();
 		ref<VulkanBufferFactory> GetBufferFactory() const { return m_bufferFactory; }
+		const ref<VulkanBindlessTable>& GetBindlessTable() const { return m_bindlessTable; }
 		VkInstance GetVKInstance() const { return m_instance; }
 		VkDevice GetGraphicDevice() const { return m_graphicDevice; }
 		VkPhysicalDevice GetPhysicalDevice() const { return m_physicalDevice; }
@@ -62,5 +64,10 @@ namespace QuantumEngine::Rendering::Vulkan {
 		VkPhysicalDeviceAccelerationStructurePropertiesKHR m_accelProps;
 		VkPhysicalDeviceRayTracingPipelinePropertiesKHR m_rtPipelineProps;
 		ref<VulkanBufferFactory> m_bufferFactory;
+		// shared by the textures and meshes of every asset manager and by the pipelines indexing them
+		ref<VulkanBindlessTable> m_bindlessTable;
+
+		// starting size of each bindless array, the table doubles it whenever it fills
+		static constexpr UInt32 InitialBindlessCapacity = 64;
 	};
 }
\ No newline at end of file
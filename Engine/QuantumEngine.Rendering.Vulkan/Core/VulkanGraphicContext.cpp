@@ -22,6 +22,9 @@ QuantumEngine::Rendering::Vulkan::VulkanGraphicContext::VulkanGraphicContext(con
 
 QuantumEngine::Rendering::Vulkan::VulkanGraphicContext::~VulkanGraphicContext()
 {
+	if (m_mappedLightData != nullptr)
+		vkUnmapMemory(m_logicDevice, m_lightBufferMemory);
+
 	vkDestroyBuffer(m_logicDevice, m_lightBuffer, nullptr);
 	vkFreeMemory(m_logicDevice, m_lightBufferMemory, nullptr);
 	vkDestroyBuffer(m_logicDevice, m_cameraBuffer, nullptr);
@@ -50,28 +53,26 @@ void QuantumEngine::Rendering::Vulkan::VulkanGraphicContext::RegisterShaderRegis
 	m_shaderRegistery = std::dynamic_pointer_cast<VulkanShaderRegistery>(shaderRegistery);
 }
 
-bool QuantumEngine::Rendering::Vulkan::VulkanGraphicContext::InitializeLightBuffer(const SceneLightData& lightData)
+bool QuantumEngine::Rendering::Vulkan::VulkanGraphicContext::InitializeLightBuffer(const ref<SceneLightData>& lightData)
 {
-	UInt32 lightSize = 10 * (sizeof(DirectionalLight) + sizeof(PointLight)) + 2 * sizeof(UInt32);
-	bool result =  m_bufferFactory->CreateBuffer(lightSize, 1, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+	m_lights = lightData;
+	m_lightClusterGrid.Initialize(*lightData);
+	UInt32 lightSize = m_lightClusterGrid.GetBufferSize();
+	bool result =  m_bufferFactory->CreateBuffer(lightSize, 1, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
 		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
 		&m_lightBuffer, &m_lightBufferMemory, &m_lightStride);
 
 	if(result == false)
 		return false;
 
+	// the clusters are rewritten every frame, keep the buffer mapped
 	void* data;
-	vkMapMemory(m_logicDevice, m_lightBufferMemory, 0, VK_WHOLE_SIZE, 0, &data);
-	Byte* pData = (Byte*)data;
-	std::memcpy(pData, (void*)lightData.directionalLights.data(), lightData.directionalLights.size() * sizeof(DirectionalLight));
-	pData += 10 * (sizeof(DirectionalLight));
-	std::memcpy(pData, (void*)lightData.pointLights.data(), lightData.pointLights.size() * sizeof(PointLight));
-	pData += 10 * (sizeof(PointLight));
-	UInt32* sizeData = (UInt32*)(pData);
-	*sizeData = lightData.directionalLights.size();
-	sizeData++;
-	*sizeData = lightData.pointLights.size();
-	vkUnmapMemory(m_logicDevice, m_lightBufferMemory);
+	if (vkMapMemory(m_logicDevice, m_lightBufferMemory, 0, VK_WHOLE_SIZE, 0, &data) != VK_SUCCESS)
+		return false;
+
+	m_mappedLightData = (Byte*)data;
+	m_lightClusterGrid.Write(*m_lights, m_mappedLightData);
+	m_lights->ClearModifiedLights();
 	return true;
 }
 
@@ -87,6 +88,14 @@ void QuantumEngine::Rendering::Vulkan::VulkanGraphicContext::UpdateCameraBuffer(
 	vkUnmapMemory(m_logicDevice, m_cameraBufferMemory);
 }
 
+void QuantumEngine::Rendering::Vulkan::VulkanGraphicContext::UpdateLightBuffer()
+{
+	// the previous frame is waited on before rendering, so the coherent buffer can be written in place
+	bool clustersChanged = m_lightClusterGrid.Build(*m_lights, m_cameraGPU.viewMatrix, m_camera->ProjectionMatrix());
+	m_lightClusterGrid.WriteModified(*m_lights, m_mappedLightData, clustersChanged);
+	m_lights->ClearModifiedLights();
+}
+
 bool QuantumEngine::Rendering::Vulkan::VulkanGraphicContext::InitializeSwapChain(VkImageUsageFlags useFlag)
 {
 	// Create Surface
@@ -2,6 +2,7 @@
 
 #include "vulkan-pch.h"
 #include "Rendering/GraphicContext.h"
+#include "Core/Light/LightClusterGrid.h"
 
 namespace QuantumEngine {
 	namespace Platform {
@@ -42,8 +43,9 @@ namespace QuantumEngine::Rendering::Vulkan {
 		bool InitializeCommandObjects();
 		bool InitializeFencesAndSemaphores();
 		bool InitializeCameraBuffer(const ref<Camera>& camera);
-		bool InitializeLightBuffer(const SceneLightData& lightData);
+		bool InitializeLightBuffer(const ref<SceneLightData>& lightData);
 		void UpdateCameraBuffer();
+		void UpdateLightBuffer();
 
 		VkDevice m_logicDevice;
 
@@ -79,5 +81,8 @@ namespace QuantumEngine::Rendering::Vulkan {
 		VkBuffer m_lightBuffer;
 		VkDeviceMemory m_lightBufferMemory;
 		UInt32 m_lightStride;
+		Byte* m_mappedLightData = nullptr;
+		ref<SceneLightData> m_lights;
+		LightClusterGrid m_lightClusterGrid;
 	};
 }
@@ -9,6 +9,7 @@
 #include "Rendering/SplineRenderer.h"
 #include "Rendering/GBufferRTReflectionRenderer.h"
 #include "Rendering/RayTracingComponent.h"
+#include "Rendering/MaterialInstance.h"
 #include "VulkanAssetManager.h"
 #include "VulkanUtilities.h"
 #include "VulkanShaderRegistery.h"
@@ -111,28 +112,45 @@ bool QuantumEngine::Rendering::Vulkan::VulkanHybridContext::PrepareScene(const r
 
 	for (auto& entity : scene->entities) {
 		m_entityGPUList.push_back({ entity, index });
+		m_frustumCuller.AddInstance(entity->GetRenderer()->GetMesh(), entity->GetTransform());
 
 		auto material = entity->GetRenderer()->GetMaterial();
-		auto matIT = usedMaterials.find(material);
 
-		if (matIT == usedMaterials.end()) {
-			usedMaterials.emplace(material, std::make_shared<Rasterization::VulkanRasterizationMaterial>(material, m_logicDevice)).first;
+		// instances share the descriptor sets of their root material, it is created even if no entity draws with it
+		while (material != nullptr && usedMaterials.contains(material) == false) {
+			usedMaterials.emplace(material, std::make_shared<Rasterization::VulkanRasterizationMaterial>(material, m_logicDevice));
+
+			auto materialInstance = std::dynamic_pointer_cast<MaterialInstance>(material);
+			material = materialInstance != nullptr ? materialInstance->GetParent() : nullptr;
 		}
 
 		index++;
 	}
 
+	auto getRootMaterial = [](ref<Material> material) {
+		while (auto materialInstance = std::dynamic_pointer_cast<MaterialInstance>(material))
+			material = materialInstance->GetParent();
+
+		return material;
+	};
+
 	std::vector<VkDescriptorPoolSize> poolSizes;
 	poolSizes.reserve(20);
 	UInt32 setcount = 0;
 
 	for (auto& matPair : usedMaterials) {
+		if (getRootMaterial(matPair.first) != matPair.first)
+			continue;
+
 		auto program = std::dynamic_pointer_cast<Rasterization::SPIRVRasterizationProgram>(matPair.first->GetProgram());
 		auto& reflection = program->GetReflection();
 		setcount += reflection.GetDescriptorLayoutCount();
 		auto& descriptors = reflection.GetDescriptors();
 
 		for (auto& descriptor : descriptors) {
+			if (descriptor.isDynamicArray) // material textures live in the bindless table
+				continue;
+
 			auto it = std::find_if(poolSizes.begin(), poolSizes.end(), [descriptor](const VkDescriptorPoolSize& poolSize) {
 				return descriptor.descriptorType == poolSize.type;
 				});
@@ -171,6 +189,8 @@ bool QuantumEngine::Rendering::Vulkan::VulkanHybridContext::PrepareScene(const r
 	if (vkCreateDescriptorPool(m_logicDevice, &poolCreateInfo, nullptr, &m_descriptorPool) != VK_SUCCESS)
 		return false;
 
+	std::vector<SplineEntityData> splineEntities;
+
 	for (auto& entityGPU : m_entityGPUList) {
 		auto& entity = entityGPU.gameEntity;
 		auto Renderer = entity->GetRenderer();
@@ -182,6 +202,8 @@ bool QuantumEngine::Rendering::Vulkan::VulkanHybridContext::PrepareScene(const r
 			ref<Rasterization::VulkanRasterizationPipelineModule> rasterizationModule = std::make_shared<Rasterization::VulkanRasterizationPipelineModule>(m_logicDevice);
 			if (rasterizationModule->Initialize(entity, gpuMateiral, m_renderPass)) {
 				m_rasterizationModules.push_back(rasterizationModule);
+				m_forwardEntityGPUList.push_back(entityGPU);
+				rasterizationModule->SetCullingIndex(entityGPU.index);
 				rasterizationModule->SetDescriptorOffset(HLSL_OBJECT_TRANSFORM_DATA_NAME, entityGPU.index * m_transformStride);
 				rasterizationModule->SetDescriptorOffset(HLSL_CAMERA_DATA_NAME, 0);
 				rasterizationModule->SetDescriptorOffset(HLSL_LIGHT_DATA_NAME, 0);
@@ -193,19 +215,12 @@ bool QuantumEngine::Rendering::Vulkan::VulkanHybridContext::PrepareScene(const r
 		auto splineRenderer = std::dynamic_pointer_cast<SplineRenderer>(Renderer);
 
 		if (splineRenderer != nullptr) {
-			auto& gpuMateiral = usedMaterials[splineRenderer->GetMaterial()];
-			ref<VulkanSplinePipelineModule> splineModule = std::make_shared<VulkanSplinePipelineModule>(m_logicDevice);
-			SplineEntityData splineEntityData{
+			splineEntities.push_back(SplineEntityData{
 				.splineRenderer = splineRenderer,
-				.material = gpuMateiral,
-				.computeProgram = std::dynamic_pointer_cast<Compute::SPIRVComputeProgram>(m_shaderRegistery->GetShaderPrograms("Bezier_Curve_Compute_Program")),
-			};
-			if (splineModule->Initialize(splineEntityData, m_renderPass, m_descriptorPool)) {
-				m_splineModues.push_back(splineModule);
-				splineModule->WriteOffset(HLSL_OBJECT_TRANSFORM_DATA_NAME, entityGPU.index * m_transformStride);
-				splineModule->WriteOffset(HLSL_CAMERA_DATA_NAME, 0);
-				splineModule->WriteOffset(HLSL_LIGHT_DATA_NAME, 0);
-			}
+				.material = usedMaterials[splineRenderer->GetMaterial()],
+				.transform = entity->GetTransform(),
+				.transformIndex = entityGPU.index,
+				});
 
 			continue;
 		}
@@ -219,6 +234,7 @@ bool QuantumEngine::Rendering::Vulkan::VulkanHybridContext::PrepareScene(const r
 			ref<Rasterization::VulkanRasterizationPipelineModule> rasterizationModule = std::make_shared<Rasterization::VulkanRasterizationPipelineModule>(m_logicDevice);
 			if (rasterizationModule->Initialize(entity, gpuMateiral, m_renderPass)) {
 				m_gBufferRasterizationModules.push_back(rasterizationModule);
+				rasterizationModule->SetCullingIndex(entityGPU.index);
 				rasterizationModule->SetDescriptorOffset(HLSL_OBJECT_TRANSFORM_DATA_NAME, entityGPU.index * m_transformStride);
 				rasterizationModule->SetDescriptorOffset(HLSL_CAMERA_DATA_NAME, 0);
 				rasterizationModule->SetDescriptorOffset(HLSL_LIGHT_DATA_NAME, 0);
@@ -227,38 +243,71 @@ bool QuantumEngine::Rendering::Vulkan::VulkanHybridContext::PrepareScene(const r
 	}
 
 	for (auto& matPair : usedMaterials) {
+		if (getRootMaterial(matPair.first) != matPair.first)
+			continue;
+
 		if (matPair.second->Initialize(m_descriptorPool) == false)
 			continue;
 		matPair.second->WriteBuffer(HLSL_OBJECT_TRANSFORM_DATA_NAME, m_transformBuffer, m_transformStride);
 		matPair.second->WriteBuffer(HLSL_CAMERA_DATA_NAME, m_cameraBuffer, m_cameraStride);
 		matPair.second->WriteBuffer(HLSL_LIGHT_DATA_NAME, m_lightBuffer, m_lightStride);
+		matPair.second->WriteBuffer(HLSL_TRANSFORM_ARRAY, m_transformBuffer, m_transformStride * (UInt32)m_entityGPUList.size());
+	}
+
+	for (auto& matPair : usedMaterials) {
+		auto rootMaterial = getRootMaterial(matPair.first);
+
+		if (rootMaterial != matPair.first)
+			matPair.second->ShareDescriptorSets(*usedMaterials[rootMaterial]);
+	}
+
+	// every spline of the scene is tessellated and drawn by one module, it writes its buffers into the initialized materials
+	if (splineEntities.size() > 0) {
+		auto splineComputeProgram = std::dynamic_pointer_cast<Compute::SPIRVComputeProgram>(m_shaderRegistery->GetShaderPrograms("Bezier_Curve_Compute_Program"));
+		m_splineModule = std::make_shared<VulkanSplinePipelineModule>(m_logicDevice);
+
+		if (m_splineModule->Initialize(splineEntities, splineComputeProgram, m_renderPass)) {
+			m_splineModule->WriteOffset(HLSL_CAMERA_DATA_NAME, 0);
+			m_splineModule->WriteOffset(HLSL_LIGHT_DATA_NAME, 0);
+		}
+		else
+			m_splineModule = nullptr;
 	}
 
 	if (m_gBufferEntityGPUList.size() > 0) {
 		auto gBufferProgram = std::dynamic_pointer_cast<Rasterization::SPIRVRasterizationProgram>( m_shaderRegistery->GetShaderPrograms("G_Buffer_Program"));
+		auto gBufferCullProgram = std::dynamic_pointer_cast<Compute::SPIRVComputeProgram>(m_shaderRegistery->GetShaderPrograms("G_Buffer_Cull_Program"));
+		auto hiZProgram = std::dynamic_pointer_cast<Compute::SPIRVComputeProgram>(m_shaderRegistery->GetShaderPrograms("HiZ_Build_Program"));
 		m_gbufferModule = std::make_shared<VulkanGBufferPipelineModule>();
-		m_gbufferModule->InitializePipeline(m_gBufferEntityGPUList, gBufferProgram, m_swapChainCapability.currentExtent.width, m_swapChainCapability.currentExtent.height, m_depthImageView);
-		m_gbufferModule->WriteBuffer(HLSL_OBJECT_TRANSFORM_DATA_NAME, m_transformBuffer, m_transformStride);
+		m_gbufferModule->InitializePipeline(m_gBufferEntityGPUList, m_forwardEntityGPUList, gBufferProgram, gBufferCullProgram, hiZProgram, m_swapChainCapability.currentExtent.width, m_swapChainCapability.currentExtent.height, m_depthImageView);
+		m_gbufferModule->WriteTransformBuffer(m_transformBuffer);
 		m_gbufferModule->WriteBuffer(HLSL_CAMERA_DATA_NAME, m_cameraBuffer, m_cameraStride);
 
+		// forward draws are predicated on the GPU culling results, occluders come from the G-buffer depth
+		for (auto& module : m_rasterizationModules)
+			module->SetVisibilityBuffer(m_gbufferModule->GetVisibilityBuffer());
+
+		for (auto& module : m_gBufferRasterizationModules)
+			module->SetVisibilityBuffer(m_gbufferModule->GetVisibilityBuffer());
+
 		auto gBufferGlobalProgram = m_shaderRegistery->GetShaderPrograms("G_Buffer_RT_Global_Program");
 
 		auto materialFactory = VulkanDeviceManager::Instance()->CreateMaterialFactory();
 		auto gBufferGlobalMaterial = materialFactory->CreateMaterial(gBufferGlobalProgram);
 		m_rayTracingModule = std::make_shared<RayTracing::VulkanRayTracingPipelineModule>();
 		
-		if (m_rayTracingModule->Initialize(scene->entities, gBufferGlobalMaterial, m_cameraBuffer, m_lightBuffer, m_transformBuffer, m_swapChainCapability.currentExtent) == false)
+		if (m_rayTracingModule->Initialize(scene->entities, gBufferGlobalMaterial, m_cameraBuffer, m_lightBuffer, m_transformBuffer, m_swapChainCapability.currentExtent, m_assetManager) == false)
 			return false;
 
-		m_rayTracingModule->SetImage("_PositionTexture", m_gbufferModule->GetPositionImageView());
 		m_rayTracingModule->SetImage("_NormalTexture", m_gbufferModule->GetNormalImageView());
-		m_rayTracingModule->SetImage("_MaskTexture", m_gbufferModule->GetMaskImageView());
+		m_rayTracingModule->SetImage("_DepthTexture", m_gbufferModule->GetDepthImageView(), VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL);
 		m_rayTracingModule->SetImage(HLSL_RT_OUTPUT_TEXTURE_NAME, m_rtOutputImageView);
 
 		for(auto& [material, rasterMaterial] : usedMaterials) {
-			rasterMaterial->SetImageView("_PositionTexture", m_gbufferModule->GetPositionImageView());
+			if (getRootMaterial(material) != material)
+				continue;
+
 			rasterMaterial->SetImageView("_NormalTexture", m_gbufferModule->GetNormalImageView());
-			rasterMaterial->SetImageView("_MaskTexture", m_gbufferModule->GetMaskImageView());
 			rasterMaterial->SetImageView(HLSL_RT_OUTPUT_TEXTURE_NAME, m_rtOutputImageView);
 		}
 	}
@@ -269,7 +318,10 @@ bool QuantumEngine::Rendering::Vulkan::VulkanHybridContext::PrepareScene(const r
 void QuantumEngine::Rendering::Vulkan::VulkanHybridContext::Render()
 {
 	UpdateCameraBuffer();
+	UpdateLightBuffer();
 	UpdateEntityTransforms();
+	UpdateCulling();
+	UpdateLODs();
 
 	vkResetFences(m_logicDevice, 1, &m_fence);
 
@@ -287,39 +339,32 @@ void QuantumEngine::Rendering::Vulkan::VulkanHybridContext::Render()
 
 	vkBeginCommandBuffer(m_commandBuffer, &beginInfo);
 
-	for (auto& m_splineModues : m_splineModues) {
-		m_splineModues->ComputeCommand(m_commandBuffer);
-	}
+	if (m_splineModule != nullptr)
+		m_splineModule->ComputeCommand(m_commandBuffer);
 
 	if (m_gbufferModule != nullptr) {
+		m_gbufferModule->CullCommand(m_commandBuffer);
 		m_gbufferModule->RenderCommand(m_commandBuffer);
+		m_gbufferModule->BuildHiZCommand(m_commandBuffer);
 
-		// Transition G-Buffer images from SHADER_READ_ONLY_OPTIMAL -> GENERAL for ray tracing usage.
+		// Transition the G-Buffer normal image from SHADER_READ_ONLY_OPTIMAL -> GENERAL for ray tracing usage.
 		// The ray tracing descriptors were created with VK_IMAGE_LAYOUT_GENERAL, so we must match that layout before tracing.
-		VkImageMemoryBarrier gBufferBarriers[3]{};
-
-		// Position image
-		gBufferBarriers[0].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-		gBufferBarriers[0].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT;
-		gBufferBarriers[0].dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
-		gBufferBarriers[0].oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		gBufferBarriers[0].newLayout = VK_IMAGE_LAYOUT_GENERAL;
-		gBufferBarriers[0].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-		gBufferBarriers[0].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-		gBufferBarriers[0].image = m_gbufferModule->GetPositionImage();
-		gBufferBarriers[0].subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		gBufferBarriers[0].subresourceRange.baseMipLevel = 0;
-		gBufferBarriers[0].subresourceRange.levelCount = 1;
-		gBufferBarriers[0].subresourceRange.baseArrayLayer = 0;
-		gBufferBarriers[0].subresourceRange.layerCount = 1;
-
-		// Normal image
-		gBufferBarriers[1] = gBufferBarriers[0];
-		gBufferBarriers[1].image = m_gbufferModule->GetNormalImage();
-
-		// Mask image
-		gBufferBarriers[2] = gBufferBarriers[0];
-		gBufferBarriers[2].image = m_gbufferModule->GetMaskImage();
+		// The depth stays in DEPTH_STENCIL_READ_ONLY_OPTIMAL, the G-buffer render pass orders its writes before tracing.
+		VkImageMemoryBarrier gBufferBarrier{};
+
+		gBufferBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		gBufferBarrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT;
+		gBufferBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		gBufferBarrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		gBufferBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+		gBufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		gBufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		gBufferBarrier.image = m_gbufferModule->GetNormalImage();
+		gBufferBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		gBufferBarrier.subresourceRange.baseMipLevel = 0;
+		gBufferBarrier.subresourceRange.levelCount = 1;
+		gBufferBarrier.subresourceRange.baseArrayLayer = 0;
+		gBufferBarrier.subresourceRange.layerCount = 1;
 
 		vkCmdPipelineBarrier(
 			m_commandBuffer,
@@ -328,7 +373,7 @@ void QuantumEngine::Rendering::Vulkan::VulkanHybridContext::Render()
 			0,
 			0, nullptr,
 			0, nullptr,
-			3, gBufferBarriers);
+			1, &gBufferBarrier);
 
 		// Prepare ray tracing output image for writes
 		VkImageMemoryBarrier rtOutImageBarrier{};
@@ -362,14 +407,12 @@ void QuantumEngine::Rendering::Vulkan::VulkanHybridContext::Render()
 		vkCmdPipelineBarrier(m_commandBuffer, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR, VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT,
 			0, 0, nullptr, 0, nullptr, 1, &rtOutImageBarrier);
 
-		// Transition G-Buffer images back from GENERAL -> SHADER_READ_ONLY_OPTIMAL
+		// Transition the G-Buffer normal image back from GENERAL -> SHADER_READ_ONLY_OPTIMAL
 		// so further graphics/fragment sampling sees the expected layout.
-		for (int i = 0; i < 3; ++i) {
-			gBufferBarriers[i].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT;
-			gBufferBarriers[i].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-			gBufferBarriers[i].oldLayout = VK_IMAGE_LAYOUT_GENERAL;
-			gBufferBarriers[i].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		}
+		gBufferBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT;
+		gBufferBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		gBufferBarrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+		gBufferBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
 		vkCmdPipelineBarrier(
 			m_commandBuffer,
@@ -378,7 +421,7 @@ void QuantumEngine::Rendering::Vulkan::VulkanHybridContext::Render()
 			0,
 			0, nullptr,
 			0, nullptr,
-			3, gBufferBarriers);
+			1, &gBufferBarrier);
 
 	}
 
@@ -422,9 +465,8 @@ void QuantumEngine::Rendering::Vulkan::VulkanHybridContext::Render()
 		module->RenderCommand(m_commandBuffer);
 	}
 
-	for (auto& module : m_splineModues) {
-		module->RenderCommand(m_commandBuffer);
-	}
+	if (m_splineModule != nullptr)
+		m_splineModule->RenderCommand(m_commandBuffer);
 
 	for(auto& module : m_gBufferRasterizationModules) {
 		module->RenderCommand(m_commandBuffer);
@@ -476,6 +518,10 @@ void QuantumEngine::Rendering::Vulkan::VulkanHybridContext::UploadMeshesToGPU(co
 			continue;
 
 		uniqueMeshes.insert(mesh);
+
+		for (UInt32 i = 0; i < mesh->GetLODCount(); i++)
+			uniqueMeshes.insert(mesh->GetLOD(i));
+
 		auto rtcomponent = entity->GetRayTracingComponent();
 
 		if (rtcomponent != nullptr)
@@ -497,7 +543,8 @@ bool QuantumEngine::Rendering::Vulkan::VulkanHybridContext::InitializeDepthBuffe
 	.arrayLayers = 1,
 	.samples = VK_SAMPLE_COUNT_1_BIT,
 	.tiling = VK_IMAGE_TILING_OPTIMAL,
-	.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+	// sampled by the Hi-Z build after the G-buffer pass
+	.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
 	.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
 	};
 
@@ -561,12 +608,25 @@ bool QuantumEngine::Rendering::Vulkan::VulkanHybridContext::InitializeRenderPass
 		.pDepthStencilAttachment = &depthAttachmentRef,
 	};
 
+	// the depth clear waits for the Hi-Z build and the ray generation shader reading the G-buffer depth
+	VkSubpassDependency externalDependency{
+		.srcSubpass = VK_SUBPASS_EXTERNAL,
+		.dstSubpass = 0,
+		.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR,
+		.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
+		.srcAccessMask = 0,
+		.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+		.dependencyFlags = 0,
+	};
+
 	VkRenderPassCreateInfo rpInfo{
 		.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
 		.attachmentCount = 2,
 		.pAttachments = attachments,
 		.subpassCount = 1,
 		.pSubpasses = &colorSubpass,
+		.dependencyCount = 1,
+		.pDependencies = &externalDependency,
 	};
 
 	auto result = vkCreateRenderPass(m_logicDevice, &rpInfo, nullptr, &m_renderPass);
@@ -595,6 +655,39 @@ bool QuantumEngine::Rendering::Vulkan::VulkanHybridContext::InitializeRenderPass
 	return true;
 }
 
+void QuantumEngine::Rendering::Vulkan::VulkanHybridContext::UpdateLODs()
+{
+	Float viewportHeight = (Float)m_swapChainCapability.currentExtent.height;
+
+	for (auto& module : m_rasterizationModules)
+		module->UpdateLOD(*m_camera, viewportHeight, m_lodPixelError);
+
+	for (auto& module : m_gBufferRasterizationModules)
+		module->UpdateLOD(*m_camera, viewportHeight, m_lodPixelError);
+
+	if (m_gbufferModule != nullptr)
+		m_gbufferModule->UpdateLODs(*m_camera, viewportHeight, m_lodPixelError);
+
+	if (m_splineModule != nullptr)
+		m_splineModule->UpdateSegments(*m_camera, viewportHeight, m_lodPixelError);
+}
+
+void QuantumEngine::Rendering::Vulkan::VulkanHybridContext::UpdateCulling()
+{
+	Matrix4 viewProjection = m_camera->ProjectionMatrix() * m_cameraGPU.viewMatrix;
+	m_frustumCuller.Cull(viewProjection);
+
+	for (auto& module : m_rasterizationModules)
+		module->UpdateVisibility(m_frustumCuller);
+
+	for (auto& module : m_gBufferRasterizationModules)
+		module->UpdateVisibility(m_frustumCuller);
+
+	// the G-buffer instances are culled on the GPU
+	if (m_gbufferModule != nullptr)
+		m_gbufferModule->UpdateFrustum(viewProjection);
+}
+
 void QuantumEngine::Rendering::Vulkan::VulkanHybridContext::UpdateEntityTransforms()
 {
 	void* data;
@@ -602,6 +695,12 @@ void QuantumEngine::Rendering::Vulkan::VulkanHybridContext::UpdateEntityTransfor
 
 	for (auto& entityGPU : m_entityGPUList) {
 		m_transformData.modelMatrix = entityGPU.gameEntity->GetTransform()->Matrix();
+
+		// quantized positions are in [-1, 1] of the mesh bounds, fold the decode into the raster transforms
+		auto mesh = entityGPU.gameEntity->GetRenderer()->GetMesh();
+		if (mesh != nullptr && mesh->GetVertexLayout() == VertexLayout::Quantized)
+			m_transformData.modelMatrix = m_transformData.modelMatrix * mesh->GetDequantizationMatrix();
+
 		m_transformData.modelViewMatrix = m_cameraGPU.viewMatrix * m_transformData.modelMatrix;
 		m_transformData.rotationMatrix = entityGPU.gameEntity->GetTransform()->RotateMatrix();
 
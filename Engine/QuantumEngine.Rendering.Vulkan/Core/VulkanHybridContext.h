@@ -1,6 +1,7 @@
 #pragma once
 #include "vulkan-pch.h"
 #include "VulkanGraphicContext.h"
+#include "Core/Camera/FrustumCuller.h"
 
 namespace QuantumEngine {
 	namespace Rendering
@@ -35,6 +36,11 @@ namespace QuantumEngine::Rendering::Vulkan {
 		bool Initialize();
 		virtual bool PrepareScene(const ref<Scene>& scene) override;
 		virtual void Render() override;
+
+		/// <summary>
+		/// rasterized entities drawn and culled in the last frame
+		/// </summary>
+		inline const CullingStats& GetCullingStats() const { return m_frustumCuller.GetStats(); }
 	private:
 
 		
@@ -43,6 +49,8 @@ namespace QuantumEngine::Rendering::Vulkan {
 		bool InitializeDepthBuffer();
 		bool InitializeRenderPass();
 		void UpdateEntityTransforms();
+		void UpdateLODs();
+		void UpdateCulling();
 
 		UInt32 m_transformStride;
 		VkBuffer m_transformBuffer;
@@ -59,8 +67,10 @@ namespace QuantumEngine::Rendering::Vulkan {
 
 		std::vector<VKEntityGPUData> m_entityGPUList;
 		std::vector<VKEntityGPUData> m_gBufferEntityGPUList;
+		// mesh entities drawn only by m_rasterizationModules, occlusion tested by the G-buffer culling pass
+		std::vector<VKEntityGPUData> m_forwardEntityGPUList;
 		std::vector<ref<Rasterization::VulkanRasterizationPipelineModule>> m_rasterizationModules;
-		std::vector<ref<VulkanSplinePipelineModule>> m_splineModues;
+		ref<VulkanSplinePipelineModule> m_splineModule = nullptr;
 
 		ref<VulkanGBufferPipelineModule> m_gbufferModule = nullptr;
 		ref<RayTracing::VulkanRayTracingPipelineModule> m_rayTracingModule;
@@ -71,5 +81,11 @@ namespace QuantumEngine::Rendering::Vulkan {
 		VkImageView m_rtOutputImageView;
 
 		VkDescriptorPool m_descriptorPool;
+
+		// one instance per entity in m_entityGPUList order, ray tracing still sees culled entities
+		FrustumCuller m_frustumCuller;
+
+		// largest screen space error in pixels a LOD may introduce
+		Float m_lodPixelError = 1.0f;
 	};
 }
\ No newline at end of file
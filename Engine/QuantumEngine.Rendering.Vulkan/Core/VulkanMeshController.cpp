@@ -3,21 +3,38 @@
 #include "Core/Mesh.h"
 #include "VulkanUtilities.h"
 #include "VulkanDeviceManager.h"
+#include "VulkanBindlessTable.h"
 #include "RayTracing/VulkanBLAS.h"
 #include "Core/VulkanBufferFactory.h"
 
 QuantumEngine::Rendering::Vulkan::VulkanMeshController::VulkanMeshController(const ref<Mesh>& mesh, const VkDevice device)
-	: m_mesh(mesh), m_device(device)
+	: m_mesh(mesh), m_device(device),
+	m_indexType(mesh->GetIndexFormat() == IndexFormat::UInt16 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32),
+	m_isQuantized(mesh->GetVertexLayout() == VertexLayout::Quantized)
 {
 }
 
 QuantumEngine::Rendering::Vulkan::VulkanMeshController::~VulkanMeshController()
 {
+	if (m_bindlessTable != nullptr) {
+		m_bindlessTable->RemoveBuffer(m_vertexStorageIndex);
+		m_bindlessTable->RemoveBuffer(m_indexStorageIndex);
+	}
+
 	vkDestroyBuffer(m_device, m_vertexBuffer, nullptr);
 	vkFreeMemory(m_device, m_vertexBufferMemory, nullptr);
 
 	vkDestroyBuffer(m_device, m_indexBuffer, nullptr);
 	vkFreeMemory(m_device, m_indexBufferMemory, nullptr);
+
+	vkDestroyBuffer(m_device, m_blasTransformBuffer, nullptr);
+	vkFreeMemory(m_device, m_blasTransformMemory, nullptr);
+
+	for (auto buffer : m_storageCopyBuffers)
+		vkDestroyBuffer(m_device, buffer, nullptr);
+
+	for (auto memory : m_storageCopyMemories)
+		vkFreeMemory(m_device, memory, nullptr);
 }
 
 bool QuantumEngine::Rendering::Vulkan::VulkanMeshController::Initialize(const VkPhysicalDeviceMemoryProperties* memoryProperties)
@@ -29,16 +46,29 @@ bool QuantumEngine::Rendering::Vulkan::VulkanMeshController::Initialize(const Vk
 		.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT,
 	};
 
-	bufferFactory->CreateBuffer(sizeof(Vertex) * m_mesh->GetVertexCount(),
+	bufferFactory->CreateBuffer(m_mesh->GetPackedVertexSize(),
 		VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
 	    VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
 		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &flags, &m_vertexBuffer, &m_vertexBufferMemory);
 
-	bufferFactory->CreateBuffer(sizeof(UInt32) * m_mesh->GetIndexCount(),
+	bufferFactory->CreateBuffer(m_mesh->GetPackedIndexSize(),
 		VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
 		VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
 		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &flags, &m_indexBuffer, &m_indexBufferMemory);
 
+	if (m_isQuantized) {
+		bufferFactory->CreateBuffer(sizeof(VkTransformMatrixKHR),
+			VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &flags, &m_blasTransformBuffer, &m_blasTransformMemory);
+
+		// Matrix4 is row major, the first three rows are exactly the 3x4 layout of VkTransformMatrixKHR
+		Matrix4 dequantizationMatrix = m_mesh->GetDequantizationMatrix();
+		void* data;
+		vkMapMemory(m_device, m_blasTransformMemory, 0, VK_WHOLE_SIZE, 0, &data);
+		std::memcpy(data, &dequantizationMatrix, sizeof(VkTransformMatrixKHR));
+		vkUnmapMemory(m_device, m_blasTransformMemory);
+	}
+
 	return true;
 }
 
@@ -47,10 +77,10 @@ void QuantumEngine::Rendering::Vulkan::VulkanMeshController::CopyCommand(VkComma
 	VkBufferCopy copyRegion{};
 	copyRegion.srcOffset = offset;
 	copyRegion.dstOffset = 0;
-	copyRegion.size = sizeof(Vertex) * m_mesh->GetVertexCount();
+	copyRegion.size = m_mesh->GetPackedVertexSize();
 	vkCmdCopyBuffer(commandBuffer, stageBuffer, m_vertexBuffer, 1, &copyRegion);
-	copyRegion.srcOffset = offset + sizeof(Vertex) * m_mesh->GetVertexCount();
-	copyRegion.size = sizeof(UInt32) * m_mesh->GetIndexCount();
+	copyRegion.srcOffset = offset + m_mesh->GetPackedVertexSize();
+	copyRegion.size = m_mesh->GetPackedIndexSize();
 	vkCmdCopyBuffer(commandBuffer, stageBuffer, m_indexBuffer, 1, &copyRegion);
 }
 
@@ -70,18 +100,27 @@ void QuantumEngine::Rendering::Vulkan::VulkanMeshController::GetBLASBuildInfo(Ra
 
 	VkAccelerationStructureGeometryTrianglesDataKHR triangles{};
 	triangles.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR;
-	triangles.vertexFormat = VK_FORMAT_R32G32B32_SFLOAT;
+	triangles.vertexFormat = m_isQuantized ? VK_FORMAT_R16G16B16A16_SNORM : VK_FORMAT_R32G32B32_SFLOAT;
 	VkDeviceOrHostAddressConstKHR vertexDeviceAddress{};
 	vertexDeviceAddress.deviceAddress = vertexAddress;
 	triangles.vertexData = vertexDeviceAddress;
-	triangles.vertexStride = sizeof(Vertex);
+	triangles.vertexStride = m_mesh->GetPackedVertexStride();
 	triangles.maxVertex = m_mesh->GetVertexCount();
-	triangles.indexType = VK_INDEX_TYPE_UINT32;
+	triangles.indexType = m_indexType;
 	VkDeviceOrHostAddressConstKHR indexDeviceAddress{};
 	indexDeviceAddress.deviceAddress = indexAddress;
 	triangles.indexData = indexDeviceAddress;
 	VkDeviceOrHostAddressConstKHR transformDeviceAddress{};
 	transformDeviceAddress.deviceAddress = 0;
+
+	if (m_isQuantized) {
+		VkBufferDeviceAddressInfo transformAddrInfo{
+			.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+			.buffer = m_blasTransformBuffer,
+		};
+		transformDeviceAddress.deviceAddress = vkGetBufferDeviceAddress(m_device, &transformAddrInfo);
+	}
+
 	triangles.transformData = transformDeviceAddress;
 
 
@@ -115,8 +154,34 @@ void QuantumEngine::Rendering::Vulkan::VulkanMeshController::GetBLASBuildInfo(Ra
 	);
 }
 
-VkBuffer QuantumEngine::Rendering::Vulkan::VulkanMeshController::CreateVertexStorageBuffer()
+UInt32 QuantumEngine::Rendering::Vulkan::VulkanMeshController::GetStorageCopySize() const
+{
+	UInt32 size = 0;
+
+	if (m_isQuantized)
+		size += sizeof(Vertex) * m_mesh->GetVertexCount();
+
+	if (m_indexType == VK_INDEX_TYPE_UINT16)
+		size += sizeof(UInt32) * m_mesh->GetIndexCount();
+
+	return size;
+}
+
+void QuantumEngine::Rendering::Vulkan::VulkanMeshController::CreateStorageBuffers(VkCommandBuffer commandBuffer, VkBuffer stageBuffer, Byte* stageData, VkBuffer* vertexStorageBuffer, VkBuffer* indexStorageBuffer)
+{
+	UInt32 indexOffset = m_isQuantized ? sizeof(Vertex) * m_mesh->GetVertexCount() : 0;
+	*vertexStorageBuffer = CreateVertexStorageBuffer(commandBuffer, stageBuffer, stageData, 0);
+	*indexStorageBuffer = CreateIndexStorageBuffer(commandBuffer, stageBuffer, stageData, indexOffset);
+}
+
+VkBuffer QuantumEngine::Rendering::Vulkan::VulkanMeshController::CreateVertexStorageBuffer(VkCommandBuffer commandBuffer, VkBuffer stageBuffer, Byte* stageData, UInt32 offset)
 {
+	// Hit shaders fetch full precision Vertex data
+	if (m_isQuantized) {
+		m_mesh->CopyVertexData(stageData + offset);
+		return CreateStorageCopy(commandBuffer, stageBuffer, offset, sizeof(Vertex) * m_mesh->GetVertexCount());
+	}
+
 	VkBufferCreateInfo info{};
 	info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
 	info.size = sizeof(Vertex) * m_mesh->GetVertexCount(); // same size as your index data
@@ -130,8 +195,13 @@ VkBuffer QuantumEngine::Rendering::Vulkan::VulkanMeshController::CreateVertexSto
 	return vertexStorageBuffer;
 }
 
-VkBuffer QuantumEngine::Rendering::Vulkan::VulkanMeshController::CreateIndexStorageBuffer()
+VkBuffer QuantumEngine::Rendering::Vulkan::VulkanMeshController::CreateIndexStorageBuffer(VkCommandBuffer commandBuffer, VkBuffer stageBuffer, Byte* stageData, UInt32 offset)
 {
+	if (m_indexType == VK_INDEX_TYPE_UINT16) {
+		m_mesh->CopyIndexData(stageData + offset);
+		return CreateStorageCopy(commandBuffer, stageBuffer, offset, sizeof(UInt32) * m_mesh->GetIndexCount());
+	}
+
 	VkBufferCreateInfo info{};
 	info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
 	info.size = sizeof(UInt32) * m_mesh->GetIndexCount(); // same size as your index data
@@ -144,3 +214,22 @@ VkBuffer QuantumEngine::Rendering::Vulkan::VulkanMeshController::CreateIndexStor
 
 	return indexStorageBuffer;
 }
+
+VkBuffer QuantumEngine::Rendering::Vulkan::VulkanMeshController::CreateStorageCopy(VkCommandBuffer commandBuffer, VkBuffer stageBuffer, UInt32 offset, UInt32 size)
+{
+	VkBuffer buffer;
+	VkDeviceMemory memory;
+	VulkanDeviceManager::Instance()->GetBufferFactory()->CreateBuffer(size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &buffer, &memory);
+
+	VkBufferCopy copyRegion{
+		.srcOffset = offset,
+		.dstOffset = 0,
+		.size = size,
+	};
+	vkCmdCopyBuffer(commandBuffer, stageBuffer, buffer, 1, &copyRegion);
+
+	m_storageCopyBuffers.push_back(buffer);
+	m_storageCopyMemories.push_back(memory);
+	return buffer;
+}
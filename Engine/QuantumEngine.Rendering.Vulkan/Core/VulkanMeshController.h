@@ -12,6 +12,8 @@ namespace QuantumEngine::Rendering::Vulkan {
 	}
 
 
+	class VulkanBindlessTable;
+
 	class VulkanMeshController : public GPUMeshController
 	{
 	public: 		
@@ -20,11 +22,28 @@ namespace QuantumEngine::Rendering::Vulkan {
 		bool Initialize(const VkPhysicalDeviceMemoryProperties* memoryProperties);
 		inline VkBuffer GetVertexBuffer() { return m_vertexBuffer; }
 		inline VkBuffer GetIndexBuffer() { return m_indexBuffer; }
+		inline VkIndexType GetIndexType() const { return m_indexType; }
+		inline bool IsQuantized() const { return m_isQuantized; }
 		void CopyCommand(VkCommandBuffer commandBuffer, VkBuffer stageBuffer, UInt32 offset);
 		void GetBLASBuildInfo(RayTracing::VulkanBLASBuildInfo* blasBuildInfo);
-		VkBuffer CreateVertexStorageBuffer();
-		VkBuffer CreateIndexStorageBuffer();
+		// size of the full precision copies that are uploaded through a stage buffer for hit shaders, 0 if they read the packed buffers directly
+		UInt32 GetStorageCopySize() const;
+		// stageData is the mapped memory of stageBuffer with at least GetStorageCopySize bytes, the copies are recorded into commandBuffer
+		void CreateStorageBuffers(VkCommandBuffer commandBuffer, VkBuffer stageBuffer, Byte* stageData, VkBuffer* vertexStorageBuffer, VkBuffer* indexStorageBuffer);
+
+		// positions of the storage buffers in the bindless table, UINT32_MAX until the asset manager adds them. The slots are removed with the controller
+		inline UInt32 GetVertexStorageIndex() const { return m_vertexStorageIndex; }
+		inline UInt32 GetIndexStorageIndex() const { return m_indexStorageIndex; }
+		inline void SetStorageIndices(const ref<VulkanBindlessTable>& bindlessTable, UInt32 vertexIndex, UInt32 indexIndex)
+		{
+			m_bindlessTable = bindlessTable;
+			m_vertexStorageIndex = vertexIndex;
+			m_indexStorageIndex = indexIndex;
+		}
 	private:
+		VkBuffer CreateVertexStorageBuffer(VkCommandBuffer commandBuffer, VkBuffer stageBuffer, Byte* stageData, UInt32 offset);
+		VkBuffer CreateIndexStorageBuffer(VkCommandBuffer commandBuffer, VkBuffer stageBuffer, Byte* stageData, UInt32 offset);
+		VkBuffer CreateStorageCopy(VkCommandBuffer commandBuffer, VkBuffer stageBuffer, UInt32 offset, UInt32 size);
 
 		ref<Mesh> m_mesh;
 		VkDevice m_device;
@@ -34,5 +53,19 @@ namespace QuantumEngine::Rendering::Vulkan {
 
 		VkBuffer m_indexBuffer;
 		VkDeviceMemory m_indexBufferMemory;
+		VkIndexType m_indexType;
+		bool m_isQuantized;
+
+		// Dequantization transform for BLAS builds over quantized positions
+		VkBuffer m_blasTransformBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory m_blasTransformMemory = VK_NULL_HANDLE;
+
+		// Device local full precision copies for hit shader attribute fetch when the packed data is compressed
+		std::vector<VkBuffer> m_storageCopyBuffers;
+		std::vector<VkDeviceMemory> m_storageCopyMemories;
+
+		ref<VulkanBindlessTable> m_bindlessTable;
+		UInt32 m_vertexStorageIndex = UINT32_MAX;
+		UInt32 m_indexStorageIndex = UINT32_MAX;
 	};
 }
@@ -284,19 +284,32 @@ void QuantumEngine::Rendering::Vulkan::VulkanShaderRegistery::Initialize()
 
 	std::string errorStr;
 
-	auto gBufferProgram = CompileProgram(root + L"\\Assets\\Shaders\\g_buffer_raster.hlsl", errorStr);
+	// the G-buffer is drawn with indirect commands filled by the culling program
+	auto gBufferProgram = CompileProgram(root + L"\\Assets\\Shaders\\g_buffer_indirect.hlsl", errorStr);
 
 	if (gBufferProgram != nullptr) {
 		m_specialPrograms.emplace("G_Buffer_Program", std::dynamic_pointer_cast<SPIRVShaderProgram>(gBufferProgram));
 	}
 
+	auto gBufferCullProgram = CompileProgram(root + L"\\Assets\\Shaders\\g_buffer_cull.cs.hlsl", errorStr);
+
+	if (gBufferCullProgram != nullptr) {
+		m_specialPrograms.emplace("G_Buffer_Cull_Program", std::dynamic_pointer_cast<SPIRVShaderProgram>(gBufferCullProgram));
+	}
+
+	auto hiZBuildProgram = CompileProgram(root + L"\\Assets\\Shaders\\hiz_build.cs.hlsl", errorStr);
+
+	if (hiZBuildProgram != nullptr) {
+		m_specialPrograms.emplace("HiZ_Build_Program", std::dynamic_pointer_cast<SPIRVShaderProgram>(hiZBuildProgram));
+	}
+
 	auto gBufferGlobalRTProgram = CompileProgram(root + L"\\Assets\\Shaders\\g_buffer_rt_global.lib.hlsl", errorStr);
 
 	if (gBufferGlobalRTProgram != nullptr) {
 		m_specialPrograms.emplace("G_Buffer_RT_Global_Program", std::dynamic_pointer_cast<SPIRVShaderProgram>(gBufferGlobalRTProgram));
 	}
 
-	auto computeProgram = CompileProgram(root + L"\\Assets\\Shaders\\curve_mesh_compute.cs.hlsl", errorStr);
+	auto computeProgram = CompileProgram(root + L"\\Assets\\Shaders\\curve_mesh_batch_compute.cs.hlsl", errorStr);
 
 	if (computeProgram != nullptr) {
 		m_specialPrograms.emplace("Bezier_Curve_Compute_Program", std::dynamic_pointer_cast<SPIRVShaderProgram>(computeProgram));
@@ -2,11 +2,25 @@
 #include "VulkanTexture2DController.h"
 #include "Core/Texture2D.h"
 #include "VulkanUtilities.h"
+#include "VulkanDeviceManager.h"
+#include "VulkanBindlessTable.h"
+#include "Core/TextureMipGenerator.h"
+#include <vector>
 
 const std::map<QuantumEngine::TextureFormat, VkFormat> QuantumEngine::Rendering::Vulkan::VulkanTexture2DController::s_texFormatMaps{
 	{QuantumEngine::TextureFormat::Unknown, VK_FORMAT_UNDEFINED},
 	{QuantumEngine::TextureFormat::RGBA32, VK_FORMAT_R8G8B8A8_UNORM},
 	{QuantumEngine::TextureFormat::BGRA32, VK_FORMAT_B8G8R8A8_UNORM},
+	{QuantumEngine::TextureFormat::RGBA64F, VK_FORMAT_R16G16B16A16_SFLOAT},
+	{QuantumEngine::TextureFormat::BC1, VK_FORMAT_BC1_RGBA_UNORM_BLOCK},
+	{QuantumEngine::TextureFormat::BC3, VK_FORMAT_BC3_UNORM_BLOCK},
+	{QuantumEngine::TextureFormat::BC5, VK_FORMAT_BC5_UNORM_BLOCK},
+	{QuantumEngine::TextureFormat::BC7, VK_FORMAT_BC7_UNORM_BLOCK},
+};
+
+const std::map<QuantumEngine::TextureFormat, VkFormat> QuantumEngine::Rendering::Vulkan::VulkanTexture2DController::s_sRGBFormatMaps{
+	{QuantumEngine::TextureFormat::RGBA32, VK_FORMAT_R8G8B8A8_SRGB},
+	{QuantumEngine::TextureFormat::BGRA32, VK_FORMAT_B8G8R8A8_SRGB},
 };
 
 QuantumEngine::Rendering::Vulkan::VulkanTexture2DController::VulkanTexture2DController(const ref<Texture2D>& texture, const VkDevice device)
@@ -16,6 +30,9 @@ QuantumEngine::Rendering::Vulkan::VulkanTexture2DController::VulkanTexture2DCont
 
 QuantumEngine::Rendering::Vulkan::VulkanTexture2DController::~VulkanTexture2DController()
 {
+	if (m_bindlessTable != nullptr)
+		m_bindlessTable->RemoveImage(m_bindlessIndex);
+
 	vkDestroyImageView(m_device, m_imageView, nullptr);
 	vkDestroyImage(m_device, m_textureImage, nullptr);
 	vkFreeMemory(m_device, m_textureImageMemory, nullptr);
@@ -23,18 +40,54 @@ QuantumEngine::Rendering::Vulkan::VulkanTexture2DController::~VulkanTexture2DCon
 
 bool QuantumEngine::Rendering::Vulkan::VulkanTexture2DController::Initialize(const VkPhysicalDeviceMemoryProperties& memoryProperties)
 {
+	VkFormat format = s_texFormatMaps.at(m_texture->GetFormat());
+	// shaders sample the stored values through a view of format, the image itself may use the sRGB twin for blits
+	VkFormat imageFormat = format;
+	VkImageCreateFlags imageFlags = 0;
+	m_uploadedMipCount = m_texture->GetMipLevelCount();
+	m_mipLevelCount = m_uploadedMipCount;
+
+	// block compression is optional outside of desktop GPUs (textureCompressionBC)
+	if (IsBlockCompressed(m_texture->GetFormat())) {
+		VkFormatProperties formatProperties;
+		vkGetPhysicalDeviceFormatProperties(VulkanDeviceManager::Instance()->GetPhysicalDevice(), format, &formatProperties);
+
+		if ((formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) == 0)
+			return false;
+	}
+
+	if (m_texture->GetGenerateGPUMips() && m_uploadedMipCount == 1) {
+		// color is averaged in linear space, data textures are filtered as stored
+		auto sRGBFormat = s_sRGBFormatMaps.find(m_texture->GetFormat());
+		VkFormat blitFormat = m_texture->IsSRGB() && sRGBFormat != s_sRGBFormatMaps.end() ? sRGBFormat->second : format;
+
+		VkFormatProperties formatProperties;
+		vkGetPhysicalDeviceFormatProperties(VulkanDeviceManager::Instance()->GetPhysicalDevice(), blitFormat, &formatProperties);
+		VkFormatFeatureFlags blitFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+
+		// without linear blits the texture keeps its single level
+		if ((formatProperties.optimalTilingFeatures & blitFeatures) == blitFeatures) {
+			m_mipLevelCount = TextureMipGenerator::GetFullMipLevelCount(m_texture->GetWidth(), m_texture->GetHeight());
+
+			if (blitFormat != format) {
+				imageFormat = blitFormat;
+				imageFlags = VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT;
+			}
+		}
+	}
+
 	VkImageCreateInfo imageInfo{
 		.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
 		.pNext = nullptr,
-		.flags = 0,
+		.flags = imageFlags,
 		.imageType = VK_IMAGE_TYPE_2D,
-		.format = s_texFormatMaps.at(m_texture->GetFormat()),
+		.format = imageFormat,
 		.extent = {m_texture->GetWidth(), m_texture->GetHeight(), 1},
-		.mipLevels = 1,
+		.mipLevels = m_mipLevelCount,
 		.arrayLayers = 1,
 		.samples = VK_SAMPLE_COUNT_1_BIT,
 		.tiling = VK_IMAGE_TILING_OPTIMAL,
-		.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+		.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
 		.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
 		.queueFamilyIndexCount = 0,
 		.pQueueFamilyIndices = nullptr,
@@ -63,8 +116,8 @@ bool QuantumEngine::Rendering::Vulkan::VulkanTexture2DController::Initialize(con
 		.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
 		.image = m_textureImage,
 		.viewType = VK_IMAGE_VIEW_TYPE_2D,
-		.format = s_texFormatMaps.at(m_texture->GetFormat()),
-		.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
+		.format = format,
+		.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, m_mipLevelCount, 0, 1},
 	};
 
 	if (vkCreateImageView(m_device, &viewInfo, nullptr, &m_imageView) != VK_SUCCESS) {
@@ -86,22 +139,70 @@ void QuantumEngine::Rendering::Vulkan::VulkanTexture2DController::CopyCommand(Vk
 		.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
 		.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
 		.image = m_textureImage,
-		.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
+		.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, m_mipLevelCount, 0, 1},
 	};
 
 	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageCopyBarrier);
 
+	std::vector<VkBufferImageCopy> copyRegions(m_uploadedMipCount);
+
+	for (UInt32 level = 0; level < m_uploadedMipCount; level++) {
+		copyRegions[level] = VkBufferImageCopy{
+			.bufferOffset = m_texture->GetMipOffset(level),
+			.bufferRowLength = 0,
+			.bufferImageHeight = 0,
+			.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1},
+			.imageOffset = {0, 0, 0},
+			.imageExtent = {m_texture->GetMipWidth(level), m_texture->GetMipHeight(level), 1},
+		};
+	}
 
-	VkBufferImageCopy copyData{
-		.bufferOffset = 0,
-		.bufferRowLength = 0,
-		.bufferImageHeight = 0,
-		.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
-		.imageOffset = {0, 0, 0},
-		.imageExtent = {m_texture->GetWidth(), m_texture->GetHeight(), 1},
-	};
+	vkCmdCopyBufferToImage(commandBuffer, stageBuffer, m_textureImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, (UInt32)copyRegions.size(), copyRegions.data());
+
+	// each generated level is blitted from the one above it, which then moves on to shader read
+	for (UInt32 level = m_uploadedMipCount; level < m_mipLevelCount; level++) {
+		VkImageMemoryBarrier sourceBarrier{
+			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+			.pNext = nullptr,
+			.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+			.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+			.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.image = m_textureImage,
+			.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 1, 0, 1},
+		};
+
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &sourceBarrier);
+
+		VkImageBlit blit{
+			.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 0, 1},
+			.srcOffsets = {{0, 0, 0}, {(Int32)m_texture->GetMipWidth(level - 1), (Int32)m_texture->GetMipHeight(level - 1), 1}},
+			.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1},
+			.dstOffsets = {{0, 0, 0}, {(Int32)m_texture->GetMipWidth(level), (Int32)m_texture->GetMipHeight(level), 1}},
+		};
+
+		vkCmdBlitImage(commandBuffer, m_textureImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_textureImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+
+		VkImageMemoryBarrier readBarrier{
+			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+			.pNext = nullptr,
+			.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+			.dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+			.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.image = m_textureImage,
+			.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 1, 0, 1},
+		};
+
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT, 0, 0, nullptr, 0, nullptr, 1, &readBarrier);
+	}
 
-	vkCmdCopyBufferToImage(commandBuffer, stageBuffer, m_textureImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyData);
+	// levels still in transfer dst: all uploaded ones, or only the last one if the rest were blitted
+	UInt32 firstPendingLevel = m_mipLevelCount > m_uploadedMipCount ? m_mipLevelCount - 1 : 0;
 
 	VkImageMemoryBarrier imageEndCopyBarrier{
 		.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
@@ -113,7 +214,7 @@ void QuantumEngine::Rendering::Vulkan::VulkanTexture2DController::CopyCommand(Vk
 		.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
 		.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
 		.image = m_textureImage,
-		.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1},
+		.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, firstPendingLevel, m_mipLevelCount - firstPendingLevel, 0, 1},
 	};
 
 	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageEndCopyBarrier);
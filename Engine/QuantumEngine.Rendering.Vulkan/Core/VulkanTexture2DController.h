@@ -9,6 +9,8 @@ namespace QuantumEngine {
 }
 
 namespace QuantumEngine::Rendering::Vulkan {
+	class VulkanBindlessTable;
+
 	class VulkanTexture2DController : public GPUTexture2DController {
 	public:
 		VulkanTexture2DController(const ref<Texture2D>& texture, const VkDevice device);
@@ -16,13 +18,25 @@ namespace QuantumEngine::Rendering::Vulkan {
 		bool Initialize(const VkPhysicalDeviceMemoryProperties& memoryProperties);
 		void CopyCommand(VkCommandBuffer commandBuffer, VkBuffer stageBuffer);
 		inline VkImageView GetImageView() const { return m_imageView; }
+
+		// position of the image view in the bindless table, the slot is removed from the table with the controller
+		inline UInt32 GetBindlessIndex() const { return m_bindlessIndex; }
+		inline void SetBindlessIndex(const ref<VulkanBindlessTable>& bindlessTable, UInt32 index) { m_bindlessTable = bindlessTable; m_bindlessIndex = index; }
 	private:
 		const static std::map<TextureFormat, VkFormat> s_texFormatMaps;
+		// sRGB twins of the 8-bit formats, used as image format so mip blits of color textures filter in linear space
+		const static std::map<TextureFormat, VkFormat> s_sRGBFormatMaps;
 		ref<Texture2D> m_texture;
 		VkDevice m_device;
 
+		// levels uploaded from the texture, the rest are blitted from the last uploaded one
+		UInt32 m_uploadedMipCount;
+		UInt32 m_mipLevelCount;
+
 		VkImage m_textureImage;
 		VkDeviceMemory m_textureImageMemory;
 		VkImageView m_imageView;
+		ref<VulkanBindlessTable> m_bindlessTable;
+		UInt32 m_bindlessIndex = UINT32_MAX;
 	};
 }
\ No newline at end of file
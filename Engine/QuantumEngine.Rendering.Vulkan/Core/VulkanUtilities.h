@@ -8,8 +8,14 @@
 #define HLSL_LIGHT_DATA_NAME "_LightData"
 #define HLSL_RT_TLAS_SCENE_NAME "_RTScene"
 #define HLSL_RT_OUTPUT_TEXTURE_NAME "_OutputTexture"
-#define HLSL_RT_VERTEX_BUFFER_ARRAY "_vertexBufferArray"
-#define HLSL_RT_INDEX_BUFFER_ARRAY "_indexBufferArray"
+#define HLSL_RT_INSTANCE_RESOURCES "_rtInstanceResources"
+#define HLSL_RT_TEXTURE_INDICES_SUFFIX "Indices"
+// push constant holding the bindless index of a rasterization texture, declared by TEXTURE_INDEX
+#define HLSL_RASTER_TEXTURE_INDEX_SUFFIX "BindlessIndex"
+
+// sets of the bindless table in ray tracing pipelines, every unbounded array is moved to one of them
+#define RT_BINDLESS_BUFFER_SET 2
+#define RT_BINDLESS_IMAGE_SET 3
 
 UInt32 GetMemoryTypeIndex(const VkMemoryRequirements* memoryRequirement, VkMemoryPropertyFlags targetFlags, const VkPhysicalDeviceMemoryProperties* memoryProperties);
 
@@ -1,6 +1,8 @@
 #include "vulkan-pch.h"
 #include "SPIRVRasterizationProgram.h"
 #include "../Core/SPIRVShader.h"
+#include "../Core/VulkanBindlessTable.h"
+#include "../Core/VulkanDeviceManager.h"
 
 QuantumEngine::Rendering::Vulkan::Rasterization::SPIRVRasterizationProgram::SPIRVRasterizationProgram(const std::vector<ref<SPIRVShader>>& spirvShaders, const VkDevice device)
 {
@@ -48,8 +50,9 @@ QuantumEngine::Rendering::Vulkan::Rasterization::SPIRVRasterizationProgram::SPIR
 	m_reflection.Initializes();
 	InitializeSampler();
 
+	m_bindlessTable = VulkanDeviceManager::Instance()->GetBindlessTable();
 	m_descriptorSetLayout.resize(m_reflection.GetDescriptorLayoutCount());
-	m_reflection.CreatePipelineLayout(device, VK_SHADER_STAGE_ALL_GRAPHICS, m_sampler, &m_pipelineLayout, m_descriptorSetLayout.data());
+	m_reflection.CreatePipelineLayout(device, VK_SHADER_STAGE_ALL_GRAPHICS, m_sampler, &m_pipelineLayout, m_descriptorSetLayout.data(), m_bindlessTable.get());
 }
 
 QuantumEngine::Rendering::Vulkan::Rasterization::SPIRVRasterizationProgram::~SPIRVRasterizationProgram()
@@ -57,6 +60,10 @@ QuantumEngine::Rendering::Vulkan::Rasterization::SPIRVRasterizationProgram::~SPI
 	vkDestroySampler(m_device, m_sampler, nullptr);
 	vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
 
-	for(auto& descriptorLayout : m_descriptorSetLayout)
+	for(auto& descriptorLayout : m_descriptorSetLayout) {
+		if (m_bindlessTable->GetDescriptorSet(descriptorLayout) != VK_NULL_HANDLE) // destroyed by the bindless table
+			continue;
+
 		vkDestroyDescriptorSetLayout(m_device, descriptorLayout, nullptr);
+	}
 }
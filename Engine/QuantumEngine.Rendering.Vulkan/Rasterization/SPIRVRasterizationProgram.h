@@ -6,6 +6,7 @@
 
 namespace QuantumEngine::Rendering::Vulkan {
 	class SPIRVShader;
+	class VulkanBindlessTable;
 }
 
 namespace QuantumEngine::Rendering::Vulkan::Rasterization {
@@ -17,6 +18,7 @@ namespace QuantumEngine::Rendering::Vulkan::Rasterization {
 		inline std::vector<VkPipelineShaderStageCreateInfo>& GetStageInfos() { return m_stageInfos; }
 		inline VkPipelineLayout GetPipelineLayout() const { return m_pipelineLayout; }
 		inline std::vector<VkDescriptorSetLayout>& GetDiscriptorLayouts() { return m_descriptorSetLayout; }
+		inline const ref<VulkanBindlessTable>& GetBindlessTable() const { return m_bindlessTable; }
 	private:
 		ref<SPIRVShader> m_vertexShader;
 		ref<SPIRVShader> m_geometryShader;
@@ -25,5 +27,7 @@ namespace QuantumEngine::Rendering::Vulkan::Rasterization {
 		std::vector<VkPipelineShaderStageCreateInfo> m_stageInfos;
 		VkPipelineLayout m_pipelineLayout;
 		std::vector<VkDescriptorSetLayout> m_descriptorSetLayout;
+		// owns the layout of the set holding the material textures
+		ref<VulkanBindlessTable> m_bindlessTable;
 	};
 }
\ No newline at end of file
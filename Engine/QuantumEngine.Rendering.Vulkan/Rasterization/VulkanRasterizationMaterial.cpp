@@ -4,6 +4,8 @@
 #include "SPIRVRasterizationProgram.h"
 #include "Core/Texture2D.h"
 #include "Core/VulkanTexture2DController.h"
+#include "Core/VulkanBindlessTable.h"
+#include "Core/VulkanUtilities.h"
 
 QuantumEngine::Rendering::Vulkan::Rasterization::VulkanRasterizationMaterial::VulkanRasterizationMaterial(const ref<Material>& material, const VkDevice device)
 	:m_material(material), m_device(device), m_program(std::dynamic_pointer_cast<SPIRVRasterizationProgram>(material->GetProgram()))
@@ -25,34 +27,28 @@ QuantumEngine::Rendering::Vulkan::Rasterization::VulkanRasterizationMaterial::Vu
 		}
 	}
 
-	auto& descriptors = reflection.GetDescriptors();
-	auto textureFields = material->GetTextureFields();
-	UInt32 fieldIndex = 0;
+	// textures are read from the image set of the bindless table through the indices pushed with the values
+	for (auto& [name, textureData] : *material->GetTextureFields()) {
+		Byte* indexLocation = material->GetValueLocation(name + HLSL_RASTER_TEXTURE_INDEX_SUFFIX);
 
-	for (auto& descriptor : descriptors) {
-		if (descriptor.name[0] == '_')
+		if (indexLocation == nullptr)
 			continue;
 
-		m_descriptorData.push_back(DescriptorData{
-			.setIndex = descriptor.data.set,
-			.binding = descriptor.data.binding,
-			.descriptorType = descriptor.descriptorType,
-			});
+		// fields without a texture sample the fallback image instead of whatever texture holds slot 0
+		auto textureController = textureData.texture == nullptr ? nullptr : std::dynamic_pointer_cast<VulkanTexture2DController>(textureData.texture->GetGPUHandle());
+		UInt32 bindlessIndex = textureController == nullptr ? m_program->GetBindlessTable()->GetFallbackImageIndex() : textureController->GetBindlessIndex();
+		std::memcpy(indexLocation, &bindlessIndex, sizeof(UInt32));
 
-		auto matIt = textureFields->find(descriptor.name);
-
-		if (matIt != textureFields->end())
-			(*matIt).second.fieldIndex = fieldIndex;
-
-		fieldIndex++;
+		textureData.fieldIndex = (UInt32)m_textureIndices.size();
+		m_textureIndices.push_back(indexLocation);
 	}
 }
 
 bool QuantumEngine::Rendering::Vulkan::Rasterization::VulkanRasterizationMaterial::Initialize(const VkDescriptorPool pool)
 {
 	auto& layouts = m_program->GetDiscriptorLayouts();
+	auto& bindlessTable = m_program->GetBindlessTable();
 	m_descriptorSets.resize(layouts.size());
-	m_descriptorData.resize(m_material->GetTextureFields()->size());
 
 	VkDescriptorSetAllocateInfo descSetAlloc{
 		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
@@ -62,40 +58,33 @@ bool QuantumEngine::Rendering::Vulkan::Rasterization::VulkanRasterizationMateria
 	};
 
 	for (UInt32 i = 0; i < layouts.size(); i++) {
+		m_descriptorSets[i] = bindlessTable->GetDescriptorSet(layouts[i]);
+
+		if (m_descriptorSets[i] != VK_NULL_HANDLE)
+			continue;
+
 		descSetAlloc.pSetLayouts = layouts.data() + i;
 
 		if (vkAllocateDescriptorSets(m_device, &descSetAlloc, m_descriptorSets.data() + i) != VK_SUCCESS)
 			return false;
 	}
-	
+
 	return true;
 }
 
-void QuantumEngine::Rendering::Vulkan::Rasterization::VulkanRasterizationMaterial::BindValues(VkCommandBuffer commandBuffer)
+void QuantumEngine::Rendering::Vulkan::Rasterization::VulkanRasterizationMaterial::ShareDescriptorSets(const VulkanRasterizationMaterial& source)
 {
-	// Update Modified Textures
-	for (auto& modified : m_material->GetModifiedTextures()) {
-		VkDescriptorImageInfo imageInfo{
-			.sampler = nullptr,
-			.imageView = std::dynamic_pointer_cast<VulkanTexture2DController>(modified->texture->GetGPUHandle())->GetImageView(),
-			.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-		};
-
-		VkWriteDescriptorSet writeDescriptor{
-		.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-		.pNext = nullptr,
-		.dstSet = m_descriptorSets[m_descriptorData[modified->fieldIndex].setIndex],
-		.dstBinding = m_descriptorData[modified->fieldIndex].binding,
-		.dstArrayElement = 0,
-		.descriptorCount = 1,
-		.descriptorType = m_descriptorData[modified->fieldIndex].descriptorType,
-		.pImageInfo = &imageInfo,
-		.pBufferInfo = nullptr,
-		.pTexelBufferView = nullptr,
-		};
+	m_descriptorSets = source.m_descriptorSets;
+}
 
-		vkUpdateDescriptorSets(m_device, 1, &writeDescriptor, 0, nullptr);
-	}
+void QuantumEngine::Rendering::Vulkan::Rasterization::VulkanRasterizationMaterial::BindValues(VkCommandBuffer commandBuffer)
+{
+	// Update Modified Textures, their bindless indices are pushed with the values below
+	m_material->ForEachModifiedTexture([&](MaterialTextureData& modified) {
+		auto textureController = std::dynamic_pointer_cast<VulkanTexture2DController>(modified.texture->GetGPUHandle());
+		UInt32 bindlessIndex = textureController->GetBindlessIndex();
+		std::memcpy(m_textureIndices[modified.fieldIndex], &bindlessIndex, sizeof(UInt32));
+	});
 
 	m_material->ClearModifiedTextures();
 
@@ -107,6 +96,16 @@ void QuantumEngine::Rendering::Vulkan::Rasterization::VulkanRasterizationMateria
 
 void QuantumEngine::Rendering::Vulkan::Rasterization::VulkanRasterizationMaterial::BindDynamicValues(VkCommandBuffer commandBuffer, UInt32* offsets, UInt32 offsetCount)
 {
+	// the bindless table reallocates its sets when it grows
+	auto& layouts = m_program->GetDiscriptorLayouts();
+
+	for (UInt32 i = 0; i < layouts.size(); i++) {
+		VkDescriptorSet bindlessSet = m_program->GetBindlessTable()->GetDescriptorSet(layouts[i]);
+
+		if (bindlessSet != VK_NULL_HANDLE)
+			m_descriptorSets[i] = bindlessSet;
+	}
+
 	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, (UInt32)m_descriptorSets.size(), m_descriptorSets.data(), offsetCount, offsets);
 }
 
@@ -12,6 +12,11 @@ namespace QuantumEngine::Rendering::Vulkan::Rasterization {
 	public:
 		VulkanRasterizationMaterial(const ref<Material>& material, const VkDevice device);
 		bool Initialize(const VkDescriptorPool pool);
+		/// <summary>
+		/// uses the descriptor sets of an initialized material of the same program instead of allocating them.
+		/// Buffers and images written into them are seen by both materials
+		/// </summary>
+		void ShareDescriptorSets(const VulkanRasterizationMaterial& source);
 		void BindValues(VkCommandBuffer commandBuffer);
 		void BindDynamicValues(VkCommandBuffer commandBuffer, UInt32* offsets, UInt32 offsetCount);
 		void WriteBuffer(const std::string name, const VkBuffer buffer, UInt32 stride);
@@ -23,18 +28,13 @@ namespace QuantumEngine::Rendering::Vulkan::Rasterization {
 			UInt32 size;
 		};
 
-		struct DescriptorData {
-			UInt32 setIndex;
-			UInt32 binding;
-			VkDescriptorType descriptorType;
-		};
-
 		ref<Material> m_material;
 		VkDevice m_device;
 		ref<SPIRVRasterizationProgram> m_program;
 		VkPipelineLayout m_pipelineLayout;
 		std::vector<pushConstantData> m_pushConstantValues; 
 		std::vector<VkDescriptorSet> m_descriptorSets;
-		std::vector<DescriptorData> m_descriptorData;
+		// bindless index of every texture field inside the pushed value block
+		std::vector<Byte*> m_textureIndices;
 	};
 }
\ No newline at end of file
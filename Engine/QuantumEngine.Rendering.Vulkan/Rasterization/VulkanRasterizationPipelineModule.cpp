@@ -3,6 +3,8 @@
 #include "Core/Mesh.h"
 #include "../Core/VulkanMeshController.h"
 #include "Core/GameEntity.h"
+#include "Core/Transform.h"
+#include "Core/Camera/FrustumCuller.h"
 #include "SPIRVRasterizationProgram.h"
 #include "Rendering/Renderer.h"
 #include "Rendering/Material.h"
@@ -31,6 +33,44 @@ VkPipelineVertexInputStateCreateInfo QuantumEngine::Rendering::Vulkan::Rasteriza
 	.pVertexAttributeDescriptions = s_attributeDescriptions,
 };
 
+VkVertexInputBindingDescription QuantumEngine::Rendering::Vulkan::Rasterization::VulkanRasterizationPipelineModule::s_quantizedBindingDescriptions = {
+	.binding = 0,
+	.stride = sizeof(QuantizedVertex),
+	.inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
+};
+
+VkVertexInputAttributeDescription QuantumEngine::Rendering::Vulkan::Rasterization::VulkanRasterizationPipelineModule::s_quantizedAttributeDescriptions[3] = {
+	{ .location = 0, .binding = 0, .format = VK_FORMAT_R16G16B16A16_SNORM, .offset = offsetof(QuantizedVertex, position) },
+	{ .location = 1, .binding = 0, .format = VK_FORMAT_R16G16_SFLOAT, .offset = offsetof(QuantizedVertex, uv) },
+	{ .location = 2, .binding = 0, .format = VK_FORMAT_R16G16_SNORM, .offset = offsetof(QuantizedVertex, normal) },
+};
+
+VkPipelineVertexInputStateCreateInfo QuantumEngine::Rendering::Vulkan::Rasterization::VulkanRasterizationPipelineModule::s_quantizedVertexInputInfo = {
+	.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+	.pNext = nullptr,
+	.flags = 0,
+	.vertexBindingDescriptionCount = 1,
+	.pVertexBindingDescriptions = &s_quantizedBindingDescriptions,
+	.vertexAttributeDescriptionCount = 3,
+	.pVertexAttributeDescriptions = s_quantizedAttributeDescriptions,
+};
+
+// constant_id 0 is _quantizedVertex in Common/VertexStructs.hlsli
+VkSpecializationMapEntry QuantumEngine::Rendering::Vulkan::Rasterization::VulkanRasterizationPipelineModule::s_quantizedSpecializationEntry = {
+	.constantID = 0,
+	.offset = 0,
+	.size = sizeof(VkBool32),
+};
+
+VkBool32 QuantumEngine::Rendering::Vulkan::Rasterization::VulkanRasterizationPipelineModule::s_quantizedSpecializationValue = VK_TRUE;
+
+VkSpecializationInfo QuantumEngine::Rendering::Vulkan::Rasterization::VulkanRasterizationPipelineModule::s_quantizedSpecializationInfo = {
+	.mapEntryCount = 1,
+	.pMapEntries = &s_quantizedSpecializationEntry,
+	.dataSize = sizeof(VkBool32),
+	.pData = &s_quantizedSpecializationValue,
+};
+
 QuantumEngine::Rendering::Vulkan::Rasterization::VulkanRasterizationPipelineModule::VulkanRasterizationPipelineModule(const VkDevice device)
 	:m_device(device)
 {
@@ -43,15 +83,42 @@ QuantumEngine::Rendering::Vulkan::Rasterization::VulkanRasterizationPipelineModu
 
 void QuantumEngine::Rendering::Vulkan::Rasterization::VulkanRasterizationPipelineModule::RenderCommand(VkCommandBuffer commandBuffer)
 {
+	if (m_isVisible == false)
+		return;
+
 	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipeline);
 	VkDeviceSize offsets[] = { 0 };
-	auto indexBuffer = m_meshController->GetIndexBuffer();
-	auto vertexBuffer = m_meshController->GetVertexBuffer();
+	auto& meshController = m_lodControllers[m_currentLOD];
+	auto indexBuffer = meshController->GetIndexBuffer();
+	auto vertexBuffer = meshController->GetVertexBuffer();
 	vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer, offsets);
-	vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+	vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, meshController->GetIndexType());
 	m_material->BindValues(commandBuffer);
 	m_material->BindDynamicValues(commandBuffer, m_offset.data(), (UInt32)m_offset.size());
-	vkCmdDrawIndexed(commandBuffer, m_mesh->GetIndexCount(), 1, 0, 0, 0);
+
+	if (m_visibilityBuffer == VK_NULL_HANDLE) {
+		vkCmdDrawIndexed(commandBuffer, m_lodMeshes[m_currentLOD]->GetIndexCount(), 1, 0, 0, 0);
+		return;
+	}
+
+	VkConditionalRenderingBeginInfoEXT conditionalInfo{
+		.sType = VK_STRUCTURE_TYPE_CONDITIONAL_RENDERING_BEGIN_INFO_EXT,
+		.pNext = nullptr,
+		.buffer = m_visibilityBuffer,
+		.offset = m_cullingIndex * sizeof(UInt32),
+		.flags = 0,
+	};
+
+	m_beginConditionalRenderingPtr(commandBuffer, &conditionalInfo);
+	vkCmdDrawIndexed(commandBuffer, m_lodMeshes[m_currentLOD]->GetIndexCount(), 1, 0, 0, 0);
+	m_endConditionalRenderingPtr(commandBuffer);
+}
+
+void QuantumEngine::Rendering::Vulkan::Rasterization::VulkanRasterizationPipelineModule::SetVisibilityBuffer(VkBuffer buffer)
+{
+	m_visibilityBuffer = buffer;
+	m_beginConditionalRenderingPtr = (PFN_vkCmdBeginConditionalRenderingEXT)vkGetDeviceProcAddr(m_device, "vkCmdBeginConditionalRenderingEXT");
+	m_endConditionalRenderingPtr = (PFN_vkCmdEndConditionalRenderingEXT)vkGetDeviceProcAddr(m_device, "vkCmdEndConditionalRenderingEXT");
 }
 
 bool QuantumEngine::Rendering::Vulkan::Rasterization::VulkanRasterizationPipelineModule::Initialize(const ref<GameEntity>& entity, ref<VulkanRasterizationMaterial> material, const VkRenderPass renderPass)
@@ -60,7 +127,17 @@ bool QuantumEngine::Rendering::Vulkan::Rasterization::VulkanRasterizationPipelin
 	m_offset = std::vector<UInt32>(m_program->GetReflection().GetDynamicDescriptorCount(), 0);
 	m_mesh = entity->GetRenderer()->GetMesh();
 	m_meshController = std::dynamic_pointer_cast<VulkanMeshController>(m_mesh->GetGPUHandle());
+	m_transform = entity->GetTransform();
 	m_material = material;
+
+	m_lodMeshes.push_back(m_mesh);
+	m_lodControllers.push_back(m_meshController);
+
+	for (UInt32 i = 0; i < m_mesh->GetLODCount(); i++) {
+		auto lod = m_mesh->GetLOD(i);
+		m_lodMeshes.push_back(lod);
+		m_lodControllers.push_back(std::dynamic_pointer_cast<VulkanMeshController>(lod->GetGPUHandle()));
+	}
 	
 	VkPipelineInputAssemblyStateCreateInfo pInputAssemblyInfo{
 		.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
@@ -153,15 +230,23 @@ bool QuantumEngine::Rendering::Vulkan::Rasterization::VulkanRasterizationPipelin
 		.pDynamicStates = dynamicStates.data(),
 	};
 
-	auto& stages = m_program->GetStageInfos();
-	
+	std::vector<VkPipelineShaderStageCreateInfo> stages = m_program->GetStageInfos();
+	bool isQuantized = m_meshController->IsQuantized();
+
+	if (isQuantized) {
+		for (auto& stage : stages) {
+			if (stage.stage == VK_SHADER_STAGE_VERTEX_BIT)
+				stage.pSpecializationInfo = &s_quantizedSpecializationInfo;
+		}
+	}
+
 	VkGraphicsPipelineCreateInfo pipelineCreateInfo{
 		.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
 		.pNext = nullptr,
 		.flags = 0,
 		.stageCount = (UInt32)stages.size(),
 		.pStages = stages.data(),
-		.pVertexInputState = &s_vertexInputInfo,
+		.pVertexInputState = isQuantized ? &s_quantizedVertexInputInfo : &s_vertexInputInfo,
 		.pInputAssemblyState = &pInputAssemblyInfo,
 		.pTessellationState = nullptr,
 		.pViewportState = &viewportStateInfo,
@@ -194,3 +279,13 @@ void QuantumEngine::Rendering::Vulkan::Rasterization::VulkanRasterizationPipelin
 
 	m_offset[descriptorData->offsetIndex] = offset;
 }
+
+void QuantumEngine::Rendering::Vulkan::Rasterization::VulkanRasterizationPipelineModule::UpdateLOD(const Camera& camera, Float viewportHeight, Float maxPixelError)
+{
+	m_currentLOD = m_mesh->SelectLOD(*m_transform, camera, viewportHeight, maxPixelError);
+}
+
+void QuantumEngine::Rendering::Vulkan::Rasterization::VulkanRasterizationPipelineModule::UpdateVisibility(const FrustumCuller& culler)
+{
+	m_isVisible = culler.IsVisible(m_cullingIndex);
+}
@@ -4,6 +4,9 @@
 namespace QuantumEngine {
 	class GameEntity;
 	class Mesh;
+	class Transform;
+	class Camera;
+	class FrustumCuller;
 
 	namespace Rendering::Vulkan {
 		class VulkanMeshController;
@@ -22,15 +25,42 @@ namespace QuantumEngine::Rendering::Vulkan::Rasterization {
 		void RenderCommand(VkCommandBuffer commandBuffer);
 		bool Initialize(const ref<GameEntity>& entity, ref<VulkanRasterizationMaterial> material, const VkRenderPass m_renderPass);
 		void SetDescriptorOffset(const std::string& name, UInt32 offset);
+		void UpdateLOD(const Camera& camera, Float viewportHeight, Float maxPixelError);
+
+		/// <summary>
+		/// index of the entity in the context's FrustumCuller, RenderCommand records nothing while it is culled
+		/// </summary>
+		inline void SetCullingIndex(UInt32 index) { m_cullingIndex = index; }
+		void UpdateVisibility(const FrustumCuller& culler);
+
+		/// <summary>
+		/// predicates the draw on the UInt32 at the culling index, the GPU culling pass writes it before the draw is executed
+		/// </summary>
+		void SetVisibilityBuffer(VkBuffer buffer);
 	private:
 		static VkVertexInputBindingDescription s_bindingDescriptions;
 		static VkVertexInputAttributeDescription s_attributeDescriptions[3];
 		static VkPipelineVertexInputStateCreateInfo s_vertexInputInfo;
+		static VkVertexInputBindingDescription s_quantizedBindingDescriptions;
+		static VkVertexInputAttributeDescription s_quantizedAttributeDescriptions[3];
+		static VkPipelineVertexInputStateCreateInfo s_quantizedVertexInputInfo;
+		static VkSpecializationMapEntry s_quantizedSpecializationEntry;
+		static VkBool32 s_quantizedSpecializationValue;
+		static VkSpecializationInfo s_quantizedSpecializationInfo;
 
 		VkDevice m_device; 
 		VkPipeline m_graphicsPipeline;
 		ref<Mesh> m_mesh;
 		ref<VulkanMeshController> m_meshController;
+		ref<Transform> m_transform;
+		std::vector<ref<Mesh>> m_lodMeshes;
+		std::vector<ref<VulkanMeshController>> m_lodControllers;
+		UInt32 m_currentLOD = 0;
+		UInt32 m_cullingIndex = 0;
+		bool m_isVisible = true;
+		VkBuffer m_visibilityBuffer = VK_NULL_HANDLE;
+		PFN_vkCmdBeginConditionalRenderingEXT m_beginConditionalRenderingPtr = nullptr;
+		PFN_vkCmdEndConditionalRenderingEXT m_endConditionalRenderingPtr = nullptr;
 		ref<VulkanRasterizationMaterial> m_material;
 		ref<SPIRVRasterizationProgram> m_program;
 		std::vector<UInt32> m_offset;
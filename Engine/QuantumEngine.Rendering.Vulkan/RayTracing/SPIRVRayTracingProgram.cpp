@@ -152,8 +152,7 @@ ref<QuantumEngine::Rendering::Vulkan::RayTracing::SPIRVRayTracingProgramVariant>
 		{HLSL_TRANSFORM_ARRAY, 3},
 		{HLSL_RT_TLAS_SCENE_NAME, 4},
 		{HLSL_RT_OUTPUT_TEXTURE_NAME, 5},
-		{HLSL_RT_VERTEX_BUFFER_ARRAY, 6},
-		{HLSL_RT_INDEX_BUFFER_ARRAY, 7},
+		{HLSL_RT_INSTANCE_RESOURCES, 6},
 	};
 
 	spvReflectEnumerateDescriptorBindings(&m_reflectionModule, &descriptorCount, nullptr);
@@ -170,6 +169,13 @@ ref<QuantumEngine::Rendering::Vulkan::RayTracing::SPIRVRayTracingProgramVariant>
 			continue;
 		}
 
+		// unbounded arrays alias the single array of the bindless table
+		if (descriptor->array.dims_count > 0 && descriptor->array.dims[0] == 0) {
+			*(wordByteCode + descriptor->word_offset.set) = descriptor->descriptor_type == SPV_REFLECT_DESCRIPTOR_TYPE_SAMPLED_IMAGE ? RT_BINDLESS_IMAGE_SET : RT_BINDLESS_BUFFER_SET;
+			*(wordByteCode + descriptor->word_offset.binding) = 0;
+			continue;
+		}
+
 		UInt32 binding = *(wordByteCode + descriptor->word_offset.binding);
 		
 		auto nameIt = specialNames.find(descriptor->name);
@@ -85,7 +85,7 @@ bool QuantumEngine::Rendering::Vulkan::RayTracing::VulkanRayTracingContext::Prep
         index++;
     }
 
-	if(m_rayTracingModule->Initialize(scene->entities, scene->rtGlobalMaterial, m_cameraBuffer, m_lightBuffer, m_transformBuffer, m_swapChainCapability.currentExtent) == false)
+	if(m_rayTracingModule->Initialize(scene->entities, scene->rtGlobalMaterial, m_cameraBuffer, m_lightBuffer, m_transformBuffer, m_swapChainCapability.currentExtent, m_assetManager) == false)
 		return false;
 
 	m_rayTracingModule->SetImage(HLSL_RT_OUTPUT_TEXTURE_NAME, m_outputImageView);
@@ -96,6 +96,7 @@ bool QuantumEngine::Rendering::Vulkan::RayTracing::VulkanRayTracingContext::Prep
 void QuantumEngine::Rendering::Vulkan::RayTracing::VulkanRayTracingContext::Render()
 {
     UpdateCameraBuffer();
+    UpdateLightBuffer();
     UpdateTransforms();
 
     vkResetFences(m_logicDevice, 1, &m_fence);
@@ -7,7 +7,7 @@
 #include "Rendering/Material.h"
 #include "Core/VulkanBufferFactory.h"
 
-bool QuantumEngine::Rendering::Vulkan::RayTracing::VulkanRayTracingPipelineBuilder::BuildRayTracingPipeline(const ref<SPIRVRayTracingProgram>& globalRTProgram, const std::vector<ref<SPIRVRayTracingProgram>>& localPrograms, RayTracePipelineBuildResult& pipelineResult)
+bool QuantumEngine::Rendering::Vulkan::RayTracing::VulkanRayTracingPipelineBuilder::BuildRayTracingPipeline(const ref<SPIRVRayTracingProgram>& globalRTProgram, const std::vector<ref<SPIRVRayTracingProgram>>& localPrograms, const VulkanBindlessTable* bindlessTable, RayTracePipelineBuildResult& pipelineResult)
 {
 	auto device = VulkanDeviceManager::Instance()->GetGraphicDevice();
 
@@ -27,7 +27,7 @@ bool QuantumEngine::Rendering::Vulkan::RayTracing::VulkanRayTracingPipelineBuild
 		.compareEnable = VK_FALSE,
 		.compareOp = VK_COMPARE_OP_ALWAYS,
 		.minLod = 0.0f,
-		.maxLod = 0.0f,
+		.maxLod = VK_LOD_CLAMP_NONE,
 		.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK,
 		.unnormalizedCoordinates = VK_FALSE,
 	};
@@ -57,7 +57,7 @@ bool QuantumEngine::Rendering::Vulkan::RayTracing::VulkanRayTracingPipelineBuild
 
 	pipelineResult.rtDescriptorLayouts.resize(pipelineResult.reflection.GetDescriptorLayoutCount());
 	pipelineResult.reflection.CreatePipelineLayout(device, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_MISS_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_INTERSECTION_BIT_KHR | VK_SHADER_STAGE_ANY_HIT_BIT_KHR
-		, pipelineResult.sampler, &pipelineResult.rtPipelineLayout, pipelineResult.rtDescriptorLayouts.data());
+		, pipelineResult.sampler, &pipelineResult.rtPipelineLayout, pipelineResult.rtDescriptorLayouts.data(), bindlessTable);
 
 	std::vector<VkPipelineShaderStageCreateInfo> stages;
 	std::vector<VkRayTracingShaderGroupCreateInfoKHR> groups;
@@ -7,6 +7,10 @@ namespace QuantumEngine::Rendering {
 	class Material;
 }
 
+namespace QuantumEngine::Rendering::Vulkan {
+	class VulkanBindlessTable;
+}
+
 namespace QuantumEngine::Rendering::Vulkan::RayTracing {
 	class SPIRVRayTracingProgram;
 	class SPIRVRayTracingProgramVariant;
@@ -48,7 +52,7 @@ namespace QuantumEngine::Rendering::Vulkan::RayTracing {
 
 	class VulkanRayTracingPipelineBuilder {
 	public:
-		static bool BuildRayTracingPipeline(const ref<SPIRVRayTracingProgram>& globalMaterial, const std::vector<ref<SPIRVRayTracingProgram>>& localPrograms, RayTracePipelineBuildResult& pipelineResult);
+		static bool BuildRayTracingPipeline(const ref<SPIRVRayTracingProgram>& globalMaterial, const std::vector<ref<SPIRVRayTracingProgram>>& localPrograms, const VulkanBindlessTable* bindlessTable, RayTracePipelineBuildResult& pipelineResult);
 		static bool BuildRayTracingSBT(const ref<Material>& globalRTMaterial, const std::vector<ref<Material>>& localMaterials, const RayTracePipelineBuildResult& pipelineData, RayTraceSBTBuildResult& sbtResult);
 	};
 }
\ No newline at end of file
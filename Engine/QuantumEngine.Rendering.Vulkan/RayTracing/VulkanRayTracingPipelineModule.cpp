@@ -19,6 +19,8 @@
 #include <iterator>
 #include "Core/Texture2D.h"
 #include "Core/VulkanTexture2DController.h"
+#include "Core/VulkanAssetManager.h"
+#include "Core/VulkanBindlessTable.h"
 
 QuantumEngine::Rendering::Vulkan::RayTracing::VulkanRayTracingPipelineModule::VulkanRayTracingPipelineModule()
 	: m_device(VulkanDeviceManager::Instance()->GetGraphicDevice()),
@@ -40,11 +42,22 @@ QuantumEngine::Rendering::Vulkan::RayTracing::VulkanRayTracingPipelineModule::~V
 
 	vkDestroyBuffer(m_device, m_SBT, nullptr);
 	vkFreeMemory(m_device, m_SBTMemory, nullptr);
+
+	vkDestroyBuffer(m_device, m_instanceResourceBuffer, nullptr);
+	vkFreeMemory(m_device, m_instanceResourceMemory, nullptr);
+
+	for (auto& [variant, programData] : m_resourceMaps) {
+		for (auto& image : programData.images) {
+			vkDestroyBuffer(m_device, image.indexBuffer, nullptr);
+			vkFreeMemory(m_device, image.indexMemory, nullptr);
+		}
+	}
 }
 
-bool QuantumEngine::Rendering::Vulkan::RayTracing::VulkanRayTracingPipelineModule::Initialize(std::vector<ref<GameEntity>>& entities, const ref<Material> rtMaterial, VkBuffer camBuffer, VkBuffer lightBuffer, VkBuffer transformBuffer, const VkExtent2D& extent)
+bool QuantumEngine::Rendering::Vulkan::RayTracing::VulkanRayTracingPipelineModule::Initialize(std::vector<ref<GameEntity>>& entities, const ref<Material> rtMaterial, VkBuffer camBuffer, VkBuffer lightBuffer, VkBuffer transformBuffer, const VkExtent2D& extent, const ref<VulkanAssetManager>& assetManager)
 {
 	m_extent = extent;
+	m_bindlessTable = assetManager->GetBindlessTable();
 	VkCommandPool commandPool;
 	VkCommandBuffer commandBuffer;
 
@@ -87,7 +100,7 @@ bool QuantumEngine::Rendering::Vulkan::RayTracing::VulkanRayTracingPipelineModul
 			return std::dynamic_pointer_cast<SPIRVRayTracingProgram>(rtComponent->GetRTMaterial()->GetProgram()); 
 		});
 
-	VulkanRayTracingPipelineBuilder::BuildRayTracingPipeline(m_globalRtProgram, localPrograms, pipelineResult);
+	VulkanRayTracingPipelineBuilder::BuildRayTracingPipeline(m_globalRtProgram, localPrograms, m_bindlessTable.get(), pipelineResult);
 
 	for (auto& matPair : pipelineResult.programPipelineBlueprintMap)
 		m_programVariantMap.emplace(matPair.first, matPair.second.variant);
@@ -134,6 +147,11 @@ bool QuantumEngine::Rendering::Vulkan::RayTracing::VulkanRayTracingPipelineModul
 			});
 	}
 
+	for (auto& [variant, programData] : m_resourceMaps) {
+		for (auto& [material, materialData] : programData.materialIndexMap)
+			m_modifiedMaterialLookup.emplace(material.get(), std::make_pair(&programData, &materialData));
+	}
+
 	////// Create Acceleration Structures
 
 	// Create BLASs
@@ -317,11 +335,14 @@ bool QuantumEngine::Rendering::Vulkan::RayTracing::VulkanRayTracingPipelineModul
 	UInt32 setcount = m_reflection.GetDescriptorLayoutCount();
 
 	for (auto& descriptor : descriptors) {
+		if (descriptor.isDynamicArray) // allocated by the bindless table
+			continue;
+
 		auto it = std::find_if(poolSizes.begin(), poolSizes.end(), [descriptor](const VkDescriptorPoolSize& poolSize) {
 			return descriptor.descriptorType == poolSize.type;
 			});
 
-		UInt32 newCount = descriptor.isDynamicArray ? 200 : 1; //TODO fix hard coded size for dynamic arrays
+		UInt32 newCount = 1;
 
 		if (it != poolSizes.end())
 			(*it).descriptorCount += newCount;
@@ -359,6 +380,11 @@ bool QuantumEngine::Rendering::Vulkan::RayTracing::VulkanRayTracingPipelineModul
 	};
 
 	for (UInt32 i = 0; i < m_descriptorLayouts.size(); i++) {
+		m_descriptorSets[i] = m_bindlessTable->GetDescriptorSet(m_descriptorLayouts[i]);
+
+		if (m_descriptorSets[i] != VK_NULL_HANDLE)
+			continue;
+
 		descSetAlloc.pSetLayouts = m_descriptorLayouts.data() + i;
 
 		if (vkAllocateDescriptorSets(m_device, &descSetAlloc, m_descriptorSets.data() + i) != VK_SUCCESS)
@@ -388,29 +414,72 @@ bool QuantumEngine::Rendering::Vulkan::RayTracing::VulkanRayTracingPipelineModul
 		vkUpdateDescriptorSets(m_device, 1, &writeAS, 0, nullptr);
 	}
 
-	m_vertexStorageBuffers.reserve(m_entities.size());
-	m_indexStorageBuffers.reserve(m_entities.size());
+	// mesh buffers are shared by every instance of a mesh, hit shaders find them through InstanceIndex()
+	std::vector<InstanceResourceData> instanceResources(m_entities.size());
 
-	for (auto& entityData : m_entities) {
-		auto rtComponent = entityData.gameEntity->GetRayTracingComponent();
+	for (UInt32 i = 0; i < m_entities.size(); i++) {
+		auto rtComponent = m_entities[i].gameEntity->GetRayTracingComponent();
 		auto meshController = std::dynamic_pointer_cast<VulkanMeshController>(rtComponent->GetMesh()->GetGPUHandle());
-		
-		m_vertexStorageBuffers.push_back(meshController->CreateVertexStorageBuffer());
-		m_indexStorageBuffers.push_back(meshController->CreateIndexStorageBuffer());
+
+		if (assetManager->GetMeshStorageIndices(meshController, &instanceResources[i].vertexBuffer, &instanceResources[i].indexBuffer) == false)
+			return false;
 	}
 
-	WriteArrayBuffer(HLSL_RT_VERTEX_BUFFER_ARRAY, m_vertexStorageBuffers);
-	WriteArrayBuffer(HLSL_RT_INDEX_BUFFER_ARRAY, m_indexStorageBuffers);
+	UInt32 instanceResourceSize = sizeof(InstanceResourceData) * std::max((UInt32)instanceResources.size(), 1u);
+
+	if (m_bufferFactory->CreateBuffer(instanceResourceSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &m_instanceResourceBuffer, &m_instanceResourceMemory) == false)
+		return false;
+
+	vkMapMemory(m_device, m_instanceResourceMemory, 0, instanceResourceSize, 0, &data);
+	std::memcpy(data, instanceResources.data(), sizeof(InstanceResourceData) * instanceResources.size());
+	vkUnmapMemory(m_device, m_instanceResourceMemory);
+
+	WriteBuffers(HLSL_RT_INSTANCE_RESOURCES, m_instanceResourceBuffer);
 
 	for (auto& [variantProgram, matResourceData] : m_resourceMaps) {
 		auto& material = matResourceData.materialIndexMap.begin()->first;
 
 		auto& textureFields = *(material->GetTextureFields());
-		matResourceData.images.resize(textureFields.size());
+		UInt32 fieldCount = 0;
+
+		for (auto& [name, MatTextureData] : textureFields)
+			fieldCount = std::max(fieldCount, MatTextureData.fieldIndex + 1);
+
+		matResourceData.images.resize(fieldCount);
+
+		// one row per material of the program, written again whenever a material changes its texture
+		UInt32 indexBufferSize = sizeof(UInt32) * (UInt32)matResourceData.materialIndexMap.size();
 
 		for (auto& [name, MatTextureData] : textureFields) {
 			auto& x = matResourceData.images[MatTextureData.fieldIndex];
-			variantProgram->GetBindingAndSet(name + "Array", &x.binding, &x.set);
+			variantProgram->GetBindingAndSet(name + HLSL_RT_TEXTURE_INDICES_SUFFIX, &x.binding, &x.set);
+
+			if (m_bufferFactory->CreateBuffer(indexBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &x.indexBuffer, &x.indexMemory) == false)
+				return false;
+
+			vkMapMemory(m_device, x.indexMemory, 0, VK_WHOLE_SIZE, 0, (void**)&x.textureIndices);
+			std::fill_n(x.textureIndices, matResourceData.materialIndexMap.size(), m_bindlessTable->GetFallbackImageIndex());
+
+			VkDescriptorBufferInfo indexBufferInfo{
+				.buffer = x.indexBuffer,
+				.offset = 0,
+				.range = VK_WHOLE_SIZE,
+			};
+
+			VkWriteDescriptorSet write{
+				.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+				.pNext = nullptr,
+				.dstSet = m_descriptorSets[x.set],
+				.dstBinding = x.binding,
+				.dstArrayElement = 0,
+				.descriptorCount = 1,
+				.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+				.pImageInfo = nullptr,
+				.pBufferInfo = &indexBufferInfo,
+				.pTexelBufferView = nullptr,
+			};
+
+			vkUpdateDescriptorSets(m_device, 1, &write, 0, nullptr);
 		}
 	}
 
@@ -421,53 +490,40 @@ bool QuantumEngine::Rendering::Vulkan::RayTracing::VulkanRayTracingPipelineModul
 
 void QuantumEngine::Rendering::Vulkan::RayTracing::VulkanRayTracingPipelineModule::RenderCommand(VkCommandBuffer commandBuffer)
 {
-	for (auto& [variantProgram, matResourceData]  : m_resourceMaps) {
-		for (auto& [material, index] : matResourceData.materialIndexMap) {
-			auto& innerTextureFields = material->GetModifiedTextures();
-
-			if (innerTextureFields.size() == 0)
-				continue;
-
-			for (auto& modifiedTextureField : innerTextureFields) {
-				auto& n = matResourceData.images[modifiedTextureField->fieldIndex];
-				auto textureController = std::dynamic_pointer_cast<VulkanTexture2DController>(modifiedTextureField->texture->GetGPUHandle());
-
-				VkDescriptorImageInfo info{};
-				info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-				info.imageView = textureController->GetImageView();
-				info.sampler = VK_NULL_HANDLE;
-
-				VkWriteDescriptorSet write{};
-				write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-				write.dstSet = m_descriptorSets[n.set];
-				write.dstBinding = n.binding;              // matches HLSL binding
-				write.dstArrayElement = index.textureArrayIndex;
-				write.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-				write.descriptorCount = 1;
-				write.pImageInfo = &info;
-
-				vkUpdateDescriptorSets(m_device, 1, &write, 0, nullptr);
-			}
-
-			material->ClearTextures();
-		}
+	// only materials changed since the last frame are visited. Their bindless texture indices and values
+	// are written straight into the persistently mapped index buffers and shader binding table
+	for (Material* material : Material::GetModifiedMaterials()) {
+		auto it = m_modifiedMaterialLookup.find(material);
 
-		for (auto& [material, matResourceData] : matResourceData.materialIndexMap) {
-			auto& innerValueFields = material->GetModifiedValues();
+		if (it == m_modifiedMaterialLookup.end())
+			continue;
 
-			if (innerValueFields.size() == 0)
-				continue;
+		ProgramResourceData& programData = *it->second.first;
+		MaterialResourceDatas& materialData = *it->second.second;
 
-			for (auto& modifiedValueField : innerValueFields) {
-				auto& locations = matResourceData.datalocations[modifiedValueField->fieldIndex];
-				
-				for (auto& location : locations)
-					std::memcpy(location, modifiedValueField->data, modifiedValueField->size);
+		material->ForEachModifiedTexture([&](MaterialTextureData& modifiedTextureField) {
+			auto& n = programData.images[modifiedTextureField.fieldIndex];
+			auto textureController = std::dynamic_pointer_cast<VulkanTexture2DController>(modifiedTextureField.texture->GetGPUHandle());
+			n.textureIndices[materialData.textureArrayIndex] = textureController->GetBindlessIndex();
+		});
 
-			}
+		material->ForEachModifiedValue([&](MaterialValueData& modifiedValueField) {
+			for (auto& location : materialData.datalocations[modifiedValueField.fieldIndex])
+				std::memcpy(location, modifiedValueField.data, modifiedValueField.size);
+		});
 
-			material->ClearModifiedValues();
-		}
+		material->ClearModifiedTextures();
+		material->ClearModifiedValues();
+	}
+
+	Material::RemoveUnmodifiedMaterials();
+
+	// the bindless table reallocates its sets when it grows
+	for (UInt32 i = 0; i < m_descriptorLayouts.size(); i++) {
+		VkDescriptorSet bindlessSet = m_bindlessTable->GetDescriptorSet(m_descriptorLayouts[i]);
+
+		if (bindlessSet != VK_NULL_HANDLE)
+			m_descriptorSets[i] = bindlessSet;
 	}
 
 	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, m_rtPipeline);
@@ -522,14 +578,14 @@ void QuantumEngine::Rendering::Vulkan::RayTracing::VulkanRayTracingPipelineModul
 	buildAccelerationStructurePtr(commandBuffer, 1, &buildCmdInfo, &pRangeInfo);
 }
 
-void QuantumEngine::Rendering::Vulkan::RayTracing::VulkanRayTracingPipelineModule::SetImage(const std::string& name, const VkImageView imageView)
+void QuantumEngine::Rendering::Vulkan::RayTracing::VulkanRayTracingPipelineModule::SetImage(const std::string& name, const VkImageView imageView, VkImageLayout layout)
 {
 	auto descriptorData = m_reflection.GetDescriptorData(name);
 
 	if (descriptorData != nullptr) {
 		VkDescriptorImageInfo imgDesc{};
 		imgDesc.imageView = imageView;
-		imgDesc.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+		imgDesc.imageLayout = layout;
 
 		VkWriteDescriptorSet write{};
 		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
@@ -570,33 +626,4 @@ void QuantumEngine::Rendering::Vulkan::RayTracing::VulkanRayTracingPipelineModul
 	};
 
 	vkUpdateDescriptorSets(m_device, 1, &writeDescriptor, 0, nullptr);
-}
-
-void QuantumEngine::Rendering::Vulkan::RayTracing::VulkanRayTracingPipelineModule::WriteArrayBuffer(const std::string name, const std::vector<VkBuffer>& buffers)
-{
-	auto descriptorData = m_reflection.GetDescriptorData(name);
-
-	if (descriptorData == nullptr)
-		return;
-
-	std::vector<VkDescriptorBufferInfo> bufferInfos;
-	bufferInfos.reserve(buffers.size());
-
-	for (auto& buffer : buffers) {
-		bufferInfos.push_back(VkDescriptorBufferInfo{
-			.buffer = buffer,
-			.offset = 0,
-			.range = VK_WHOLE_SIZE,
-			});
-	}
-
-	VkWriteDescriptorSet write{};
-	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	write.dstSet = m_descriptorSets[descriptorData->data.set];
-	write.dstBinding = descriptorData->data.binding;
-	write.descriptorType = descriptorData->descriptorType;
-	write.descriptorCount = (UInt32)(bufferInfos.size()); // Current dynamic size
-	write.pBufferInfo = bufferInfos.data();
-
-	vkUpdateDescriptorSets(m_device, 1, &write, 0, nullptr);
-}
+}
\ No newline at end of file
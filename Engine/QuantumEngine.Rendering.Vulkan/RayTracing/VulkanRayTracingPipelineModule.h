@@ -15,6 +15,8 @@ namespace QuantumEngine::Rendering::Vulkan {
 	struct VKEntityGPUData;
 	class VulkanBufferFactory;
 	class VulkanMeshController;
+	class VulkanAssetManager;
+	class VulkanBindlessTable;
 }
 
 namespace QuantumEngine::Rendering::Vulkan::RayTracing {
@@ -27,25 +29,38 @@ namespace QuantumEngine::Rendering::Vulkan::RayTracing {
 		VulkanRayTracingPipelineModule();
 		~VulkanRayTracingPipelineModule();
 
-		bool Initialize(std::vector<ref<GameEntity>>& entities, const ref<Material> rtMaterial, VkBuffer camBuffer, VkBuffer lightBuffer, VkBuffer transformBuffer, const VkExtent2D& extent);
+		bool Initialize(std::vector<ref<GameEntity>>& entities, const ref<Material> rtMaterial, VkBuffer camBuffer, VkBuffer lightBuffer, VkBuffer transformBuffer, const VkExtent2D& extent, const ref<VulkanAssetManager>& assetManager);
 		void RenderCommand(VkCommandBuffer commandBuffer);
 		void UpdateTLAS(VkCommandBuffer commandBuffer);
-		void SetImage(const std::string& name, const VkImageView imageView);
+		/// <summary>
+		/// layout is the one the image is in while the ray tracing pipeline runs
+		/// </summary>
+		void SetImage(const std::string& name, const VkImageView imageView, VkImageLayout layout = VK_IMAGE_LAYOUT_GENERAL);
 	private:
 		void WriteBuffers(const std::string name, const VkBuffer buffer);
-		void WriteArrayBuffer(const std::string name, const std::vector<VkBuffer>& buffers);
 		struct VKEntityGPUData {
 		public:
 			ref<GameEntity> gameEntity;
 			UInt32 index;
 		};
 
+		// bindless table index of the field's texture for every material of the program
 		struct MaterialTextureFieldData {
 			UInt32 binding;
 			UInt32 set;
+			VkBuffer indexBuffer = VK_NULL_HANDLE;
+			VkDeviceMemory indexMemory = VK_NULL_HANDLE;
+			UInt32* textureIndices = nullptr;
+		};
+
+		// bindless indices of the mesh buffers of a TLAS instance, matches RTInstanceResources in RTStructs.hlsli
+		struct InstanceResourceData {
+			UInt32 vertexBuffer;
+			UInt32 indexBuffer;
 		};
 
 		struct MaterialResourceDatas {
+			// InstanceID() of the material's instances, the row of the material in the texture index buffers
 			UInt32 textureArrayIndex;
 			std::vector<std::set<Byte*>> datalocations;
 		};
@@ -70,6 +85,7 @@ namespace QuantumEngine::Rendering::Vulkan::RayTracing {
 		VkDevice m_device;
 		VkDescriptorPool m_descriptorPool;
 		ref<VulkanBufferFactory> m_bufferFactory;
+		ref<VulkanBindlessTable> m_bindlessTable;
 
 		std::vector<VKEntityGPUData> m_entities;
 
@@ -112,9 +128,11 @@ namespace QuantumEngine::Rendering::Vulkan::RayTracing {
 		ref<Material> m_globalMaterial;
 		SPIRVReflection m_reflection;
 
-		std::vector<VkBuffer> m_indexStorageBuffers;
-		std::vector<VkBuffer> m_vertexStorageBuffers;
+		VkBuffer m_instanceResourceBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory m_instanceResourceMemory = VK_NULL_HANDLE;
 
 		std::map<ref<SPIRVRayTracingProgramVariant>, ProgramResourceData> m_resourceMaps;
+		// material entries of m_resourceMaps keyed by the raw pointer, to look up the entries of Material::GetModifiedMaterials
+		std::map<Material*, std::pair<ProgramResourceData*, MaterialResourceDatas*>> m_modifiedMaterialLookup;
 	};
 }
\ No newline at end of file
@@ -3,47 +3,89 @@
 #include "Core/VulkanDeviceManager.h"
 #include "Core/VulkanBufferFactory.h"
 #include "Rasterization/SPIRVRasterizationProgram.h"
+#include "Core/VulkanBindlessTable.h"
 #include "Core/VulkanHybridContext.h"
 #include "Core/Mesh.h"
 #include "Core/GameEntity.h"
+#include "Core/Transform.h"
+#include "Core/Camera/FrustumCuller.h"
 #include "Rendering/GBufferRTReflectionRenderer.h"
-#include "Core/VulkanMeshController.h"
 #include "Core/VulkanUtilities.h"
+#include "Compute/SPIRVComputeProgram.h"
+#include <map>
 
 QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::VulkanGBufferPipelineModule()
 	:m_device(VulkanDeviceManager::Instance()->GetGraphicDevice()),
-	m_positionFormat(VK_FORMAT_R16G16B16A16_SFLOAT), 
-	m_normalFormat(VK_FORMAT_R16G16B16A16_UNORM), 
-	m_maskFormat(VK_FORMAT_R32_UINT)
+	// octahedral normal and mask, matches PackGBufferNormal in Common/GBufferFunctions.hlsli
+	m_normalFormat(VK_FORMAT_R16G16_UINT)
 {
 }
 
 QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::~VulkanGBufferPipelineModule()
 {
-	vkDestroyImageView(m_device, m_positionImageView, nullptr);
-	vkDestroyImage(m_device, m_positionImage, nullptr);
-	vkFreeMemory(m_device, m_positionImageMemory, nullptr);
-
 	vkDestroyImageView(m_device, m_normalImageView, nullptr);
 	vkDestroyImage(m_device, m_normalImage, nullptr);
 	vkFreeMemory(m_device, m_normalImageMemory, nullptr);
 
-	vkDestroyImageView(m_device, m_maskImageView, nullptr);
-	vkDestroyImage(m_device, m_maskImage, nullptr);
-	vkFreeMemory(m_device, m_maskImageMemory, nullptr);
-
 	vkDestroyFramebuffer(m_device, m_frameBuffer, nullptr);
 
 	vkDestroyRenderPass(m_device, m_renderPass, nullptr);
+
+	vkDestroyPipeline(m_device, m_gBufferPipeline, nullptr);
+	vkDestroyPipeline(m_device, m_quantizedGBufferPipeline, nullptr);
+	vkDestroyPipeline(m_device, m_cullPipeline, nullptr);
+
+	for (UInt32 i = 0; i < GBUFFER_PIPELINE_COUNT; i++) {
+		vkDestroyBuffer(m_device, m_vertexBuffers[i], nullptr);
+		vkFreeMemory(m_device, m_vertexBufferMemories[i], nullptr);
+	}
+
+	vkDestroyBuffer(m_device, m_indexBuffer, nullptr);
+	vkFreeMemory(m_device, m_indexBufferMemory, nullptr);
+
+	if (m_instanceData != nullptr)
+		vkUnmapMemory(m_device, m_instanceBufferMemory);
+
+	vkDestroyBuffer(m_device, m_instanceBuffer, nullptr);
+	vkFreeMemory(m_device, m_instanceBufferMemory, nullptr);
+
+	vkDestroyBuffer(m_device, m_drawCommandBuffer, nullptr);
+	vkFreeMemory(m_device, m_drawCommandBufferMemory, nullptr);
+
+	vkDestroyBuffer(m_device, m_drawCountBuffer, nullptr);
+	vkFreeMemory(m_device, m_drawCountBufferMemory, nullptr);
+
+	if (m_occlusionParameters != nullptr)
+		vkUnmapMemory(m_device, m_occlusionBufferMemory);
+
+	vkDestroyBuffer(m_device, m_occlusionBuffer, nullptr);
+	vkFreeMemory(m_device, m_occlusionBufferMemory, nullptr);
+
+	vkDestroyBuffer(m_device, m_visibilityBuffer, nullptr);
+	vkFreeMemory(m_device, m_visibilityBufferMemory, nullptr);
+
+	vkDestroyPipeline(m_device, m_hiZPipeline, nullptr);
+
+	for (UInt32 i = 0; i < HIZ_MAX_MIP_COUNT; i++)
+		vkDestroyImageView(m_device, m_hiZMipViews[i], nullptr);
+
+	vkDestroyImageView(m_device, m_hiZImageView, nullptr);
+	vkDestroyImage(m_device, m_hiZImage, nullptr);
+	vkFreeMemory(m_device, m_hiZImageMemory, nullptr);
+
+	vkDestroyBuffer(m_device, m_hiZCounterBuffer, nullptr);
+	vkFreeMemory(m_device, m_hiZCounterBufferMemory, nullptr);
 }
 
-bool QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::InitializePipeline(const std::vector<VKEntityGPUData>& entities, const ref<Rasterization::SPIRVRasterizationProgram>& gBufferProgram, UInt32 width, UInt32 height, VkImageView depthView)
+bool QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::InitializePipeline(const std::vector<VKEntityGPUData>& entities, const std::vector<VKEntityGPUData>& forwardEntities, const ref<Rasterization::SPIRVRasterizationProgram>& gBufferProgram,
+	const ref<Compute::SPIRVComputeProgram>& cullProgram, const ref<Compute::SPIRVComputeProgram>& hiZProgram, UInt32 width, UInt32 height, VkImageView depthView)
 {
 	m_gBufferProgram = gBufferProgram;
+	m_cullProgram = cullProgram;
+	m_hiZProgram = hiZProgram;
 	m_depthView = depthView;
 	m_offsets = std::vector<UInt32>(gBufferProgram->GetReflection().GetDynamicDescriptorCount(), 0);
-	auto descriptorData = gBufferProgram->GetReflection().GetDescriptorData(HLSL_OBJECT_TRANSFORM_DATA_NAME);
-	m_transformIndex = descriptorData->offsetIndex;
+	m_cullOffsets = std::vector<UInt32>(cullProgram->GetReflection().GetDynamicDescriptorCount(), 0);
 	
 	if(CreateRenderPass() == false)
 		return false;
@@ -51,24 +93,31 @@ bool QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::InitializePi
 	if(CreateFrameBuffers(width, height) == false)
 		return false;
 
-	if(CreateRasterPipeline() == false)
+	if(CreateRasterPipeline(false, &m_gBufferPipeline) == false)
+		return false;
+
+	if (CreateHiZPyramid(width, height) == false)
 		return false;
 
 	if(CreateDescriptorSets(gBufferProgram) == false)
 		return false;
 
-	for (auto& entity : entities) {
-		m_entities.push_back(GBufferEntityGPUData{
-			.meshController = std::dynamic_pointer_cast<VulkanMeshController>(entity.gameEntity->GetRenderer()->GetMesh()->GetGPUHandle()),
-			.indexCount = entity.gameEntity->GetRenderer()->GetMesh()->GetIndexCount(),
-			.transformOffset = (UInt32)sizeof(TransformGPU) * entity.index,
-			});
-	}
+	if (CreateGeometryBuffers(entities, forwardEntities) == false)
+		return false;
+
+	if (m_pipelineInstanceCounts[1] > 0 && CreateRasterPipeline(true, &m_quantizedGBufferPipeline) == false)
+		return false;
+
+	if (CreateCullPipeline() == false)
+		return false;
+
+	if (CreateHiZPipeline() == false)
+		return false;
 
 	return true;
 }
 
-void QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::WriteBuffer(const std::string& name, VkBuffer buffer, UInt32 stride)
+void QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::WriteBuffer(const std::string& name, VkBuffer buffer, VkDeviceSize range)
 {
 	auto descriptorData = m_gBufferProgram->GetReflection().GetDescriptorData(name);
 
@@ -78,7 +127,7 @@ void QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::WriteBuffer(
 	VkDescriptorBufferInfo descBufferInfo{
 		.buffer = buffer,
 		.offset = 0,
-		.range = stride,
+		.range = range,
 	};
 
 	VkWriteDescriptorSet writeDescriptor{
@@ -97,11 +146,74 @@ void QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::WriteBuffer(
 	vkUpdateDescriptorSets(m_device, 1, &writeDescriptor, 0, nullptr);
 }
 
+void QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::WriteTransformBuffer(VkBuffer buffer)
+{
+	WriteBuffer(HLSL_TRANSFORM_ARRAY, buffer, VK_WHOLE_SIZE);
+	WriteComputeBuffer(m_cullProgram, m_cullDescriptorSet, HLSL_TRANSFORM_ARRAY, buffer);
+}
+
+void QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::CullCommand(VkCommandBuffer commandBuffer)
+{
+	// the pyramid stays in the general layout once the first frame moved it there
+	if (m_isHiZBuilt == false) {
+		VkImageMemoryBarrier hiZBarrier{
+			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+			.pNext = nullptr,
+			.srcAccessMask = 0,
+			.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+			.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+			.newLayout = VK_IMAGE_LAYOUT_GENERAL,
+			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.image = m_hiZImage,
+			.subresourceRange = {
+				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+				.baseMipLevel = 0,
+				.levelCount = m_hiZParameters.mipCount,
+				.baseArrayLayer = 0,
+				.layerCount = 1,
+			},
+		};
+
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+			0, nullptr, 0, nullptr, 1, &hiZBarrier);
+	}
+
+	vkCmdFillBuffer(commandBuffer, m_drawCountBuffer, 0, VK_WHOLE_SIZE, 0);
+
+	VkMemoryBarrier clearBarrier{
+		.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+		.pNext = nullptr,
+		.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+		.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+	};
+
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+		1, &clearBarrier, 0, nullptr, 0, nullptr);
+
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_cullPipeline);
+	vkCmdPushConstants(commandBuffer, m_cullProgram->GetPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(GBufferCullParameters), &m_cullParameters);
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_cullProgram->GetPipelineLayout(), 0, 1, &m_cullDescriptorSet, (UInt32)m_cullOffsets.size(), m_cullOffsets.data());
+
+	// 64 threads per group in g_buffer_cull.cs.hlsl
+	vkCmdDispatch(commandBuffer, (m_cullParameters.instanceCount + 63) / 64, 1, 1);
+
+	// draw commands for this pass, visibility flags for the forward passes
+	VkMemoryBarrier drawBarrier{
+		.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+		.pNext = nullptr,
+		.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+		.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_CONDITIONAL_RENDERING_READ_BIT_EXT,
+	};
+
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_CONDITIONAL_RENDERING_BIT_EXT, 0,
+		1, &drawBarrier, 0, nullptr, 0, nullptr);
+}
+
 void QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::RenderCommand(VkCommandBuffer commandBuffer)
 {
 	vkCmdBeginRenderPass(commandBuffer, &m_renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
 
-	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_gBufferPipeline);
 	VkDeviceSize offsets[] = { 0 };
 
 	VkViewport viewport{};
@@ -120,44 +232,94 @@ void QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::RenderComman
 
 	vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-	for (auto& entity : m_entities) {
-		auto indexBuffer = entity.meshController->GetIndexBuffer();
-		auto vertexBuffer = entity.meshController->GetVertexBuffer();
-		vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer, offsets);
-		vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);		
-		m_offsets[m_transformIndex] = entity.transformOffset;
+	// both pipelines share the layout of the G-buffer program
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_gBufferProgram->GetPipelineLayout(), 0, (UInt32)m_descriptorSets.size(), m_descriptorSets.data(), (UInt32)m_offsets.size(), m_offsets.data());
+	vkCmdBindIndexBuffer(commandBuffer, m_indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+
+	VkPipeline pipelines[GBUFFER_PIPELINE_COUNT] = { m_gBufferPipeline, m_quantizedGBufferPipeline };
+
+	for (UInt32 i = 0; i < GBUFFER_PIPELINE_COUNT; i++) {
+		if (m_pipelineInstanceCounts[i] == 0)
+			continue;
 
-		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_gBufferProgram->GetPipelineLayout(), 0, (UInt32)m_descriptorSets.size(), m_descriptorSets.data(), m_offsets.size(), m_offsets.data());
-		vkCmdDrawIndexed(commandBuffer, entity.indexCount, 1, 0, 0, 0);
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelines[i]);
+		vkCmdBindVertexBuffers(commandBuffer, 0, 1, &m_vertexBuffers[i], offsets);
+		vkCmdDrawIndexedIndirectCount(commandBuffer, m_drawCommandBuffer, m_pipelineDrawOffsets[i] * sizeof(VkDrawIndexedIndirectCommand),
+			m_drawCountBuffer, i * sizeof(UInt32), m_pipelineInstanceCounts[i], sizeof(VkDrawIndexedIndirectCommand));
 	}
 
 	vkCmdEndRenderPass(commandBuffer);
 }
 
-bool QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::CreateRenderPass()
+void QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::BuildHiZCommand(VkCommandBuffer commandBuffer)
 {
-	VkAttachmentDescription attachments[4] = {};
+	vkCmdFillBuffer(commandBuffer, m_hiZCounterBuffer, 0, VK_WHOLE_SIZE, 0);
 
-	attachments[0] = {
-		.format = m_positionFormat,
-		.samples = VK_SAMPLE_COUNT_1_BIT,
-		.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
-		.storeOp = VK_ATTACHMENT_STORE_OP_STORE,
-		.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-		.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+	// also keeps this frame's culling reads ahead of the pyramid writes, the depth is ordered by the render pass dependency
+	VkMemoryBarrier clearBarrier{
+		.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+		.pNext = nullptr,
+		.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+		.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
 	};
 
-	attachments[1] = {
-		.format = m_normalFormat,
-		.samples = VK_SAMPLE_COUNT_1_BIT,
-		.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
-		.storeOp = VK_ATTACHMENT_STORE_OP_STORE,
-		.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-		.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+		1, &clearBarrier, 0, nullptr, 0, nullptr);
+
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_hiZPipeline);
+	vkCmdPushConstants(commandBuffer, m_hiZProgram->GetPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(HiZBuildParameters), &m_hiZParameters);
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_hiZProgram->GetPipelineLayout(), 0, 1, &m_hiZDescriptorSet, 0, nullptr);
+
+	// one group per 64x64 tile of level 0
+	vkCmdDispatch(commandBuffer, m_hiZParameters.tileCount, 1, 1);
+
+	VkMemoryBarrier pyramidBarrier{
+		.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+		.pNext = nullptr,
+		.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+		.dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
 	};
 
-	attachments[2] = {
-		.format = m_maskFormat,
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+		1, &pyramidBarrier, 0, nullptr, 0, nullptr);
+
+	m_isHiZBuilt = true;
+}
+
+void QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::UpdateLODs(const Camera& camera, Float viewportHeight, Float maxPixelError)
+{
+	for (UInt32 i = 0; i < m_entities.size(); i++) {
+		auto& entity = m_entities[i];
+		UInt32 lod = entity.mesh->SelectLOD(*entity.transform, camera, viewportHeight, maxPixelError);
+
+		if (lod == entity.lod)
+			continue;
+
+		// the instance buffer is host coherent and the previous frame has finished reading it
+		auto& range = entity.lodRanges[lod];
+		m_instanceData[i].firstIndex = range.firstIndex;
+		m_instanceData[i].indexCount = range.indexCount;
+		m_instanceData[i].vertexOffset = range.vertexOffset;
+		entity.lod = lod;
+	}
+}
+
+void QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::UpdateFrustum(const Matrix4& viewProjection)
+{
+	FrustumCuller::ExtractPlanes(viewProjection, m_cullParameters.frustumPlanes);
+
+	// tested against the pyramid of the previous frame, built from the depth of its view projection
+	m_occlusionParameters->viewProjection = m_viewProjection;
+	m_occlusionParameters->enabled = m_isHiZBuilt ? 1 : 0;
+	m_viewProjection = viewProjection;
+}
+
+bool QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::CreateRenderPass()
+{
+	VkAttachmentDescription attachments[2] = {};
+
+	attachments[0] = {
+		.format = m_normalFormat,
 		.samples = VK_SAMPLE_COUNT_1_BIT,
 		.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
 		.storeOp = VK_ATTACHMENT_STORE_OP_STORE,
@@ -165,41 +327,54 @@ bool QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::CreateRender
 		.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
 	};
 
-	attachments[3] = {
+	attachments[1] = {
 		.format = VK_FORMAT_D32_SFLOAT,
 		.samples = VK_SAMPLE_COUNT_1_BIT,
 		.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
-		.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+		// kept for the Hi-Z build and the position reconstruction
+		.storeOp = VK_ATTACHMENT_STORE_OP_STORE,
 		.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
 		.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
 		.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-		.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+		.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
 	};
 
-	VkAttachmentReference colorRefs[3] = {
-		{0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL},
-		{1, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL},
-		{2, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL},
+	VkAttachmentReference colorRef{
+		.attachment = 0,
+		.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
 	};
 
 	VkAttachmentReference depthAttachmentRef{
-		.attachment = 3,
+		.attachment = 1,
 		.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
 	};
 
 	VkSubpassDescription subpass = {
 		.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,
-		.colorAttachmentCount = 3,
-		.pColorAttachments = colorRefs,
+		.colorAttachmentCount = 1,
+		.pColorAttachments = &colorRef,
 		.pDepthStencilAttachment = &depthAttachmentRef,
 	};
 
+	// depth writes have to land before BuildHiZCommand and the ray generation shader read them
+	VkSubpassDependency depthDependency{
+		.srcSubpass = 0,
+		.dstSubpass = VK_SUBPASS_EXTERNAL,
+		.srcStageMask = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+		.dstStageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR,
+		.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+		.dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+		.dependencyFlags = 0,
+	};
+
 	VkRenderPassCreateInfo rpInfo = {
 		.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
-		.attachmentCount = 4,
+		.attachmentCount = 2,
 		.pAttachments = attachments,
 		.subpassCount = 1,
 		.pSubpasses = &subpass,
+		.dependencyCount = 1,
+		.pDependencies = &depthDependency,
 	};
 
 	vkCreateRenderPass(m_device, &rpInfo, nullptr, &m_renderPass);
@@ -213,57 +388,35 @@ bool QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::CreateFrameB
 	m_height = height;
 	auto bufferFactory = VulkanDeviceManager::Instance()->GetBufferFactory();
 
-	// Position buffer
+	// Normal and mask buffer, sampled by the ray tracing and forward passes
 	VkImageCreateInfo imgInfo{};
 	imgInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
 	imgInfo.imageType = VK_IMAGE_TYPE_2D;
-	imgInfo.format = m_positionFormat;
+	imgInfo.format = m_normalFormat;
 	imgInfo.extent = { width, height, 1 };
 	imgInfo.mipLevels = 1;
 	imgInfo.arrayLayers = 1;
 	imgInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 	imgInfo.samples = VK_SAMPLE_COUNT_1_BIT;
 	imgInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-	imgInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | 
-		VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+	imgInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
 		VK_IMAGE_USAGE_SAMPLED_BIT;
 
-	bufferFactory->CreateImage(&imgInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &m_positionImage, &m_positionImageMemory);
+	bufferFactory->CreateImage(&imgInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &m_normalImage, &m_normalImageMemory);
 
 	VkImageViewCreateInfo viewInfo{};
 	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-	viewInfo.image = m_positionImage;
+	viewInfo.image = m_normalImage;
 	viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
 	viewInfo.format = imgInfo.format;
 	viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 	viewInfo.subresourceRange.levelCount = 1;
 	viewInfo.subresourceRange.layerCount = 1;
 
-	vkCreateImageView(m_device, &viewInfo, nullptr, &m_positionImageView);
-
-	//normalBuffer
-
-	imgInfo.format = m_normalFormat;
-	bufferFactory->CreateImage(&imgInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &m_normalImage, &m_normalImageMemory);
-
-	viewInfo.format = m_normalFormat;
-	viewInfo.image = m_normalImage;
-
 	vkCreateImageView(m_device, &viewInfo, nullptr, &m_normalImageView);
 
-	// Mask Buffer
-	imgInfo.format = m_maskFormat;
-	bufferFactory->CreateImage(&imgInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &m_maskImage, &m_maskImageMemory);
-
-	viewInfo.format = m_maskFormat;
-	viewInfo.image = m_maskImage;
-
-	vkCreateImageView(m_device, &viewInfo, nullptr, &m_maskImageView);
-
-	VkImageView views[4] = {
-	m_positionImageView,
+	VkImageView views[2] = {
 	m_normalImageView,
-	m_maskImageView,
 	m_depthView,
 	};
 
@@ -271,7 +424,7 @@ bool QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::CreateFrameB
 	VkFramebufferCreateInfo fbInfo = {
 	.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
 	.renderPass = m_renderPass,
-	.attachmentCount = 4,
+	.attachmentCount = 2,
 	.pAttachments = views,
 	.width = width,
 	.height = height,
@@ -280,10 +433,9 @@ bool QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::CreateFrameB
 
 	vkCreateFramebuffer(m_device, &fbInfo, nullptr, &m_frameBuffer);
 
-	m_clearValues[0].color = { {1.0f, 1.0f, 1.0f, 1.0f} };
-	m_clearValues[1].color = { {1.0f, 1.0f, 1.0f, 1.0f} };
-	m_clearValues[2].color = { {0.0f, 0.0f, 0.0f, 0.0f} };
-	m_clearValues[3].depthStencil = { 1.0f, 0 };
+	// mask 0 where nothing is drawn
+	m_clearValues[0].color = { .uint32 = { 0, 0, 0, 0 } };
+	m_clearValues[1].depthStencil = { 1.0f, 0 };
 
 	m_renderPassInfo = VkRenderPassBeginInfo{
 		.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
@@ -294,14 +446,14 @@ bool QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::CreateFrameB
 			.offset = { 0, 0 },
 			.extent = {width, height},
 		},
-		.clearValueCount = 4,
+		.clearValueCount = 2,
 		.pClearValues = m_clearValues,
 	};
 
 	return true;
 }
 
-bool QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::CreateRasterPipeline()
+bool QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::CreateRasterPipeline(bool quantizedVertex, VkPipeline* pipeline)
 {
 	VkVertexInputBindingDescription bindingDescriptions = {
 	.binding = 0,
@@ -325,6 +477,27 @@ bool QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::CreateRaster
 		.pVertexAttributeDescriptions = attributeDescriptions,
 	};
 
+	VkVertexInputBindingDescription quantizedBindingDescriptions = {
+	.binding = 0,
+	.stride = sizeof(QuantizedVertex),
+	.inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
+	};
+
+	VkVertexInputAttributeDescription quantizedAttributeDescriptions[3] = {
+		{.location = 0, .binding = 0, .format = VK_FORMAT_R16G16B16A16_SNORM, .offset = offsetof(QuantizedVertex, position) },
+		{.location = 1, .binding = 0, .format = VK_FORMAT_R16G16_SFLOAT, .offset = offsetof(QuantizedVertex, uv) },
+		{.location = 2, .binding = 0, .format = VK_FORMAT_R16G16_SNORM, .offset = offsetof(QuantizedVertex, normal) },
+	};
+
+	VkPipelineVertexInputStateCreateInfo quantizedVertexInputInfo = {
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+		.pNext = nullptr,
+		.flags = 0,
+		.vertexBindingDescriptionCount = 1,
+		.pVertexBindingDescriptions = &quantizedBindingDescriptions,
+		.vertexAttributeDescriptionCount = 3,
+		.pVertexAttributeDescriptions = quantizedAttributeDescriptions,
+	};
 
 
 	VkPipelineInputAssemblyStateCreateInfo pInputAssemblyInfo{
@@ -385,9 +558,7 @@ bool QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::CreateRaster
 		.maxDepthBounds = 1.0f,
 	};
 
-	VkPipelineColorBlendAttachmentState colorBlendAttachmentState[3];
-
-	colorBlendAttachmentState[0] = VkPipelineColorBlendAttachmentState{
+	VkPipelineColorBlendAttachmentState colorBlendAttachmentState{
 		.blendEnable = VK_FALSE,
 		.srcColorBlendFactor = VK_BLEND_FACTOR_ONE,
 		.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO,
@@ -395,19 +566,17 @@ bool QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::CreateRaster
 		.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
 		.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO,
 		.alphaBlendOp = VK_BLEND_OP_ADD,
-		.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT,
+		.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT,
 	};
 
-	colorBlendAttachmentState[2] = colorBlendAttachmentState[1] = colorBlendAttachmentState[0];
-
 	VkPipelineColorBlendStateCreateInfo colorBlendStateInfo{
 		.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
 		.pNext = nullptr,
 		.flags = 0,
 		.logicOpEnable = VK_FALSE,
 		.logicOp = VK_LOGIC_OP_COPY,
-		.attachmentCount = 3,
-		.pAttachments = colorBlendAttachmentState,
+		.attachmentCount = 1,
+		.pAttachments = &colorBlendAttachmentState,
 		.blendConstants = { 0.0f, 0.0f, 0.0f, 0.0f },
 	};
 
@@ -422,7 +591,29 @@ bool QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::CreateRaster
 		.pDynamicStates = dynamicStates.data(),
 	};
 
-	auto& stages = m_gBufferProgram->GetStageInfos();
+	std::vector<VkPipelineShaderStageCreateInfo> stages = m_gBufferProgram->GetStageInfos();
+
+	// constant_id 0 is _quantizedVertex in Common/VertexStructs.hlsli
+	VkBool32 quantizedValue = VK_TRUE;
+	VkSpecializationMapEntry specializationEntry{
+		.constantID = 0,
+		.offset = 0,
+		.size = sizeof(VkBool32),
+	};
+
+	VkSpecializationInfo specializationInfo{
+		.mapEntryCount = 1,
+		.pMapEntries = &specializationEntry,
+		.dataSize = sizeof(VkBool32),
+		.pData = &quantizedValue,
+	};
+
+	if (quantizedVertex) {
+		for (auto& stage : stages) {
+			if (stage.stage == VK_SHADER_STAGE_VERTEX_BIT)
+				stage.pSpecializationInfo = &specializationInfo;
+		}
+	}
 
 	VkGraphicsPipelineCreateInfo pipelineCreateInfo{
 		.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
@@ -430,7 +621,7 @@ bool QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::CreateRaster
 		.flags = 0,
 		.stageCount = (UInt32)stages.size(),
 		.pStages = stages.data(),
-		.pVertexInputState = &vertexInputInfo,
+		.pVertexInputState = quantizedVertex ? &quantizedVertexInputInfo : &vertexInputInfo,
 		.pInputAssemblyState = &pInputAssemblyInfo,
 		.pTessellationState = nullptr,
 		.pViewportState = &viewportStateInfo,
@@ -447,7 +638,7 @@ bool QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::CreateRaster
 
 	};
 
-	if (vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_gBufferPipeline) != VK_SUCCESS) {
+	if (vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, pipeline) != VK_SUCCESS) {
 		return false;
 	}
 
@@ -461,28 +652,33 @@ bool QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::CreateDescri
 
 	auto& reflection = gBufferProgram->GetReflection();
 	UInt32 setCount = reflection.GetDescriptorLayoutCount();
-	auto& descriptors = reflection.GetDescriptors();
 	m_descriptorSets.resize(setCount);
 
-	for (auto& descriptor : descriptors) {
-		auto it = std::find_if(poolSizes.begin(), poolSizes.end(), [descriptor](const VkDescriptorPoolSize& poolSize) {
-			return descriptor.descriptorType == poolSize.type;
-			});
+	// the culling and Hi-Z sets are allocated from the same pool
+	for (auto programReflection : { &reflection, &m_cullProgram->GetReflection(), &m_hiZProgram->GetReflection() }) {
+		for (auto& descriptor : programReflection->GetDescriptors()) {
+			if (descriptor.isDynamicArray) // allocated by the bindless table
+				continue;
 
-		if (it != poolSizes.end())
-			(*it).descriptorCount++;
-		else
-			poolSizes.push_back(VkDescriptorPoolSize{
-			.type = descriptor.descriptorType,
-			.descriptorCount = 1,
+			auto it = std::find_if(poolSizes.begin(), poolSizes.end(), [descriptor](const VkDescriptorPoolSize& poolSize) {
+				return descriptor.descriptorType == poolSize.type;
 				});
+
+			if (it != poolSizes.end())
+				(*it).descriptorCount += descriptor.data.count;
+			else
+				poolSizes.push_back(VkDescriptorPoolSize{
+				.type = descriptor.descriptorType,
+				.descriptorCount = descriptor.data.count,
+					});
+		}
 	}
 
 	VkDescriptorPoolCreateInfo poolCreateInfo{
 		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
 		.pNext = nullptr,
 		.flags = 0,
-		.maxSets = setCount,
+		.maxSets = setCount + m_cullProgram->GetReflection().GetDescriptorLayoutCount() + m_hiZProgram->GetReflection().GetDescriptorLayoutCount(),
 		.poolSizeCount = (UInt32)poolSizes.size(),
 		.pPoolSizes = poolSizes.data(),
 	};
@@ -500,6 +696,11 @@ bool QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::CreateDescri
 	auto& descLayouts = gBufferProgram->GetDiscriptorLayouts();
 
 	for (UInt32 i = 0; i < descLayouts.size(); i++) {
+		m_descriptorSets[i] = gBufferProgram->GetBindlessTable()->GetDescriptorSet(descLayouts[i]);
+
+		if (m_descriptorSets[i] != VK_NULL_HANDLE)
+			continue;
+
 		descSetAlloc.pSetLayouts = descLayouts.data() + i;
 
 		if (vkAllocateDescriptorSets(m_device, &descSetAlloc, m_descriptorSets.data() + i) != VK_SUCCESS)
@@ -508,3 +709,463 @@ bool QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::CreateDescri
 
 	return true;
 }
+
+bool QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::CreateGeometryBuffers(const std::vector<VKEntityGPUData>& entities, const std::vector<VKEntityGPUData>& forwardEntities)
+{
+	auto bufferFactory = VulkanDeviceManager::Instance()->GetBufferFactory();
+
+	// every mesh and LOD is packed once, instances of a mesh share its range
+	std::map<Mesh*, GBufferMeshRange> meshRanges;
+	std::vector<ref<Mesh>> packedMeshes[GBUFFER_PIPELINE_COUNT];
+	UInt32 vertexCounts[GBUFFER_PIPELINE_COUNT] = { 0, 0 };
+	UInt32 indexCount = 0;
+
+	auto addMesh = [&](const ref<Mesh>& mesh, UInt32 pipelineIndex) {
+		auto it = meshRanges.find(mesh.get());
+
+		if (it != meshRanges.end())
+			return it->second;
+
+		GBufferMeshRange range{
+			.firstIndex = indexCount,
+			.indexCount = mesh->GetIndexCount(),
+			.vertexOffset = (Int32)vertexCounts[pipelineIndex],
+		};
+
+		meshRanges.emplace(mesh.get(), range);
+		packedMeshes[pipelineIndex].push_back(mesh);
+		vertexCounts[pipelineIndex] += mesh->GetVertexCount();
+		indexCount += mesh->GetIndexCount();
+		return range;
+	};
+
+	std::vector<GBufferInstanceGPU> instances;
+	instances.reserve(entities.size() + forwardEntities.size());
+	m_entities.reserve(entities.size());
+
+	for (auto& entity : entities) {
+		auto mesh = entity.gameEntity->GetRenderer()->GetMesh();
+		// LODs are kept on the layout of the base mesh
+		bool isQuantized = mesh->GetVertexLayout() == VertexLayout::Quantized;
+		UInt32 pipelineIndex = isQuantized ? 1 : 0;
+
+		std::vector<GBufferMeshRange> lodRanges = { addMesh(mesh, pipelineIndex) };
+
+		for (UInt32 i = 0; i < mesh->GetLODCount(); i++)
+			lodRanges.push_back(addMesh(mesh->GetLOD(i), pipelineIndex));
+
+		// quantized positions are in [-1, 1] and the transform of the entity holds the dequantization
+		Vector3 boundsCenter = isQuantized ? Vector3(0.0f, 0.0f, 0.0f) : 0.5f * (mesh->GetBoundsMin() + mesh->GetBoundsMax());
+		Float boundsRadius = isQuantized ? std::sqrt(3.0f) : mesh->GetBoundingRadius();
+
+		instances.push_back(GBufferInstanceGPU{
+			.boundsCenter = boundsCenter,
+			.boundsRadius = boundsRadius,
+			.transformIndex = entity.index,
+			.firstIndex = lodRanges[0].firstIndex,
+			.indexCount = lodRanges[0].indexCount,
+			.vertexOffset = lodRanges[0].vertexOffset,
+			.pipelineIndex = pipelineIndex,
+			.drawOffset = 0,
+			.padding = { 0, 0 },
+			});
+
+		m_entities.push_back(GBufferEntityGPUData{
+			.mesh = mesh,
+			.transform = entity.gameEntity->GetTransform(),
+			.lodRanges = lodRanges,
+			.lod = 0,
+			});
+
+		m_pipelineInstanceCounts[pipelineIndex]++;
+	}
+
+	for (UInt32 i = 1; i < GBUFFER_PIPELINE_COUNT; i++)
+		m_pipelineDrawOffsets[i] = m_pipelineDrawOffsets[i - 1] + m_pipelineInstanceCounts[i - 1];
+
+	for (auto& instance : instances)
+		instance.drawOffset = m_pipelineDrawOffsets[instance.pipelineIndex];
+
+	UInt32 entityCount = 0;
+
+	for (auto& entity : entities)
+		entityCount = std::max(entityCount, entity.index + 1);
+
+	// after the G-buffer instances so UpdateLODs indices still match m_entities, the forward modules keep their own LODs
+	for (auto& entity : forwardEntities) {
+		entityCount = std::max(entityCount, entity.index + 1);
+		auto mesh = entity.gameEntity->GetRenderer()->GetMesh();
+		bool isQuantized = mesh->GetVertexLayout() == VertexLayout::Quantized;
+
+		instances.push_back(GBufferInstanceGPU{
+			.boundsCenter = isQuantized ? Vector3(0.0f, 0.0f, 0.0f) : 0.5f * (mesh->GetBoundsMin() + mesh->GetBoundsMax()),
+			.boundsRadius = isQuantized ? std::sqrt(3.0f) : mesh->GetBoundingRadius(),
+			.transformIndex = entity.index,
+			.firstIndex = 0,
+			.indexCount = 0,
+			.vertexOffset = 0,
+			.pipelineIndex = GBUFFER_NO_DRAW_PIPELINE,
+			.drawOffset = 0,
+			.padding = { 0, 0 },
+			});
+	}
+
+	m_cullParameters.instanceCount = (UInt32)instances.size();
+
+	// Upload the merged geometry through one staging buffer
+	UInt32 vertexSizes[GBUFFER_PIPELINE_COUNT] = { vertexCounts[0] * (UInt32)sizeof(Vertex), vertexCounts[1] * (UInt32)sizeof(QuantizedVertex) };
+	UInt32 indexSize = indexCount * sizeof(UInt32);
+	UInt32 stageSize = vertexSizes[0] + vertexSizes[1] + indexSize;
+
+	for (UInt32 i = 0; i < GBUFFER_PIPELINE_COUNT; i++) {
+		if (vertexSizes[i] == 0)
+			continue;
+
+		if (bufferFactory->CreateBuffer(vertexSizes[i], VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &m_vertexBuffers[i], &m_vertexBufferMemories[i]) == false)
+			return false;
+	}
+
+	if (bufferFactory->CreateBuffer(indexSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &m_indexBuffer, &m_indexBufferMemory) == false)
+		return false;
+
+	VkBuffer stageBuffer;
+	VkDeviceMemory stageBufferMemory;
+
+	if (bufferFactory->CreateBuffer(stageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &stageBuffer, &stageBufferMemory) == false)
+		return false;
+
+	void* data;
+	vkMapMemory(m_device, stageBufferMemory, 0, VK_WHOLE_SIZE, 0, &data);
+	Byte* vertexData = (Byte*)data;
+	Byte* indexData = vertexData + vertexSizes[0] + vertexSizes[1];
+
+	for (UInt32 i = 0; i < GBUFFER_PIPELINE_COUNT; i++) {
+		for (auto& mesh : packedMeshes[i]) {
+			mesh->CopyPackedVertexData(vertexData);
+			vertexData += mesh->GetPackedVertexSize();
+			// always 32 bit, the 16 bit copies only fit meshes drawn from their own buffers
+			mesh->CopyIndexData(indexData + meshRanges[mesh.get()].firstIndex * sizeof(UInt32));
+		}
+	}
+
+	vkUnmapMemory(m_device, stageBufferMemory);
+
+	VkCommandPool commandPool;
+	VkCommandBuffer commandBuffer;
+
+	VkCommandPoolCreateInfo poolInfo{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+		.pNext = nullptr,
+		.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+		.queueFamilyIndex = VulkanDeviceManager::Instance()->GetGraphicsQueueFamilyIndex(),
+	};
+
+	if (vkCreateCommandPool(m_device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS)
+		return false;
+
+	VkCommandBufferAllocateInfo allocInfo{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+		.pNext = nullptr,
+		.commandPool = commandPool,
+		.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+		.commandBufferCount = 1,
+	};
+
+	if (vkAllocateCommandBuffers(m_device, &allocInfo, &commandBuffer) != VK_SUCCESS)
+		return false;
+
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+	vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+	VkBufferCopy copyRegion{};
+
+	for (UInt32 i = 0; i < GBUFFER_PIPELINE_COUNT; i++) {
+		if (vertexSizes[i] == 0)
+			continue;
+
+		copyRegion.dstOffset = 0;
+		copyRegion.size = vertexSizes[i];
+		vkCmdCopyBuffer(commandBuffer, stageBuffer, m_vertexBuffers[i], 1, &copyRegion);
+		copyRegion.srcOffset += vertexSizes[i];
+	}
+
+	copyRegion.size = indexSize;
+	vkCmdCopyBuffer(commandBuffer, stageBuffer, m_indexBuffer, 1, &copyRegion);
+
+	vkEndCommandBuffer(commandBuffer);
+
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &commandBuffer;
+
+	VkQueue graphicsQueue = VulkanDeviceManager::Instance()->GetGraphicsQueue();
+	vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+	vkQueueWaitIdle(graphicsQueue);
+
+	vkDestroyCommandPool(m_device, commandPool, nullptr);
+	vkDestroyBuffer(m_device, stageBuffer, nullptr);
+	vkFreeMemory(m_device, stageBufferMemory, nullptr);
+
+	// Instances stay mapped, LOD changes are written in place
+	if (bufferFactory->CreateBuffer((UInt32)(sizeof(GBufferInstanceGPU) * instances.size()), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &m_instanceBuffer, &m_instanceBufferMemory) == false)
+		return false;
+
+	vkMapMemory(m_device, m_instanceBufferMemory, 0, VK_WHOLE_SIZE, 0, &data);
+	m_instanceData = (GBufferInstanceGPU*)data;
+	std::memcpy(m_instanceData, instances.data(), sizeof(GBufferInstanceGPU) * instances.size());
+
+	// only G-buffer instances emit draws
+	if (bufferFactory->CreateBuffer((UInt32)(sizeof(VkDrawIndexedIndirectCommand) * entities.size()), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &m_drawCommandBuffer, &m_drawCommandBufferMemory) == false)
+		return false;
+
+	if (bufferFactory->CreateBuffer(sizeof(UInt32) * GBUFFER_PIPELINE_COUNT, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &m_drawCountBuffer, &m_drawCountBufferMemory) == false)
+		return false;
+
+	// entities without an instance, such as splines, are never written and stay visible
+	if (bufferFactory->CreateBuffer(sizeof(UInt32) * entityCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_CONDITIONAL_RENDERING_BIT_EXT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &m_visibilityBuffer, &m_visibilityBufferMemory) == false)
+		return false;
+
+	vkMapMemory(m_device, m_visibilityBufferMemory, 0, VK_WHOLE_SIZE, 0, &data);
+	std::fill_n((UInt32*)data, entityCount, 1u);
+	vkUnmapMemory(m_device, m_visibilityBufferMemory);
+
+	if (bufferFactory->CreateBuffer(sizeof(GBufferOcclusionParameters), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &m_occlusionBuffer, &m_occlusionBufferMemory) == false)
+		return false;
+
+	vkMapMemory(m_device, m_occlusionBufferMemory, 0, VK_WHOLE_SIZE, 0, &data);
+	m_occlusionParameters = (GBufferOcclusionParameters*)data;
+	*m_occlusionParameters = GBufferOcclusionParameters{
+		.viewProjection = Matrix4(),
+		.pyramidWidth = m_hiZParameters.pyramidWidth,
+		.pyramidHeight = m_hiZParameters.pyramidHeight,
+		.mipCount = m_hiZParameters.mipCount,
+		.enabled = 0,
+	};
+
+	return true;
+}
+
+bool QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::CreateCullPipeline()
+{
+	VkComputePipelineCreateInfo pipelineInfo{
+		.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+		.pNext = nullptr,
+		.flags = 0,
+		.stage = m_cullProgram->GetComputeStageInfo(),
+		.layout = m_cullProgram->GetPipelineLayout(),
+		.basePipelineHandle = VK_NULL_HANDLE,
+		.basePipelineIndex = -1,
+	};
+
+	if (vkCreateComputePipelines(m_device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_cullPipeline) != VK_SUCCESS)
+		return false;
+
+	auto& layouts = m_cullProgram->GetDiscriptorLayouts();
+
+	VkDescriptorSetAllocateInfo descSetAlloc{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+		.descriptorPool = m_descriptorPool,
+		.descriptorSetCount = 1,
+		.pSetLayouts = layouts.data(),
+	};
+
+	if (vkAllocateDescriptorSets(m_device, &descSetAlloc, &m_cullDescriptorSet) != VK_SUCCESS)
+		return false;
+
+	WriteComputeBuffer(m_cullProgram, m_cullDescriptorSet, "GBufferInstances", m_instanceBuffer);
+	WriteComputeBuffer(m_cullProgram, m_cullDescriptorSet, "DrawCommands", m_drawCommandBuffer);
+	WriteComputeBuffer(m_cullProgram, m_cullDescriptorSet, "DrawCounts", m_drawCountBuffer);
+	WriteComputeBuffer(m_cullProgram, m_cullDescriptorSet, "Occlusion", m_occlusionBuffer);
+	WriteComputeBuffer(m_cullProgram, m_cullDescriptorSet, "Visibility", m_visibilityBuffer);
+	WriteComputeImages(m_cullProgram, m_cullDescriptorSet, "HiZPyramid", &m_hiZImageView, 1, VK_IMAGE_LAYOUT_GENERAL);
+
+	return true;
+}
+
+bool QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::CreateHiZPyramid(UInt32 width, UInt32 height)
+{
+	auto bufferFactory = VulkanDeviceManager::Instance()->GetBufferFactory();
+
+	// level 0 is the largest power of two that fits, so every level halves exactly and a texel covers at most 3x3 depth pixels
+	auto previousPowerOfTwo = [](UInt32 value) {
+		UInt32 result = 1;
+
+		while (result * 2 <= value && result < (1u << (HIZ_MAX_MIP_COUNT - 1)))
+			result *= 2;
+
+		return result;
+		};
+
+	UInt32 pyramidWidth = previousPowerOfTwo(width);
+	UInt32 pyramidHeight = previousPowerOfTwo(height);
+	UInt32 mipCount = 1;
+
+	while ((std::max(pyramidWidth, pyramidHeight) >> mipCount) > 0)
+		mipCount++;
+
+	UInt32 tileCountX = (pyramidWidth + HIZ_TILE_SIZE - 1) / HIZ_TILE_SIZE;
+	UInt32 tileCountY = (pyramidHeight + HIZ_TILE_SIZE - 1) / HIZ_TILE_SIZE;
+
+	m_hiZParameters = HiZBuildParameters{
+		.depthWidth = width,
+		.depthHeight = height,
+		.pyramidWidth = pyramidWidth,
+		.pyramidHeight = pyramidHeight,
+		.mipCount = mipCount,
+		.tileCountX = tileCountX,
+		.tileCount = tileCountX * tileCountY,
+	};
+
+	VkImageCreateInfo imgInfo{};
+	imgInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imgInfo.imageType = VK_IMAGE_TYPE_2D;
+	imgInfo.format = VK_FORMAT_R32_SFLOAT;
+	imgInfo.extent = { pyramidWidth, pyramidHeight, 1 };
+	imgInfo.mipLevels = mipCount;
+	imgInfo.arrayLayers = 1;
+	imgInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	imgInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	imgInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imgInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+
+	if (bufferFactory->CreateImage(&imgInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &m_hiZImage, &m_hiZImageMemory) == false)
+		return false;
+
+	VkImageViewCreateInfo viewInfo{};
+	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	viewInfo.image = m_hiZImage;
+	viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+	viewInfo.format = imgInfo.format;
+	viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	viewInfo.subresourceRange.levelCount = mipCount;
+	viewInfo.subresourceRange.layerCount = 1;
+
+	if (vkCreateImageView(m_device, &viewInfo, nullptr, &m_hiZImageView) != VK_SUCCESS)
+		return false;
+
+	viewInfo.subresourceRange.levelCount = 1;
+
+	for (UInt32 i = 0; i < mipCount; i++) {
+		viewInfo.subresourceRange.baseMipLevel = i;
+
+		if (vkCreateImageView(m_device, &viewInfo, nullptr, &m_hiZMipViews[i]) != VK_SUCCESS)
+			return false;
+	}
+
+	return bufferFactory->CreateBuffer(sizeof(UInt32), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &m_hiZCounterBuffer, &m_hiZCounterBufferMemory);
+}
+
+bool QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::CreateHiZPipeline()
+{
+	VkComputePipelineCreateInfo pipelineInfo{
+		.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+		.pNext = nullptr,
+		.flags = 0,
+		.stage = m_hiZProgram->GetComputeStageInfo(),
+		.layout = m_hiZProgram->GetPipelineLayout(),
+		.basePipelineHandle = VK_NULL_HANDLE,
+		.basePipelineIndex = -1,
+	};
+
+	if (vkCreateComputePipelines(m_device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_hiZPipeline) != VK_SUCCESS)
+		return false;
+
+	auto& layouts = m_hiZProgram->GetDiscriptorLayouts();
+
+	VkDescriptorSetAllocateInfo descSetAlloc{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+		.descriptorPool = m_descriptorPool,
+		.descriptorSetCount = 1,
+		.pSetLayouts = layouts.data(),
+	};
+
+	if (vkAllocateDescriptorSets(m_device, &descSetAlloc, &m_hiZDescriptorSet) != VK_SUCCESS)
+		return false;
+
+	// the shader declares every possible level, the unused ones alias the last real level and are never written
+	VkImageView mipViews[HIZ_MAX_MIP_COUNT];
+
+	for (UInt32 i = 0; i < HIZ_MAX_MIP_COUNT; i++)
+		mipViews[i] = m_hiZMipViews[std::min(i, m_hiZParameters.mipCount - 1)];
+
+	WriteComputeImages(m_hiZProgram, m_hiZDescriptorSet, "DepthTexture", &m_depthView, 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL);
+	WriteComputeImages(m_hiZProgram, m_hiZDescriptorSet, "HiZMips", mipViews, HIZ_MAX_MIP_COUNT, VK_IMAGE_LAYOUT_GENERAL);
+	WriteComputeBuffer(m_hiZProgram, m_hiZDescriptorSet, "HiZCounter", m_hiZCounterBuffer);
+
+	return true;
+}
+
+void QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::WriteComputeImages(const ref<Compute::SPIRVComputeProgram>& program, VkDescriptorSet descriptorSet, const std::string& name, const VkImageView* views, UInt32 count, VkImageLayout layout)
+{
+	auto descriptorData = program->GetReflection().GetDescriptorData(name);
+
+	if (descriptorData == nullptr)
+		return;
+
+	std::vector<VkDescriptorImageInfo> imageInfos(count);
+
+	for (UInt32 i = 0; i < count; i++) {
+		imageInfos[i] = VkDescriptorImageInfo{
+			.sampler = VK_NULL_HANDLE,
+			.imageView = views[i],
+			.imageLayout = layout,
+		};
+	}
+
+	VkWriteDescriptorSet writeDescriptor{
+		.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+		.pNext = nullptr,
+		.dstSet = descriptorSet,
+		.dstBinding = descriptorData->data.binding,
+		.dstArrayElement = 0,
+		.descriptorCount = count,
+		.descriptorType = descriptorData->descriptorType,
+		.pImageInfo = imageInfos.data(),
+		.pBufferInfo = nullptr,
+		.pTexelBufferView = nullptr,
+	};
+
+	vkUpdateDescriptorSets(m_device, 1, &writeDescriptor, 0, nullptr);
+}
+
+void QuantumEngine::Rendering::Vulkan::VulkanGBufferPipelineModule::WriteComputeBuffer(const ref<Compute::SPIRVComputeProgram>& program, VkDescriptorSet descriptorSet, const std::string& name, VkBuffer buffer)
+{
+	auto descriptorData = program->GetReflection().GetDescriptorData(name);
+
+	if (descriptorData == nullptr)
+		return;
+
+	VkDescriptorBufferInfo descBufferInfo{
+		.buffer = buffer,
+		.offset = 0,
+		.range = VK_WHOLE_SIZE,
+	};
+
+	VkWriteDescriptorSet writeDescriptor{
+		.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+		.pNext = nullptr,
+		.dstSet = descriptorSet,
+		.dstBinding = descriptorData->data.binding,
+		.dstArrayElement = 0,
+		.descriptorCount = 1,
+		.descriptorType = descriptorData->descriptorType,
+		.pImageInfo = nullptr,
+		.pBufferInfo = &descBufferInfo,
+		.pTexelBufferView = nullptr,
+	};
+
+	vkUpdateDescriptorSets(m_device, 1, &writeDescriptor, 0, nullptr);
+}
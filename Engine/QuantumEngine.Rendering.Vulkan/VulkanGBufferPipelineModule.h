@@ -1,81 +1,229 @@
 #pragma once
 #include "vulkan-pch.h"
+#include "Core/Vector3.h"
+#include "Core/Matrix4.h"
 
 namespace QuantumEngine {
 	class GameEntity;
+	class Mesh;
+	class Transform;
+	class Camera;
 }
 
 namespace QuantumEngine::Rendering::Vulkan {
-	class VulkanMeshController;
-
 	namespace Rasterization {
 		class SPIRVRasterizationProgram;
 	}
 
+	namespace Compute {
+		class SPIRVComputeProgram;
+	}
+
 	struct VKEntityGPUData;
 
-	struct GBufferEntityGPUData {
-		ref<VulkanMeshController> meshController;
+	// full and quantized vertex layouts, one pipeline and one merged vertex buffer each
+	constexpr UInt32 GBUFFER_PIPELINE_COUNT = 2;
+	// pipeline index of forward pass instances, culled for their visibility flag without drawing
+	constexpr UInt32 GBUFFER_NO_DRAW_PIPELINE = 0xFFFFFFFF;
+
+	// Hi-Z pyramid limits, match hiz_build.cs.hlsl. 13 levels cover depth buffers up to 8191 pixels
+	constexpr UInt32 HIZ_MAX_MIP_COUNT = 13;
+	constexpr UInt32 HIZ_TILE_SIZE = 64;
+
+	/// <summary>
+	/// Range of a mesh in the merged index and vertex buffers of its layout
+	/// </summary>
+	struct GBufferMeshRange {
+		UInt32 firstIndex;
 		UInt32 indexCount;
-		UInt32 transformOffset;
+		Int32 vertexOffset;
+	};
+
+	/// <summary>
+	/// Instance read by the G-buffer culling shader, matches GBufferInstance in g_buffer_cull.cs.hlsl
+	/// </summary>
+	struct GBufferInstanceGPU {
+		// bounding sphere in the space of the vertex positions
+		Vector3 boundsCenter;
+		Float boundsRadius;
+		UInt32 transformIndex;
+		// range of the selected LOD
+		UInt32 firstIndex;
+		UInt32 indexCount;
+		Int32 vertexOffset;
+		UInt32 pipelineIndex;
+		// first draw command of the pipeline
+		UInt32 drawOffset;
+		UInt32 padding[2];
+	};
+
+	struct GBufferCullParameters {
+		Float frustumPlanes[6][4];
+		UInt32 instanceCount;
+	};
+
+	/// <summary>
+	/// Hi-Z test state read by the culling shader, matches OcclusionParameters in g_buffer_cull.cs.hlsl
+	/// </summary>
+	struct GBufferOcclusionParameters {
+		// view projection of the frame the pyramid was built from
+		Matrix4 viewProjection;
+		UInt32 pyramidWidth;
+		UInt32 pyramidHeight;
+		UInt32 mipCount;
+		// 0 until the first pyramid is built
+		UInt32 enabled;
+	};
+
+	struct HiZBuildParameters {
+		UInt32 depthWidth;
+		UInt32 depthHeight;
+		UInt32 pyramidWidth;
+		UInt32 pyramidHeight;
+		UInt32 mipCount;
+		UInt32 tileCountX;
+		UInt32 tileCount;
+	};
+
+	struct GBufferEntityGPUData {
+		ref<Mesh> mesh;
+		ref<Transform> transform;
+		// the mesh and its LODs in the merged buffers
+		std::vector<GBufferMeshRange> lodRanges;
+		UInt32 lod;
 	};
 
 	class VulkanGBufferPipelineModule {
 	public:
 		VulkanGBufferPipelineModule();
 		~VulkanGBufferPipelineModule();
-		bool InitializePipeline(const std::vector<VKEntityGPUData>& entities, const ref<Rasterization::SPIRVRasterizationProgram>& gBufferProgram, UInt32 width, UInt32 height, VkImageView depthView);
-		void WriteBuffer(const std::string& name, VkBuffer buffer, UInt32 stride);
+		/// <summary>
+		/// forwardEntities are culled with the G-buffer instances to fill the visibility buffer but not drawn
+		/// </summary>
+		bool InitializePipeline(const std::vector<VKEntityGPUData>& entities, const std::vector<VKEntityGPUData>& forwardEntities, const ref<Rasterization::SPIRVRasterizationProgram>& gBufferProgram,
+			const ref<Compute::SPIRVComputeProgram>& cullProgram, const ref<Compute::SPIRVComputeProgram>& hiZProgram, UInt32 width, UInt32 height, VkImageView depthView);
+		void WriteBuffer(const std::string& name, VkBuffer buffer, VkDeviceSize range);
+
+		/// <summary>
+		/// binds the transforms of all entities, indexed by entity in the culling pass and by instance in the vertex shader
+		/// </summary>
+		void WriteTransformBuffer(VkBuffer buffer);
+
+		/// <summary>
+		/// frustum and occlusion culls every instance on the GPU, fills the indirect draw commands and the visibility buffer.
+		/// Recorded outside of render passes before RenderCommand
+		/// </summary>
+		void CullCommand(VkCommandBuffer commandBuffer);
+
+		/// <summary>
+		/// draws the surviving instances with one indirect count draw per pipeline
+		/// </summary>
 		void RenderCommand(VkCommandBuffer commandBuffer);
-		inline VkImageView GetPositionImageView() const { return m_positionImageView; }
-		inline VkImageView GetNormalImageView() const { return m_normalImageView; }
-		inline VkImageView GetMaskImageView() const { return m_maskImageView; }
 
-		inline VkImage GetPositionImage() const { return m_positionImage; }
+		/// <summary>
+		/// reduces the depth RenderCommand wrote into the Hi-Z pyramid the next frame is culled against, recorded after RenderCommand
+		/// </summary>
+		void BuildHiZCommand(VkCommandBuffer commandBuffer);
+		void UpdateLODs(const Camera& camera, Float viewportHeight, Float maxPixelError);
+		void UpdateFrustum(const Matrix4& viewProjection);
+
+		/// <summary>
+		/// one UInt32 per entity index, nonzero when the entity passed culling this frame. Usable as a conditional rendering predicate
+		/// </summary>
+		inline VkBuffer GetVisibilityBuffer() const { return m_visibilityBuffer; }
+
+		/// <summary>
+		/// octahedral normal and mask packed by Common/GBufferFunctions.hlsli
+		/// </summary>
+		inline VkImageView GetNormalImageView() const { return m_normalImageView; }
 		inline VkImage GetNormalImage() const { return m_normalImage; }
-		inline VkImage GetMaskImage() const { return m_maskImage; }
+
+		/// <summary>
+		/// the depth written by RenderCommand, positions are rebuilt from it. Stays in VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL after the pass
+		/// </summary>
+		inline VkImageView GetDepthImageView() const { return m_depthView; }
 	private:
 		bool CreateRenderPass();
 		bool CreateFrameBuffers(UInt32 width, UInt32 height);
-		bool CreateRasterPipeline();
+		bool CreateRasterPipeline(bool quantizedVertex, VkPipeline* pipeline);
 		bool CreateDescriptorSets(const ref<Rasterization::SPIRVRasterizationProgram>& gBufferProgram);
+		bool CreateGeometryBuffers(const std::vector<VKEntityGPUData>& entities, const std::vector<VKEntityGPUData>& forwardEntities);
+		bool CreateCullPipeline();
+		bool CreateHiZPyramid(UInt32 width, UInt32 height);
+		bool CreateHiZPipeline();
+		void WriteComputeImages(const ref<Compute::SPIRVComputeProgram>& program, VkDescriptorSet descriptorSet, const std::string& name, const VkImageView* views, UInt32 count, VkImageLayout layout);
+		void WriteComputeBuffer(const ref<Compute::SPIRVComputeProgram>& program, VkDescriptorSet descriptorSet, const std::string& name, VkBuffer buffer);
 
 		VkDevice m_device;
 		VkPipeline m_gBufferPipeline;
+		VkPipeline m_quantizedGBufferPipeline = VK_NULL_HANDLE;
 		VkDescriptorPool m_descriptorPool;
 
+		ref<Compute::SPIRVComputeProgram> m_cullProgram;
+		VkPipeline m_cullPipeline = VK_NULL_HANDLE;
+		VkDescriptorSet m_cullDescriptorSet;
+		std::vector<UInt32> m_cullOffsets;
+		GBufferCullParameters m_cullParameters;
+
+		VkBuffer m_occlusionBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory m_occlusionBufferMemory = VK_NULL_HANDLE;
+		GBufferOcclusionParameters* m_occlusionParameters = nullptr;
+		Matrix4 m_viewProjection;
+		bool m_isHiZBuilt = false;
+
+		VkBuffer m_visibilityBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory m_visibilityBufferMemory = VK_NULL_HANDLE;
+
+		ref<Compute::SPIRVComputeProgram> m_hiZProgram;
+		VkPipeline m_hiZPipeline = VK_NULL_HANDLE;
+		VkDescriptorSet m_hiZDescriptorSet;
+		HiZBuildParameters m_hiZParameters;
+		// kept in the general layout, sampled by the culling pass and written per level by the build pass
+		VkImage m_hiZImage = VK_NULL_HANDLE;
+		VkDeviceMemory m_hiZImageMemory = VK_NULL_HANDLE;
+		VkImageView m_hiZImageView = VK_NULL_HANDLE;
+		VkImageView m_hiZMipViews[HIZ_MAX_MIP_COUNT] = {};
+		VkBuffer m_hiZCounterBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory m_hiZCounterBufferMemory = VK_NULL_HANDLE;
+
+		// merged geometry of every mesh and LOD, 32 bit indices relative to the vertex buffer of the layout
+		VkBuffer m_vertexBuffers[GBUFFER_PIPELINE_COUNT] = { VK_NULL_HANDLE, VK_NULL_HANDLE };
+		VkDeviceMemory m_vertexBufferMemories[GBUFFER_PIPELINE_COUNT] = { VK_NULL_HANDLE, VK_NULL_HANDLE };
+		VkBuffer m_indexBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory m_indexBufferMemory = VK_NULL_HANDLE;
+
+		VkBuffer m_instanceBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory m_instanceBufferMemory = VK_NULL_HANDLE;
+		GBufferInstanceGPU* m_instanceData = nullptr;
+
+		// one region of draw commands per pipeline, sized for all of its instances
+		VkBuffer m_drawCommandBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory m_drawCommandBufferMemory = VK_NULL_HANDLE;
+		VkBuffer m_drawCountBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory m_drawCountBufferMemory = VK_NULL_HANDLE;
+		UInt32 m_pipelineInstanceCounts[GBUFFER_PIPELINE_COUNT] = { 0, 0 };
+		UInt32 m_pipelineDrawOffsets[GBUFFER_PIPELINE_COUNT] = { 0, 0 };
+
 		VkRenderPass m_renderPass;
 
 		ref<Rasterization::SPIRVRasterizationProgram> m_gBufferProgram;
 		VkImageView m_depthView;
 
-		VkFormat m_positionFormat;
-		VkImage m_positionImage;
-		VkDeviceMemory m_positionImageMemory;
-		VkImageView m_positionImageView;
-
 		VkFormat m_normalFormat;
 		VkImage m_normalImage;
 		VkDeviceMemory m_normalImageMemory;
 		VkImageView m_normalImageView;
 
-		VkFormat m_maskFormat;
-		VkImage m_maskImage;
-		VkDeviceMemory m_maskImageMemory;
-		VkImageView m_maskImageView;
-
-
 		VkFramebuffer m_frameBuffer;
 
 		std::vector<VkDescriptorSet> m_descriptorSets;
 
 		std::vector<GBufferEntityGPUData> m_entities;
 
-		VkClearValue m_clearValues[4];
+		VkClearValue m_clearValues[2];
 		VkRenderPassBeginInfo m_renderPassInfo;
 
 		std::vector<UInt32> m_offsets;
-		UInt32 m_transformIndex = 0;
 		UInt32 m_width;
 		UInt32 m_height;
 	};
@@ -7,6 +7,10 @@
 #include "Rasterization/VulkanRasterizationMaterial.h"
 #include "Core/VulkanDeviceManager.h"
 #include "Core/VulkanBufferFactory.h"
+#include "Core/Transform.h"
+#include "Core/Camera/Camera.h"
+#include <algorithm>
+#include <cmath>
 
 VkVertexInputBindingDescription QuantumEngine::Rendering::Vulkan::VulkanSplinePipelineModule::s_bindingDescriptions = {
 	.binding = 0,
@@ -38,87 +42,378 @@ QuantumEngine::Rendering::Vulkan::VulkanSplinePipelineModule::VulkanSplinePipeli
 
 QuantumEngine::Rendering::Vulkan::VulkanSplinePipelineModule::~VulkanSplinePipelineModule()
 {
-	vkDestroyPipeline(m_device, m_graphicsPipeline, nullptr);
+	for (auto& batch : m_batches)
+		vkDestroyPipeline(m_device, batch.pipeline, nullptr);
+
+	vkDestroyPipeline(m_device, m_computePipeline, nullptr);
+	vkDestroyDescriptorPool(m_device, m_descriptorPool, nullptr);
 
 	vkDestroyBuffer(m_device, m_vertexBuffer, nullptr);
 	vkFreeMemory(m_device, m_vertexBufferMemory, nullptr);
+
+	if (m_parameters != nullptr)
+		vkUnmapMemory(m_device, m_parameterBufferMemory);
+
+	vkDestroyBuffer(m_device, m_parameterBuffer, nullptr);
+	vkFreeMemory(m_device, m_parameterBufferMemory, nullptr);
+
+	if (m_curvePoints != nullptr)
+		vkUnmapMemory(m_device, m_curvePointBufferMemory);
+
+	vkDestroyBuffer(m_device, m_curvePointBuffer, nullptr);
+	vkFreeMemory(m_device, m_curvePointBufferMemory, nullptr);
+
+	if (m_arcLengths != nullptr)
+		vkUnmapMemory(m_device, m_arcLengthBufferMemory);
+
+	vkDestroyBuffer(m_device, m_arcLengthBuffer, nullptr);
+	vkFreeMemory(m_device, m_arcLengthBufferMemory, nullptr);
+
+	if (m_dirtySplines != nullptr)
+		vkUnmapMemory(m_device, m_dirtyBufferMemory);
+
+	vkDestroyBuffer(m_device, m_dirtyBuffer, nullptr);
+	vkFreeMemory(m_device, m_dirtyBufferMemory, nullptr);
+
+	if (m_drawCommands != nullptr)
+		vkUnmapMemory(m_device, m_drawCommandBufferMemory);
+
+	vkDestroyBuffer(m_device, m_drawCommandBuffer, nullptr);
+	vkFreeMemory(m_device, m_drawCommandBufferMemory, nullptr);
 }
 
-bool QuantumEngine::Rendering::Vulkan::VulkanSplinePipelineModule::Initialize(const SplineEntityData& splineEntity, const VkRenderPass renderPass, const VkDescriptorPool pool)
+bool QuantumEngine::Rendering::Vulkan::VulkanSplinePipelineModule::Initialize(const std::vector<SplineEntityData>& splineEntities, const ref<Compute::SPIRVComputeProgram>& computeProgram, const VkRenderPass renderPass)
 {
-	m_splineRenderer = splineEntity.splineRenderer;
-	m_computeProgram = splineEntity.computeProgram;
+	m_computeProgram = computeProgram;
 
-	if(InitializeVertexBuffer(splineEntity) == false)
+	if(InitializeBuffers(splineEntities) == false)
 		return false;
 
-	if(InitializeComputePipeline(splineEntity, pool) == false)
+	if(InitializeComputePipeline() == false)
 		return false;
 
-	if(InitializeGraphicsPipeline(splineEntity, renderPass) == false)
-		return false;
+	for (auto& batch : m_batches) {
+		if (InitializeGraphicsPipeline(batch, renderPass) == false)
+			return false;
+
+		batch.material->WriteBuffer("Splines", m_parameterBuffer, (UInt32)(sizeof(SplineParameters) * m_splineRenderers.size()));
+	}
 
 	return true;
 }
 
+void QuantumEngine::Rendering::Vulkan::VulkanSplinePipelineModule::UpdateSegments(const Camera& camera, Float viewportHeight, Float maxPixelError)
+{
+	for (UInt32 i = 0; i < m_splineRenderers.size(); i++) {
+		auto& splineRenderer = m_splineRenderers[i];
+		auto& transform = m_transforms[i];
+		auto& curve = splineRenderer->GetCurve();
+		bool curveChanged = splineRenderer->IsDirty();
+
+		Vector3 scale = transform->Scale();
+		Float maxScale = std::max(std::fabs(scale.x), std::max(std::fabs(scale.y), std::fabs(scale.z)));
+
+		// Matrix4 * Vector3 ignores translation
+		Vector3 center = transform->Position() + transform->Matrix() * curve.GetBoundsCenter();
+		Float pixelsPerUnit = maxScale * camera.PixelsPerUnit(center, curve.GetBoundsRadius() * maxScale, viewportHeight);
+
+		if (splineRenderer->UpdateSegments(pixelsPerUnit, maxPixelError, curveChanged)) {
+			ResizeVertexRange(i, splineRenderer->GetSegments() + 1);
+			curveChanged = true;
+		}
+
+		if (curveChanged)
+			m_pendingSplines[i] = 1;
+	}
+}
+
 void QuantumEngine::Rendering::Vulkan::VulkanSplinePipelineModule::ComputeCommand(VkCommandBuffer commandBuffer)
 {
-	if (m_splineRenderer->IsDirty()) {
-		m_splineParameters.startPoint = m_splineRenderer->GetCurve().m_point1;
-		m_splineParameters.midPoint = m_splineRenderer->GetCurve().m_point2;
-		m_splineParameters.endPoint = m_splineRenderer->GetCurve().m_point3;
-		m_splineParameters.width = m_splineRenderer->GetWidth();
-		m_splineParameters.length = m_splineRenderer->GetCurve().InterpolateLength(1.0f);
-
-		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_computePipeline);
-		vkCmdPushConstants(commandBuffer, m_computeProgram->GetPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(SplineParameters), &m_splineParameters);
-		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_computeProgram->GetPipelineLayout(), 0, 1, &m_computeDescriptorSet, 0, 0);
-
-		vkCmdDispatch(commandBuffer, m_splineRenderer->GetSegments() + 1, 1, 1);
+	SplineBatchParameters batchParameters{
+		.dirtySplineCount = 0,
+		.dirtyVertexCount = 0,
+	};
+
+	for (UInt32 i = 0; i < m_splineRenderers.size(); i++) {
+		auto& splineRenderer = m_splineRenderers[i];
+
+		if (m_pendingSplines[i] == 0)
+			continue;
+
+		m_pendingSplines[i] = 0;
+
+		auto& curve = splineRenderer->GetCurve();
+		auto& parameters = m_parameters[i];
+		parameters.width = splineRenderer->GetWidth();
+		parameters.length = curve.GetLength();
+		WriteCurve(parameters, curve);
+
+		// slot and first thread pairs, the shader searches them by thread
+		m_dirtySplines[2 * batchParameters.dirtySplineCount] = i;
+		m_dirtySplines[2 * batchParameters.dirtySplineCount + 1] = batchParameters.dirtyVertexCount;
+		batchParameters.dirtySplineCount++;
+		batchParameters.dirtyVertexCount += parameters.vertexCount;
 	}
+
+	if (batchParameters.dirtySplineCount == 0)
+		return;
+
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_computePipeline);
+	vkCmdPushConstants(commandBuffer, m_computeProgram->GetPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(SplineBatchParameters), &batchParameters);
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_computeProgram->GetPipelineLayout(), 0, 1, &m_computeDescriptorSet, 0, 0);
+
+	// 64 threads per group in curve_mesh_batch_compute.cs.hlsl
+	vkCmdDispatch(commandBuffer, (batchParameters.dirtyVertexCount + 63) / 64, 1, 1);
+
+	VkMemoryBarrier vertexBarrier{
+		.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+		.pNext = nullptr,
+		.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+		.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT,
+	};
+
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0,
+		1, &vertexBarrier, 0, nullptr, 0, nullptr);
 }
 
 void QuantumEngine::Rendering::Vulkan::VulkanSplinePipelineModule::RenderCommand(VkCommandBuffer commandBuffer)
 {
-	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipeline);
 	VkDeviceSize offsets[] = { 0 };
 	vkCmdBindVertexBuffers(commandBuffer, 0, 1, &m_vertexBuffer, offsets);
-	vkCmdPushConstants(commandBuffer, m_program->GetPipelineLayout(), VK_SHADER_STAGE_ALL_GRAPHICS, m_widthOffset, sizeof(Float), &m_splineParameters.width);
-
-	m_material->BindValues(commandBuffer);
-	m_material->BindDynamicValues(commandBuffer, m_offset.data(), (UInt32)m_offset.size());
-	vkCmdDraw(commandBuffer, m_splineRenderer->GetSegments() + 1, 1, 0, 0);
 
+	for (auto& batch : m_batches) {
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, batch.pipeline);
+		batch.material->BindValues(commandBuffer);
+		batch.material->BindDynamicValues(commandBuffer, batch.offsets.data(), (UInt32)batch.offsets.size());
+		vkCmdDrawIndirect(commandBuffer, m_drawCommandBuffer, batch.firstDraw * sizeof(VkDrawIndirectCommand), batch.drawCount, sizeof(VkDrawIndirectCommand));
+	}
 }
 
 void QuantumEngine::Rendering::Vulkan::VulkanSplinePipelineModule::WriteOffset(const std::string name, UInt32 offset)
 {
-	auto descriptorData = m_program->GetReflection().GetDescriptorData(name);
+	for (auto& batch : m_batches) {
+		auto descriptorData = batch.program->GetReflection().GetDescriptorData(name);
 
-	if (descriptorData == nullptr)
+		if (descriptorData == nullptr)
+			continue;
+
+		batch.offsets[descriptorData->offsetIndex] = offset;
+	}
+}
+
+bool QuantumEngine::Rendering::Vulkan::VulkanSplinePipelineModule::InitializeBuffers(const std::vector<SplineEntityData>& splineEntities)
+{
+	// splines of a material get consecutive slots so their draw commands are contiguous
+	std::vector<const SplineEntityData*> sortedSplines;
+	sortedSplines.reserve(splineEntities.size());
+
+	for (auto& splineEntity : splineEntities)
+		sortedSplines.push_back(&splineEntity);
+
+	std::stable_sort(sortedSplines.begin(), sortedSplines.end(), [](const SplineEntityData* a, const SplineEntityData* b) {
+		return a->material.get() < b->material.get();
+		});
+
+	std::vector<SplineParameters> parameters;
+	std::vector<VkDrawIndirectCommand> drawCommands;
+	parameters.reserve(sortedSplines.size());
+	drawCommands.reserve(sortedSplines.size());
+	UInt32 vertexCapacity = 0;
+	UInt32 pointCount = 0;
+	UInt32 lengthCount = 0;
+
+	for (auto splineEntity : sortedSplines) {
+		UInt32 slot = (UInt32)m_splineRenderers.size();
+		UInt32 splineVertexCount = splineEntity->splineRenderer->GetSegments() + 1;
+		auto& curve = splineEntity->splineRenderer->GetCurve();
+
+		if (m_batches.empty() || m_batches.back().material != splineEntity->material) {
+			m_batches.push_back(SplineMaterialBatch{
+				.material = splineEntity->material,
+				.program = std::dynamic_pointer_cast<Rasterization::SPIRVRasterizationProgram>(splineEntity->splineRenderer->GetMaterial()->GetProgram()),
+				.pipeline = VK_NULL_HANDLE,
+				.firstDraw = slot,
+				.drawCount = 0,
+				});
+		}
+
+		m_batches.back().drawCount++;
+		m_splineRenderers.push_back(splineEntity->splineRenderer);
+		m_transforms.push_back(splineEntity->transform);
+
+		// vertex ranges are placed in the pool once every spline is known
+		parameters.push_back(SplineParameters{
+			.width = splineEntity->splineRenderer->GetWidth(),
+			.length = curve.GetLength(),
+			.vertexOffset = 0,
+			.vertexCount = splineVertexCount,
+			.transformIndex = splineEntity->transformIndex,
+			.pointOffset = pointCount,
+			.segmentCount = curve.GetSegmentCount(),
+			.lengthOffset = lengthCount,
+			});
+
+		// the first instance is the slot, the vertex shader reads it back as SV_InstanceID
+		drawCommands.push_back(VkDrawIndirectCommand{
+			.vertexCount = splineVertexCount,
+			.instanceCount = 1,
+			.firstVertex = 0,
+			.firstInstance = slot,
+			});
+
+		// twice the authored tessellation, ResizeVertexRange grows the pool when the splines outgrow it
+		vertexCapacity += 2 * splineVertexCount;
+		pointCount += (UInt32)curve.GetBezierPoints().size();
+		lengthCount += (UInt32)curve.GetArcLengths().size();
+	}
+
+	if (CreateVertexBuffer(vertexCapacity) == false)
+		return false;
+
+	void* data;
+
+	if (CreateMappedBuffer((UInt32)(sizeof(SplineParameters) * parameters.size()), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, &m_parameterBuffer, &m_parameterBufferMemory, &data) == false)
+		return false;
+
+	m_parameters = (SplineParameters*)data;
+	std::memcpy(m_parameters, parameters.data(), sizeof(SplineParameters) * parameters.size());
+
+	if (CreateMappedBuffer(4 * sizeof(Float) * pointCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, &m_curvePointBuffer, &m_curvePointBufferMemory, &data) == false)
+		return false;
+
+	m_curvePoints = (Float*)data;
+
+	if (CreateMappedBuffer(sizeof(Float) * lengthCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, &m_arcLengthBuffer, &m_arcLengthBufferMemory, &data) == false)
+		return false;
+
+	m_arcLengths = (Float*)data;
+
+	if (CreateMappedBuffer((UInt32)(2 * sizeof(UInt32) * parameters.size()), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, &m_dirtyBuffer, &m_dirtyBufferMemory, &data) == false)
+		return false;
+
+	m_dirtySplines = (UInt32*)data;
+
+	// vertex ranges of the commands follow the segment counts
+	if (CreateMappedBuffer((UInt32)(sizeof(VkDrawIndirectCommand) * drawCommands.size()), VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, &m_drawCommandBuffer, &m_drawCommandBufferMemory, &data) == false)
+		return false;
+
+	m_drawCommands = (VkDrawIndirectCommand*)data;
+	std::memcpy(m_drawCommands, drawCommands.data(), sizeof(VkDrawIndirectCommand) * drawCommands.size());
+
+	m_vertexAllocator.Reset(vertexCapacity);
+	CompactVertexRanges();
+
+	return true;
+}
+
+void QuantumEngine::Rendering::Vulkan::VulkanSplinePipelineModule::SetVertexRange(UInt32 slot, UInt32 vertexOffset, UInt32 vertexCount)
+{
+	m_parameters[slot].vertexOffset = vertexOffset;
+	m_parameters[slot].vertexCount = vertexCount;
+	m_drawCommands[slot].firstVertex = vertexOffset;
+	m_drawCommands[slot].vertexCount = vertexCount;
+}
+
+void QuantumEngine::Rendering::Vulkan::VulkanSplinePipelineModule::ResizeVertexRange(UInt32 slot, UInt32 vertexCount)
+{
+	auto& parameters = m_parameters[slot];
+	m_vertexAllocator.Free(parameters.vertexOffset, parameters.vertexCount);
+
+	UInt32 vertexOffset;
+
+	if (m_vertexAllocator.Allocate(vertexCount, &vertexOffset)) {
+		SetVertexRange(slot, vertexOffset, vertexCount);
 		return;
+	}
+
+	UInt32 requiredCapacity = m_vertexAllocator.GetCapacity() - m_vertexAllocator.GetFreeSize() + vertexCount;
 
-	m_offset[descriptorData->offsetIndex] = offset;
+	// every spline is rebuilt after compaction, the old vertices are not copied.
+	// if the larger pool can't be created the spline keeps its previous vertex count
+	if (requiredCapacity <= m_vertexAllocator.GetCapacity() || GrowVertexBuffer(std::max(2 * m_vertexAllocator.GetCapacity(), requiredCapacity)))
+		parameters.vertexCount = vertexCount;
+
+	// the pool is too fragmented, every spline is packed again
+	CompactVertexRanges();
 }
 
-bool QuantumEngine::Rendering::Vulkan::VulkanSplinePipelineModule::InitializeVertexBuffer(const SplineEntityData& splineEntity)
+bool QuantumEngine::Rendering::Vulkan::VulkanSplinePipelineModule::GrowVertexBuffer(UInt32 vertexCapacity)
 {
-	auto bufferFactory = VulkanDeviceManager::Instance()->GetBufferFactory();
+	VkBuffer oldBuffer = m_vertexBuffer;
+	VkDeviceMemory oldBufferMemory = m_vertexBufferMemory;
 
-	if(bufferFactory->CreateBuffer(sizeof(SplineVertex) * (m_splineRenderer->GetSegments() + 1), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &m_vertexBuffer, &m_vertexBufferMemory) == false)
+	if (CreateVertexBuffer(vertexCapacity) == false) {
+		m_vertexBuffer = oldBuffer;
+		m_vertexBufferMemory = oldBufferMemory;
 		return false;
+	}
 
+	// the old buffer may still be read by the last submitted frame
+	vkDeviceWaitIdle(m_device);
+	vkDestroyBuffer(m_device, oldBuffer, nullptr);
+	vkFreeMemory(m_device, oldBufferMemory, nullptr);
+
+	WriteComputeBuffer("SplineVertices", m_vertexBuffer);
+	m_vertexAllocator.Reset(vertexCapacity);
 	return true;
 }
 
-bool QuantumEngine::Rendering::Vulkan::VulkanSplinePipelineModule::InitializeComputePipeline(const SplineEntityData& splineEntity, const VkDescriptorPool pool)
+bool QuantumEngine::Rendering::Vulkan::VulkanSplinePipelineModule::CreateVertexBuffer(UInt32 vertexCapacity)
+{
+	auto bufferFactory = VulkanDeviceManager::Instance()->GetBufferFactory();
+
+	return bufferFactory->CreateBuffer(sizeof(SplineVertex) * vertexCapacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &m_vertexBuffer, &m_vertexBufferMemory);
+}
+
+void QuantumEngine::Rendering::Vulkan::VulkanSplinePipelineModule::CompactVertexRanges()
+{
+	m_vertexAllocator.Reset(m_vertexAllocator.GetCapacity());
+
+	for (UInt32 i = 0; i < m_splineRenderers.size(); i++) {
+		UInt32 vertexOffset;
+		m_vertexAllocator.Allocate(m_parameters[i].vertexCount, &vertexOffset);
+		SetVertexRange(i, vertexOffset, m_parameters[i].vertexCount);
+	}
+
+	m_pendingSplines.assign(m_splineRenderers.size(), 1);
+}
+
+bool QuantumEngine::Rendering::Vulkan::VulkanSplinePipelineModule::CreateMappedBuffer(UInt32 size, VkBufferUsageFlags usage, VkBuffer* buffer, VkDeviceMemory* memory, void** data)
+{
+	auto bufferFactory = VulkanDeviceManager::Instance()->GetBufferFactory();
+
+	if (bufferFactory->CreateBuffer(size, usage, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, buffer, memory) == false)
+		return false;
+
+	return vkMapMemory(m_device, *memory, 0, VK_WHOLE_SIZE, 0, data) == VK_SUCCESS;
+}
+
+void QuantumEngine::Rendering::Vulkan::VulkanSplinePipelineModule::WriteCurve(const SplineParameters& parameters, const Core::BezierCurve& curve)
+{
+	auto& points = curve.GetBezierPoints();
+	Float* pointData = m_curvePoints + 4 * parameters.pointOffset;
+
+	for (auto& point : points) {
+		pointData[0] = point.x;
+		pointData[1] = point.y;
+		pointData[2] = point.z;
+		pointData[3] = 0.0f;
+		pointData += 4;
+	}
+
+	auto& lengths = curve.GetArcLengths();
+	std::memcpy(m_arcLengths + parameters.lengthOffset, lengths.data(), sizeof(Float) * lengths.size());
+}
+
+bool QuantumEngine::Rendering::Vulkan::VulkanSplinePipelineModule::InitializeComputePipeline()
 {
 	VkComputePipelineCreateInfo pipelineInfo{
 		.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
 		.pNext = nullptr,
 		.flags = 0,
-		.stage = splineEntity.computeProgram->GetComputeStageInfo(),
-		.layout = splineEntity.computeProgram->GetPipelineLayout(),
+		.stage = m_computeProgram->GetComputeStageInfo(),
+		.layout = m_computeProgram->GetPipelineLayout(),
 		.basePipelineHandle = VK_NULL_HANDLE,
 		.basePipelineIndex = -1,
 	};
@@ -126,11 +421,39 @@ bool QuantumEngine::Rendering::Vulkan::VulkanSplinePipelineModule::InitializeCom
 	if (vkCreateComputePipelines(m_device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_computePipeline) != VK_SUCCESS)
 		return false;
 
-	auto& layouts = splineEntity.computeProgram->GetDiscriptorLayouts();
+	std::vector<VkDescriptorPoolSize> poolSizes;
+
+	for (auto& descriptor : m_computeProgram->GetReflection().GetDescriptors()) {
+		auto it = std::find_if(poolSizes.begin(), poolSizes.end(), [descriptor](const VkDescriptorPoolSize& poolSize) {
+			return descriptor.descriptorType == poolSize.type;
+			});
+
+		if (it != poolSizes.end())
+			(*it).descriptorCount += descriptor.data.count;
+		else
+			poolSizes.push_back(VkDescriptorPoolSize{
+			.type = descriptor.descriptorType,
+			.descriptorCount = descriptor.data.count,
+				});
+	}
+
+	VkDescriptorPoolCreateInfo poolCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+		.pNext = nullptr,
+		.flags = 0,
+		.maxSets = 1,
+		.poolSizeCount = (UInt32)poolSizes.size(),
+		.pPoolSizes = poolSizes.data(),
+	};
+
+	if (vkCreateDescriptorPool(m_device, &poolCreateInfo, nullptr, &m_descriptorPool) != VK_SUCCESS)
+		return false;
+
+	auto& layouts = m_computeProgram->GetDiscriptorLayouts();
 
 	VkDescriptorSetAllocateInfo descSetAlloc{
 		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
-		.descriptorPool = pool,
+		.descriptorPool = m_descriptorPool,
 		.descriptorSetCount = 1,
 		.pSetLayouts = layouts.data(),
 	};
@@ -138,10 +461,24 @@ bool QuantumEngine::Rendering::Vulkan::VulkanSplinePipelineModule::InitializeCom
 	if (vkAllocateDescriptorSets(m_device, &descSetAlloc, &m_computeDescriptorSet) != VK_SUCCESS)
 		return false;
 
-	auto descriptorData = splineEntity.computeProgram->GetReflection().GetDescriptorData("_vertexBuffer");
+	WriteComputeBuffer("Splines", m_parameterBuffer);
+	WriteComputeBuffer("CurvePoints", m_curvePointBuffer);
+	WriteComputeBuffer("CurveArcLengths", m_arcLengthBuffer);
+	WriteComputeBuffer("DirtySplines", m_dirtyBuffer);
+	WriteComputeBuffer("SplineVertices", m_vertexBuffer);
+
+	return true;
+}
+
+void QuantumEngine::Rendering::Vulkan::VulkanSplinePipelineModule::WriteComputeBuffer(const std::string& name, VkBuffer buffer)
+{
+	auto descriptorData = m_computeProgram->GetReflection().GetDescriptorData(name);
+
+	if (descriptorData == nullptr)
+		return;
 
 	VkDescriptorBufferInfo descBufferInfo{
-		.buffer = m_vertexBuffer,
+		.buffer = buffer,
 		.offset = 0,
 		.range = VK_WHOLE_SIZE,
 	};
@@ -160,16 +497,11 @@ bool QuantumEngine::Rendering::Vulkan::VulkanSplinePipelineModule::InitializeCom
 	};
 
 	vkUpdateDescriptorSets(m_device, 1, &writeDescriptor, 0, nullptr);
-
-	return true;
 }
 
-bool QuantumEngine::Rendering::Vulkan::VulkanSplinePipelineModule::InitializeGraphicsPipeline(const SplineEntityData& splineEntity, const VkRenderPass renderPass)
+bool QuantumEngine::Rendering::Vulkan::VulkanSplinePipelineModule::InitializeGraphicsPipeline(SplineMaterialBatch& batch, const VkRenderPass renderPass)
 {
-	m_program = std::dynamic_pointer_cast<Rasterization::SPIRVRasterizationProgram>(splineEntity.splineRenderer->GetMaterial()->GetProgram());
-	m_offset = std::vector<UInt32>(m_program->GetReflection().GetDynamicDescriptorCount(), 0);
-	m_material = splineEntity.material;
-	m_widthOffset = m_program->GetReflection().GetPushConstantBlockData("_width")->offset;
+	batch.offsets = std::vector<UInt32>(batch.program->GetReflection().GetDynamicDescriptorCount(), 0);
 
 	VkPipelineInputAssemblyStateCreateInfo pInputAssemblyInfo{
 		.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
@@ -262,7 +594,7 @@ bool QuantumEngine::Rendering::Vulkan::VulkanSplinePipelineModule::InitializeGra
 		.pDynamicStates = dynamicStates.data(),
 	};
 
-	auto& stages = m_program->GetStageInfos();
+	auto& stages = batch.program->GetStageInfos();
 
 	VkGraphicsPipelineCreateInfo pipelineCreateInfo{
 		.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
@@ -279,7 +611,7 @@ bool QuantumEngine::Rendering::Vulkan::VulkanSplinePipelineModule::InitializeGra
 		.pDepthStencilState = &depthStencilState,
 		.pColorBlendState = &colorBlendStateInfo,
 		.pDynamicState = &dynamicStateInfo,
-		.layout = m_program->GetPipelineLayout(),
+		.layout = batch.program->GetPipelineLayout(),
 		.renderPass = renderPass,
 		.subpass = 0,
 		.basePipelineHandle = VK_NULL_HANDLE,
@@ -287,7 +619,7 @@ bool QuantumEngine::Rendering::Vulkan::VulkanSplinePipelineModule::InitializeGra
 
 	};
 
-	if (vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_graphicsPipeline) != VK_SUCCESS) {
+	if (vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &batch.pipeline) != VK_SUCCESS) {
 		return false;
 	}
 	return true;
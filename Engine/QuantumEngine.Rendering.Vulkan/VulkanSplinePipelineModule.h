@@ -1,8 +1,18 @@
 #pragma once
 #include "Core/Vector2.h"
 #include "Core/Vector3.h"
+#include "Core/RangeAllocator.h"
 #include "vulkan-pch.h"
 
+namespace QuantumEngine {
+	class Transform;
+	class Camera;
+}
+
+namespace QuantumEngine::Core {
+	class BezierCurve;
+}
+
 namespace QuantumEngine::Rendering {
 	class SplineRenderer;
 }
@@ -21,7 +31,8 @@ namespace QuantumEngine::Rendering::Vulkan {
 	struct SplineEntityData {
 		ref<SplineRenderer> splineRenderer;
 		ref<Rasterization::VulkanRasterizationMaterial> material;
-		ref<Compute::SPIRVComputeProgram> computeProgram;
+		ref<Transform> transform;
+		UInt32 transformIndex;
 	};
 
 	struct SplineVertex {
@@ -40,26 +51,76 @@ namespace QuantumEngine::Rendering::Vulkan {
 		}
 	};
 
+	/// <summary>
+	/// Spline slot in the shared parameter buffer, matches SplineData in Common/SplineStructs.hlsli
+	/// </summary>
 	struct SplineParameters {
-		Vector3 startPoint;
 		float width;
-		Vector3 midPoint;
 		float length;
-		Vector3 endPoint;
+		// first vertex of the spline in the shared vertex buffer
+		UInt32 vertexOffset;
+		UInt32 vertexCount;
+		UInt32 transformIndex;
+		// first bezier point and arc length of the curve in the shared curve buffers
+		UInt32 pointOffset;
+		UInt32 segmentCount;
+		UInt32 lengthOffset;
 	};
 
+	struct SplineBatchParameters {
+		UInt32 dirtySplineCount;
+		UInt32 dirtyVertexCount;
+	};
+
+	/// <summary>
+	/// Splines sharing a material, their draw commands are contiguous so one indirect draw covers them
+	/// </summary>
+	struct SplineMaterialBatch {
+		ref<Rasterization::VulkanRasterizationMaterial> material;
+		ref<Rasterization::SPIRVRasterizationProgram> program;
+		VkPipeline pipeline;
+		UInt32 firstDraw;
+		UInt32 drawCount;
+		std::vector<UInt32> offsets;
+	};
+
+	/// <summary>
+	/// Tessellates and draws every spline of the scene from shared parameter and vertex buffers
+	/// </summary>
 	class VulkanSplinePipelineModule {
 	public:
 		VulkanSplinePipelineModule(const VkDevice device);
 		~VulkanSplinePipelineModule();
-		bool Initialize(const SplineEntityData& splineEntity, const VkRenderPass renderPass, const VkDescriptorPool pool);
+		bool Initialize(const std::vector<SplineEntityData>& splineEntities, const ref<Compute::SPIRVComputeProgram>& computeProgram, const VkRenderPass renderPass);
+
+		/// <summary>
+		/// adapts the segment count of every spline to its curvature and screen size, splines that changed
+		/// are moved to a new range of the vertex pool and queued for ComputeCommand
+		/// </summary>
+		void UpdateSegments(const Camera& camera, Float viewportHeight, Float maxPixelError);
+
+		/// <summary>
+		/// rebuilds the vertices of every queued spline with one dispatch, one thread per vertex
+		/// </summary>
 		void ComputeCommand(VkCommandBuffer commandBuffer);
+
+		/// <summary>
+		/// one indirect draw per material, every spline is a separate line strip command
+		/// </summary>
 		void RenderCommand(VkCommandBuffer commandBuffer);
 		void WriteOffset(const std::string name, UInt32 offsetIndex);
 	private:
-		bool InitializeVertexBuffer(const SplineEntityData& splineEntity);
-		bool InitializeComputePipeline(const SplineEntityData& splineEntity, const VkDescriptorPool pool);
-		bool InitializeGraphicsPipeline(const SplineEntityData& splineEntity, const VkRenderPass renderPass);
+		bool InitializeBuffers(const std::vector<SplineEntityData>& splineEntities);
+		bool CreateMappedBuffer(UInt32 size, VkBufferUsageFlags usage, VkBuffer* buffer, VkDeviceMemory* memory, void** data);
+		void WriteCurve(const SplineParameters& parameters, const Core::BezierCurve& curve);
+		void SetVertexRange(UInt32 slot, UInt32 vertexOffset, UInt32 vertexCount);
+		void ResizeVertexRange(UInt32 slot, UInt32 vertexCount);
+		bool CreateVertexBuffer(UInt32 vertexCapacity);
+		bool GrowVertexBuffer(UInt32 vertexCapacity);
+		void CompactVertexRanges();
+		bool InitializeComputePipeline();
+		bool InitializeGraphicsPipeline(SplineMaterialBatch& batch, const VkRenderPass renderPass);
+		void WriteComputeBuffer(const std::string& name, VkBuffer buffer);
 		
 		static VkVertexInputBindingDescription s_bindingDescriptions;
 		static VkVertexInputAttributeDescription s_attributeDescriptions[4];
@@ -67,19 +128,40 @@ namespace QuantumEngine::Rendering::Vulkan {
 		
 		
 		VkDevice m_device;
-		VkBuffer m_vertexBuffer;
-		VkDeviceMemory m_vertexBufferMemory;
+
+		// pool grown on demand up to SplineRenderer::MaxSegments per spline, splines own variable length ranges of it
+		VkBuffer m_vertexBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory m_vertexBufferMemory = VK_NULL_HANDLE;
+		RangeAllocator m_vertexAllocator;
+
+		// host visible and mapped, written while the previous frame's fence guarantees the GPU is idle
+		VkBuffer m_parameterBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory m_parameterBufferMemory = VK_NULL_HANDLE;
+		SplineParameters* m_parameters = nullptr;
+		// bezier points as float4 and arc length tables of every curve
+		VkBuffer m_curvePointBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory m_curvePointBufferMemory = VK_NULL_HANDLE;
+		Float* m_curvePoints = nullptr;
+		VkBuffer m_arcLengthBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory m_arcLengthBufferMemory = VK_NULL_HANDLE;
+		Float* m_arcLengths = nullptr;
+		VkBuffer m_dirtyBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory m_dirtyBufferMemory = VK_NULL_HANDLE;
+		UInt32* m_dirtySplines = nullptr;
+		VkBuffer m_drawCommandBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory m_drawCommandBufferMemory = VK_NULL_HANDLE;
+		VkDrawIndirectCommand* m_drawCommands = nullptr;
 
 		ref<Compute::SPIRVComputeProgram> m_computeProgram;
-		VkPipeline m_computePipeline;
+		VkPipeline m_computePipeline = VK_NULL_HANDLE;
+		VkDescriptorPool m_descriptorPool = VK_NULL_HANDLE;
 		VkDescriptorSet m_computeDescriptorSet;
-		SplineParameters m_splineParameters;
-		UInt32 m_widthOffset;
-		ref<SplineRenderer> m_splineRenderer;
-
-		VkPipeline m_graphicsPipeline;
-		ref<Rasterization::VulkanRasterizationMaterial> m_material;
-		ref<Rasterization::SPIRVRasterizationProgram> m_program;
-		std::vector<UInt32> m_offset;
+
+		// in slot order, grouped by material
+		std::vector<ref<SplineRenderer>> m_splineRenderers;
+		std::vector<ref<Transform>> m_transforms;
+		// splines whose vertices are rebuilt by the next ComputeCommand
+		std::vector<UInt8> m_pendingSplines;
+		std::vector<SplineMaterialBatch> m_batches;
 	};
 }
\ No newline at end of file